@@ -0,0 +1,264 @@
+/*
+ * bench_parse.c — Microbenchmark for parsing an SQL resultset response.
+ *
+ * Parses one synthetic sqlstmnt response of rows x columns quoted fields three ways:
+ *
+ *   malloc    one allocation per row copy, per field and for the result (the parser
+ *             before arena-backed results), freed field by field
+ *   arena     cfrds_buffer_to_sql_sqlstmnt, rows copied once into the arena owned by
+ *             the result and fields terminated in that copy, freed in one call
+ *   views     cfrds_buffer_to_sql_sqlstmnt with result views, fields terminated in place
+ *             and the result taking over the response (copied beforehand, untimed)
+ *
+ * Reported per run: malloc/realloc calls, free calls, and time to parse and free.
+ *
+ * usage: bench_parse [rows] [columns] [rounds]
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+static size_t bench_allocs;
+static size_t bench_frees;
+
+static void *bench_malloc(size_t size)
+{
+    bench_allocs++;
+
+    return malloc(size);
+}
+
+static void *bench_realloc(void *ptr, size_t size)
+{
+    bench_allocs++;
+
+    return realloc(ptr, size);
+}
+
+static void bench_free(void *ptr)
+{
+    if (ptr)
+        bench_frees++;
+
+    free(ptr);
+}
+
+#define malloc bench_malloc
+#define realloc bench_realloc
+#define free bench_free
+#include "../src/cfrds_buffer.c"
+#undef malloc
+#undef realloc
+#undef free
+
+#include <stdio.h>
+#include <time.h>
+
+typedef struct {
+    size_t columns;
+    size_t rows;
+    char *values[];
+} legacy_resultset;
+
+static void legacy_resultset_free(legacy_resultset *value)
+{
+    if (value == NULL)
+        return;
+
+    for (size_t i = 0; i < (value->rows + 1) * value->columns; i++)
+        bench_free(value->values[i]);
+
+    bench_free(value);
+}
+
+/* Same walk as the arena parser, with every row and field in its own allocation. */
+static legacy_resultset *legacy_sqlstmnt(cfrds_buffer *buffer)
+{
+    const char *data = cfrds_buffer_data(buffer);
+    size_t size = cfrds_buffer_data_size(buffer);
+    int64_t cnt = 0;
+    size_t cols = 0;
+
+    if ((!cfrds_buffer_parse_number(&data, &size, &cnt))||(cnt < 1))
+        return NULL;
+
+    const char *start_data = data;
+    size_t start_size = size;
+
+    {
+        cfrds_str_defer(row);
+        if (!cfrds_buffer_parse_string(&data, &size, &row))
+            return NULL;
+
+        const char *walker = row;
+        size_t remaining = strlen(walker);
+        while (remaining)
+        {
+            cfrds_str_defer(field);
+            if (!cfrds_buffer_parse_string_list_item(&walker, &remaining, &field))
+                return NULL;
+            cols++;
+        }
+    }
+
+    size_t buf_size = offsetof(legacy_resultset, values) + sizeof(char *) * (size_t)cnt * cols;
+    legacy_resultset *ret = bench_malloc(buf_size);
+    if (ret == NULL)
+        return NULL;
+
+    memset(ret, 0, buf_size);
+    ret->columns = cols;
+    ret->rows = (size_t)cnt - 1;
+
+    data = start_data;
+    size = start_size;
+
+    for (size_t r = 0; r < (size_t)cnt; r++)
+    {
+        cfrds_str_defer(row);
+        if (!cfrds_buffer_parse_string(&data, &size, &row))
+        {
+            legacy_resultset_free(ret);
+            return NULL;
+        }
+
+        const char *walker = row;
+        size_t remaining = strlen(walker);
+
+        for (size_t c = 0; c < cols; c++)
+        {
+            if (!cfrds_buffer_parse_string_list_item(&walker, &remaining, &ret->values[r * cols + c]))
+            {
+                legacy_resultset_free(ret);
+                return NULL;
+            }
+        }
+    }
+
+    return ret;
+}
+
+static double bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1e9);
+}
+
+typedef enum {
+    BENCH_MALLOC,
+    BENCH_ARENA,
+    BENCH_VIEWS
+} bench_mode;
+
+static int bench_run(const char *name, bench_mode mode, cfrds_buffer *response, size_t rows, size_t columns, int rounds)
+{
+    size_t allocs = 0;
+    size_t frees = 0;
+    double elapsed = 0;
+
+    for (int r = 0; r < rounds; r++)
+    {
+        cfrds_buffer_defer(views);
+        cfrds_buffer *source = response;
+        const char *last = NULL;
+
+        if (mode == BENCH_VIEWS)
+        {
+            /* the result takes the response storage, so every round parses its own copy */
+            if ((!cfrds_buffer_create(&views))||(!cfrds_buffer_append_buffer(views, response)))
+                return 1;
+            cfrds_buffer_set_result_views(views, true);
+            source = views;
+        }
+
+        bench_allocs = 0;
+        bench_frees = 0;
+        double start = bench_now();
+
+        if (mode != BENCH_MALLOC)
+        {
+            cfrds_sql_resultset *value = cfrds_buffer_to_sql_sqlstmnt(source);
+            if ((value == NULL)||(value->rows != rows)||(value->columns != columns))
+                return 1;
+            last = value->values[(rows + 1) * columns - 1].str;
+            if (strcmp(last, "v") != 0)
+                return 1;
+            cfrds_arena_free(value->arena);
+        }
+        else
+        {
+            legacy_resultset *value = legacy_sqlstmnt(response);
+            if ((value == NULL)||(value->rows != rows)||(value->columns != columns))
+                return 1;
+            last = value->values[(rows + 1) * columns - 1];
+            if (strcmp(last, "v") != 0)
+                return 1;
+            legacy_resultset_free(value);
+        }
+
+        elapsed += bench_now() - start;
+        allocs += bench_allocs;
+        frees += bench_frees;
+    }
+
+    printf("%-9s %10zu allocs %10zu frees %9.2f ms\n", name,
+           allocs / (size_t)rounds, frees / (size_t)rounds, elapsed * 1000 / rounds);
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    size_t rows = (argc > 1) ? strtoul(argv[1], NULL, 10) : 9999;
+    size_t columns = (argc > 2) ? strtoul(argv[2], NULL, 10) : 20;
+    int rounds = (argc > 3) ? atoi(argv[3]) : 20;
+    char row[64];
+
+    if (rounds < 1)
+        rounds = 1;
+
+    if ((rows > CFRDS_MAX_PARSER_ITEMS - 1)||(columns < 1))
+    {
+        fprintf(stderr, "rows must be below %d and columns above 0\n", CFRDS_MAX_PARSER_ITEMS);
+        return 1;
+    }
+
+    cfrds_buffer_defer(response);
+    cfrds_buffer_defer(line);
+
+    if ((!cfrds_buffer_create(&response))||(!cfrds_buffer_create(&line)))
+        return 1;
+
+    snprintf(row, sizeof(row), "%zu:", rows + 1);
+    cfrds_buffer_append(response, row);
+
+    for (size_t r = 0; r <= rows; r++)
+    {
+        cfrds_buffer_slice(line, 0, 0);
+        for (size_t c = 0; c < columns; c++)
+        {
+            if (r == 0)
+                snprintf(row, sizeof(row), "%s\"column%zu\"", c ? "," : "", c);
+            else
+                snprintf(row, sizeof(row), "%s\"%s\"", c ? "," : "", (c + 1 == columns) ? "v" : "value");
+            cfrds_buffer_append(line, row);
+        }
+        snprintf(row, sizeof(row), "%zu:", cfrds_buffer_data_size(line));
+        cfrds_buffer_append(response, row);
+        cfrds_buffer_append_buffer(response, line);
+    }
+
+    printf("%zu rows x %zu columns, %zu bytes, average of %d rounds\n",
+           rows, columns, cfrds_buffer_data_size(response), rounds);
+
+    int ret = bench_run("malloc", BENCH_MALLOC, response, rows, columns, rounds);
+    if (ret == 0)
+        ret = bench_run("arena", BENCH_ARENA, response, rows, columns, rounds);
+    if (ret == 0)
+        ret = bench_run("views", BENCH_VIEWS, response, rows, columns, rounds);
+
+    return ret;
+}
@@ -0,0 +1,200 @@
+/*
+ * bench_recv.c — Microbenchmark for receiving a response body into a cfrds_buffer.
+ *
+ * A writer thread sends one large HTTP response over a local socket pair and the
+ * reader collects its body three ways:
+ *
+ *   baseline  4KB reads into a stack buffer, body copied into the response buffer
+ *             by the parser callback (the receive loop before direct receive)
+ *   bounce    http_receive_response without a target buffer (64KB reads, copied)
+ *   direct    http_receive_response receiving into the response buffer in place
+ *
+ * Reported per run: recv calls, body bytes copied out of a bounce buffer, and time.
+ *
+ * usage: bench_recv [body size in MB] [rounds]
+ */
+
+#include <sys/types.h>
+#include <sys/socket.h>
+
+static size_t bench_recv_calls;
+
+static ssize_t bench_recv(int sockfd, void *buf, size_t len, int flags)
+{
+    bench_recv_calls++;
+
+    return recv(sockfd, buf, len, flags);
+}
+
+#define recv bench_recv
+#include "../src/cfrds_buffer.c"
+#include "../src/cfrds_http.c"
+#undef recv
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+
+typedef struct {
+    int sockfd;
+    const char *head;
+    const char *body;
+    size_t body_size;
+} bench_writer;
+
+typedef struct {
+    cfrds_buffer *buffer;
+    size_t copied;
+} bench_sink;
+
+static void *bench_write(void *arg)
+{
+    bench_writer *writer = arg;
+    const cfrds_http_segment segs[] = {
+        { .data = writer->head, .size = strlen(writer->head) },
+        { .data = writer->body, .size = writer->body_size },
+    };
+
+    cfrds_server_defer(server);
+    if (cfrds_server_init(&server, "127.0.0.1", 80, "admin", "secret"))
+        http_send_all(server, writer->sockfd, segs, 2, UINT64_MAX, NULL);
+
+    return NULL;
+}
+
+static cfrds_status bench_append(void *ctx, const char *data, size_t size)
+{
+    bench_sink *sink = ctx;
+
+    sink->copied += size;
+    if (!cfrds_buffer_append_bytes(sink->buffer, data, size))
+        return CFRDS_STATUS_MEMORY_ERROR;
+
+    return CFRDS_STATUS_OK;
+}
+
+static cfrds_status baseline_receive(cfrds_socket sockfd, cfrds_http_parser *parser)
+{
+    while (parser->state != CFRDS_HTTP_STATE_DONE)
+    {
+        char recv_buf[4096];
+        ssize_t nread = bench_recv(sockfd, recv_buf, sizeof(recv_buf), 0);
+        if (nread <= 0)
+            return cfrds_http_parser_finish(parser);
+
+        cfrds_status status = cfrds_http_parser_feed(parser, recv_buf, (size_t)nread, NULL);
+        if (status != CFRDS_STATUS_OK)
+            return status;
+    }
+
+    return CFRDS_STATUS_OK;
+}
+
+static double bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1e9);
+}
+
+static int bench_run(const char *name, int mode, const char *body, size_t body_size, int rounds)
+{
+    char head[128];
+    size_t calls = 0;
+    size_t copied = 0;
+    double elapsed = 0;
+
+    snprintf(head, sizeof(head), "HTTP/1.1 200 OK\r\nContent-Length: %zu\r\n\r\n", body_size);
+
+    for (int r = 0; r < rounds; r++)
+    {
+        int fds[2];
+        pthread_t thread;
+        cfrds_http_parser parser;
+        size_t received = 0;
+        bool reusable = false;
+        cfrds_status status;
+
+        cfrds_server_defer(server);
+        cfrds_buffer_defer(response);
+        bench_sink sink = { 0, };
+
+        if ((!cfrds_server_init(&server, "127.0.0.1", 80, "admin", "secret"))||(!cfrds_buffer_create(&response)))
+            return 1;
+
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+            return 1;
+
+        bench_writer writer = { fds[0], head, body, body_size };
+        sink.buffer = response;
+
+        if (!cfrds_http_parser_init(&parser, bench_append, &sink))
+            return 1;
+        parser.max_body_size = UINT64_MAX;
+
+        if (pthread_create(&thread, NULL, bench_write, &writer) != 0)
+            return 1;
+
+        bench_recv_calls = 0;
+        double start = bench_now();
+
+        if (mode == 0)
+            status = baseline_receive(fds[1], &parser);
+        else
+            status = http_receive_response(server, fds[1], &parser, (mode == 2) ? response : NULL, UINT64_MAX, &received, NULL, &reusable);
+
+        elapsed += bench_now() - start;
+
+        pthread_join(thread, NULL);
+        cfrds_http_parser_cleanup(&parser);
+        close(fds[0]);
+        close(fds[1]);
+
+        if ((status != CFRDS_STATUS_OK)||(cfrds_buffer_data_size(response) != body_size)||
+            (memcmp(cfrds_buffer_data(response), body, body_size) != 0))
+        {
+            fprintf(stderr, "%s: body mismatch (status %d)\n", name, status);
+            return 1;
+        }
+
+        calls += bench_recv_calls;
+        copied += sink.copied;
+    }
+
+    printf("%-9s %10zu recv calls %12zu bytes copied %9.2f ms\n", name,
+           calls / (size_t)rounds, copied / (size_t)rounds, elapsed * 1000 / rounds);
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    size_t body_size = ((argc > 1) ? strtoul(argv[1], NULL, 10) : 64) * 1024 * 1024;
+    int rounds = (argc > 2) ? atoi(argv[2]) : 5;
+
+    if (rounds < 1)
+        rounds = 1;
+
+    char *body = malloc(body_size);
+    if (body == NULL)
+        return 1;
+
+    for (size_t i = 0; i < body_size; i++)
+        body[i] = (char)('a' + (i % 26));
+
+    printf("body %zu bytes, average of %d rounds\n", body_size, rounds);
+
+    int ret = bench_run("baseline", 0, body, body_size, rounds);
+    if (ret == 0)
+        ret = bench_run("bounce", 1, body, body_size, rounds);
+    if (ret == 0)
+        ret = bench_run("direct", 2, body, body_size, rounds);
+
+    free(body);
+
+    return ret;
+}
@@ -0,0 +1,218 @@
+/*
+ * bench_wddx.c — Microbenchmark for parsing a WDDX packet.
+ *
+ * Parses one synthetic packet shaped like a debugger scope dump (a struct of vars,
+ * each a struct of strings, numbers, booleans and a small array) two ways:
+ *
+ *   dom       xmlParseMemory into a libxml2 document, then walking it into WDDX
+ *             nodes (wddx_from_xml before the single-pass reader)
+ *   reader    wddx_from_xml, building the nodes while reading the text once
+ *
+ * Reported per run: malloc/realloc calls, time to parse the packet and time to free it.
+ * Allocations made inside libxml2 are not counted, nor are the var names the DOM
+ * walk copies with strdup.
+ *
+ * Then every var is looked up by name with wddx_get_var, through the struct's key
+ * index and with the index detached (the linear scan lookups did before), and the
+ * parsed packet is written back out through a libxml2 document (wddx_to_xml before
+ * the direct serializer) and with wddx_to_xml. The libxml2 output is shorter: it
+ * drops the NAME strings, whose '&' it takes for the start of an entity.
+ *
+ * usage: bench_wddx [vars] [rounds]
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+static size_t bench_allocs;
+
+static void *bench_malloc(size_t size)
+{
+    bench_allocs++;
+
+    return malloc(size);
+}
+
+static void *bench_realloc(void *ptr, size_t size)
+{
+    bench_allocs++;
+
+    return realloc(ptr, size);
+}
+
+#define malloc bench_malloc
+#define realloc bench_realloc
+#include "../src/cfrds_buffer.c"
+#include "../src/wddx.c"
+#undef malloc
+#undef realloc
+
+#include <stdio.h>
+#include <time.h>
+
+static double bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1e9);
+}
+
+static int bench_run(const char *name, WDDX *(*parse)(const char *), const char *xml, size_t vars, int rounds)
+{
+    size_t allocs = 0;
+    double parse_time = 0;
+    double free_time = 0;
+
+    for (int r = 0; r < rounds; r++)
+    {
+        bench_allocs = 0;
+        double start = bench_now();
+
+        WDDX *value = parse(xml);
+        if ((value == NULL)||(wddx_node_struct_size(wddx_data(value)) != (int)vars))
+            return 1;
+
+        double parsed = bench_now();
+        wddx_cleanup(&value);
+
+        parse_time += parsed - start;
+        free_time += bench_now() - parsed;
+        allocs += bench_allocs;
+    }
+
+    printf("%-9s %10zu allocs %9.2f ms parse %9.2f ms free\n", name,
+           allocs / (size_t)rounds, parse_time * 1000 / rounds, free_time * 1000 / rounds);
+
+    return 0;
+}
+
+static int bench_lookup(const char *name, WDDX *value, size_t vars, bool indexed)
+{
+    struct WDDX_NODE *data = (struct WDDX_NODE *)wddx_data(value);
+    wddx_struct_index *index = data->index;
+    char key[64];
+
+    if (!indexed)
+        data->index = NULL;
+
+    double start = bench_now();
+
+    for (size_t v = 0; v < vars; v++)
+    {
+        snprintf(key, sizeof(key), "VARIABLE%zu,COUNT", v);
+        if (wddx_get_var(value, key) == NULL)
+        {
+            data->index = index;
+            return 1;
+        }
+    }
+
+    double elapsed = bench_now() - start;
+
+    data->index = index;
+
+    printf("%-9s %10zu lookups %8.2f ms\n", name, vars, elapsed * 1000);
+
+    return 0;
+}
+
+static size_t bench_serialize_libxml2(WDDX *value)
+{
+    xmlBufferPtr xml = wddx_to_xml_libxml2(value);
+    if (xml == NULL)
+        return 0;
+
+    size_t size = (size_t)xmlBufferLength(xml);
+    xmlBufferFree(xml);
+
+    return size;
+}
+
+static size_t bench_serialize_direct(WDDX *value)
+{
+    const char *xml = wddx_to_xml(value);
+
+    return xml ? strlen(xml) : 0;
+}
+
+static int bench_serialize(const char *name, size_t (*serialize)(WDDX *), WDDX *value, int rounds)
+{
+    size_t allocs = 0;
+    size_t size = 0;
+    double elapsed = 0;
+
+    for (int r = 0; r < rounds; r++)
+    {
+        bench_allocs = 0;
+        double start = bench_now();
+
+        size = serialize(value);
+        if (size == 0)
+            return 1;
+
+        elapsed += bench_now() - start;
+        allocs += bench_allocs;
+    }
+
+    printf("%-9s %10zu allocs %9.2f ms %10zu bytes\n", name, allocs / (size_t)rounds, elapsed * 1000 / rounds, size);
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    size_t vars = (argc > 1) ? strtoul(argv[1], NULL, 10) : 5000;
+    int rounds = (argc > 2) ? atoi(argv[2]) : 20;
+    char line[512];
+
+    if (rounds < 1)
+        rounds = 1;
+
+    cfrds_buffer_defer(xml);
+
+    if (!cfrds_buffer_create(&xml))
+        return 1;
+
+    cfrds_buffer_append(xml, "<wddxPacket version='1.0'><header/><data><struct type='coldfusion.runtime.Struct'>");
+    for (size_t v = 0; v < vars; v++)
+    {
+        snprintf(line, sizeof(line),
+                 "<var name='VARIABLE%zu'><struct>"
+                 "<var name='NAME'><string>value &amp; text %zu</string></var>"
+                 "<var name='COUNT'><number>%zu.0</number></var>"
+                 "<var name='ENABLED'><boolean value='%s'/></var>"
+                 "<var name='ITEMS'><array length='2'><string>a</string><string>b</string></array></var>"
+                 "</struct></var>",
+                 v, v, v, (v % 2) ? "true" : "false");
+        cfrds_buffer_append(xml, line);
+    }
+    cfrds_buffer_append(xml, "</struct></data></wddxPacket>");
+
+    printf("%zu vars, %zu bytes, average of %d rounds\n", vars, cfrds_buffer_data_size(xml), rounds);
+
+    /* the parsers take a C string */
+    if (!cfrds_buffer_append_bytes(xml, "", 1))
+        return 1;
+
+    int ret = bench_run("dom", wddx_from_xml_dom, cfrds_buffer_data(xml), vars, rounds);
+    if (ret == 0)
+        ret = bench_run("reader", wddx_from_xml, cfrds_buffer_data(xml), vars, rounds);
+
+    WDDX_defer(value);
+    value = wddx_from_xml(cfrds_buffer_data(xml));
+    if (value == NULL)
+        return 1;
+
+    if (ret == 0)
+        ret = bench_lookup("scan", value, vars, false);
+    if (ret == 0)
+        ret = bench_lookup("index", value, vars, true);
+    if (ret == 0)
+        ret = bench_serialize("libxml2", bench_serialize_libxml2, value, rounds);
+    if (ret == 0)
+        ret = bench_serialize("direct", bench_serialize_direct, value, rounds);
+
+    return ret;
+}
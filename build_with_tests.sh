@@ -9,3 +9,10 @@ cmake --build build
 
 ./bin/test_buffer
 ./bin/test_wddx
+./bin/test_http
+./bin/test_file
+./bin/test_sql
+./bin/test_loop
+./bin/test_batch
+./bin/test_retry
+./bin/test_threads
@@ -1,5 +1,30 @@
 #include "cmd_common.h"
 
+typedef struct {
+    file_hnd_fd fd;
+    int err;
+} file_sink;
+
+static cfrds_status write_to_file(void *ctx, const void *data, size_t size)
+{
+    file_sink *sink = ctx;
+
+    while (size > 0)
+    {
+        ssize_t written = os_write(sink->fd, data, size);
+        if (written <= 0)
+        {
+            sink->err = errno;
+            return CFRDS_STATUS_COMMAND_FAILED;
+        }
+
+        data = (const char *)data + written;
+        size -= (size_t)written;
+    }
+
+    return CFRDS_STATUS_OK;
+}
+
 int handle_cmd_file(cfrds_server *server, const char *command, const char *path, int argc, char *argv[], cfrds_str *cfroot)
 {
     (void)argc;
@@ -109,13 +134,8 @@ int handle_cmd_file(cfrds_server *server, const char *command, const char *path,
         }
         return EXIT_SUCCESS;
     } else if ((strcmp(command, "get") == 0)||(strcmp(command, "download") == 0)) {
-        res = cfrds_command_file_read(server, path, &content);
-        if (res != CFRDS_STATUS_OK)
-        {
-            HANDLE_SERVER_ERROR(res, "get/download FAILED with error");
-        }
-
         const char *dest_fname = argv[3];
+        size_t to_write = 0;
 
         os_file_defer(fd);
 
@@ -125,16 +145,20 @@ int handle_cmd_file(cfrds_server *server, const char *command, const char *path,
             HANDLE_ERROR(CFRDS_STATUS_INVALID_INPUT_PARAMETER, "open FAILED with error: %s", strerror(errno));
         }
 
-        size_t to_write = cfrds_file_content_get_size(content);
-        if (to_write == (size_t)-1)
+        /* the file is written as it is received, never held in memory */
+        file_sink sink = { .fd = fd, .err = 0 };
+        res = cfrds_command_file_read_stream(server, path, write_to_file, &sink, &to_write);
+        if (res != CFRDS_STATUS_OK)
         {
-            HANDLE_SERVER_ERROR(CFRDS_STATUS_RESPONSE_ERROR, "get/download FAILED with error");
-        }
+            os_file_close(fd);
+            fd = FILE_HND_FD_NULL;
+            os_remove_file(dest_fname);
 
-        ssize_t written = os_write(fd, cfrds_file_content_get_data(content), to_write);
-        if ((written < 0) || ((size_t)written != to_write))
-        {
-            HANDLE_ERROR(CFRDS_STATUS_INVALID_INPUT_PARAMETER, "write FAILED with error: %s", strerror(errno));
+            if (sink.err != 0)
+            {
+                HANDLE_ERROR(CFRDS_STATUS_INVALID_INPUT_PARAMETER, "write FAILED with error: %s", strerror(sink.err));
+            }
+            HANDLE_SERVER_ERROR(res, "get/download FAILED with error");
         }
 
         if (json_output)
@@ -149,21 +173,11 @@ int handle_cmd_file(cfrds_server *server, const char *command, const char *path,
         return EXIT_SUCCESS;
     } else if ((strcmp(command, "put") == 0)||(strcmp(command, "upload") == 0)) {
         const char *src_fname = argv[2];
-        size_t src_size = 0;
-        void *buf = NULL;
-
-        buf = os_map(src_fname, &src_size);
-        if ((buf == NULL)&&(src_size > 0))
-        {
-            HANDLE_ERROR(CFRDS_STATUS_INVALID_INPUT_PARAMETER, "mmap FAILED with error: %s", strerror(errno));
-        }
 
-        res = cfrds_command_file_write(server, path, buf, src_size);
+        res = cfrds_command_file_write_from_path(server, path, src_fname);
         if (res != CFRDS_STATUS_OK) {
-            os_unmap(buf, src_size);
             HANDLE_SERVER_ERROR(res, "upload FAILED with error");
         }
-        os_unmap(buf, src_size);
 
         if (json_output)
         {
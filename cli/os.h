@@ -21,12 +21,10 @@ typedef int file_hnd_fd;
 
 file_hnd_fd os_creat_file(const char* pathname);
 void os_file_close(file_hnd_fd hnd_fd);
+int os_remove_file(const char *pathname);
 
 ssize_t os_write(file_hnd_fd hnd_fd, const void *buffer, size_t len);
 
-void* os_map(const char* pathname, size_t* size);
-void os_unmap(void *addr, size_t size);
-
 ssize_t os_write_to_terminal(const void *buffer, size_t len);
 
 void os_file_cleanup(void *fd);
@@ -7,7 +7,6 @@
 
 #include <sys/types.h>
 #include <sys/stat.h>
-#include <sys/mman.h>
 #include <unistd.h>
 #include <fcntl.h>
 
@@ -22,42 +21,14 @@ void os_file_close(file_hnd_fd hnd_fd)
     close(hnd_fd);
 }
 
-ssize_t os_write(file_hnd_fd hnd_fd, const void *buffer, size_t len)
+int os_remove_file(const char *pathname)
 {
-    return write(hnd_fd, buffer, len);
-}
-
-void* os_map(const char *pathname, size_t* size)
-{
-    void* ret = NULL;
-    struct stat stat;
-    os_file_defer(fd);
-
-    fd = open(pathname, O_RDONLY);
-    if (fd == -1)
-        return NULL;
-
-    if (fstat(fd, &stat))
-        return NULL;
-
-    if (stat.st_size < 0)
-        return NULL;
-
-    *size = (size_t)stat.st_size;
-
-    if (stat.st_size == 0)
-        return NULL;
-
-    ret = mmap(NULL, (size_t)stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
-    if (ret == MAP_FAILED)
-        return NULL;
-
-    return ret;
+    return unlink(pathname);
 }
 
-void os_unmap(void* addr, size_t size)
+ssize_t os_write(file_hnd_fd hnd_fd, const void *buffer, size_t len)
 {
-    munmap(addr, size);
+    return write(hnd_fd, buffer, len);
 }
 
 ssize_t os_write_to_terminal(const void *buffer, size_t len)
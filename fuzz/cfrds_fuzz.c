@@ -121,13 +121,7 @@ int LLVMFuzzerTestOneInput_rds_browse_dir(const uint8_t *Data, size_t Size) {
     }
 
     cfrds_browse_dir *res = cfrds_buffer_to_browse_dir(buf);
-    if (res) {
-        // Free items
-        for (size_t i = 0; i < res->cnt; i++) {
-            free(res->items[i].name);
-        }
-        free(res);
-    }
+    cfrds_browse_dir_free(res);
 
     cfrds_buffer_free(buf);
     return 0;
@@ -145,14 +139,7 @@ int LLVMFuzzerTestOneInput_rds_sql_sqlstmnt(const uint8_t *Data, size_t Size) {
     }
 
     cfrds_sql_resultset *res = cfrds_buffer_to_sql_sqlstmnt(buf);
-    if (res) {
-        // Free all values
-        size_t total = res->columns * (res->rows + 1);
-        for (size_t i = 0; i < total; i++) {
-            free(res->values[i]);
-        }
-        free(res);
-    }
+    cfrds_sql_resultset_free(res);
 
     cfrds_buffer_free(buf);
     return 0;
@@ -212,10 +199,7 @@ int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size) {
                 cfrds_buffer_create(&buf);
                 cfrds_buffer_append_bytes(buf, Data + 1, Size - 1);
                 cfrds_browse_dir *res = cfrds_buffer_to_browse_dir(buf);
-                if (res) {
-                    for (size_t i = 0; i < res->cnt; i++) free(res->items[i].name);
-                    free(res);
-                }
+                cfrds_browse_dir_free(res);
                 cfrds_buffer_free(buf);
             }
             break;
@@ -70,11 +70,14 @@ typedef struct cfrds_sql_importedkeys cfrds_sql_importedkeys;
 typedef struct cfrds_sql_exportedkeys cfrds_sql_exportedkeys;
 typedef struct cfrds_sql_resultset cfrds_sql_resultset;
 typedef struct cfrds_sql_metadata cfrds_sql_metadata;
+typedef struct cfrds_sql_cursor cfrds_sql_cursor;
 typedef struct cfrds_sql_supportedcommands cfrds_sql_supportedcommands;
 typedef struct WDDX cfrds_debugger_event;
 typedef struct json_object cfrds_security_analyzer_result;
 typedef struct WDDX cfrds_adminapi_customtagpaths;
 typedef struct WDDX cfrds_adminapi_mappings;
+typedef struct cfrds_loop cfrds_loop;
+typedef struct cfrds_batch cfrds_batch;
 
 typedef enum {
     CFRDS_STATUS_OK,
@@ -103,6 +106,18 @@ typedef enum {
     CFRDS_DEBUGGER_EVENT_UNKNOWN,
 } cfrds_debugger_type;
 
+/** @brief Storage of one column of a columnar SQL resultset, see cfrds_sql_resultset_make_columnar(). */
+typedef enum {
+    CFRDS_SQL_COLUMN_NONE,
+    CFRDS_SQL_COLUMN_TEXT,
+    CFRDS_SQL_COLUMN_INT64,
+    CFRDS_SQL_COLUMN_DOUBLE,
+    CFRDS_SQL_COLUMN_BOOL,
+} cfrds_sql_column_type;
+
+/** @brief Tests bit `row` of a null bitmap returned by cfrds_sql_resultset_column_nulls(). */
+#define CFRDS_SQL_IS_NULL(nulls, row) ((((nulls)[(row) / 8]) >> ((row) % 8)) & 1)
+
 #if defined(__GNUC__) || defined(__clang__)
 #define cfrds_buffer_defer(var) cfrds_buffer* var __attribute__((cleanup(cfrds_buffer_cleanup))) = NULL
 #define cfrds_file_content_defer(var) cfrds_file_content* var __attribute__((cleanup(cfrds_file_content_cleanup))) = NULL
@@ -120,23 +135,29 @@ typedef enum {
 #define cfrds_sql_importedkeys_defer(var) cfrds_sql_importedkeys* var __attribute__((cleanup(cfrds_sql_importedkeys_cleanup))) = NULL
 #define cfrds_sql_exportedkeys_defer(var) cfrds_sql_exportedkeys* var __attribute__((cleanup(cfrds_sql_exportedkeys_cleanup))) = NULL
 #define cfrds_sql_resultset_defer(var) cfrds_sql_resultset* var __attribute__((cleanup(cfrds_sql_resultset_cleanup))) = NULL
+#define cfrds_sql_cursor_defer(var) cfrds_sql_cursor* var __attribute__((cleanup(cfrds_sql_cursor_cleanup))) = NULL
 #define cfrds_sql_metadata_defer(var) cfrds_sql_metadata* var __attribute__((cleanup(cfrds_sql_metadata_cleanup))) = NULL
 #define cfrds_sql_supportedcommands_defer(var) cfrds_sql_supportedcommands* var __attribute__((cleanup(cfrds_sql_supportedcommands_cleanup))) = NULL
 #define cfrds_debugger_event_defer(var) cfrds_debugger_event* var __attribute__((cleanup(cfrds_debugger_event_cleanup))) = NULL
 #define cfrds_security_analyzer_result_defer(var) cfrds_security_analyzer_result* var __attribute__((cleanup(cfrds_security_analyzer_result_cleanup))) = NULL
 #define cfrds_adminapi_customtagpaths_defer(var) cfrds_adminapi_customtagpaths* var __attribute__((cleanup(cfrds_adminapi_customtagpaths_cleanup))) = NULL
 #define cfrds_adminapi_mappings_defer(var) cfrds_adminapi_mappings* var __attribute__((cleanup(cfrds_adminapi_mappings_cleanup))) = NULL
+#define cfrds_loop_defer(var) cfrds_loop* var __attribute__((cleanup(cfrds_loop_cleanup))) = NULL
+#define cfrds_batch_defer(var) cfrds_batch* var __attribute__((cleanup(cfrds_batch_cleanup))) = NULL
 #endif
 
 /**
  * @note Thread Safety
  *
- * This library is NOT thread-safe. A `cfrds_server` instance must not be used
- * concurrently from multiple threads without external synchronisation.
+ * A `cfrds_server` instance may be shared by threads once it is configured: commands
+ * on it can run concurrently and share its keep-alive pool and DNS cache, while the
+ * error state (`cfrds_server_get_error` and friends) is kept per thread.
  *
- * Each thread must create and manage its own `cfrds_server` instance.
+ * The `cfrds_server_set_*` calls are not synchronized and must be made before the
+ * server is shared, and `cfrds_server_free` only once no other thread uses it.
+ * A `cfrds_loop` or `cfrds_batch` belongs to one thread at a time.
  * Result types (`cfrds_browse_dir`, `cfrds_file_content`, `cfrds_sql_resultset`,
- * etc.) are likewise not safe to share across threads without external locking.
+ * etc.) are not safe to share across threads without external locking.
  */
 
 #ifdef __cplusplus
@@ -178,6 +199,11 @@ EXPORT_CFRDS void cfrds_str_cleanup(cfrds_str *str);
 
 /**
  * @brief Initializes a cfrds_server connection instance.
+ *
+ * Once configured, a server may be shared by threads: commands can be issued concurrently
+ * and share the keep-alive pool and DNS cache, while error state is kept per thread.
+ * The `cfrds_server_set_*` configuration calls are not synchronized and belong before sharing.
+ *
  * @param server Output pointer to the initialized server structure. Must be freed with cfrds_server_free.
  * @param host The hostname or IP address of the ColdFusion server.
  * @param port The port number of the server (typically 8500 or 80).
@@ -189,6 +215,10 @@ EXPORT_CFRDS bool cfrds_server_init(cfrds_server **server, const char *host, uin
 
 /**
  * @brief Deallocates all resources associated with a cfrds_server instance.
+ *
+ * No other thread may be inside a call on the server. The calling thread's error state for the server
+ * is released; other threads that used it release theirs when they next need a new error state or exit.
+ *
  * @param server Server instance to free. Safe to call if NULL.
  */
 EXPORT_CFRDS void cfrds_server_free(cfrds_server *server);
@@ -200,15 +230,16 @@ EXPORT_CFRDS void cfrds_server_free(cfrds_server *server);
 EXPORT_CFRDS void cfrds_server_cleanup(cfrds_server **server);
 
 /**
- * @brief Clears the internal error status of the cfrds_server instance.
+ * @brief Clears the error status of the calling thread on the cfrds_server instance.
  * @param server Server instance.
  */
 EXPORT_CFRDS void cfrds_server_clear_error(cfrds_server *server);
 
 /**
- * @brief Retrieves the last recorded error message for the server.
+ * @brief Retrieves the last error message recorded for the server by the calling thread.
  * @param server Server instance.
  * @return Const pointer to the error string, or NULL if no error has occurred.
+ *         Valid until the thread's next call on the server.
  */
 EXPORT_CFRDS const char *cfrds_server_get_error(const cfrds_server *server);
 
@@ -240,6 +271,142 @@ EXPORT_CFRDS const char *cfrds_server_get_username(const cfrds_server *server);
  */
 EXPORT_CFRDS const char *cfrds_server_get_password(const cfrds_server *server);
 
+/**
+ * @brief Enables or disables HTTP keep-alive connection reuse for the server.
+ *
+ * When enabled, requests ask the server to keep the TCP connection open and responses
+ * are framed by their `Content-Length`, so finished connections are parked in a
+ * per-server pool and reused by the next command. Idle connections are health checked
+ * before reuse and dropped once they exceed the idle timeout; a stale connection is
+ * transparently replaced by a fresh one. Changing the setting closes all idle connections.
+ * @param server Server instance.
+ * @param enabled true to reuse connections, false to open a new connection per command (default).
+ * @param max_idle Maximum number of idle connections kept in the pool. 0 selects the default (4).
+ * @param idle_timeout_sec Seconds an idle connection may stay in the pool. 0 selects the default (15).
+ * @return true on success, false if server is NULL.
+ */
+EXPORT_CFRDS bool cfrds_server_set_keepalive(cfrds_server *server, bool enabled, size_t max_idle, unsigned int idle_timeout_sec);
+
+/**
+ * @brief Prewarms the keep-alive pool of the server with open connections.
+ *
+ * Opens connections until `count` idle ones (at most the pool size set with
+ * `cfrds_server_set_keepalive`) are waiting, so a burst of commands such as a debugger session
+ * or a recursive sync does not pay the connection setup on its first requests.
+ * @param server Server instance with keep-alive enabled.
+ * @param count Number of idle connections wanted.
+ * @return CFRDS_STATUS_OK, CFRDS_STATUS_INVALID_INPUT_PARAMETER if keep-alive is disabled,
+ *         or the connection error of the first connection that failed.
+ */
+EXPORT_CFRDS cfrds_status cfrds_server_prewarm(cfrds_server *server, size_t count);
+
+/**
+ * @brief Sets how long the resolved addresses of the server host are reused.
+ *
+ * The host name is resolved on the first connection and the result is kept for `ttl_sec`
+ * seconds instead of calling the resolver for every command. If no cached address accepts a
+ * connection, the host is resolved again right away. Changing the setting drops the cache.
+ * @param server Server instance.
+ * @param ttl_sec Seconds a lookup stays valid, 0 resolves on every connection. Default 30.
+ * @return true on success, false if server is NULL.
+ */
+EXPORT_CFRDS bool cfrds_server_set_dns_cache(cfrds_server *server, unsigned int ttl_sec);
+
+/**
+ * @brief Enables or disables Happy Eyeballs (RFC 8305) connection setup for the server.
+ *
+ * When enabled and the host resolves to several addresses, the next address (alternating
+ * between IPv6 and IPv4) is tried in parallel whenever the previous attempts have not
+ * connected within 250ms, and the first connection established is used. When disabled the
+ * addresses are tried one after another (default).
+ * @param server Server instance.
+ * @param enabled true to race connection attempts, false to connect sequentially.
+ * @return true on success, false if server is NULL.
+ */
+EXPORT_CFRDS bool cfrds_server_set_happy_eyeballs(cfrds_server *server, bool enabled);
+
+/**
+ * @brief Sets the deadlines of every request sent to the server.
+ *
+ * Sockets are non-blocking and each wait is bounded with `poll` on a monotonic clock, so a
+ * latency-sensitive caller can cap a command at a few hundred milliseconds while a bulk export
+ * allows minutes. Each deadline is also capped by the total one. Applies to blocking commands,
+ * `cfrds_loop` requests and `cfrds_batch` connections.
+ * @param server Server instance.
+ * @param connect_ms Time allowed to establish the TCP connection. 0 selects the default of 30 seconds.
+ * @param first_byte_ms Time allowed between the end of the request and the first response byte. 0 selects the default of 30 seconds.
+ * @param total_ms Time allowed for the whole request, from connecting to the last response byte. 0 selects the default of 60 seconds.
+ * @return true on success, false if server is NULL.
+ */
+EXPORT_CFRDS bool cfrds_server_set_timeouts(cfrds_server *server, unsigned int connect_ms, unsigned int first_byte_ms, unsigned int total_ms);
+
+/**
+ * @brief Sets how large a buffered response may grow and where it is kept.
+ *
+ * Responses collected in memory (every command except streamed file downloads) fail with
+ * `CFRDS_STATUS_RESPONSE_TOO_LARGE` past `max_size`. With a spill threshold, a response that
+ * outgrows it moves to a memory-mapped temporary file (in `TMPDIR`, or `/tmp`) that is deleted
+ * with the response, so large log downloads and SQL exports are parsed from one contiguous view
+ * without holding the whole body in anonymous memory. Applies to blocking commands, `cfrds_loop`
+ * requests and `cfrds_batch` requests.
+ * @param server Server instance.
+ * @param max_size Largest accepted response body in bytes. 0 selects the default of 100MB.
+ * @param spill_threshold Response size in bytes past which the body is spilled to a file, 0 to keep responses on the heap (default).
+ * @return true on success, false if server is NULL.
+ */
+EXPORT_CFRDS bool cfrds_server_set_response_limits(cfrds_server *server, uint64_t max_size, size_t spill_threshold);
+
+/**
+ * @brief Sets whether parsed results borrow their strings from the response.
+ *
+ * When enabled, result strings are terminated in place inside the response body and the
+ * result takes over the response storage (heap or spilled file), instead of copying every
+ * field into its arena. String accessors return pointers into that storage and the `_len`
+ * accessors report string lengths without a `strlen`. Results are released with their usual
+ * `_free` function either way. Applies to blocking commands, `cfrds_loop` requests and
+ * `cfrds_batch` requests; disabled by default.
+ * @param server Server instance.
+ * @param enabled true to parse results as views into the response, false to copy strings.
+ * @return true on success, false if server is NULL.
+ */
+EXPORT_CFRDS bool cfrds_server_set_result_views(cfrds_server *server, bool enabled);
+
+/** @brief `hedge_after_ms` value hedging after the 95th percentile of recent response times. */
+#define CFRDS_HEDGE_AFTER_P95 ((unsigned int)-1)
+
+/**
+ * @brief Sets how idempotent commands recover from slow or failing requests.
+ *
+ * Read-only commands (directory listings, file reads and existence checks, database metadata,
+ * `IDE_DEFAULT`) are retried after connect, read and write errors, timeouts and HTTP 5xx
+ * responses, waiting a random time between 0 and `min(backoff_max_ms, backoff_base_ms * 2^n)`
+ * before retry n (full jitter). With hedging, a request that has not received its first response
+ * byte after `hedge_after_ms` is sent again on a new connection and whichever connection answers
+ * first is read, the other one is dropped. Retries and hedges stay within the total deadline of
+ * `cfrds_server_set_timeouts`. Commands that change state are never repeated. Applies to blocking
+ * commands.
+ * @param server Server instance.
+ * @param max_attempts Attempts per command, including the first one. 0 selects the default of 1 (no retries).
+ * @param backoff_base_ms Upper bound of the first retry delay. 0 selects the default of 50ms.
+ * @param backoff_max_ms Cap of the retry delay. 0 selects the default of 2 seconds.
+ * @param hedge_after_ms Time to wait for the first response byte before hedging, `CFRDS_HEDGE_AFTER_P95`
+ *                       for the 95th percentile of the first byte times of the last 64 successful idempotent
+ *                       commands (once 16 were measured), or 0 to disable hedging (default).
+ * @return true on success, false if server is NULL.
+ */
+EXPORT_CFRDS bool cfrds_server_set_retry_policy(cfrds_server *server, unsigned int max_attempts, unsigned int backoff_base_ms, unsigned int backoff_max_ms, unsigned int hedge_after_ms);
+
+/**
+ * @brief Enables or disables compressed (gzip/deflate) HTTP responses for the server.
+ *
+ * When enabled, requests advertise `Accept-Encoding: gzip, deflate` and compressed response bodies
+ * are inflated while they are received. The response size limit applies to the decompressed size.
+ * @param server Server instance.
+ * @param enabled true to request compressed responses, false to request identity encoding (default).
+ * @return true on success, false if server is NULL or compression is requested but the library was built without zlib.
+ */
+EXPORT_CFRDS bool cfrds_server_set_compression(cfrds_server *server, bool enabled);
+
 /**
  * @brief Lists files and folders in a remote directory on the server.
  * @param server Initialized server connection.
@@ -284,6 +451,14 @@ EXPORT_CFRDS char cfrds_browse_dir_item_get_kind(const cfrds_browse_dir *value,
  */
 EXPORT_CFRDS const char *cfrds_browse_dir_item_get_name(const cfrds_browse_dir *value, size_t ndx);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_browse_dir_item_get_name().
+ * @param value Directory listing structure.
+ * @param ndx 0-based item index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_browse_dir_item_get_name_len(const cfrds_browse_dir *value, size_t ndx);
+
 /**
  * @brief Retrieves the access permissions of the item at a specific index.
  * @param value Directory listing structure.
@@ -323,6 +498,41 @@ EXPORT_CFRDS uint64_t cfrds_browse_dir_item_get_modified(const cfrds_browse_dir
  */
 EXPORT_CFRDS cfrds_status cfrds_command_file_read(cfrds_server *server, const char *pathname, cfrds_file_content **out);
 
+/**
+ * @brief Callback receiving the contents of a remote file as they are downloaded.
+ * @param ctx Context pointer given to cfrds_command_file_read_stream.
+ * @param data Next piece of the file. Valid only for the duration of the call.
+ * @param size Number of bytes in data.
+ * @return CFRDS_STATUS_OK to continue, any other status aborts the download and is returned to the caller.
+ */
+typedef cfrds_status (*cfrds_file_read_fn)(void *ctx, const void *data, size_t size);
+
+/**
+ * @brief Reads the contents of a remote file, passing them to a callback as they arrive.
+ *
+ * The response is parsed incrementally and the file is never held in memory, so the
+ * response size limit of cfrds_command_file_read does not apply.
+ * @param server Initialized server connection.
+ * @param pathname Path to the file on the remote server.
+ * @param on_data Callback receiving the file contents in order.
+ * @param ctx Context pointer passed to on_data.
+ * @param size Optional output for the file size. Ignored if NULL.
+ * @return Status code. On failure on_data may already have received part of the file.
+ */
+EXPORT_CFRDS cfrds_status cfrds_command_file_read_stream(cfrds_server *server, const char *pathname, cfrds_file_read_fn on_data, void *ctx, size_t *size);
+
+/**
+ * @brief Downloads a remote file into a file descriptor.
+ *
+ * Same as cfrds_command_file_read_stream() writing the contents to fd at its current position.
+ * @param server Initialized server connection.
+ * @param pathname Path to the file on the remote server.
+ * @param fd File descriptor open for writing.
+ * @param size Optional output for the file size. Ignored if NULL.
+ * @return Status code. CFRDS_STATUS_COMMAND_FAILED if writing to fd failed.
+ */
+EXPORT_CFRDS cfrds_status cfrds_command_file_read_to_fd(cfrds_server *server, const char *pathname, int fd, size_t *size);
+
 /**
  * @brief Frees an allocated cfrds_file_content structure.
  * @param value Structure to free.
@@ -350,6 +560,13 @@ EXPORT_CFRDS size_t cfrds_file_content_get_size(const cfrds_file_content *value)
  */
 EXPORT_CFRDS const char *cfrds_file_content_get_modified(const cfrds_file_content *value);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_file_content_get_modified().
+ * @param value File content structure.
+ * @return String length, 0 if the value is NULL.
+ */
+EXPORT_CFRDS size_t cfrds_file_content_get_modified_len(const cfrds_file_content *value);
+
 /**
  * @brief Retrieves the remote permission string of the file.
  * @param value File content structure.
@@ -357,6 +574,13 @@ EXPORT_CFRDS const char *cfrds_file_content_get_modified(const cfrds_file_conten
  */
 EXPORT_CFRDS const char *cfrds_file_content_get_permission(const cfrds_file_content *value);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_file_content_get_permission().
+ * @param value File content structure.
+ * @return String length, 0 if the value is NULL.
+ */
+EXPORT_CFRDS size_t cfrds_file_content_get_permission_len(const cfrds_file_content *value);
+
 /**
  * @brief Writes data bytes to a remote file path on the server.
  * @param server Initialized server connection.
@@ -367,6 +591,31 @@ EXPORT_CFRDS const char *cfrds_file_content_get_permission(const cfrds_file_cont
  */
 EXPORT_CFRDS cfrds_status cfrds_command_file_write(cfrds_server *server, const char *pathname, const void *data, size_t length);
 
+/**
+ * @brief Writes the contents of an open file to a remote file path on the server.
+ *
+ * The data is streamed from the descriptor (with sendfile() where available) instead of being
+ * loaded into memory, so memory use does not depend on the file size.
+ * @param server Initialized server connection.
+ * @param pathname Target file path.
+ * @param fd Seekable file descriptor to read from, starting at its current position. The file position is not changed.
+ * @param length Number of bytes to write.
+ * @return Status code. CFRDS_STATUS_INVALID_INPUT_PARAMETER if fd is invalid or not seekable,
+ *         CFRDS_STATUS_WRITING_TO_SOCKET_FAILED if the file ends before length bytes were sent.
+ */
+EXPORT_CFRDS cfrds_status cfrds_command_file_write_fd(cfrds_server *server, const char *pathname, int fd, size_t length);
+
+/**
+ * @brief Uploads a local file to a remote file path on the server.
+ *
+ * Same as cfrds_command_file_write_fd() for the whole file.
+ * @param server Initialized server connection.
+ * @param pathname Target file path.
+ * @param local_path Path of the local regular file to upload.
+ * @return Status code. CFRDS_STATUS_INVALID_INPUT_PARAMETER if the file can not be opened or is not a regular file.
+ */
+EXPORT_CFRDS cfrds_status cfrds_command_file_write_from_path(cfrds_server *server, const char *pathname, const char *local_path);
+
 /**
  * @brief Renames or moves a remote file or folder on the server.
  * @param server Initialized server connection.
@@ -452,6 +701,14 @@ EXPORT_CFRDS size_t cfrds_sql_dsninfo_count(const cfrds_sql_dsninfo *value);
  */
 EXPORT_CFRDS const char *cfrds_sql_dsninfo_item_get_name(const cfrds_sql_dsninfo *value, size_t ndx);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_dsninfo_item_get_name().
+ * @param value DSN info structure.
+ * @param ndx 0-based index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_dsninfo_item_get_name_len(const cfrds_sql_dsninfo *value, size_t ndx);
+
 /**
  * @brief Retrieves the database tables list metadata for a specific DSN.
  * @param server Initialized server connection.
@@ -488,6 +745,14 @@ EXPORT_CFRDS size_t cfrds_sql_tableinfo_count(const cfrds_sql_tableinfo *value);
  */
 EXPORT_CFRDS const char *cfrds_sql_tableinfo_get_column_unknown(const cfrds_sql_tableinfo *value, size_t column);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_tableinfo_get_column_unknown().
+ * @param value Table info structure.
+ * @param column 0-based table index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_tableinfo_get_column_unknown_len(const cfrds_sql_tableinfo *value, size_t column);
+
 /**
  * @brief Retrieves the schema name attribute for a table.
  * @param value Table info structure.
@@ -496,6 +761,14 @@ EXPORT_CFRDS const char *cfrds_sql_tableinfo_get_column_unknown(const cfrds_sql_
  */
 EXPORT_CFRDS const char *cfrds_sql_tableinfo_get_column_schema(const cfrds_sql_tableinfo *value, size_t column);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_tableinfo_get_column_schema().
+ * @param value Table info structure.
+ * @param column 0-based table index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_tableinfo_get_column_schema_len(const cfrds_sql_tableinfo *value, size_t column);
+
 /**
  * @brief Retrieves the table name attribute.
  * @param value Table info structure.
@@ -504,6 +777,14 @@ EXPORT_CFRDS const char *cfrds_sql_tableinfo_get_column_schema(const cfrds_sql_t
  */
 EXPORT_CFRDS const char *cfrds_sql_tableinfo_get_column_name(const cfrds_sql_tableinfo *value, size_t column);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_tableinfo_get_column_name().
+ * @param value Table info structure.
+ * @param column 0-based table index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_tableinfo_get_column_name_len(const cfrds_sql_tableinfo *value, size_t column);
+
 /**
  * @brief Retrieves the table type attribute (e.g. "TABLE", "VIEW").
  * @param value Table info structure.
@@ -512,6 +793,14 @@ EXPORT_CFRDS const char *cfrds_sql_tableinfo_get_column_name(const cfrds_sql_tab
  */
 EXPORT_CFRDS const char *cfrds_sql_tableinfo_get_column_type(const cfrds_sql_tableinfo *value, size_t column);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_tableinfo_get_column_type().
+ * @param value Table info structure.
+ * @param column 0-based table index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_tableinfo_get_column_type_len(const cfrds_sql_tableinfo *value, size_t column);
+
 /**
  * @brief Retrieves column metadata definitions for a database table.
  * @param server Initialized server connection.
@@ -549,6 +838,14 @@ EXPORT_CFRDS size_t cfrds_sql_columninfo_count(const cfrds_sql_columninfo *value
  */
 EXPORT_CFRDS const char *cfrds_sql_columninfo_get_schema(const cfrds_sql_columninfo *value, size_t column);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_columninfo_get_schema().
+ * @param value Column info structure.
+ * @param column 0-based column index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_columninfo_get_schema_len(const cfrds_sql_columninfo *value, size_t column);
+
 /**
  * @brief Retrieves the owner name attribute for a column.
  * @param value Column info.
@@ -557,6 +854,14 @@ EXPORT_CFRDS const char *cfrds_sql_columninfo_get_schema(const cfrds_sql_columni
  */
 EXPORT_CFRDS const char *cfrds_sql_columninfo_get_owner(const cfrds_sql_columninfo *value, size_t column);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_columninfo_get_owner().
+ * @param value Column info.
+ * @param column 0-based index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_columninfo_get_owner_len(const cfrds_sql_columninfo *value, size_t column);
+
 /**
  * @brief Retrieves the table name attribute for a column.
  * @param value Column info.
@@ -565,6 +870,14 @@ EXPORT_CFRDS const char *cfrds_sql_columninfo_get_owner(const cfrds_sql_columnin
  */
 EXPORT_CFRDS const char *cfrds_sql_columninfo_get_table(const cfrds_sql_columninfo *value, size_t column);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_columninfo_get_table().
+ * @param value Column info.
+ * @param column 0-based index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_columninfo_get_table_len(const cfrds_sql_columninfo *value, size_t column);
+
 /**
  * @brief Retrieves the column name attribute.
  * @param value Column info.
@@ -573,6 +886,14 @@ EXPORT_CFRDS const char *cfrds_sql_columninfo_get_table(const cfrds_sql_columnin
  */
 EXPORT_CFRDS const char *cfrds_sql_columninfo_get_name(const cfrds_sql_columninfo *value, size_t column);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_columninfo_get_name().
+ * @param value Column info.
+ * @param column 0-based index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_columninfo_get_name_len(const cfrds_sql_columninfo *value, size_t column);
+
 /**
  * @brief Retrieves the JDBC database data type integer for the column.
  * @param value Column info.
@@ -589,6 +910,14 @@ EXPORT_CFRDS int cfrds_sql_columninfo_get_type(const cfrds_sql_columninfo *value
  */
 EXPORT_CFRDS const char *cfrds_sql_columninfo_get_typeStr(const cfrds_sql_columninfo *value, size_t column);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_columninfo_get_typeStr().
+ * @param value Column info.
+ * @param column 0-based index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_columninfo_get_typeStr_len(const cfrds_sql_columninfo *value, size_t column);
+
 /**
  * @brief Retrieves the numeric precision attribute for the column.
  * @param value Column info.
@@ -666,6 +995,14 @@ EXPORT_CFRDS size_t cfrds_sql_primarykeys_count(const cfrds_sql_primarykeys *val
  */
 EXPORT_CFRDS const char *cfrds_sql_primarykeys_get_catalog(const cfrds_sql_primarykeys *value, size_t ndx);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_primarykeys_get_catalog().
+ * @param value Primary keys structure.
+ * @param ndx 0-based index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_primarykeys_get_catalog_len(const cfrds_sql_primarykeys *value, size_t ndx);
+
 /**
  * @brief Retrieves owner name of the primary key.
  * @param value Primary keys structure.
@@ -674,6 +1011,14 @@ EXPORT_CFRDS const char *cfrds_sql_primarykeys_get_catalog(const cfrds_sql_prima
  */
 EXPORT_CFRDS const char *cfrds_sql_primarykeys_get_owner(const cfrds_sql_primarykeys *value, size_t ndx);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_primarykeys_get_owner().
+ * @param value Primary keys structure.
+ * @param ndx 0-based index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_primarykeys_get_owner_len(const cfrds_sql_primarykeys *value, size_t ndx);
+
 /**
  * @brief Retrieves table name of the primary key.
  * @param value Primary keys structure.
@@ -682,6 +1027,14 @@ EXPORT_CFRDS const char *cfrds_sql_primarykeys_get_owner(const cfrds_sql_primary
  */
 EXPORT_CFRDS const char *cfrds_sql_primarykeys_get_table(const cfrds_sql_primarykeys *value, size_t ndx);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_primarykeys_get_table().
+ * @param value Primary keys structure.
+ * @param ndx 0-based index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_primarykeys_get_table_len(const cfrds_sql_primarykeys *value, size_t ndx);
+
 /**
  * @brief Retrieves column name of the primary key.
  * @param value Primary keys structure.
@@ -690,6 +1043,14 @@ EXPORT_CFRDS const char *cfrds_sql_primarykeys_get_table(const cfrds_sql_primary
  */
 EXPORT_CFRDS const char *cfrds_sql_primarykeys_get_column(const cfrds_sql_primarykeys *value, size_t ndx);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_primarykeys_get_column().
+ * @param value Primary keys structure.
+ * @param ndx 0-based index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_primarykeys_get_column_len(const cfrds_sql_primarykeys *value, size_t ndx);
+
 /**
  * @brief Retrieves key sequence number inside multi-column keys.
  * @param value Primary keys structure.
@@ -735,6 +1096,14 @@ EXPORT_CFRDS size_t cfrds_sql_foreignkeys_count(const cfrds_sql_foreignkeys *val
  */
 EXPORT_CFRDS const char *cfrds_sql_foreignkeys_get_pkcatalog(const cfrds_sql_foreignkeys *value, size_t ndx);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_foreignkeys_get_pkcatalog().
+ * @param value Foreign keys structure.
+ * @param ndx 0-based index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_foreignkeys_get_pkcatalog_len(const cfrds_sql_foreignkeys *value, size_t ndx);
+
 /**
  * @brief Retrieves owner name of the referenced primary key.
  * @param value Foreign keys structure.
@@ -743,6 +1112,14 @@ EXPORT_CFRDS const char *cfrds_sql_foreignkeys_get_pkcatalog(const cfrds_sql_for
  */
 EXPORT_CFRDS const char *cfrds_sql_foreignkeys_get_pkowner(const cfrds_sql_foreignkeys *value, size_t ndx);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_foreignkeys_get_pkowner().
+ * @param value Foreign keys structure.
+ * @param ndx 0-based index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_foreignkeys_get_pkowner_len(const cfrds_sql_foreignkeys *value, size_t ndx);
+
 /**
  * @brief Retrieves table name of the referenced primary key.
  * @param value Foreign keys structure.
@@ -751,6 +1128,14 @@ EXPORT_CFRDS const char *cfrds_sql_foreignkeys_get_pkowner(const cfrds_sql_forei
  */
 EXPORT_CFRDS const char *cfrds_sql_foreignkeys_get_pktable(const cfrds_sql_foreignkeys *value, size_t ndx);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_foreignkeys_get_pktable().
+ * @param value Foreign keys structure.
+ * @param ndx 0-based index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_foreignkeys_get_pktable_len(const cfrds_sql_foreignkeys *value, size_t ndx);
+
 /**
  * @brief Retrieves column name of the referenced primary key.
  * @param value Foreign keys structure.
@@ -759,6 +1144,14 @@ EXPORT_CFRDS const char *cfrds_sql_foreignkeys_get_pktable(const cfrds_sql_forei
  */
 EXPORT_CFRDS const char *cfrds_sql_foreignkeys_get_pkcolumn(const cfrds_sql_foreignkeys *value, size_t ndx);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_foreignkeys_get_pkcolumn().
+ * @param value Foreign keys structure.
+ * @param ndx 0-based index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_foreignkeys_get_pkcolumn_len(const cfrds_sql_foreignkeys *value, size_t ndx);
+
 /**
  * @brief Retrieves catalog name of the foreign key table.
  * @param value Foreign keys structure.
@@ -767,6 +1160,14 @@ EXPORT_CFRDS const char *cfrds_sql_foreignkeys_get_pkcolumn(const cfrds_sql_fore
  */
 EXPORT_CFRDS const char *cfrds_sql_foreignkeys_get_fkcatalog(const cfrds_sql_foreignkeys *value, size_t ndx);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_foreignkeys_get_fkcatalog().
+ * @param value Foreign keys structure.
+ * @param ndx 0-based index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_foreignkeys_get_fkcatalog_len(const cfrds_sql_foreignkeys *value, size_t ndx);
+
 /**
  * @brief Retrieves owner name of the foreign key table.
  * @param value Foreign keys.
@@ -775,6 +1176,14 @@ EXPORT_CFRDS const char *cfrds_sql_foreignkeys_get_fkcatalog(const cfrds_sql_for
  */
 EXPORT_CFRDS const char *cfrds_sql_foreignkeys_get_fkowner(const cfrds_sql_foreignkeys *value, size_t ndx);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_foreignkeys_get_fkowner().
+ * @param value Foreign keys.
+ * @param ndx 0-based index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_foreignkeys_get_fkowner_len(const cfrds_sql_foreignkeys *value, size_t ndx);
+
 /**
  * @brief Retrieves table name of the foreign key.
  * @param value Foreign keys.
@@ -783,6 +1192,14 @@ EXPORT_CFRDS const char *cfrds_sql_foreignkeys_get_fkowner(const cfrds_sql_forei
  */
 EXPORT_CFRDS const char *cfrds_sql_foreignkeys_get_fktable(const cfrds_sql_foreignkeys *value, size_t ndx);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_foreignkeys_get_fktable().
+ * @param value Foreign keys.
+ * @param ndx 0-based index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_foreignkeys_get_fktable_len(const cfrds_sql_foreignkeys *value, size_t ndx);
+
 /**
  * @brief Retrieves column name of the foreign key.
  * @param value Foreign keys.
@@ -791,6 +1208,14 @@ EXPORT_CFRDS const char *cfrds_sql_foreignkeys_get_fktable(const cfrds_sql_forei
  */
 EXPORT_CFRDS const char *cfrds_sql_foreignkeys_get_fkcolumn(const cfrds_sql_foreignkeys *value, size_t ndx);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_foreignkeys_get_fkcolumn().
+ * @param value Foreign keys.
+ * @param ndx 0-based index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_foreignkeys_get_fkcolumn_len(const cfrds_sql_foreignkeys *value, size_t ndx);
+
 /**
  * @brief Retrieves sequence order of the foreign key inside composite keys.
  * @param value Foreign keys.
@@ -852,6 +1277,14 @@ EXPORT_CFRDS size_t cfrds_sql_importedkeys_count(const cfrds_sql_importedkeys *v
  */
 EXPORT_CFRDS const char *cfrds_sql_importedkeys_get_pkcatalog(const cfrds_sql_importedkeys *value, size_t ndx);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_importedkeys_get_pkcatalog().
+ * @param value Imported keys structure.
+ * @param ndx 0-based index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_importedkeys_get_pkcatalog_len(const cfrds_sql_importedkeys *value, size_t ndx);
+
 /**
  * @brief Retrieves owner name of the referenced primary key.
  * @param value Imported keys.
@@ -860,6 +1293,14 @@ EXPORT_CFRDS const char *cfrds_sql_importedkeys_get_pkcatalog(const cfrds_sql_im
  */
 EXPORT_CFRDS const char *cfrds_sql_importedkeys_get_pkowner(const cfrds_sql_importedkeys *value, size_t ndx);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_importedkeys_get_pkowner().
+ * @param value Imported keys.
+ * @param ndx 0-based index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_importedkeys_get_pkowner_len(const cfrds_sql_importedkeys *value, size_t ndx);
+
 /**
  * @brief Retrieves table name of the referenced primary key.
  * @param value Imported keys.
@@ -868,6 +1309,14 @@ EXPORT_CFRDS const char *cfrds_sql_importedkeys_get_pkowner(const cfrds_sql_impo
  */
 EXPORT_CFRDS const char *cfrds_sql_importedkeys_get_pktable(const cfrds_sql_importedkeys *value, size_t ndx);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_importedkeys_get_pktable().
+ * @param value Imported keys.
+ * @param ndx 0-based index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_importedkeys_get_pktable_len(const cfrds_sql_importedkeys *value, size_t ndx);
+
 /**
  * @brief Retrieves column name of the referenced primary key.
  * @param value Imported keys.
@@ -876,6 +1325,14 @@ EXPORT_CFRDS const char *cfrds_sql_importedkeys_get_pktable(const cfrds_sql_impo
  */
 EXPORT_CFRDS const char *cfrds_sql_importedkeys_get_pkcolumn(const cfrds_sql_importedkeys *value, size_t ndx);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_importedkeys_get_pkcolumn().
+ * @param value Imported keys.
+ * @param ndx 0-based index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_importedkeys_get_pkcolumn_len(const cfrds_sql_importedkeys *value, size_t ndx);
+
 /**
  * @brief Retrieves catalog name of the foreign key table.
  * @param value Imported keys.
@@ -884,6 +1341,14 @@ EXPORT_CFRDS const char *cfrds_sql_importedkeys_get_pkcolumn(const cfrds_sql_imp
  */
 EXPORT_CFRDS const char *cfrds_sql_importedkeys_get_fkcatalog(const cfrds_sql_importedkeys *value, size_t ndx);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_importedkeys_get_fkcatalog().
+ * @param value Imported keys.
+ * @param ndx 0-based index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_importedkeys_get_fkcatalog_len(const cfrds_sql_importedkeys *value, size_t ndx);
+
 /**
  * @brief Retrieves owner name of the foreign key table.
  * @param value Imported keys.
@@ -892,6 +1357,14 @@ EXPORT_CFRDS const char *cfrds_sql_importedkeys_get_fkcatalog(const cfrds_sql_im
  */
 EXPORT_CFRDS const char *cfrds_sql_importedkeys_get_fkowner(const cfrds_sql_importedkeys *value, size_t ndx);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_importedkeys_get_fkowner().
+ * @param value Imported keys.
+ * @param ndx 0-based index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_importedkeys_get_fkowner_len(const cfrds_sql_importedkeys *value, size_t ndx);
+
 /**
  * @brief Retrieves table name of the foreign key.
  * @param value Imported keys.
@@ -900,6 +1373,14 @@ EXPORT_CFRDS const char *cfrds_sql_importedkeys_get_fkowner(const cfrds_sql_impo
  */
 EXPORT_CFRDS const char *cfrds_sql_importedkeys_get_fktable(const cfrds_sql_importedkeys *value, size_t ndx);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_importedkeys_get_fktable().
+ * @param value Imported keys.
+ * @param ndx 0-based index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_importedkeys_get_fktable_len(const cfrds_sql_importedkeys *value, size_t ndx);
+
 /**
  * @brief Retrieves column name of the foreign key.
  * @param value Imported keys.
@@ -908,6 +1389,14 @@ EXPORT_CFRDS const char *cfrds_sql_importedkeys_get_fktable(const cfrds_sql_impo
  */
 EXPORT_CFRDS const char *cfrds_sql_importedkeys_get_fkcolumn(const cfrds_sql_importedkeys *value, size_t ndx);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_importedkeys_get_fkcolumn().
+ * @param value Imported keys.
+ * @param ndx 0-based index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_importedkeys_get_fkcolumn_len(const cfrds_sql_importedkeys *value, size_t ndx);
+
 /**
  * @brief Retrieves sequence order of the imported key inside composite keys.
  * @param value Imported keys.
@@ -969,6 +1458,14 @@ EXPORT_CFRDS size_t cfrds_sql_exportedkeys_count(const cfrds_sql_exportedkeys *v
  */
 EXPORT_CFRDS const char *cfrds_sql_exportedkeys_get_pkcatalog(const cfrds_sql_exportedkeys *value, size_t ndx);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_exportedkeys_get_pkcatalog().
+ * @param value Exported keys structure.
+ * @param ndx 0-based index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_exportedkeys_get_pkcatalog_len(const cfrds_sql_exportedkeys *value, size_t ndx);
+
 /**
  * @brief Retrieves owner name of the primary key.
  * @param value Exported keys.
@@ -977,6 +1474,14 @@ EXPORT_CFRDS const char *cfrds_sql_exportedkeys_get_pkcatalog(const cfrds_sql_ex
  */
 EXPORT_CFRDS const char *cfrds_sql_exportedkeys_get_pkowner(const cfrds_sql_exportedkeys *value, size_t ndx);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_exportedkeys_get_pkowner().
+ * @param value Exported keys.
+ * @param ndx 0-based index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_exportedkeys_get_pkowner_len(const cfrds_sql_exportedkeys *value, size_t ndx);
+
 /**
  * @brief Retrieves table name of the primary key.
  * @param value Exported keys.
@@ -985,6 +1490,14 @@ EXPORT_CFRDS const char *cfrds_sql_exportedkeys_get_pkowner(const cfrds_sql_expo
  */
 EXPORT_CFRDS const char *cfrds_sql_exportedkeys_get_pktable(const cfrds_sql_exportedkeys *value, size_t ndx);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_exportedkeys_get_pktable().
+ * @param value Exported keys.
+ * @param ndx 0-based index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_exportedkeys_get_pktable_len(const cfrds_sql_exportedkeys *value, size_t ndx);
+
 /**
  * @brief Retrieves column name of the primary key.
  * @param value Exported keys.
@@ -994,12 +1507,28 @@ EXPORT_CFRDS const char *cfrds_sql_exportedkeys_get_pktable(const cfrds_sql_expo
 EXPORT_CFRDS const char *cfrds_sql_exportedkeys_get_pkcolumn(const cfrds_sql_exportedkeys *value, size_t ndx);
 
 /**
- * @brief Retrieves catalog name of the foreign key table referencing it.
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_exportedkeys_get_pkcolumn().
+ * @param value Exported keys.
+ * @param ndx 0-based index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_exportedkeys_get_pkcolumn_len(const cfrds_sql_exportedkeys *value, size_t ndx);
+
+/**
+ * @brief Retrieves catalog name of the foreign key table referencing it.
+ * @param value Exported keys.
+ * @param ndx 0-based index.
+ * @return Foreign key catalog name.
+ */
+EXPORT_CFRDS const char *cfrds_sql_exportedkeys_get_fkcatalog(const cfrds_sql_exportedkeys *value, size_t ndx);
+
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_exportedkeys_get_fkcatalog().
  * @param value Exported keys.
  * @param ndx 0-based index.
- * @return Foreign key catalog name.
+ * @return String length, 0 if the value is NULL or the index is out of range.
  */
-EXPORT_CFRDS const char *cfrds_sql_exportedkeys_get_fkcatalog(const cfrds_sql_exportedkeys *value, size_t ndx);
+EXPORT_CFRDS size_t cfrds_sql_exportedkeys_get_fkcatalog_len(const cfrds_sql_exportedkeys *value, size_t ndx);
 
 /**
  * @brief Retrieves owner name of the foreign key table.
@@ -1009,6 +1538,14 @@ EXPORT_CFRDS const char *cfrds_sql_exportedkeys_get_fkcatalog(const cfrds_sql_ex
  */
 EXPORT_CFRDS const char *cfrds_sql_exportedkeys_get_fkowner(const cfrds_sql_exportedkeys *value, size_t ndx);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_exportedkeys_get_fkowner().
+ * @param value Exported keys.
+ * @param ndx 0-based index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_exportedkeys_get_fkowner_len(const cfrds_sql_exportedkeys *value, size_t ndx);
+
 /**
  * @brief Retrieves table name of the foreign key.
  * @param value Exported keys.
@@ -1017,6 +1554,14 @@ EXPORT_CFRDS const char *cfrds_sql_exportedkeys_get_fkowner(const cfrds_sql_expo
  */
 EXPORT_CFRDS const char *cfrds_sql_exportedkeys_get_fktable(const cfrds_sql_exportedkeys *value, size_t ndx);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_exportedkeys_get_fktable().
+ * @param value Exported keys.
+ * @param ndx 0-based index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_exportedkeys_get_fktable_len(const cfrds_sql_exportedkeys *value, size_t ndx);
+
 /**
  * @brief Retrieves column name of the foreign key.
  * @param value Exported keys.
@@ -1025,6 +1570,14 @@ EXPORT_CFRDS const char *cfrds_sql_exportedkeys_get_fktable(const cfrds_sql_expo
  */
 EXPORT_CFRDS const char *cfrds_sql_exportedkeys_get_fkcolumn(const cfrds_sql_exportedkeys *value, size_t ndx);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_exportedkeys_get_fkcolumn().
+ * @param value Exported keys.
+ * @param ndx 0-based index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_exportedkeys_get_fkcolumn_len(const cfrds_sql_exportedkeys *value, size_t ndx);
+
 /**
  * @brief Retrieves sequence order of the exported key inside composite keys.
  * @param value Exported keys.
@@ -1093,6 +1646,14 @@ EXPORT_CFRDS size_t cfrds_sql_resultset_rows(const cfrds_sql_resultset *value);
  */
 EXPORT_CFRDS const char *cfrds_sql_resultset_column_name(const cfrds_sql_resultset *value, size_t column);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_resultset_column_name().
+ * @param value Resultset structure.
+ * @param column 0-based column index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_resultset_column_name_len(const cfrds_sql_resultset *value, size_t column);
+
 /**
  * @brief Retrieves cell value string at a specific row and column grid coordinate.
  * @param value Resultset structure.
@@ -1102,6 +1663,163 @@ EXPORT_CFRDS const char *cfrds_sql_resultset_column_name(const cfrds_sql_results
  */
 EXPORT_CFRDS const char *cfrds_sql_resultset_value(const cfrds_sql_resultset *value, size_t row, size_t column);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_resultset_value().
+ * @param value Resultset structure.
+ * @param row 0-based row index.
+ * @param column 0-based column index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_resultset_value_len(const cfrds_sql_resultset *value, size_t row, size_t column);
+
+/**
+ * @brief Adds a column-major copy of a resultset, typed from its query metadata.
+ *
+ * Every column gets one offsets array and one byte heap holding the text of all its rows.
+ * Columns whose metadata `jtype` (a `java.sql.Types` code or name) is an integer, floating
+ * point/decimal or bit/boolean type also get an array of `int64_t`, `double` or `bool` values
+ * and a null bitmap. Empty cells, `NULL` and text that does not parse as the column type are
+ * null and stored as 0. The row-major accessors keep working, the columns live in the same
+ * memory and are freed with the resultset. Each call builds the columns anew.
+ * @param value Resultset structure.
+ * @param metadata Metadata of the same query (cfrds_command_sql_sqlmetadata()), or NULL to keep every column as text.
+ * @return true on success, false if value is NULL, the metadata column count differs or memory runs out.
+ */
+EXPORT_CFRDS bool cfrds_sql_resultset_make_columnar(cfrds_sql_resultset *value, const cfrds_sql_metadata *metadata);
+
+/**
+ * @brief Retrieves the storage type of a column built by cfrds_sql_resultset_make_columnar().
+ * @param value Resultset structure.
+ * @param column 0-based column index.
+ * @return Column type, CFRDS_SQL_COLUMN_NONE if the resultset is not columnar or the index is out of range.
+ */
+EXPORT_CFRDS cfrds_sql_column_type cfrds_sql_resultset_column_type(const cfrds_sql_resultset *value, size_t column);
+
+/**
+ * @brief Retrieves the text of a whole column built by cfrds_sql_resultset_make_columnar().
+ *
+ * Row `r` is the `offsets[r + 1] - offsets[r]` bytes at `heap + offsets[r]`, not NUL-terminated.
+ * @param value Resultset structure.
+ * @param column 0-based column index.
+ * @param offsets Output pointer to cfrds_sql_resultset_rows() + 1 offsets into the heap.
+ * @param heap Output pointer to the column text.
+ * @return true on success, false if the resultset is not columnar or the index is out of range.
+ */
+EXPORT_CFRDS bool cfrds_sql_resultset_column_text(const cfrds_sql_resultset *value, size_t column, const size_t **offsets, const char **heap);
+
+/**
+ * @brief Retrieves the values of a CFRDS_SQL_COLUMN_INT64 column.
+ * @param value Resultset structure.
+ * @param column 0-based column index.
+ * @param values Output pointer to cfrds_sql_resultset_rows() values.
+ * @return true on success, false if the column is not an integer column.
+ */
+EXPORT_CFRDS bool cfrds_sql_resultset_column_int64(const cfrds_sql_resultset *value, size_t column, const int64_t **values);
+
+/**
+ * @brief Retrieves the values of a CFRDS_SQL_COLUMN_DOUBLE column.
+ * @param value Resultset structure.
+ * @param column 0-based column index.
+ * @param values Output pointer to cfrds_sql_resultset_rows() values.
+ * @return true on success, false if the column is not a floating point column.
+ */
+EXPORT_CFRDS bool cfrds_sql_resultset_column_double(const cfrds_sql_resultset *value, size_t column, const double **values);
+
+/**
+ * @brief Retrieves the values of a CFRDS_SQL_COLUMN_BOOL column.
+ * @param value Resultset structure.
+ * @param column 0-based column index.
+ * @param values Output pointer to cfrds_sql_resultset_rows() values.
+ * @return true on success, false if the column is not a boolean column.
+ */
+EXPORT_CFRDS bool cfrds_sql_resultset_column_bool(const cfrds_sql_resultset *value, size_t column, const bool **values);
+
+/**
+ * @brief Retrieves the null bitmap of a typed column, test rows with CFRDS_SQL_IS_NULL().
+ * @param value Resultset structure.
+ * @param column 0-based column index.
+ * @return Bitmap with one bit per row, NULL for text columns or if the index is out of range.
+ */
+EXPORT_CFRDS const uint8_t *cfrds_sql_resultset_column_nulls(const cfrds_sql_resultset *value, size_t column);
+
+/**
+ * @brief Executes an SQL query or statement and opens a cursor reading its rows as they arrive.
+ *
+ * The response is parsed incrementally, one row at a time, so memory stays bounded by the
+ * largest row plus one socket read and there is no limit on the number of rows. Only the
+ * response size limit (cfrds_server_set_response_limits()) applies, to a single row.
+ * The server connection is busy until the cursor is closed; it returns to the connection pool
+ * only if all rows were read.
+ * @param server Initialized server connection.
+ * @param connection_name The DSN connection name.
+ * @param sql The SQL command string to execute.
+ * @param cursor Output pointer to the open cursor, positioned before the first row. Must be closed with cfrds_sql_cursor_close.
+ * @return Status code.
+ */
+EXPORT_CFRDS cfrds_status cfrds_sql_cursor_open(cfrds_server *server, const char *connection_name, const char *sql, cfrds_sql_cursor **cursor);
+
+/**
+ * @brief Moves a cursor to its next row, receiving more of the response when needed.
+ *
+ * The whole response, from cfrds_sql_cursor_open() to the last row, must arrive within the
+ * server total timeout (cfrds_server_set_timeouts()).
+ * @param cursor Open cursor.
+ * @param row Output set to true if a row was read, false after the last row.
+ * @return Status code. After an error the cursor can only be closed.
+ */
+EXPORT_CFRDS cfrds_status cfrds_sql_cursor_next_row(cfrds_sql_cursor *cursor, bool *row);
+
+/**
+ * @brief Returns the count of columns of the cursor resultset.
+ * @param cursor Open cursor.
+ * @return Count of columns.
+ */
+EXPORT_CFRDS size_t cfrds_sql_cursor_columns(const cfrds_sql_cursor *cursor);
+
+/**
+ * @brief Returns the count of rows announced by the server for the cursor resultset.
+ * @param cursor Open cursor.
+ * @return Count of rows.
+ */
+EXPORT_CFRDS size_t cfrds_sql_cursor_rows(const cfrds_sql_cursor *cursor);
+
+/**
+ * @brief Retrieves column header name for a specific column index.
+ * @param cursor Open cursor.
+ * @param column 0-based column index.
+ * @return Column header name, valid until the cursor is closed. NULL if the index is out of range.
+ */
+EXPORT_CFRDS const char *cfrds_sql_cursor_column_name(const cfrds_sql_cursor *cursor, size_t column);
+
+/**
+ * @brief Retrieves a cell value of the current row.
+ * @param cursor Open cursor.
+ * @param column 0-based column index.
+ * @return Cell value, valid until the next cfrds_sql_cursor_next_row() or cfrds_sql_cursor_close().
+ *         NULL before the first row or if the index is out of range.
+ */
+EXPORT_CFRDS const char *cfrds_sql_cursor_value(const cfrds_sql_cursor *cursor, size_t column);
+
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_cursor_value().
+ * @param cursor Open cursor.
+ * @param column 0-based column index.
+ * @return String length, 0 before the first row or if the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_cursor_value_len(const cfrds_sql_cursor *cursor, size_t column);
+
+/**
+ * @brief Closes a cursor, dropping the connection if rows were left unread.
+ * @param cursor Cursor to close. Safe to call if NULL.
+ */
+EXPORT_CFRDS void cfrds_sql_cursor_close(cfrds_sql_cursor *cursor);
+
+/**
+ * @brief Automatically closes and nullifies a cfrds_sql_cursor pointer.
+ * @param cursor Double pointer to cursor. Cleared to NULL after closing.
+ */
+EXPORT_CFRDS void cfrds_sql_cursor_cleanup(cfrds_sql_cursor **cursor);
+
 /**
  * @brief Retrieves query resultset metadata (columns detail).
  * @param server Initialized server connection.
@@ -1139,6 +1857,14 @@ EXPORT_CFRDS size_t cfrds_sql_metadata_count(const cfrds_sql_metadata *value);
  */
 EXPORT_CFRDS const char *cfrds_sql_metadata_get_name(const cfrds_sql_metadata *value, size_t ndx);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_metadata_get_name().
+ * @param value Metadata structure.
+ * @param ndx 0-based column index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_metadata_get_name_len(const cfrds_sql_metadata *value, size_t ndx);
+
 /**
  * @brief Retrieves column database type name at a specific index.
  * @param value Metadata structure.
@@ -1147,6 +1873,14 @@ EXPORT_CFRDS const char *cfrds_sql_metadata_get_name(const cfrds_sql_metadata *v
  */
 EXPORT_CFRDS const char *cfrds_sql_metadata_get_type(const cfrds_sql_metadata *value, size_t ndx);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_metadata_get_type().
+ * @param value Metadata structure.
+ * @param ndx 0-based column index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_metadata_get_type_len(const cfrds_sql_metadata *value, size_t ndx);
+
 /**
  * @brief Retrieves column Java type name at a specific index.
  * @param value Metadata structure.
@@ -1155,6 +1889,14 @@ EXPORT_CFRDS const char *cfrds_sql_metadata_get_type(const cfrds_sql_metadata *v
  */
 EXPORT_CFRDS const char *cfrds_sql_metadata_get_jtype(const cfrds_sql_metadata *value, size_t ndx);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_metadata_get_jtype().
+ * @param value Metadata structure.
+ * @param ndx 0-based column index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_metadata_get_jtype_len(const cfrds_sql_metadata *value, size_t ndx);
+
 /**
  * @brief Retrieves supported SQL commands catalog from the database server.
  * @param server Initialized server connection.
@@ -1190,6 +1932,14 @@ EXPORT_CFRDS size_t cfrds_sql_supportedcommands_count(const cfrds_sql_supportedc
  */
 EXPORT_CFRDS const char *cfrds_sql_supportedcommands_get(const cfrds_sql_supportedcommands *value, size_t ndx);
 
+/**
+ * @brief Returns the length in bytes of the string returned by cfrds_sql_supportedcommands_get().
+ * @param value Supported commands structure.
+ * @param ndx 0-based index.
+ * @return String length, 0 if the value is NULL or the index is out of range.
+ */
+EXPORT_CFRDS size_t cfrds_sql_supportedcommands_get_len(const cfrds_sql_supportedcommands *value, size_t ndx);
+
 /**
  * @brief Retrieves the description/version banner of the database engine for a DSN.
  * @param server Initialized server connection.
@@ -1934,6 +2684,431 @@ EXPORT_CFRDS const char *cfrds_adminapi_mappings_value(const cfrds_adminapi_mapp
  */
 EXPORT_CFRDS cfrds_status cfrds_command_graphing(cfrds_server *server, cfrds_buffer **out_buffer, const char *chart_attributes, size_t num_series, const char **series_data);
 
+/**
+ * @brief Completion callback of a request submitted to a cfrds_loop.
+ *
+ * Called exactly once per successfully submitted request, from `cfrds_loop_run_once`, `cfrds_loop_run`
+ * or `cfrds_loop_free`. Right before the call the error state of `server` (`cfrds_server_get_error`)
+ * is set to describe this request. The callback may submit new requests, but must not free the loop.
+ * @param server Server the request was submitted for.
+ * @param status Status code of the request (CFRDS_STATUS_OK on success).
+ * @param result Parsed result on success (same type as the output of the matching cfrds_command_* function), otherwise NULL.
+ *               Ownership passes to the callback, which must free it with the matching *_free function.
+ * @param ctx Context pointer given at submit time.
+ */
+typedef void (*cfrds_loop_done_fn)(cfrds_server *server, cfrds_status status, void *result, void *ctx);
+
+/**
+ * @brief Creates an event loop driving many RDS requests concurrently from one thread.
+ *
+ * Requests use non-blocking sockets multiplexed with epoll (poll on other platforms) and share
+ * the keep-alive pools of their servers. Builds configured with CFRDS_WITH_IO_URING submit the
+ * socket operations through io_uring instead, falling back to epoll when the kernel does not allow it. Any number of `cfrds_server` instances may be used with one loop.
+ * Host names are still resolved with a blocking lookup: a request that needs a new connection while the
+ * server DNS cache (`cfrds_server_set_dns_cache`) holds no valid entry waits for the resolver in
+ * `cfrds_loop_submit_*`, or inside `cfrds_loop_run` when submitted from a callback or when a stale pooled
+ * socket is replaced, and every other request of the loop waits with it. The first request to a host
+ * always does; on a keep-alive server, `cfrds_server_prewarm` before submitting fills the cache and the pool.
+ * @param loop Output pointer to the new loop. Must be freed with cfrds_loop_free.
+ * @return true on success, false on allocation failure or if the event backend can not be created.
+ */
+EXPORT_CFRDS bool cfrds_loop_init(cfrds_loop **loop);
+
+/**
+ * @brief Frees an event loop.
+ *
+ * Requests still in flight are aborted and their callbacks are called with CFRDS_STATUS_COMMAND_FAILED.
+ * @param loop Loop instance to free. Safe to call if NULL.
+ */
+EXPORT_CFRDS void cfrds_loop_free(cfrds_loop *loop);
+
+/**
+ * @brief Automatically deallocates and nullifies a cfrds_loop pointer.
+ * @param loop Double pointer to the loop. Cleared to NULL after freeing.
+ */
+EXPORT_CFRDS void cfrds_loop_cleanup(cfrds_loop **loop);
+
+/**
+ * @brief Returns the name of the I/O backend the loop runs on.
+ * @param loop Loop instance.
+ * @return "io_uring", "epoll" or "poll", or NULL if loop is NULL.
+ */
+EXPORT_CFRDS const char *cfrds_loop_get_backend(const cfrds_loop *loop);
+
+/**
+ * @brief Returns the number of requests submitted to the loop that have not completed yet.
+ * @param loop Loop instance.
+ * @return Count of requests in flight.
+ */
+EXPORT_CFRDS size_t cfrds_loop_pending(const cfrds_loop *loop);
+
+/**
+ * @brief Waits for socket activity once and advances all requests that are ready.
+ *
+ * Completed and timed out requests have their callbacks called before this function returns.
+ * @param loop Loop instance.
+ * @param timeout_ms Maximum time to wait in milliseconds, or -1 to wait until some request makes progress or times out.
+ * @return CFRDS_STATUS_OK, CFRDS_STATUS_PARAM_IS_NULL or CFRDS_STATUS_COMMAND_FAILED if waiting for events failed.
+ */
+EXPORT_CFRDS cfrds_status cfrds_loop_run_once(cfrds_loop *loop, int timeout_ms);
+
+/**
+ * @brief Runs the loop until all submitted requests, including ones submitted from callbacks, have completed.
+ * @param loop Loop instance.
+ * @return CFRDS_STATUS_OK, CFRDS_STATUS_PARAM_IS_NULL or CFRDS_STATUS_COMMAND_FAILED if waiting for events failed.
+ */
+EXPORT_CFRDS cfrds_status cfrds_loop_run(cfrds_loop *loop);
+
+/**
+ * @brief Submits an asynchronous cfrds_command_browse_dir.
+ * @param loop Loop instance.
+ * @param server Initialized server connection. Must stay valid until the callback is called.
+ * @param path Remote path to list.
+ * @param done Completion callback, receives a cfrds_browse_dir.
+ * @param ctx Context pointer passed to the callback.
+ * @return CFRDS_STATUS_OK if the request was queued, otherwise the error status (the callback is not called).
+ */
+EXPORT_CFRDS cfrds_status cfrds_loop_submit_browse_dir(cfrds_loop *loop, cfrds_server *server, const char *path, cfrds_loop_done_fn done, void *ctx);
+
+/**
+ * @brief Submits an asynchronous cfrds_command_file_read.
+ * @param loop Loop instance.
+ * @param server Initialized server connection. Must stay valid until the callback is called.
+ * @param pathname Remote file path.
+ * @param done Completion callback, receives a cfrds_file_content.
+ * @param ctx Context pointer passed to the callback.
+ * @return CFRDS_STATUS_OK if the request was queued, otherwise the error status (the callback is not called).
+ */
+EXPORT_CFRDS cfrds_status cfrds_loop_submit_file_read(cfrds_loop *loop, cfrds_server *server, const char *pathname, cfrds_loop_done_fn done, void *ctx);
+
+/**
+ * @brief Submits an asynchronous cfrds_command_file_get_root_dir.
+ * @param loop Loop instance.
+ * @param server Initialized server connection. Must stay valid until the callback is called.
+ * @param done Completion callback, receives a cfrds_str (free with cfrds_str_cleanup).
+ * @param ctx Context pointer passed to the callback.
+ * @return CFRDS_STATUS_OK if the request was queued, otherwise the error status (the callback is not called).
+ */
+EXPORT_CFRDS cfrds_status cfrds_loop_submit_file_get_root_dir(cfrds_loop *loop, cfrds_server *server, cfrds_loop_done_fn done, void *ctx);
+
+/**
+ * @brief Submits an asynchronous cfrds_command_sql_dsninfo.
+ * @param loop Loop instance.
+ * @param server Initialized server connection. Must stay valid until the callback is called.
+ * @param done Completion callback, receives a cfrds_sql_dsninfo.
+ * @param ctx Context pointer passed to the callback.
+ * @return CFRDS_STATUS_OK if the request was queued, otherwise the error status (the callback is not called).
+ */
+EXPORT_CFRDS cfrds_status cfrds_loop_submit_sql_dsninfo(cfrds_loop *loop, cfrds_server *server, cfrds_loop_done_fn done, void *ctx);
+
+/**
+ * @brief Submits an asynchronous cfrds_command_sql_tableinfo.
+ * @param loop Loop instance.
+ * @param server Initialized server connection. Must stay valid until the callback is called.
+ * @param connection_name Datasource name.
+ * @param done Completion callback, receives a cfrds_sql_tableinfo.
+ * @param ctx Context pointer passed to the callback.
+ * @return CFRDS_STATUS_OK if the request was queued, otherwise the error status (the callback is not called).
+ */
+EXPORT_CFRDS cfrds_status cfrds_loop_submit_sql_tableinfo(cfrds_loop *loop, cfrds_server *server, const char *connection_name, cfrds_loop_done_fn done, void *ctx);
+
+/**
+ * @brief Submits an asynchronous cfrds_command_sql_columninfo.
+ * @param loop Loop instance.
+ * @param server Initialized server connection. Must stay valid until the callback is called.
+ * @param connection_name Datasource name.
+ * @param table_name Table name.
+ * @param done Completion callback, receives a cfrds_sql_columninfo.
+ * @param ctx Context pointer passed to the callback.
+ * @return CFRDS_STATUS_OK if the request was queued, otherwise the error status (the callback is not called).
+ */
+EXPORT_CFRDS cfrds_status cfrds_loop_submit_sql_columninfo(cfrds_loop *loop, cfrds_server *server, const char *connection_name, const char *table_name, cfrds_loop_done_fn done, void *ctx);
+
+/**
+ * @brief Submits an asynchronous cfrds_command_sql_primarykeys.
+ * @param loop Loop instance.
+ * @param server Initialized server connection. Must stay valid until the callback is called.
+ * @param connection_name Datasource name.
+ * @param table_name Table name.
+ * @param done Completion callback, receives a cfrds_sql_primarykeys.
+ * @param ctx Context pointer passed to the callback.
+ * @return CFRDS_STATUS_OK if the request was queued, otherwise the error status (the callback is not called).
+ */
+EXPORT_CFRDS cfrds_status cfrds_loop_submit_sql_primarykeys(cfrds_loop *loop, cfrds_server *server, const char *connection_name, const char *table_name, cfrds_loop_done_fn done, void *ctx);
+
+/**
+ * @brief Submits an asynchronous cfrds_command_sql_foreignkeys.
+ * @param loop Loop instance.
+ * @param server Initialized server connection. Must stay valid until the callback is called.
+ * @param connection_name Datasource name.
+ * @param table_name Table name.
+ * @param done Completion callback, receives a cfrds_sql_foreignkeys.
+ * @param ctx Context pointer passed to the callback.
+ * @return CFRDS_STATUS_OK if the request was queued, otherwise the error status (the callback is not called).
+ */
+EXPORT_CFRDS cfrds_status cfrds_loop_submit_sql_foreignkeys(cfrds_loop *loop, cfrds_server *server, const char *connection_name, const char *table_name, cfrds_loop_done_fn done, void *ctx);
+
+/**
+ * @brief Submits an asynchronous cfrds_command_sql_importedkeys.
+ * @param loop Loop instance.
+ * @param server Initialized server connection. Must stay valid until the callback is called.
+ * @param connection_name Datasource name.
+ * @param table_name Table name.
+ * @param done Completion callback, receives a cfrds_sql_importedkeys.
+ * @param ctx Context pointer passed to the callback.
+ * @return CFRDS_STATUS_OK if the request was queued, otherwise the error status (the callback is not called).
+ */
+EXPORT_CFRDS cfrds_status cfrds_loop_submit_sql_importedkeys(cfrds_loop *loop, cfrds_server *server, const char *connection_name, const char *table_name, cfrds_loop_done_fn done, void *ctx);
+
+/**
+ * @brief Submits an asynchronous cfrds_command_sql_exportedkeys.
+ * @param loop Loop instance.
+ * @param server Initialized server connection. Must stay valid until the callback is called.
+ * @param connection_name Datasource name.
+ * @param table_name Table name.
+ * @param done Completion callback, receives a cfrds_sql_exportedkeys.
+ * @param ctx Context pointer passed to the callback.
+ * @return CFRDS_STATUS_OK if the request was queued, otherwise the error status (the callback is not called).
+ */
+EXPORT_CFRDS cfrds_status cfrds_loop_submit_sql_exportedkeys(cfrds_loop *loop, cfrds_server *server, const char *connection_name, const char *table_name, cfrds_loop_done_fn done, void *ctx);
+
+/**
+ * @brief Submits an asynchronous cfrds_command_sql_sqlstmnt.
+ * @param loop Loop instance.
+ * @param server Initialized server connection. Must stay valid until the callback is called.
+ * @param connection_name Datasource name.
+ * @param sql SQL statement to execute.
+ * @param done Completion callback, receives a cfrds_sql_resultset.
+ * @param ctx Context pointer passed to the callback.
+ * @return CFRDS_STATUS_OK if the request was queued, otherwise the error status (the callback is not called).
+ */
+EXPORT_CFRDS cfrds_status cfrds_loop_submit_sql_sqlstmnt(cfrds_loop *loop, cfrds_server *server, const char *connection_name, const char *sql, cfrds_loop_done_fn done, void *ctx);
+
+/**
+ * @brief Submits an asynchronous cfrds_command_sql_sqlmetadata.
+ * @param loop Loop instance.
+ * @param server Initialized server connection. Must stay valid until the callback is called.
+ * @param connection_name Datasource name.
+ * @param sql SQL statement to describe.
+ * @param done Completion callback, receives a cfrds_sql_metadata.
+ * @param ctx Context pointer passed to the callback.
+ * @return CFRDS_STATUS_OK if the request was queued, otherwise the error status (the callback is not called).
+ */
+EXPORT_CFRDS cfrds_status cfrds_loop_submit_sql_sqlmetadata(cfrds_loop *loop, cfrds_server *server, const char *connection_name, const char *sql, cfrds_loop_done_fn done, void *ctx);
+
+/**
+ * @brief Submits an asynchronous cfrds_command_sql_getsupportedcommands.
+ * @param loop Loop instance.
+ * @param server Initialized server connection. Must stay valid until the callback is called.
+ * @param done Completion callback, receives a cfrds_sql_supportedcommands.
+ * @param ctx Context pointer passed to the callback.
+ * @return CFRDS_STATUS_OK if the request was queued, otherwise the error status (the callback is not called).
+ */
+EXPORT_CFRDS cfrds_status cfrds_loop_submit_sql_getsupportedcommands(cfrds_loop *loop, cfrds_server *server, cfrds_loop_done_fn done, void *ctx);
+
+/**
+ * @brief Submits an asynchronous cfrds_command_sql_dbdescription.
+ * @param loop Loop instance.
+ * @param server Initialized server connection. Must stay valid until the callback is called.
+ * @param connection_name Datasource name.
+ * @param done Completion callback, receives a cfrds_str (free with cfrds_str_cleanup).
+ * @param ctx Context pointer passed to the callback.
+ * @return CFRDS_STATUS_OK if the request was queued, otherwise the error status (the callback is not called).
+ */
+EXPORT_CFRDS cfrds_status cfrds_loop_submit_sql_dbdescription(cfrds_loop *loop, cfrds_server *server, const char *connection_name, cfrds_loop_done_fn done, void *ctx);
+
+/**
+ * @brief Starts a batch of RDS requests pipelined over keep-alive connections.
+ *
+ * Requests added to the batch are encoded right away and sent by `cfrds_batch_execute`, which spreads
+ * them round robin over up to `max_connections` sockets taken from the server keep-alive pool (or newly
+ * connected), writes each connection's requests back to back without waiting for the responses, and
+ * matches the responses to their requests in order. Requests the server did not get to answer because it
+ * closed the connection are sent again on a new connection, except SQLSTMNT and SQLMETADATA requests, which
+ * fail instead since the server may have run them. Requires keep-alive (`cfrds_server_set_keepalive`).
+ * @param server Initialized server connection. Must stay valid until the batch is freed.
+ * @param max_connections Largest number of connections used at once, 0 for the keep-alive pool size.
+ * @param batch Output pointer to the new batch. Must be freed with cfrds_batch_free.
+ * @return CFRDS_STATUS_OK, CFRDS_STATUS_PARAM_IS_NULL, CFRDS_STATUS_SERVER_IS_NULL, CFRDS_STATUS_MEMORY_ERROR
+ *         or CFRDS_STATUS_INVALID_INPUT_PARAMETER if keep-alive is disabled.
+ */
+EXPORT_CFRDS cfrds_status cfrds_batch_begin(cfrds_server *server, size_t max_connections, cfrds_batch **batch);
+
+/**
+ * @brief Frees a batch. Requests that were added but not executed are dropped without calling their callbacks.
+ * @param batch Batch instance to free. Safe to call if NULL.
+ */
+EXPORT_CFRDS void cfrds_batch_free(cfrds_batch *batch);
+
+/**
+ * @brief Automatically deallocates and nullifies a cfrds_batch pointer.
+ * @param batch Double pointer to the batch. Cleared to NULL after freeing.
+ */
+EXPORT_CFRDS void cfrds_batch_cleanup(cfrds_batch **batch);
+
+/**
+ * @brief Returns the number of requests added to the batch and not executed yet.
+ * @param batch Batch instance.
+ * @return Count of requests, 0 if batch is NULL.
+ */
+EXPORT_CFRDS size_t cfrds_batch_count(const cfrds_batch *batch);
+
+/**
+ * @brief Sends all requests of the batch and waits for their responses.
+ *
+ * Every added request has its callback called exactly once before this function returns, in the order
+ * its response arrived; responses on one connection arrive in the order the requests were added. Right
+ * before each call the error state of the server describes that request. The batch is empty afterwards
+ * and may be reused.
+ * @param batch Batch instance.
+ * @return CFRDS_STATUS_OK if all requests succeeded, otherwise the status of the first failed one.
+ */
+EXPORT_CFRDS cfrds_status cfrds_batch_execute(cfrds_batch *batch);
+
+/**
+ * @brief Adds a pipelined cfrds_command_browse_dir.
+ * @param batch Batch instance.
+ * @param path Remote path to list.
+ * @param done Completion callback, receives a cfrds_browse_dir.
+ * @param ctx Context pointer passed to the callback.
+ * @return CFRDS_STATUS_OK if the request was added, otherwise the error status (the callback is not called).
+ */
+EXPORT_CFRDS cfrds_status cfrds_batch_add_browse_dir(cfrds_batch *batch, const char *path, cfrds_loop_done_fn done, void *ctx);
+
+/**
+ * @brief Adds a pipelined cfrds_command_file_read.
+ * @param batch Batch instance.
+ * @param pathname Remote file path.
+ * @param done Completion callback, receives a cfrds_file_content.
+ * @param ctx Context pointer passed to the callback.
+ * @return CFRDS_STATUS_OK if the request was added, otherwise the error status (the callback is not called).
+ */
+EXPORT_CFRDS cfrds_status cfrds_batch_add_file_read(cfrds_batch *batch, const char *pathname, cfrds_loop_done_fn done, void *ctx);
+
+/**
+ * @brief Adds a pipelined cfrds_command_file_get_root_dir.
+ * @param batch Batch instance.
+ * @param done Completion callback, receives a cfrds_str (free with cfrds_str_cleanup).
+ * @param ctx Context pointer passed to the callback.
+ * @return CFRDS_STATUS_OK if the request was added, otherwise the error status (the callback is not called).
+ */
+EXPORT_CFRDS cfrds_status cfrds_batch_add_file_get_root_dir(cfrds_batch *batch, cfrds_loop_done_fn done, void *ctx);
+
+/**
+ * @brief Adds a pipelined cfrds_command_sql_dsninfo.
+ * @param batch Batch instance.
+ * @param done Completion callback, receives a cfrds_sql_dsninfo.
+ * @param ctx Context pointer passed to the callback.
+ * @return CFRDS_STATUS_OK if the request was added, otherwise the error status (the callback is not called).
+ */
+EXPORT_CFRDS cfrds_status cfrds_batch_add_sql_dsninfo(cfrds_batch *batch, cfrds_loop_done_fn done, void *ctx);
+
+/**
+ * @brief Adds a pipelined cfrds_command_sql_tableinfo.
+ * @param batch Batch instance.
+ * @param connection_name Datasource name.
+ * @param done Completion callback, receives a cfrds_sql_tableinfo.
+ * @param ctx Context pointer passed to the callback.
+ * @return CFRDS_STATUS_OK if the request was added, otherwise the error status (the callback is not called).
+ */
+EXPORT_CFRDS cfrds_status cfrds_batch_add_sql_tableinfo(cfrds_batch *batch, const char *connection_name, cfrds_loop_done_fn done, void *ctx);
+
+/**
+ * @brief Adds a pipelined cfrds_command_sql_columninfo.
+ * @param batch Batch instance.
+ * @param connection_name Datasource name.
+ * @param table_name Table name.
+ * @param done Completion callback, receives a cfrds_sql_columninfo.
+ * @param ctx Context pointer passed to the callback.
+ * @return CFRDS_STATUS_OK if the request was added, otherwise the error status (the callback is not called).
+ */
+EXPORT_CFRDS cfrds_status cfrds_batch_add_sql_columninfo(cfrds_batch *batch, const char *connection_name, const char *table_name, cfrds_loop_done_fn done, void *ctx);
+
+/**
+ * @brief Adds a pipelined cfrds_command_sql_primarykeys.
+ * @param batch Batch instance.
+ * @param connection_name Datasource name.
+ * @param table_name Table name.
+ * @param done Completion callback, receives a cfrds_sql_primarykeys.
+ * @param ctx Context pointer passed to the callback.
+ * @return CFRDS_STATUS_OK if the request was added, otherwise the error status (the callback is not called).
+ */
+EXPORT_CFRDS cfrds_status cfrds_batch_add_sql_primarykeys(cfrds_batch *batch, const char *connection_name, const char *table_name, cfrds_loop_done_fn done, void *ctx);
+
+/**
+ * @brief Adds a pipelined cfrds_command_sql_foreignkeys.
+ * @param batch Batch instance.
+ * @param connection_name Datasource name.
+ * @param table_name Table name.
+ * @param done Completion callback, receives a cfrds_sql_foreignkeys.
+ * @param ctx Context pointer passed to the callback.
+ * @return CFRDS_STATUS_OK if the request was added, otherwise the error status (the callback is not called).
+ */
+EXPORT_CFRDS cfrds_status cfrds_batch_add_sql_foreignkeys(cfrds_batch *batch, const char *connection_name, const char *table_name, cfrds_loop_done_fn done, void *ctx);
+
+/**
+ * @brief Adds a pipelined cfrds_command_sql_importedkeys.
+ * @param batch Batch instance.
+ * @param connection_name Datasource name.
+ * @param table_name Table name.
+ * @param done Completion callback, receives a cfrds_sql_importedkeys.
+ * @param ctx Context pointer passed to the callback.
+ * @return CFRDS_STATUS_OK if the request was added, otherwise the error status (the callback is not called).
+ */
+EXPORT_CFRDS cfrds_status cfrds_batch_add_sql_importedkeys(cfrds_batch *batch, const char *connection_name, const char *table_name, cfrds_loop_done_fn done, void *ctx);
+
+/**
+ * @brief Adds a pipelined cfrds_command_sql_exportedkeys.
+ * @param batch Batch instance.
+ * @param connection_name Datasource name.
+ * @param table_name Table name.
+ * @param done Completion callback, receives a cfrds_sql_exportedkeys.
+ * @param ctx Context pointer passed to the callback.
+ * @return CFRDS_STATUS_OK if the request was added, otherwise the error status (the callback is not called).
+ */
+EXPORT_CFRDS cfrds_status cfrds_batch_add_sql_exportedkeys(cfrds_batch *batch, const char *connection_name, const char *table_name, cfrds_loop_done_fn done, void *ctx);
+
+/**
+ * @brief Adds a pipelined cfrds_command_sql_sqlstmnt.
+ * @param batch Batch instance.
+ * @param connection_name Datasource name.
+ * @param sql SQL statement to execute.
+ * @param done Completion callback, receives a cfrds_sql_resultset.
+ * @param ctx Context pointer passed to the callback.
+ * @return CFRDS_STATUS_OK if the request was added, otherwise the error status (the callback is not called).
+ */
+EXPORT_CFRDS cfrds_status cfrds_batch_add_sql_sqlstmnt(cfrds_batch *batch, const char *connection_name, const char *sql, cfrds_loop_done_fn done, void *ctx);
+
+/**
+ * @brief Adds a pipelined cfrds_command_sql_sqlmetadata.
+ * @param batch Batch instance.
+ * @param connection_name Datasource name.
+ * @param sql SQL statement to describe.
+ * @param done Completion callback, receives a cfrds_sql_metadata.
+ * @param ctx Context pointer passed to the callback.
+ * @return CFRDS_STATUS_OK if the request was added, otherwise the error status (the callback is not called).
+ */
+EXPORT_CFRDS cfrds_status cfrds_batch_add_sql_sqlmetadata(cfrds_batch *batch, const char *connection_name, const char *sql, cfrds_loop_done_fn done, void *ctx);
+
+/**
+ * @brief Adds a pipelined cfrds_command_sql_getsupportedcommands.
+ * @param batch Batch instance.
+ * @param done Completion callback, receives a cfrds_sql_supportedcommands.
+ * @param ctx Context pointer passed to the callback.
+ * @return CFRDS_STATUS_OK if the request was added, otherwise the error status (the callback is not called).
+ */
+EXPORT_CFRDS cfrds_status cfrds_batch_add_sql_getsupportedcommands(cfrds_batch *batch, cfrds_loop_done_fn done, void *ctx);
+
+/**
+ * @brief Adds a pipelined cfrds_command_sql_dbdescription.
+ * @param batch Batch instance.
+ * @param connection_name Datasource name.
+ * @param done Completion callback, receives a cfrds_str (free with cfrds_str_cleanup).
+ * @param ctx Context pointer passed to the callback.
+ * @return CFRDS_STATUS_OK if the request was added, otherwise the error status (the callback is not called).
+ */
+EXPORT_CFRDS cfrds_status cfrds_batch_add_sql_dbdescription(cfrds_batch *batch, const char *connection_name, cfrds_loop_done_fn done, void *ctx);
+
 #ifdef __cplusplus
 }
 #endif
@@ -26,6 +26,7 @@ struct cfrds_debugger_event;
 struct cfrds_security_analyzer_result;
 struct cfrds_adminapi_customtagpaths;
 struct cfrds_adminapi_mappings;
+struct cfrds_loop;
 
 namespace cfrds {
 
@@ -145,6 +146,7 @@ using DebuggerEvent = AutoFree<struct ::cfrds_debugger_event>;            ///< M
 using SecurityAnalyzerResult = AutoFree<struct ::cfrds_security_analyzer_result>; ///< Managed cfrds_security_analyzer_result scanner report.
 using AdminApiCustomTagPaths = AutoFree<struct ::cfrds_adminapi_customtagpaths>; ///< Managed cfrds_adminapi_customtagpaths tag paths.
 using AdminApiMappings = AutoFree<struct ::cfrds_adminapi_mappings>;      ///< Managed cfrds_adminapi_mappings logic path configurations.
+using Loop = AutoFree<struct ::cfrds_loop>;                              ///< Managed cfrds_loop asynchronous request engine.
 
 // ------------------------------------------------------------------------------------------------
 // Factory Methods for Easy Initialization
@@ -184,6 +186,8 @@ inline SecurityAnalyzerResult make_security_analyzer_result() { return SecurityA
 inline AdminApiCustomTagPaths make_adminapi_customtagpaths() { return AdminApiCustomTagPaths(nullptr, ::cfrds_adminapi_customtagpaths_free); }
 /** @brief Instantiates an AdminApiMappings wrapper initialized to nullptr. */
 inline AdminApiMappings make_adminapi_mappings() { return AdminApiMappings(nullptr, ::cfrds_adminapi_mappings_free); }
+/** @brief Instantiates a Loop wrapper initialized to nullptr. */
+inline Loop make_loop() { return Loop(nullptr, ::cfrds_loop_free); }
 
 } // namespace cfrds
 
@@ -12,7 +12,13 @@
 #define DEFINE_STRING_ACCESSOR(func_name, struct_type, field) \
     const char *func_name(const struct_type *value, size_t ndx) { \
         CFRDS_CHECK_BOUNDS(value, ndx, NULL); \
-        return value->items[ndx].field; \
+        return value->items[ndx].field.str; \
+    }
+
+#define DEFINE_STRING_LEN_ACCESSOR(func_name, struct_type, field) \
+    size_t func_name(const struct_type *value, size_t ndx) { \
+        CFRDS_CHECK_BOUNDS(value, ndx, 0); \
+        return value->items[ndx].field.len; \
     }
 
 #define DEFINE_INT_ACCESSOR(func_name, struct_type, field, default_val) \
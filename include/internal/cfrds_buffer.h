@@ -13,67 +13,134 @@
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
 typedef SSIZE_T ssize_t;
+typedef SRWLOCK cfrds_mutex;
+typedef DWORD cfrds_tls_key;
 #else
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <pthread.h>
+typedef pthread_mutex_t cfrds_mutex;
+typedef pthread_key_t cfrds_tls_key;
 #endif
 
+/**
+ * @brief Error state of one thread's calls on a cfrds_server.
+ *
+ * Every thread issuing commands through a server gets its own context, so concurrent calls
+ * never overwrite each other's error. A thread finds its contexts through one library-wide
+ * thread-local list; each context is also linked into its server, so whichever of the
+ * thread and the server goes away first detaches it.
+ */
+typedef struct cfrds_error_ctx {
+    int _errno;
+    int64_t error_code;
+    char *error;
+    uint64_t serial;                      ///< Serial of the server, unique for the process lifetime.
+    cfrds_server *server;                 ///< NULL once the server was freed.
+    struct cfrds_error_ctx *prev;
+    struct cfrds_error_ctx *next;
+    struct cfrds_error_ctx *thread_next;  ///< Next context of the same thread.
+} cfrds_error_ctx;
+
 struct cfrds_server {
     char *host;
     uint16_t port;
     char *username;
     char *orig_password;
     char *password;
-    int _errno;
-    int64_t error_code;
-    char *error;
+    cfrds_mutex lock;
+    uint64_t serial;
+    cfrds_error_ctx *error_ctxs;
+    bool keepalive;
+    size_t keepalive_max_idle;
+    unsigned int keepalive_idle_timeout;
+    struct cfrds_http_pool *pool;
+    bool compression;
+    unsigned int dns_ttl;
+    struct cfrds_http_addrs *addrs;
+    bool happy_eyeballs;
+    unsigned int connect_timeout_ms;
+    unsigned int first_byte_timeout_ms;
+    unsigned int total_timeout_ms;
+    uint64_t max_response_size;
+    size_t spill_threshold;
+    bool result_views;
+    unsigned int retry_max_attempts;
+    unsigned int retry_backoff_base_ms;
+    unsigned int retry_backoff_max_ms;
+    unsigned int hedge_after_ms;
+    uint32_t latency[64];                 ///< Recent times from request sent to first response byte, in ms.
+    size_t latency_cnt;
+    uint64_t jitter_state;
 };
 
+/**
+ * @brief Bump allocator backing a parsed result and all of its strings.
+ *
+ * Memory comes from a list of chunks that only grow; nothing is freed individually,
+ * the whole arena goes away in one cfrds_arena_free() call.
+ */
+typedef struct cfrds_arena cfrds_arena;
+
+/**
+ * @brief A string of a parsed result and its length in bytes.
+ *
+ * `str` is null-terminated, either copied into the result arena or, for results parsed
+ * with views (cfrds_buffer_set_result_views()), terminated in place inside the response.
+ */
+typedef struct {
+    char *str;
+    size_t len;
+} cfrds_str_view;
+
 struct cfrds_file_content {
-    char *data;
-    size_t size;
-    char *modified;
-    char *permission;
+    cfrds_arena *arena;
+    cfrds_str_view data;
+    cfrds_str_view modified;
+    cfrds_str_view permission;
 };
 
 typedef struct {
     char kind;
-    char *name;
+    cfrds_str_view name;
     uint8_t permissions;
     size_t size;
     uint64_t modified;
 } cfrds_browse_dir_item;
 
 struct cfrds_browse_dir {
+    cfrds_arena *arena;
     size_t cnt;
     cfrds_browse_dir_item items[];
 };
 
 struct cfrds_sql_dsninfo {
+    cfrds_arena *arena;
     size_t cnt;
-    char *names[];
+    cfrds_str_view names[];
 };
 
 typedef struct {
-    char *unknown;
-    char *schema;
-    char *name;
-    char *type;
+    cfrds_str_view unknown;
+    cfrds_str_view schema;
+    cfrds_str_view name;
+    cfrds_str_view type;
 } cfrds_sql_tableinfoitem;
 
 struct cfrds_sql_tableinfo {
+    cfrds_arena *arena;
     size_t cnt;
     cfrds_sql_tableinfoitem items[];
 };
 
 typedef struct {
-    char *schema;
-    char *owner;
-    char *table;
-    char *name;
+    cfrds_str_view schema;
+    cfrds_str_view owner;
+    cfrds_str_view table;
+    cfrds_str_view name;
     int type;
-    char *typeStr;
+    cfrds_str_view typeStr;
     int precision;
     int length;
     int scale;
@@ -82,32 +149,34 @@ typedef struct {
 } cfrds_sql_columninfoitem;
 
 struct cfrds_sql_columninfo {
+    cfrds_arena *arena;
     size_t cnt;
     cfrds_sql_columninfoitem items[];
 };
 
 typedef struct {
-    char *tableCatalog;
-    char *tableOwner;
-    char *tableName;
-    char *colName;
+    cfrds_str_view tableCatalog;
+    cfrds_str_view tableOwner;
+    cfrds_str_view tableName;
+    cfrds_str_view colName;
     int keySequence;
 } cfrds_sql_primarykeysitem;
 
 struct cfrds_sql_primarykeys {
+    cfrds_arena *arena;
     size_t cnt;
     cfrds_sql_primarykeysitem items[];
 };
 
 typedef struct {
-    char *pkTableCatalog;
-    char *pkTableOwner;
-    char *pkTableName;
-    char *pkColName;
-    char *fkTableCatalog;
-    char *fkTableOwner;
-    char *fkTableName;
-    char *fkColName;
+    cfrds_str_view pkTableCatalog;
+    cfrds_str_view pkTableOwner;
+    cfrds_str_view pkTableName;
+    cfrds_str_view pkColName;
+    cfrds_str_view fkTableCatalog;
+    cfrds_str_view fkTableOwner;
+    cfrds_str_view fkTableName;
+    cfrds_str_view fkColName;
     int keySequence;
     int updateRule;
     int deleteRule;
@@ -118,45 +187,61 @@ typedef cfrds_sql_keyinfoitem cfrds_sql_importedkeysitem;
 typedef cfrds_sql_keyinfoitem cfrds_sql_exportedkeysitem;
 
 struct cfrds_sql_keyinfo {
+    cfrds_arena *arena;
     size_t cnt;
     cfrds_sql_keyinfoitem items[];
 };
 
 struct cfrds_sql_foreignkeys {
+    cfrds_arena *arena;
     size_t cnt;
     cfrds_sql_keyinfoitem items[];
 };
 
 struct cfrds_sql_importedkeys {
+    cfrds_arena *arena;
     size_t cnt;
     cfrds_sql_keyinfoitem items[];
 };
 
 struct cfrds_sql_exportedkeys {
+    cfrds_arena *arena;
     size_t cnt;
     cfrds_sql_keyinfoitem items[];
 };
 
+typedef struct {
+    cfrds_sql_column_type type;
+    size_t *offsets;    ///< rows + 1 offsets, row i is heap[offsets[i], offsets[i + 1]).
+    char *heap;         ///< Text of every row, back to back.
+    uint8_t *nulls;     ///< Bit per row, set for NULL cells. Typed columns only.
+    void *values;       ///< One int64_t, double or bool per row. Typed columns only.
+} cfrds_sql_column;
+
 struct cfrds_sql_resultset {
+    cfrds_arena *arena;
+    cfrds_sql_column *column_data;  ///< Column-major copy, NULL until cfrds_sql_resultset_make_columnar().
     size_t columns;
     size_t rows;
-    char *values[];
+    cfrds_str_view values[];
 };
 
 typedef struct {
-    char *name;
-    char *type;
-    char *jtype;
+    cfrds_str_view name;
+    cfrds_str_view type;
+    cfrds_str_view jtype;
 } cfrds_sql_metadataitem;
 
 struct cfrds_sql_metadata {
+    cfrds_arena *arena;
     size_t cnt;
     cfrds_sql_metadataitem items[];
 };
 
 struct cfrds_sql_supportedcommands {
+    cfrds_arena *arena;
     size_t cnt;
-    char *commands[];
+    cfrds_str_view commands[];
 };
 
 
@@ -211,6 +296,20 @@ bool cfrds_buffer_append(cfrds_buffer *buffer, const char *str);
  */
 bool cfrds_buffer_append_escaped(cfrds_buffer *buffer, const char *str);
 
+/**
+ * @brief Appends a string to the buffer as XML character data or as a double-quoted attribute value.
+ * 
+ * Escapes the way libxml2 serializes a document without an encoding: `<`, `>`, `&` and CR in
+ * text; in attribute values also `"`, LF, TAB and non-ASCII characters, as character references.
+ * Runs of bytes needing no escape are found 16 at a time with SSE2 where available.
+ * 
+ * @param buffer Destination buffer.
+ * @param str Null-terminated string to append.
+ * @param attribute true to escape for an attribute value, false for element text.
+ * @return true on success, false if buffer/str is NULL or appending fails.
+ */
+bool cfrds_buffer_append_xml_escaped(cfrds_buffer *buffer, const char *str, bool attribute);
+
 
 
 /**
@@ -272,6 +371,17 @@ bool cfrds_buffer_append_rds_string(cfrds_buffer *buffer, const char *str);
  */
 bool cfrds_buffer_append_rds_bytes(cfrds_buffer *buffer, const void *data, size_t length);
 
+/**
+ * @brief Appends the prefix of an RDS byte array without its contents.
+ * 
+ * Formats and appends `"STR:<length>:"`, for a body that sends the `length` data bytes in place.
+ * 
+ * @param buffer Destination buffer.
+ * @param length Count of bytes that follow.
+ * @return true on success, false if buffer is NULL or appending fails.
+ */
+bool cfrds_buffer_append_rds_bytes_prefix(cfrds_buffer *buffer, size_t length);
+
 /**
  * @brief Reserves a specified amount of additional free space in the buffer.
  * 
@@ -295,15 +405,124 @@ bool cfrds_buffer_reserve_above_size(cfrds_buffer *buffer, size_t size);
  */
 bool cfrds_buffer_expand(cfrds_buffer *buffer, size_t size);
 
+/**
+ * @brief Returns writable spare capacity past the active data.
+ * 
+ * Grows the storage geometrically (like the append functions) until at least `size` bytes are
+ * free, so a producer such as `recv` can write straight into the buffer. The bytes only become
+ * part of the data once they are committed with `cfrds_buffer_commit`.
+ * 
+ * @param buffer Target buffer.
+ * @param size Minimum bytes of free space requested.
+ * @return Pointer to the first free byte, or NULL if buffer is NULL, realloc fails or nothing is
+ *         allocated yet and size is 0.
+ */
+char *cfrds_buffer_spare(cfrds_buffer *buffer, size_t size);
+
+/**
+ * @brief Appends `size` bytes already written into the spare capacity to the active data.
+ * 
+ * Advances the active size and restores the null sentinel.
+ * 
+ * @param buffer Target buffer.
+ * @param size Number of bytes written at the pointer returned by `cfrds_buffer_spare`.
+ * @return true on success, false if buffer is NULL or size exceeds the free capacity.
+ */
+bool cfrds_buffer_commit(cfrds_buffer *buffer, size_t size);
+
+/**
+ * @brief Shrinks the buffer to the `size` bytes starting at `offset`.
+ * 
+ * Moves the selected range to the start of the storage with memmove, updates the active size
+ * and restores the null sentinel. The allocation is kept for reuse.
+ * 
+ * @param buffer Target buffer.
+ * @param offset Start of the range to keep.
+ * @param size Number of bytes to keep.
+ * @return true on success, false if buffer is NULL or the range exceeds the active data.
+ */
+bool cfrds_buffer_slice(cfrds_buffer *buffer, size_t offset, size_t size);
+
+/**
+ * @brief Sets the size past which the buffer moves its data to a memory-mapped temporary file.
+ * 
+ * Once growing the storage would exceed `threshold` bytes, the data is copied into an unlinked
+ * temporary file (in `TMPDIR`, or `/tmp`) mapped read-write, and further growth extends the file
+ * and its mapping. The data stays contiguous and null-terminated, so parsers read it unchanged,
+ * while the kernel can write idle pages back to disk instead of keeping them in anonymous memory.
+ * A buffer never moves back to the heap.
+ * 
+ * @param buffer Target buffer.
+ * @param threshold Largest heap allocation in bytes, 0 to never spill (default).
+ * @return true on success, false if buffer is NULL.
+ */
+bool cfrds_buffer_set_spill_threshold(cfrds_buffer *buffer, size_t threshold);
+
+/**
+ * @brief Tells whether the buffer data lives in a memory-mapped temporary file.
+ * 
+ * @param buffer Pointer to the buffer.
+ * @return true once the buffer has spilled, false otherwise or if buffer is NULL.
+ */
+bool cfrds_buffer_spilled(cfrds_buffer *buffer);
+
+/**
+ * @brief Makes the cfrds_buffer_to_* parsers point result strings into the buffer instead of copying them.
+ * 
+ * A result parsed from such a buffer takes over its storage and terminates each string in
+ * place, so parsing allocates nothing per field. The buffer is left empty but usable; when
+ * parsing fails its contents may already have been modified.
+ * 
+ * @param buffer Target buffer.
+ * @param enabled true to parse results as views, false to copy strings (default).
+ * @return true on success, false if buffer is NULL.
+ */
+bool cfrds_buffer_set_result_views(cfrds_buffer *buffer, bool enabled);
+
 /**
  * @brief Frees all memory associated with the buffer.
  * 
- * Frees internal byte array and the cfrds_buffer container. Safe if buffer is NULL.
+ * Frees internal byte array (or unmaps and closes its spill file) and the cfrds_buffer container.
+ * Safe if buffer is NULL.
  * 
  * @param buffer Pointer to the buffer to free.
  */
 void cfrds_buffer_free(cfrds_buffer *buffer);
 
+/**
+ * @brief Creates an arena whose first chunk holds `capacity` bytes.
+ * 
+ * @param capacity Expected total size of the allocations, the arena grows past it when needed.
+ * @return The new arena, or NULL if malloc fails.
+ */
+cfrds_arena *cfrds_arena_create(size_t capacity);
+
+/**
+ * @brief Allocates zeroed, suitably aligned memory from the arena.
+ * 
+ * @param arena Arena to allocate from.
+ * @param size Number of bytes.
+ * @return Pointer valid until cfrds_arena_free(), or NULL if arena is NULL or malloc fails.
+ */
+void *cfrds_arena_alloc(cfrds_arena *arena, size_t size);
+
+/**
+ * @brief Copies `len` bytes of `str` into the arena and null-terminates the copy.
+ * 
+ * @param arena Arena to allocate from.
+ * @param str Source bytes, need not be null-terminated.
+ * @param len Number of bytes to copy.
+ * @return The copy, or NULL if arena is NULL or malloc fails.
+ */
+char *cfrds_arena_strndup(cfrds_arena *arena, const char *str, size_t len);
+
+/**
+ * @brief Frees the arena, everything allocated from it and the response storage it took over.
+ * 
+ * @param arena Arena to free, may be NULL.
+ */
+void cfrds_arena_free(cfrds_arena *arena);
+
 /**
  * @brief Parses an RDS protocol base-10 number terminated by a colon.
  * 
@@ -438,8 +657,9 @@ struct cfrds_sql_exportedkeys *cfrds_buffer_to_sql_exportedkeys(cfrds_buffer *bu
 /**
  * @brief Parses query sql statement resultset from the RDS server response.
  * 
- * Expects tabular list. The first row contains column headers. Determines the number of columns 
- * and rows, then builds a tabular grid of value strings.
+ * Expects tabular list. The first row contains column headers. Parses the response in one pass,
+ * taking the number of columns from the header row, into a row-major grid of value strings that
+ * point into one copy of the rows (or into the response itself with result views).
  * 
  * @param buffer Server response buffer.
  * @return Allocated `cfrds_sql_resultset` representing rows and columns. Must be freed by the caller.
@@ -447,6 +667,22 @@ struct cfrds_sql_exportedkeys *cfrds_buffer_to_sql_exportedkeys(cfrds_buffer *bu
  */
 struct cfrds_sql_resultset *cfrds_buffer_to_sql_sqlstmnt(cfrds_buffer *buffer);
 
+/**
+ * @brief Splits one sql statement row (a comma separated, optionally quoted list) in place.
+ * 
+ * Every field is null-terminated inside `row` once it is parsed, so `row` must have a writable
+ * byte at `row[size]`, as buffer data has. With `fields` NULL the fields are only counted.
+ * Embedded NULs end the row, like in `cfrds_buffer_to_sql_sqlstmnt`.
+ * 
+ * @param row Row text, modified in place unless `fields` is NULL.
+ * @param size Row size in bytes.
+ * @param fields Output array for the fields, or NULL to count them.
+ * @param max Capacity of `fields`.
+ * @param cnt Output for the number of fields.
+ * @return true on success, false if the row is malformed or has more than `max` fields.
+ */
+bool cfrds_buffer_split_row(char *row, size_t size, cfrds_str_view *fields, size_t max, size_t *cnt);
+
 /**
  * @brief Parses query column metadata from the RDS server response.
  * 
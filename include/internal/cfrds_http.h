@@ -4,29 +4,498 @@
 #include "cfrds_buffer.h"
 
 #include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <WinSock2.h>
+#else
+#include <sys/types.h>
+#include <errno.h>
+#endif
+
+#define CFRDS_MAX_RESPONSE_SIZE (100 * 1024 * 1024)
+#define CFRDS_MAX_HEADER_SIZE (64 * 1024)
+#define CFRDS_HTTP_MAX_SEGMENTS 8
+#define CFRDS_HTTP_CONNECT_ATTEMPT_DELAY_MS 250
+#define CFRDS_HTTP_CONNECT_TIMEOUT_MS (30 * 1000)
+#define CFRDS_HTTP_FIRST_BYTE_TIMEOUT_MS (30 * 1000)
+#define CFRDS_HTTP_TOTAL_TIMEOUT_MS (60 * 1000)
+#define CFRDS_HTTP_RETRY_BACKOFF_BASE_MS 50
+#define CFRDS_HTTP_RETRY_BACKOFF_MAX_MS (2 * 1000)
+#define CFRDS_HTTP_LATENCY_MIN_SAMPLES 16
+
+#ifdef _WIN32
+typedef SOCKET cfrds_socket;
+#define CFRDS_INVALID_SOCKET INVALID_SOCKET
+#define GET_SOCKET_ERRNO() WSAGetLastError()
+#define IS_SOCKET_EINTR(err) ((err) == WSAEINTR)
+#define IS_SOCKET_EWOULDBLOCK(err) ((err) == WSAEWOULDBLOCK)
+#define IS_SOCKET_EINPROGRESS(err) (((err) == WSAEWOULDBLOCK)||((err) == WSAEINPROGRESS))
+#define SOCKET_ETIMEDOUT WSAETIMEDOUT
+#else
+typedef int cfrds_socket;
+#define CFRDS_INVALID_SOCKET (-1)
+#define GET_SOCKET_ERRNO() errno
+#ifdef EINTR
+#define IS_SOCKET_EINTR(err) ((err) == EINTR)
+#else
+#define IS_SOCKET_EINTR(err) false
+#endif
+#define IS_SOCKET_EWOULDBLOCK(err) (((err) == EAGAIN)||((err) == EWOULDBLOCK))
+#define IS_SOCKET_EINPROGRESS(err) ((err) == EINPROGRESS)
+#define SOCKET_ETIMEDOUT ETIMEDOUT
+#endif
+
+#ifdef MSG_NOSIGNAL
+#define CFRDS_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define CFRDS_SEND_FLAGS 0
+#endif
+
+/**
+ * @brief Closes a socket and sets it to `CFRDS_INVALID_SOCKET`.
+ *
+ * @param sock Pointer to the socket. Safe to call if NULL or already invalid.
+ */
+void cfrds_sock_cleanup(cfrds_socket *sock);
+#define cfrds_sock_defer(var) cfrds_socket var __attribute__((cleanup(cfrds_sock_cleanup))) = CFRDS_INVALID_SOCKET
+
+
+/**
+ * @brief A piece of request data sent in place, without copying it into the request buffer.
+ *
+ * A segment with `data` set to NULL is file backed: `size` bytes are streamed from `fd` starting
+ * at `file_offset` (with `sendfile` where available), without changing the file position.
+ */
+typedef struct {
+    const void *data;
+    size_t size;
+    int fd;
+    uint64_t file_offset;
+} cfrds_http_segment;
+
+/**
+ * @brief Callback receiving HTTP response body bytes as they arrive.
+ *
+ * @param ctx Caller supplied context pointer.
+ * @param data Decoded body bytes (chunk framing already removed). Valid only for the duration of the call.
+ * @param size Number of bytes in `data`.
+ * @return `CFRDS_STATUS_OK` to continue, any other status aborts the response with that status.
+ */
+typedef cfrds_status (*cfrds_http_body_fn)(void *ctx, const char *data, size_t size);
+
+/**
+ * @enum cfrds_http_state
+ * @brief Position of the incremental HTTP response parser within the message.
+ */
+typedef enum {
+    CFRDS_HTTP_STATE_HEADERS,
+    CFRDS_HTTP_STATE_BODY_LENGTH,
+    CFRDS_HTTP_STATE_BODY_EOF,
+    CFRDS_HTTP_STATE_CHUNK_SIZE,
+    CFRDS_HTTP_STATE_CHUNK_DATA,
+    CFRDS_HTTP_STATE_CHUNK_DATA_END,
+    CFRDS_HTTP_STATE_TRAILER,
+    CFRDS_HTTP_STATE_DONE
+} cfrds_http_state;
+
+/**
+ * @enum cfrds_http_encoding
+ * @brief Content-Encoding of the response body.
+ */
+typedef enum {
+    CFRDS_HTTP_ENCODING_IDENTITY,
+    CFRDS_HTTP_ENCODING_DEFLATE,
+    CFRDS_HTTP_ENCODING_GZIP
+} cfrds_http_encoding;
+
+/**
+ * @brief Incremental HTTP/1.0 and HTTP/1.1 response parser.
+ *
+ * Bytes are pushed with `cfrds_http_parser_feed` in whatever pieces the socket returns them.
+ * The status line and headers are collected (up to 64KB), after which the body is framed by
+ * `Transfer-Encoding: chunked`, `Content-Length` or connection close, in that order of precedence,
+ * and handed to the body callback without being buffered. Interim 1xx responses are skipped.
+ * When built with zlib (`CFRDS_HAVE_ZLIB`), gzip and deflate encoded bodies are inflated on the fly
+ * and the size limit (`max_body_size`, 100MB by default) applies to the decompressed body.
+ */
+typedef struct {
+    cfrds_http_state state;
+    int status_code;              ///< HTTP status code, valid once the headers are complete.
+    bool keep_alive;              ///< Whether the connection may carry another request after this response.
+    bool chunked;                 ///< Body uses chunked transfer encoding.
+    int64_t content_length;       ///< Declared Content-Length, or -1 when absent.
+    uint64_t remaining;           ///< Bytes left in the current body or chunk.
+    uint64_t body_size;           ///< Total (decoded) body bytes received so far, error bodies included.
+    uint64_t delivered;           ///< Body bytes handed to `on_body` or committed to its buffer.
+    uint64_t max_body_size;       ///< Largest accepted body, `CFRDS_MAX_RESPONSE_SIZE` unless changed after init (see `server->max_response_size`).
+    cfrds_http_encoding encoding; ///< Content-Encoding of the body.
+    void *inflater;               ///< zlib stream while decoding a compressed body.
+    uint8_t inflate_head[2];      ///< First body bytes, used to detect the compressed stream format.
+    size_t inflate_head_len;
+    bool inflate_end;             ///< Compressed stream reached its end marker.
+    size_t header_match;
+    size_t line_len;
+    bool chunk_ext;
+    bool chunk_digits;
+    cfrds_buffer *headers;        ///< Raw status line and header block.
+    cfrds_http_body_fn on_body;
+    void *ctx;
+    cfrds_status status;          ///< Sticky error status once parsing failed.
+    const char *error;            ///< Static description of the failure, or NULL.
+} cfrds_http_parser;
 
 
 /**
  * @brief Sends an HTTP POST request to the target RDS server and retrieves the response.
  * 
  * Formats and sends a custom HTTP POST request with "compatible; Macromedia RDS Client" User-Agent.
- * Resolves the server host, connects to it (establishing a TCP connection via socket), sets send/receive timeouts
- * to 30 seconds, and transmits the request headers and payload. Then, it reads the HTTP response, verifies the 
+ * Resolves the server host, connects to it (establishing a TCP connection via socket), and transmits the
+ * request headers and payload. Then, it reads the HTTP response, verifies the 
  * status code is 200 (supporting HTTP/1.0 and HTTP/1.1), skips the HTTP headers, parses the response-specific RDS error 
  * code, and sets server-level errors if any failures occur during host resolution, connection, socket IO, or status parsing.
+ *
+ * The response is read through the incremental `cfrds_http_parser`, so the body is framed by chunked transfer
+ * encoding or `Content-Length` when the server uses them, otherwise it is read until EOF.
+ * With keep-alive enabled (see `cfrds_server_set_keepalive`), the socket is taken from and returned to the
+ * server connection pool; if a pooled socket turns out to be closed by the peer before any response byte
+ * arrives, the request is retried once on a fresh connection, provided the command is idempotent or
+ * no byte of the request was written yet.
+ * The socket is non-blocking and every wait goes through `poll` against the server deadlines
+ * (see `cfrds_server_set_timeouts`): connect, first response byte after the request was sent, and total.
  * 
  * @param server Pointer to the `cfrds_server` containing connection configurations (host, port, etc.) and error state.
  * @param command The API action string appended to the URL (e.g. `ACTION=command`).
  * @param payload The `cfrds_buffer` representing the POST body data to be transmitted.
- * @param response Output pointer where a pointer to the parsed HTTP response body `cfrds_buffer` is returned.
+ * @param response Output pointer where a pointer to the HTTP response body `cfrds_buffer` (headers stripped) is returned.
+ *                 The body spills to a mapped temporary file past the server's `spill_threshold`.
  *                 Must be freed by the caller via `cfrds_buffer_free` on success. Ignored if NULL.
  * @return `cfrds_status` indicating success (`CFRDS_STATUS_OK`) or specific failure code:
  *         - `CFRDS_STATUS_MEMORY_ERROR` on allocation/snprintf failure.
  *         - `CFRDS_STATUS_SOCKET_HOST_NOT_FOUND` on name resolution failure.
- *         - `CFRDS_STATUS_CONNECTION_TO_SERVER_FAILED` on TCP connection or socket timeout configuration failure.
- *         - `CFRDS_STATUS_WRITING_TO_SOCKET_FAILED` or `CFRDS_STATUS_READING_FROM_SOCKET_FAILED` on socket transmission errors.
- *         - `CFRDS_STATUS_RESPONSE_TOO_LARGE` if the response exceeds `CFRDS_MAX_RESPONSE_SIZE` (100MB).
+ *         - `CFRDS_STATUS_CONNECTION_TO_SERVER_FAILED` on TCP connection failure or connect timeout.
+ *         - `CFRDS_STATUS_WRITING_TO_SOCKET_FAILED` or `CFRDS_STATUS_READING_FROM_SOCKET_FAILED` on socket transmission errors and timeouts.
+ *         - `CFRDS_STATUS_RESPONSE_TOO_LARGE` if the response exceeds the server's `max_response_size` (100MB by default).
  *         - `CFRDS_STATUS_RESPONSE_ERROR` if the HTTP status is not 200 or parsing error code fails or RDS error code indicates failure (< 0).
  *         - `CFRDS_STATUS_HTTP_RESPONSE_NOT_FOUND` if the header end separator `\r\n\r\n` cannot be found.
  */
 cfrds_status cfrds_http_post(cfrds_server *server, const char *command, cfrds_buffer *payload, cfrds_buffer **response);
+
+/**
+ * @brief Sends an HTTP POST request whose body is gathered from several segments.
+ *
+ * Same as `cfrds_http_post`, but the body is the concatenation of `body` segments, written to the
+ * socket in place (scatter/gather) after the request headers. Lets large caller data or files be
+ * sent without building a copy of the whole body.
+ *
+ * @param server Pointer to the `cfrds_server`.
+ * @param command The API action string appended to the URL.
+ * @param body Body segments. The memory they point to must stay valid during the call.
+ * @param cnt Number of segments, less than `CFRDS_HTTP_MAX_SEGMENTS`.
+ * @param idempotent true if the command may be sent more than once, so the server retry policy and hedging apply.
+ * @param response Output pointer for the response body, see `cfrds_http_post`. Ignored if NULL.
+ * @return Same as `cfrds_http_post`.
+ */
+cfrds_status cfrds_http_post_segments(cfrds_server *server, const char *command, const cfrds_http_segment *body, size_t cnt, bool idempotent, cfrds_buffer **response);
+
+/**
+ * @brief Sends an HTTP POST request and streams the response body to a callback.
+ *
+ * Same transport as `cfrds_http_post` (connection pool, retry of a stale pooled socket), but the body
+ * is passed to `on_body` piece by piece as it is received instead of being collected in a buffer.
+ * The RDS error code at the start of the body is not interpreted. An idempotent command is only
+ * retried while no body bytes were passed to `on_body`.
+ *
+ * @param server Pointer to the `cfrds_server`.
+ * @param command The API action string appended to the URL.
+ * @param body Body segments, see `cfrds_http_post_segments`.
+ * @param cnt Number of segments, less than `CFRDS_HTTP_MAX_SEGMENTS`.
+ * @param max_body_size Largest accepted response body (`CFRDS_STATUS_RESPONSE_TOO_LARGE` above it).
+ *                      `UINT64_MAX` when `on_body` does not keep the body in memory.
+ * @param on_body Callback receiving the decoded body bytes. Only called for 2xx responses.
+ * @param ctx Context pointer passed to `on_body`.
+ * @param idempotent true if the command may be sent more than once, see `cfrds_http_post_segments`.
+ * @return `CFRDS_STATUS_OK` on success, the status returned by `on_body` if it aborted, or one of the
+ *         transport errors listed for `cfrds_http_post`.
+ */
+cfrds_status cfrds_http_post_stream(cfrds_server *server, const char *command, const cfrds_http_segment *body, size_t cnt, uint64_t max_body_size, cfrds_http_body_fn on_body, void *ctx, bool idempotent);
+
+/**
+ * @brief A response read on demand, see `cfrds_http_stream_open`.
+ */
+typedef struct cfrds_http_stream cfrds_http_stream;
+
+/**
+ * @brief Sends an HTTP POST request and reads the response only as far as its headers.
+ *
+ * The pull counterpart of `cfrds_http_post_stream`: the caller receives the body piece by piece
+ * with `cfrds_http_stream_read`, at its own pace, and `on_body` gets the decoded bytes (2xx only).
+ * A stale pooled socket is replaced once while no byte of the request was written to it; nothing else is retried.
+ * The body size is not limited, `on_body` decides what to keep.
+ *
+ * @param server Pointer to the `cfrds_server`.
+ * @param command The API action string appended to the URL.
+ * @param body Body segments, see `cfrds_http_post_segments`.
+ * @param cnt Number of segments, less than `CFRDS_HTTP_MAX_SEGMENTS`.
+ * @param on_body Callback receiving the decoded body bytes, may already be called here.
+ * @param ctx Context pointer passed to `on_body`.
+ * @param out Output for the open stream. Must be closed with `cfrds_http_stream_close`.
+ * @return `CFRDS_STATUS_OK` once a 200 response started, `CFRDS_STATUS_RESPONSE_ERROR` for any other
+ *         HTTP status, or one of the transport errors listed for `cfrds_http_post`.
+ */
+cfrds_status cfrds_http_stream_open(cfrds_server *server, const char *command, const cfrds_http_segment *body, size_t cnt, cfrds_http_body_fn on_body, void *ctx, cfrds_http_stream **out);
+
+/**
+ * @brief Receives the next piece of a streamed response and passes its body bytes to `on_body`.
+ *
+ * Blocks until data arrives, at most until the total deadline set when the stream was opened,
+ * which covers the whole response however slowly it is consumed. Does nothing once the response is complete.
+ *
+ * @param stream Stream opened with `cfrds_http_stream_open`.
+ * @return `CFRDS_STATUS_OK`, the status returned by `on_body` if it aborted, or a transport error.
+ */
+cfrds_status cfrds_http_stream_read(cfrds_http_stream *stream);
+
+/**
+ * @brief Tells whether the whole response was received.
+ *
+ * @param stream Stream opened with `cfrds_http_stream_open`.
+ * @return true once the response is complete.
+ */
+bool cfrds_http_stream_done(const cfrds_http_stream *stream);
+
+/**
+ * @brief Closes a streamed response.
+ *
+ * A completely received response on a keep-alive connection returns the socket to the server
+ * connection pool, otherwise the connection is closed.
+ *
+ * @param stream Stream to close. Safe to call if NULL.
+ */
+void cfrds_http_stream_close(cfrds_http_stream *stream);
+
+/**
+ * @brief Initializes an HTTP response parser.
+ *
+ * @param parser Parser to initialize.
+ * @param on_body Callback receiving body bytes. May be NULL to discard the body.
+ * @param ctx Context pointer passed to `on_body`.
+ * @return true on success, false if parser is NULL or the header buffer cannot be allocated.
+ */
+bool cfrds_http_parser_init(cfrds_http_parser *parser, cfrds_http_body_fn on_body, void *ctx);
+
+/**
+ * @brief Releases the memory held by an HTTP response parser.
+ *
+ * @param parser Parser to clean up. Safe to call if NULL.
+ */
+void cfrds_http_parser_cleanup(cfrds_http_parser *parser);
+
+/**
+ * @brief Feeds received bytes into the parser.
+ *
+ * Consumes input until it is exhausted or the response is complete (`state == CFRDS_HTTP_STATE_DONE`).
+ * Bytes following a complete response are left unconsumed.
+ *
+ * @param parser Initialized parser.
+ * @param data Received bytes.
+ * @param size Number of bytes in `data`.
+ * @param consumed Output for the number of bytes consumed. Ignored if NULL.
+ * @return `CFRDS_STATUS_OK`, or the error status (`CFRDS_STATUS_RESPONSE_ERROR` for malformed input,
+ *         `CFRDS_STATUS_RESPONSE_TOO_LARGE`, `CFRDS_STATUS_MEMORY_ERROR` or the body callback status).
+ *         Errors are sticky; `parser->error` describes parser failures.
+ */
+cfrds_status cfrds_http_parser_feed(cfrds_http_parser *parser, const char *data, size_t size, size_t *consumed);
+
+/**
+ * @brief Signals end of input (peer closed the connection) to the parser.
+ *
+ * @param parser Initialized parser.
+ * @return `CFRDS_STATUS_OK` if the response is complete (a body framed by connection close ends here),
+ *         `CFRDS_STATUS_RESPONSE_ERROR` if nothing was received, `CFRDS_STATUS_HTTP_RESPONSE_NOT_FOUND`
+ *         if the header block is incomplete, or `CFRDS_STATUS_READING_FROM_SOCKET_FAILED` if the body is truncated.
+ */
+cfrds_status cfrds_http_parser_finish(cfrds_http_parser *parser);
+
+/**
+ * @brief Returns how many body bytes may be received straight into the body's destination.
+ *
+ * Non-zero only while the parser is inside identity encoded body data of a response it delivers
+ * (2xx with a body callback): the rest of a Content-Length body or of the current chunk, or
+ * `UINT64_MAX` for a body framed by connection close. Framing, headers and compressed bodies have
+ * to go through `cfrds_http_parser_feed`.
+ *
+ * @param parser Initialized parser.
+ * @return Size of the window in bytes, 0 if bytes must be fed.
+ */
+uint64_t cfrds_http_parser_direct_window(const cfrds_http_parser *parser);
+
+/**
+ * @brief Accounts for body bytes the caller stored itself instead of feeding them.
+ *
+ * Same bookkeeping as `cfrds_http_parser_feed` for body data (size limit, framing state), but the
+ * body callback is not called: the caller already placed the bytes where the callback would have.
+ *
+ * @param parser Initialized parser.
+ * @param size Number of bytes received, at most `cfrds_http_parser_direct_window`.
+ * @return `CFRDS_STATUS_OK`, `CFRDS_STATUS_RESPONSE_TOO_LARGE`, or `CFRDS_STATUS_INVALID_INPUT_PARAMETER`
+ *         if size exceeds the window. Errors are sticky, like for `cfrds_http_parser_feed`.
+ */
+cfrds_status cfrds_http_parser_direct_commit(cfrds_http_parser *parser, size_t size);
+
+/**
+ * @brief Formats the HTTP request line and headers of an RDS command.
+ *
+ * The body is not appended, it is sent after the headers from its own storage.
+ *
+ * @param server Pointer to the `cfrds_server` (host, port, keep-alive and compression settings).
+ * @param command The API action string appended to the URL.
+ * @param content_length Size of the POST body in bytes.
+ * @param send_buf Buffer the headers are appended to.
+ * @return `CFRDS_STATUS_OK`, or `CFRDS_STATUS_MEMORY_ERROR` (server error is set).
+ */
+cfrds_status cfrds_http_build_header(cfrds_server *server, const char *command, size_t content_length, cfrds_buffer *send_buf);
+
+/**
+ * @brief Writes request segments to a socket with a single gathering send call.
+ *
+ * Uses `sendmsg` (`WSASend` on Windows), so the segments are not copied into one buffer.
+ *
+ * @param sockfd Connected socket.
+ * @param segs Request segments in memory, in order (no file backed segments).
+ * @param cnt Number of segments. At most `CFRDS_HTTP_MAX_SEGMENTS` are sent per call.
+ * @param offset Number of bytes of the segments already sent, skipped.
+ * @return Number of bytes written (0 if nothing remains), or -1 with the socket error set.
+ */
+ssize_t cfrds_http_send_segments(cfrds_socket sockfd, const cfrds_http_segment *segs, size_t cnt, size_t offset);
+
+/**
+ * @brief Interprets the RDS status number at the start of a response body.
+ *
+ * Stores the number in the calling thread's error context (`error_code`). A negative number means the command failed on the
+ * server and the rest of the body is its error message.
+ *
+ * @param server Pointer to the `cfrds_server`.
+ * @param response Response body.
+ * @return `CFRDS_STATUS_OK`, or `CFRDS_STATUS_RESPONSE_ERROR` if the number is missing or negative (server error is set).
+ */
+cfrds_status cfrds_http_parse_rds_status(cfrds_server *server, cfrds_buffer *response);
+
+/**
+ * @brief Switches a socket between blocking and non-blocking mode.
+ *
+ * @param sockfd Socket.
+ * @param blocking true for blocking mode, false for non-blocking mode.
+ * @return true on success.
+ */
+bool cfrds_http_socket_set_blocking(cfrds_socket sockfd, bool blocking);
+
+/**
+ * @brief Reads the monotonic clock all request deadlines are measured on.
+ *
+ * @return Milliseconds since an arbitrary fixed point (`CLOCK_MONOTONIC`, `GetTickCount64` on Windows).
+ */
+uint64_t cfrds_http_now_ms(void);
+
+/**
+ * @brief Computes the deadline `timeout_ms` from now, capped at `limit`.
+ *
+ * @param timeout_ms Timeout in milliseconds.
+ * @param limit Latest acceptable deadline, usually the total deadline of the request.
+ * @return Absolute deadline on the `cfrds_http_now_ms` clock.
+ */
+uint64_t cfrds_http_deadline(unsigned int timeout_ms, uint64_t limit);
+
+/**
+ * @brief Opens a non-blocking TCP connection to the server.
+ *
+ * Resolves the host through the per-server cache and connects sequentially or, when enabled,
+ * with Happy Eyeballs, giving up when `deadline` passes.
+ *
+ * @param server Pointer to the `cfrds_server`.
+ * @param deadline Connect deadline on the `cfrds_http_now_ms` clock.
+ * @param out_sockfd Output for the connected socket.
+ * @return `CFRDS_STATUS_OK`, `CFRDS_STATUS_SOCKET_HOST_NOT_FOUND`, `CFRDS_STATUS_CONNECTION_TO_SERVER_FAILED`
+ *         or `CFRDS_STATUS_MEMORY_ERROR` (server error is set).
+ */
+cfrds_status cfrds_http_connect(cfrds_server *server, uint64_t deadline, cfrds_socket *out_sockfd);
+
+/**
+ * @brief Resolved addresses of a server host.
+ *
+ * Reference counted, so a connection attempt can keep using the list while the server cache
+ * replaces it. The count is atomic; the cache reference is taken and dropped under the server lock.
+ */
+typedef struct cfrds_http_addrs {
+    size_t refs;
+    time_t resolved_at;           ///< Time of the lookup, the cache entry expires `dns_ttl` seconds later.
+    struct addrinfo *list;        ///< getaddrinfo() result, TCP addresses in resolver order.
+} cfrds_http_addrs;
+
+/**
+ * @brief Resolves the server host, answering from the per-server cache while it is fresh.
+ *
+ * A new lookup is stored in the cache unless caching is disabled (`dns_ttl` is 0).
+ *
+ * @param server Pointer to the `cfrds_server`.
+ * @param out Output for a reference to the addresses, released with `cfrds_http_addrs_release`.
+ * @param cached Output, true if the addresses came from the cache. Ignored if NULL.
+ * @return `CFRDS_STATUS_OK`, `CFRDS_STATUS_MEMORY_ERROR` or `CFRDS_STATUS_SOCKET_HOST_NOT_FOUND`.
+ *         The server error is not set.
+ */
+cfrds_status cfrds_http_resolve(cfrds_server *server, cfrds_http_addrs **out, bool *cached);
+
+/**
+ * @brief Drops a reference to resolved addresses, freeing them with the last one.
+ *
+ * @param addrs Addresses returned by `cfrds_http_resolve`. Safe to call if NULL.
+ */
+void cfrds_http_addrs_release(cfrds_http_addrs *addrs);
+
+/**
+ * @brief Forgets the cached addresses of the server, the next connection resolves the host again.
+ *
+ * @param server Pointer to the `cfrds_server`. Safe to call if NULL.
+ */
+void cfrds_http_dns_flush(cfrds_server *server);
+
+/**
+ * @brief Opens connections to the server and parks them in its keep-alive pool.
+ *
+ * Connects until the pool holds `count` idle connections (at most `keepalive_max_idle`).
+ *
+ * @param server Pointer to the `cfrds_server`, with keep-alive enabled.
+ * @param count Number of idle connections wanted.
+ * @return `CFRDS_STATUS_OK`, or the connection error of the first failed connect (server error is set).
+ */
+cfrds_status cfrds_http_pool_prewarm(cfrds_server *server, size_t count);
+
+/**
+ * @brief Takes an idle keep-alive connection from the server pool.
+ *
+ * Connections idle longer than the pool timeout or closed by the peer are discarded.
+ *
+ * @param server Pointer to the `cfrds_server`.
+ * @param out_sockfd Output for the connected (non-blocking) socket.
+ * @return true if a usable connection was found.
+ */
+bool cfrds_http_pool_acquire(cfrds_server *server, cfrds_socket *out_sockfd);
+
+/**
+ * @brief Parks a connection whose response was fully read in the server pool.
+ *
+ * The socket must be in non-blocking mode. If the pool is full, the least recently used connection is closed.
+ *
+ * @param server Pointer to the `cfrds_server`.
+ * @param sockfd Socket to release. Set to `CFRDS_INVALID_SOCKET`; closed if it can not be pooled.
+ */
+void cfrds_http_pool_release(cfrds_server *server, cfrds_socket *sockfd);
+
+/**
+ * @brief Closes all idle keep-alive connections of the server and releases the pool.
+ *
+ * @param server Pointer to the `cfrds_server`. Safe to call if NULL or if no pool was allocated.
+ */
+void cfrds_http_pool_free(cfrds_server *server);
@@ -5,11 +5,11 @@
 #include <internal/cfrds_http.h>
 
 /**
- * @brief Sets the error state of a cfrds_server instance.
+ * @brief Sets the error state of a cfrds_server instance for the calling thread.
  * 
- * Sets the numeric error code of the given `cfrds_server` and updates its string error message.
- * It will free any previous error string stored in the server instance before allocating and 
- * copying the new one (using `strdup`).
+ * Sets the numeric error code in the calling thread's error context of the given `cfrds_server`
+ * and updates its string error message. It will free any previous error string stored in the
+ * context before allocating and copying the new one (using `strdup`).
  * 
  * @param server Pointer to the `cfrds_server` instance whose error state is to be updated.
  *               If NULL, the function does nothing and returns immediately.
@@ -18,16 +18,89 @@
  */
 EXPORT_CFRDS void cfrds_server_set_error(cfrds_server *server, int64_t error_code, const char *error);
 
+/**
+ * @brief Returns the calling thread's error context for a server, creating it on first use.
+ *
+ * Never returns NULL for a non-NULL server: if the context cannot be allocated, a per-thread
+ * fallback that is not tied to any server is returned instead.
+ */
+cfrds_error_ctx *cfrds_server_error_ctx(const cfrds_server *server);
+
+/**
+ * @brief Locks the state a server shares between threads (connection pool, DNS cache, latency samples).
+ */
+void cfrds_server_lock(const cfrds_server *server);
+
+/**
+ * @brief Unlocks the state locked by cfrds_server_lock.
+ */
+void cfrds_server_unlock(const cfrds_server *server);
+
 /**
  * @brief Encodes a plaintext password for ColdFusion RDS protocol transmission.
  */
 EXPORT_CFRDS char *cfrds_server_encode_password(const char *password);
 
+/**
+ * @brief Encodes an RDS command argument list, followed by the server credentials, as a POST body.
+ *
+ * @param server Server instance supplying username and password.
+ * @param list NULL-terminated list of arguments (at most 1024).
+ * @param payload Output pointer to the allocated body. Must be freed with cfrds_buffer_free.
+ * @return `CFRDS_STATUS_OK`, `CFRDS_STATUS_INVALID_INPUT_PARAMETER` for an unterminated list or `CFRDS_STATUS_MEMORY_ERROR`.
+ */
+cfrds_status cfrds_build_command_payload(cfrds_server *server, const char *list[], cfrds_buffer **payload);
+
 /**
  * @brief Sends an RDS command with list of arguments.
  */
 EXPORT_CFRDS cfrds_status cfrds_send_command(cfrds_server *server, cfrds_buffer **response, const char *command, const char *list[]);
 
+/**
+ * @brief Sends a read-only RDS command, which the server retry policy may repeat or hedge.
+ */
+cfrds_status cfrds_send_idempotent_command(cfrds_server *server, cfrds_buffer **response, const char *command, const char *list[]);
+
 typedef void *(*cfrds_sql_parser_fn)(cfrds_buffer *buffer);
 EXPORT_CFRDS cfrds_status cfrds_execute_sql_cmd(cfrds_server *server, const char *params[], cfrds_sql_parser_fn parser, void **out_result);
 
+
+/**
+ * @brief Queues an RDS command on an event loop.
+ *
+ * The argument list is encoded immediately, so it does not need to outlive the call.
+ * On completion the RDS status is checked and, if `parser` is not NULL, the response body
+ * is converted with it; a NULL parser result fails the request with `CFRDS_STATUS_RESPONSE_ERROR`.
+ * Without a pooled socket the request connects right away, resolving the host first (blocking)
+ * when the server DNS cache misses, e.g. for the first request to a host unless
+ * `cfrds_server_prewarm` was called.
+ *
+ * @param loop Loop instance.
+ * @param server Server the command is sent to.
+ * @param command The API action string appended to the URL.
+ * @param list NULL-terminated list of arguments.
+ * @param idempotent true if the command may be sent again when a stale pooled socket fails after the request was written.
+ * @param parser Response parser, or NULL for commands without a result.
+ * @param done Completion callback.
+ * @param ctx Context pointer passed to `done`.
+ * @return `CFRDS_STATUS_OK` if the request was queued, otherwise the error status (`done` is not called).
+ */
+cfrds_status cfrds_loop_submit(cfrds_loop *loop, cfrds_server *server, const char *command, const char *list[], bool idempotent, cfrds_sql_parser_fn parser, cfrds_loop_done_fn done, void *ctx);
+
+/**
+ * @brief Adds an RDS command to a batch.
+ *
+ * The request headers and the encoded argument list are built immediately, so the list does not need
+ * to outlive the call. Responses are checked and converted the same way as for `cfrds_loop_submit`.
+ *
+ * @param batch Batch instance.
+ * @param command The API action string appended to the URL.
+ * @param list NULL-terminated list of arguments.
+ * @param idempotent true if the command may be sent again on a new connection when the server closes
+ *                   the pipeline before answering it.
+ * @param parser Response parser, or NULL for commands without a result.
+ * @param done Completion callback.
+ * @param ctx Context pointer passed to `done`.
+ * @return `CFRDS_STATUS_OK` if the request was added, otherwise the error status (`done` is not called).
+ */
+cfrds_status cfrds_batch_add(cfrds_batch *batch, const char *command, const char *list[], bool idempotent, cfrds_sql_parser_fn parser, cfrds_loop_done_fn done, void *ctx);
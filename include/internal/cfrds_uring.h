@@ -0,0 +1,81 @@
+#pragma once
+
+#include <linux/io_uring.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+
+
+/**
+ * @brief Minimal io_uring instance (submission and completion rings mapped from the kernel).
+ *
+ * Talks to the kernel through the raw `io_uring_setup`/`io_uring_enter` system calls, so no
+ * liburing dependency is needed. Not thread-safe: one owner drives both rings.
+ */
+typedef struct {
+    int fd;
+    void *sq_ring;
+    size_t sq_ring_size;
+    void *cq_ring;
+    size_t cq_ring_size;
+    struct io_uring_sqe *sqes;
+    size_t sqes_size;
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_array;
+    unsigned sq_mask;
+    unsigned sq_entries;
+    unsigned sq_local_tail;       ///< Tail including queued entries not yet published to the kernel.
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned cq_mask;
+    struct io_uring_cqe *cqes;
+} cfrds_uring;
+
+/**
+ * @brief Creates an io_uring instance.
+ *
+ * Fails when the kernel has no io_uring support, it is disabled (e.g. by seccomp or
+ * `kernel.io_uring_disabled`), or it predates the socket operations and fast poll (Linux 5.7).
+ *
+ * @param ring Ring to initialize.
+ * @param entries Requested submission queue size.
+ * @return true on success, false if io_uring is not usable.
+ */
+bool cfrds_uring_init(cfrds_uring *ring, unsigned entries);
+
+/**
+ * @brief Unmaps the rings and closes the io_uring instance.
+ *
+ * @param ring Ring to clean up. Safe to call on a ring whose init failed.
+ */
+void cfrds_uring_cleanup(cfrds_uring *ring);
+
+/**
+ * @brief Returns a zeroed submission queue entry to fill in.
+ *
+ * The entry is queued but not passed to the kernel until `cfrds_uring_submit`. A full
+ * submission queue is flushed first.
+ *
+ * @param ring Ring instance.
+ * @return The entry, or NULL if the queue is full and can not be flushed.
+ */
+struct io_uring_sqe *cfrds_uring_get_sqe(cfrds_uring *ring);
+
+/**
+ * @brief Submits all queued entries and optionally waits for completions.
+ *
+ * @param ring Ring instance.
+ * @param wait_nr Number of completions to wait for (0 returns immediately).
+ * @return 0 on success, or a negative errno value.
+ */
+int cfrds_uring_submit(cfrds_uring *ring, unsigned wait_nr);
+
+/**
+ * @brief Takes the next completion from the completion queue.
+ *
+ * @param ring Ring instance.
+ * @param cqe Output for a copy of the completion entry.
+ * @return true if a completion was available.
+ */
+bool cfrds_uring_next_cqe(cfrds_uring *ring, struct io_uring_cqe *cqe);
@@ -34,6 +34,13 @@ enum wddx_type {
  */
 typedef struct WDDX WDDX;
 
+/**
+ * @typedef wddx_path
+ * @brief Opaque handle to a compiled comma-separated path.
+ * @see wddx_path_compile(), wddx_path_free(), wddx_path_static(), wddx_get_var_compiled()
+ */
+typedef struct wddx_path wddx_path;
+
 /**
  * @typedef WDDX_NODE
  * @brief Opaque handle to a single WDDX node (value of any type).
@@ -54,8 +61,8 @@ typedef struct WDDX_NODE WDDX_NODE;
 /**
  * @brief Creates a new, empty WDDX packet.
  * 
- * Allocates memory for a `WDDX` struct (containing pointer fields for `header`, `data`, and 
- * `str` of type `xmlBufferPtr`) and clears it using explicit_bzero.
+ * Creates the arena the packet lives in, together with every node, struct member and key later
+ * added to it. The `WDDX` struct itself is its first allocation.
  * 
  * @return A newly allocated `WDDX*`, or `NULL` on allocation failure.
  */
@@ -67,11 +74,12 @@ WDDX *wddx_create(void);
  * Traverses or constructs a hierarchy of nested array and struct nodes recursively based on the 
  * comma-separated path.
  * - If a segment is numeric (determined by checking up to 20 digits via is_string_numeric), it is 
- *   treated as a 0-based array index. It allocates or reallocates the child items list array size
- *   as needed to accommodate the index, zeroing the new elements.
+ *   treated as a 0-based array index. It copies the child items list into a larger one from the
+ *   packet's arena as needed to accommodate the index, zeroing the new elements.
  * - Otherwise, the segment is treated as a struct variable name, and search is done on the existing
  *   structure variables. If not found, a new struct element is allocated and added to the end of the items list.
  * Values are stored under a newly allocated `WDDX_NODE` with type `WDDX_BOOLEAN` and string representation `"true"` or `"false"`.
+ * A value being replaced and outgrown items lists are not freed, they stay in the arena until wddx_cleanup().
  * 
  * @param dest The target WDDX packet.
  * @param path Comma-separated path string specifying structural position (e.g. "0,foo,2").
@@ -109,33 +117,45 @@ bool wddx_put_string(WDDX *dest, const char *path, const char *value);
 /**
  * @brief Serializes the WDDX packet to XML format.
  * 
- * Frees any existing serialized buffer in `src->str`. Then uses libxml2 to build a new XML document:
- * - `<wddxPacket version="1.0">` is created as root.
- * - `<header>` child element is created and populated recursively from `src->header`.
- * - `<data>` child element is created and populated recursively from `src->data`.
- * XML node translation rules:
+ * Writes the packet with wddx_to_buffer() into a buffer owned by `src`, reused by later calls,
+ * and returns its contents.
+ * 
+ * @param src The WDDX packet.
+ * @return Null-terminated string containing the serialized XML. Pointer is owned by `src`. NULL if out of memory.
+ */
+const char *wddx_to_xml(WDDX *src);
+
+/**
+ * @brief Appends the WDDX packet as XML to a buffer.
+ * 
+ * Writes the XML text directly, with no intermediate document:
+ * - `<wddxPacket version="1.0">` as root, with `<header>` and `<data>` holding `src->header` and `src->data`.
  * - `WDDX_NULL` -> `<null/>`
  * - `WDDX_BOOLEAN` -> `<boolean value="true|false"/>`
  * - `WDDX_NUMBER` -> `<number>...</number>`
  * - `WDDX_STRING` -> `<string>...</string>`
  * - `WDDX_ARRAY` -> `<array length="N">...</array>`
  * - `WDDX_STRUCT` -> `<struct type="java.util.HashMap">` containing `<var name="key">` children.
- * Dumps the document into `src->str` and returns its contents pointer.
+ * Values are escaped as plain text, elements without content are written as `<name/>`; the output
+ * is byte for byte what libxml2's `xmlNodeDump` gives for the same document.
  * 
  * @param src The WDDX packet.
- * @return Null-terminated string containing the serialized XML. Pointer is owned by `src`.
+ * @param out Buffer the XML is appended to.
+ * @return true on success, false if an argument is NULL or appending fails.
  */
-const char *wddx_to_xml(WDDX *src);
+bool wddx_to_buffer(const WDDX *src, cfrds_buffer *out);
 
 /**
  * @brief Parses an XML string into a WDDX packet.
  * 
- * Uses libxml2's `xmlParseMemory` to parse the string. Silences error output in non-NDEBUG builds
- * via a custom generic error handler. Traverses the document structure to verify the root 
- * `<wddxPacket>` and its `<header>` and `<data>` children. Parses all nodes recursively mapping
- * elements to their respective internal types (`null`, `boolean`, `number`, `string`, `array`, `struct`).
+ * Reads the string in a single pass, checking it is well-formed XML and building the nodes as
+ * their elements are read, with no intermediate DOM. Packets with a DOCTYPE or declaring an
+ * encoding other than UTF-8 are parsed with libxml2's `xmlParseMemory` instead.
+ * Verifies the root `<wddxPacket>` and its `<header>` and `<data>` children, and maps elements
+ * to their respective internal types (`null`, `boolean`, `number`, `string`, `array`, `struct`).
  * - Arrays read their `length` property and parse child items up to that length.
  * - Structs scan for `<var>` elements, extracting `name` property and parsing their inner child.
+ * All nodes, keys and strings are carved from one arena sized by the length of `xml`.
  * 
  * @param xml Null-terminated string containing WDDX XML data.
  * @return A newly allocated WDDX structure containing the parsed trees, or NULL on parsing failure.
@@ -240,6 +260,8 @@ EXPORT_CFRDS const char *wddx_get_string(const void *src, const char *path);
  * @brief Query helper to retrieve a node at a specific path.
  * 
  * Traverses structural nodes recursively matching indexes for array items and keys for struct fields.
+ * Struct keys are found through a hash index once a struct has 16 keys or more, smaller structs are
+ * scanned; with duplicate keys the first one wins either way.
  * 
  * @param src Pointer to the WDDX structure.
  * @param path Comma-separated path.
@@ -247,13 +269,86 @@ EXPORT_CFRDS const char *wddx_get_string(const void *src, const char *path);
  */
 EXPORT_CFRDS const WDDX_NODE *wddx_get_var(const void *src, const char *path);
 
+/**
+ * @brief Compiles a comma-separated path for repeated lookups.
+ * 
+ * Splits `path` once into its segments the way the `wddx_get_*` helpers read it: all-digit
+ * segments index arrays, the others are struct keys, stored with their hash.
+ * 
+ * @param path Comma-separated path, NULL or empty for the data root.
+ * @return A newly allocated path to be freed with wddx_path_free(), or NULL if out of memory.
+ */
+EXPORT_CFRDS wddx_path *wddx_path_compile(const char *path);
+
+/**
+ * @brief Frees a path returned by wddx_path_compile().
+ * 
+ * @param path The compiled path. Ignored if NULL.
+ */
+EXPORT_CFRDS void wddx_path_free(wddx_path *path);
+
+/**
+ * @brief Compiles `path` into `*slot` the first time it is called for that slot.
+ * 
+ * Safe to call from several threads; the compiled path is kept until the process exits.
+ * Lets a fixed path be compiled once: `static wddx_path *slot;` then `wddx_path_static(&slot, "0,STATUS")`.
+ * 
+ * @param slot Storage for the compiled path, a NULL-initialized static variable.
+ * @param path Comma-separated path.
+ * @return The compiled path, or NULL if out of memory.
+ */
+EXPORT_CFRDS const wddx_path *wddx_path_static(wddx_path **slot, const char *path);
+
+/**
+ * @def wddx_path_defer(var)
+ * @brief RAII macro for automatic cleanup of compiled paths using GCC/Clang `__attribute__((cleanup))`.
+ * @see wddx_path_free()
+ */
+#define wddx_path_defer(var) wddx_path* var __attribute__((cleanup(wddx_path_cleanup))) = NULL
+
+/**
+ * @brief Cleanup function for wddx_path_defer().
+ * 
+ * @param path Pointer to the wddx_path* pointer to free and set to NULL.
+ */
+EXPORT_CFRDS void wddx_path_cleanup(wddx_path **path);
+
+/**
+ * @brief wddx_get_var() with a compiled path.
+ * 
+ * @param src Pointer to the WDDX structure.
+ * @param path Compiled path, NULL finds nothing.
+ * @return Const pointer to the located WDDX_NODE, or NULL if not found.
+ */
+EXPORT_CFRDS const WDDX_NODE *wddx_get_var_compiled(const void *src, const wddx_path *path);
+
+/**
+ * @brief wddx_get_string() with a compiled path.
+ * 
+ * @param src Pointer to the WDDX structure.
+ * @param path Compiled path, NULL finds nothing.
+ * @return Pointer to the null-terminated string, or NULL if not found or type mismatch.
+ */
+EXPORT_CFRDS const char *wddx_get_string_compiled(const void *src, const wddx_path *path);
+
+/**
+ * @brief wddx_get_number() with a compiled path.
+ * 
+ * @param src Pointer to the WDDX structure.
+ * @param path Compiled path, NULL finds nothing.
+ * @param ok Output parameter set to true on success, false on traversal or type mismatch.
+ * @return The double value if successful, 0.0 otherwise.
+ */
+EXPORT_CFRDS double wddx_get_number_compiled(const void *src, const wddx_path *path, bool *ok);
+
 
 
 /**
- * @brief Recursively frees a WDDX packet structure and associated memory.
+ * @brief Frees a WDDX packet and everything allocated for it.
  * 
- * Destroys all structural nodes, internal variable names, values, and XML serializer buffer.
- * Finally, frees the WDDX container and sets the referenced pointer to NULL.
+ * Frees the XML serializer buffer, then the packet's arena: the WDDX container and all of its
+ * nodes, variable names and values go in one call per arena chunk, without walking the tree.
+ * Sets the referenced pointer to NULL.
  * 
  * @param value Pointer to the WDDX* pointer to clean up.
  */
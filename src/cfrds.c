@@ -22,10 +22,7 @@ void cfrds_file_content_free(cfrds_file_content *value)
     if (value == NULL)
         return;
 
-    free(value->data);
-    free(value->modified);
-    free(value->permission);
-    free(value);
+    cfrds_arena_free(value->arena);
 }
 
 const char *cfrds_file_content_get_data(const cfrds_file_content *value)
@@ -33,7 +30,7 @@ const char *cfrds_file_content_get_data(const cfrds_file_content *value)
     if (value == NULL)
         return NULL;
 
-    return value->data;
+    return value->data.str;
 }
 
 size_t cfrds_file_content_get_size(const cfrds_file_content *value)
@@ -41,7 +38,7 @@ size_t cfrds_file_content_get_size(const cfrds_file_content *value)
     if (value == NULL)
         return 0;
 
-    return value->size;
+    return value->data.len;
 }
 
 const char *cfrds_file_content_get_modified(const cfrds_file_content *value)
@@ -49,7 +46,15 @@ const char *cfrds_file_content_get_modified(const cfrds_file_content *value)
     if (value == NULL)
         return NULL;
 
-    return value->modified;
+    return value->modified.str;
+}
+
+size_t cfrds_file_content_get_modified_len(const cfrds_file_content *value)
+{
+    if (value == NULL)
+        return 0;
+
+    return value->modified.len;
 }
 
 const char *cfrds_file_content_get_permission(const cfrds_file_content *value)
@@ -57,7 +62,15 @@ const char *cfrds_file_content_get_permission(const cfrds_file_content *value)
     if (value == NULL)
         return NULL;
 
-    return value->permission;
+    return value->permission.str;
+}
+
+size_t cfrds_file_content_get_permission_len(const cfrds_file_content *value)
+{
+    if (value == NULL)
+        return 0;
+
+    return value->permission.len;
 }
 
 void cfrds_browse_dir_free(cfrds_browse_dir *value)
@@ -65,12 +78,7 @@ void cfrds_browse_dir_free(cfrds_browse_dir *value)
     if (value == NULL)
         return;
 
-    for(size_t c = 0; c < value->cnt; c++)
-    {
-        free(value->items[c].name);
-    }
-
-    free(value);
+    cfrds_arena_free(value->arena);
 }
 
 size_t cfrds_browse_dir_count(const cfrds_browse_dir *value)
@@ -91,6 +99,7 @@ size_t cfrds_browse_dir_count(const cfrds_browse_dir *value)
 
 DEFINE_CHAR_ACCESSOR(cfrds_browse_dir_item_get_kind, cfrds_browse_dir, kind, 0)
 DEFINE_STRING_ACCESSOR(cfrds_browse_dir_item_get_name, cfrds_browse_dir, name)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_browse_dir_item_get_name_len, cfrds_browse_dir, name)
 DEFINE_UINT8_ACCESSOR(cfrds_browse_dir_item_get_permissions, cfrds_browse_dir, permissions, 0)
 DEFINE_SIZE_ACCESSOR(cfrds_browse_dir_item_get_size, cfrds_browse_dir, size, 0)
 DEFINE_UINT64_ACCESSOR(cfrds_browse_dir_item_get_modified, cfrds_browse_dir, modified, 0)
@@ -100,12 +109,7 @@ void cfrds_sql_dsninfo_free(cfrds_sql_dsninfo *value)
     if (value == NULL)
         return;
 
-    for(size_t c = 0; c < value->cnt; c++)
-    {
-        free(value->names[c]);
-    }
-
-    free(value);
+    cfrds_arena_free(value->arena);
 }
 
 size_t cfrds_sql_dsninfo_count(const cfrds_sql_dsninfo *value)
@@ -124,7 +128,18 @@ const char *cfrds_sql_dsninfo_item_get_name(const cfrds_sql_dsninfo *value, size
     if (ndx >= value->cnt)
         return NULL;
 
-    return value->names[ndx];
+    return value->names[ndx].str;
+}
+
+size_t cfrds_sql_dsninfo_item_get_name_len(const cfrds_sql_dsninfo *value, size_t ndx)
+{
+    if (value == NULL)
+        return 0;
+
+    if (ndx >= value->cnt)
+        return 0;
+
+    return value->names[ndx].len;
 }
 
 void cfrds_sql_tableinfo_free(cfrds_sql_tableinfo *value)
@@ -132,15 +147,7 @@ void cfrds_sql_tableinfo_free(cfrds_sql_tableinfo *value)
     if (value == NULL)
         return;
 
-    for(size_t c = 0; c < value->cnt; c++)
-    {
-        if(value->items[c].unknown) free(value->items[c].unknown);
-        if(value->items[c].schema) free(value->items[c].schema);
-        if(value->items[c].name) free(value->items[c].name);
-        if(value->items[c].type) free(value->items[c].type);
-    }
-
-    free(value);
+    cfrds_arena_free(value->arena);
 }
 
 size_t cfrds_sql_tableinfo_count(const cfrds_sql_tableinfo *value)
@@ -152,25 +159,20 @@ size_t cfrds_sql_tableinfo_count(const cfrds_sql_tableinfo *value)
 }
 
 DEFINE_STRING_ACCESSOR(cfrds_sql_tableinfo_get_column_unknown, cfrds_sql_tableinfo, unknown)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_tableinfo_get_column_unknown_len, cfrds_sql_tableinfo, unknown)
 DEFINE_STRING_ACCESSOR(cfrds_sql_tableinfo_get_column_schema, cfrds_sql_tableinfo, schema)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_tableinfo_get_column_schema_len, cfrds_sql_tableinfo, schema)
 DEFINE_STRING_ACCESSOR(cfrds_sql_tableinfo_get_column_name, cfrds_sql_tableinfo, name)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_tableinfo_get_column_name_len, cfrds_sql_tableinfo, name)
 DEFINE_STRING_ACCESSOR(cfrds_sql_tableinfo_get_column_type, cfrds_sql_tableinfo, type)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_tableinfo_get_column_type_len, cfrds_sql_tableinfo, type)
 
 void cfrds_sql_columninfo_free(cfrds_sql_columninfo *value)
 {
     if (value == NULL)
         return;
 
-    for(size_t c = 0; c < value->cnt; c++)
-    {
-        if(value->items[c].schema) free(value->items[c].schema);
-        if(value->items[c].owner) free(value->items[c].owner);
-        if(value->items[c].table) free(value->items[c].table);
-        if(value->items[c].name) free(value->items[c].name);
-        if(value->items[c].typeStr) free(value->items[c].typeStr);
-    }
-
-    free(value);
+    cfrds_arena_free(value->arena);
 }
 
 size_t cfrds_sql_columninfo_count(const cfrds_sql_columninfo *value)
@@ -182,11 +184,16 @@ size_t cfrds_sql_columninfo_count(const cfrds_sql_columninfo *value)
 }
 
 DEFINE_STRING_ACCESSOR(cfrds_sql_columninfo_get_schema, cfrds_sql_columninfo, schema)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_columninfo_get_schema_len, cfrds_sql_columninfo, schema)
 DEFINE_STRING_ACCESSOR(cfrds_sql_columninfo_get_owner, cfrds_sql_columninfo, owner)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_columninfo_get_owner_len, cfrds_sql_columninfo, owner)
 DEFINE_STRING_ACCESSOR(cfrds_sql_columninfo_get_table, cfrds_sql_columninfo, table)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_columninfo_get_table_len, cfrds_sql_columninfo, table)
 DEFINE_STRING_ACCESSOR(cfrds_sql_columninfo_get_name, cfrds_sql_columninfo, name)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_columninfo_get_name_len, cfrds_sql_columninfo, name)
 DEFINE_INT_ACCESSOR(cfrds_sql_columninfo_get_type, cfrds_sql_columninfo, type, -1)
 DEFINE_STRING_ACCESSOR(cfrds_sql_columninfo_get_typeStr, cfrds_sql_columninfo, typeStr)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_columninfo_get_typeStr_len, cfrds_sql_columninfo, typeStr)
 DEFINE_INT_ACCESSOR(cfrds_sql_columninfo_get_precision, cfrds_sql_columninfo, precision, -1)
 DEFINE_INT_ACCESSOR(cfrds_sql_columninfo_get_length, cfrds_sql_columninfo, length, -1)
 DEFINE_INT_ACCESSOR(cfrds_sql_columninfo_get_scale, cfrds_sql_columninfo, scale, -1)
@@ -198,15 +205,7 @@ void cfrds_sql_primarykeys_free(cfrds_sql_primarykeys *value)
     if (value == NULL)
         return;
 
-    for(size_t c = 0; c < value->cnt; c++)
-    {
-        if(value->items[c].tableCatalog) free(value->items[c].tableCatalog);
-        if(value->items[c].tableOwner) free(value->items[c].tableOwner);
-        if(value->items[c].tableName) free(value->items[c].tableName);
-        if(value->items[c].colName) free(value->items[c].colName);
-    }
-
-    free(value);
+    cfrds_arena_free(value->arena);
 }
 
 size_t cfrds_sql_primarykeys_count(const cfrds_sql_primarykeys *value)
@@ -218,36 +217,21 @@ size_t cfrds_sql_primarykeys_count(const cfrds_sql_primarykeys *value)
 }
 
 DEFINE_STRING_ACCESSOR(cfrds_sql_primarykeys_get_catalog, cfrds_sql_primarykeys, tableCatalog)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_primarykeys_get_catalog_len, cfrds_sql_primarykeys, tableCatalog)
 DEFINE_STRING_ACCESSOR(cfrds_sql_primarykeys_get_owner, cfrds_sql_primarykeys, tableOwner)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_primarykeys_get_owner_len, cfrds_sql_primarykeys, tableOwner)
 DEFINE_STRING_ACCESSOR(cfrds_sql_primarykeys_get_table, cfrds_sql_primarykeys, tableName)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_primarykeys_get_table_len, cfrds_sql_primarykeys, tableName)
 DEFINE_STRING_ACCESSOR(cfrds_sql_primarykeys_get_column, cfrds_sql_primarykeys, colName)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_primarykeys_get_column_len, cfrds_sql_primarykeys, colName)
 DEFINE_INT_ACCESSOR(cfrds_sql_primarykeys_get_key_sequence, cfrds_sql_primarykeys, keySequence, -1)
 
-static void cfrds_sql_keyitems_free(cfrds_sql_foreignkeysitem *items, size_t cnt)
-{
-    if (items == NULL)
-        return;
-
-    for (size_t c = 0; c < cnt; c++)
-    {
-        free(items[c].pkTableCatalog);
-        free(items[c].pkTableOwner);
-        free(items[c].pkTableName);
-        free(items[c].pkColName);
-        free(items[c].fkTableCatalog);
-        free(items[c].fkTableOwner);
-        free(items[c].fkTableName);
-        free(items[c].fkColName);
-    }
-}
-
 void cfrds_sql_foreignkeys_free(cfrds_sql_foreignkeys *value)
 {
     if (value == NULL)
         return;
 
-    cfrds_sql_keyitems_free(value->items, value->cnt);
-    free(value);
+    cfrds_arena_free(value->arena);
 }
 
 size_t cfrds_sql_foreignkeys_count(const cfrds_sql_foreignkeys *value)
@@ -259,13 +243,21 @@ size_t cfrds_sql_foreignkeys_count(const cfrds_sql_foreignkeys *value)
 }
 
 DEFINE_STRING_ACCESSOR(cfrds_sql_foreignkeys_get_pkcatalog, cfrds_sql_foreignkeys, pkTableCatalog)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_foreignkeys_get_pkcatalog_len, cfrds_sql_foreignkeys, pkTableCatalog)
 DEFINE_STRING_ACCESSOR(cfrds_sql_foreignkeys_get_pkowner, cfrds_sql_foreignkeys, pkTableOwner)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_foreignkeys_get_pkowner_len, cfrds_sql_foreignkeys, pkTableOwner)
 DEFINE_STRING_ACCESSOR(cfrds_sql_foreignkeys_get_pktable, cfrds_sql_foreignkeys, pkTableName)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_foreignkeys_get_pktable_len, cfrds_sql_foreignkeys, pkTableName)
 DEFINE_STRING_ACCESSOR(cfrds_sql_foreignkeys_get_pkcolumn, cfrds_sql_foreignkeys, pkColName)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_foreignkeys_get_pkcolumn_len, cfrds_sql_foreignkeys, pkColName)
 DEFINE_STRING_ACCESSOR(cfrds_sql_foreignkeys_get_fkcatalog, cfrds_sql_foreignkeys, fkTableCatalog)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_foreignkeys_get_fkcatalog_len, cfrds_sql_foreignkeys, fkTableCatalog)
 DEFINE_STRING_ACCESSOR(cfrds_sql_foreignkeys_get_fkowner, cfrds_sql_foreignkeys, fkTableOwner)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_foreignkeys_get_fkowner_len, cfrds_sql_foreignkeys, fkTableOwner)
 DEFINE_STRING_ACCESSOR(cfrds_sql_foreignkeys_get_fktable, cfrds_sql_foreignkeys, fkTableName)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_foreignkeys_get_fktable_len, cfrds_sql_foreignkeys, fkTableName)
 DEFINE_STRING_ACCESSOR(cfrds_sql_foreignkeys_get_fkcolumn, cfrds_sql_foreignkeys, fkColName)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_foreignkeys_get_fkcolumn_len, cfrds_sql_foreignkeys, fkColName)
 DEFINE_INT_ACCESSOR(cfrds_sql_foreignkeys_get_key_sequence, cfrds_sql_foreignkeys, keySequence, -1)
 DEFINE_INT_ACCESSOR(cfrds_sql_foreignkeys_get_updaterule, cfrds_sql_foreignkeys, updateRule, -1)
 DEFINE_INT_ACCESSOR(cfrds_sql_foreignkeys_get_deleterule, cfrds_sql_foreignkeys, deleteRule, -1)
@@ -275,8 +267,7 @@ void cfrds_sql_importedkeys_free(cfrds_sql_importedkeys *value)
     if (value == NULL)
         return;
 
-    cfrds_sql_keyitems_free((cfrds_sql_foreignkeysitem *)value->items, value->cnt);
-    free(value);
+    cfrds_arena_free(value->arena);
 }
 
 size_t cfrds_sql_importedkeys_count(const cfrds_sql_importedkeys *value)
@@ -288,13 +279,21 @@ size_t cfrds_sql_importedkeys_count(const cfrds_sql_importedkeys *value)
 }
 
 DEFINE_STRING_ACCESSOR(cfrds_sql_importedkeys_get_pkcatalog, cfrds_sql_importedkeys, pkTableCatalog)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_importedkeys_get_pkcatalog_len, cfrds_sql_importedkeys, pkTableCatalog)
 DEFINE_STRING_ACCESSOR(cfrds_sql_importedkeys_get_pkowner, cfrds_sql_importedkeys, pkTableOwner)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_importedkeys_get_pkowner_len, cfrds_sql_importedkeys, pkTableOwner)
 DEFINE_STRING_ACCESSOR(cfrds_sql_importedkeys_get_pktable, cfrds_sql_importedkeys, pkTableName)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_importedkeys_get_pktable_len, cfrds_sql_importedkeys, pkTableName)
 DEFINE_STRING_ACCESSOR(cfrds_sql_importedkeys_get_pkcolumn, cfrds_sql_importedkeys, pkColName)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_importedkeys_get_pkcolumn_len, cfrds_sql_importedkeys, pkColName)
 DEFINE_STRING_ACCESSOR(cfrds_sql_importedkeys_get_fkcatalog, cfrds_sql_importedkeys, fkTableCatalog)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_importedkeys_get_fkcatalog_len, cfrds_sql_importedkeys, fkTableCatalog)
 DEFINE_STRING_ACCESSOR(cfrds_sql_importedkeys_get_fkowner, cfrds_sql_importedkeys, fkTableOwner)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_importedkeys_get_fkowner_len, cfrds_sql_importedkeys, fkTableOwner)
 DEFINE_STRING_ACCESSOR(cfrds_sql_importedkeys_get_fktable, cfrds_sql_importedkeys, fkTableName)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_importedkeys_get_fktable_len, cfrds_sql_importedkeys, fkTableName)
 DEFINE_STRING_ACCESSOR(cfrds_sql_importedkeys_get_fkcolumn, cfrds_sql_importedkeys, fkColName)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_importedkeys_get_fkcolumn_len, cfrds_sql_importedkeys, fkColName)
 DEFINE_INT_ACCESSOR(cfrds_sql_importedkeys_get_key_sequence, cfrds_sql_importedkeys, keySequence, -1)
 DEFINE_INT_ACCESSOR(cfrds_sql_importedkeys_get_updaterule, cfrds_sql_importedkeys, updateRule, -1)
 DEFINE_INT_ACCESSOR(cfrds_sql_importedkeys_get_deleterule, cfrds_sql_importedkeys, deleteRule, -1)
@@ -304,8 +303,7 @@ void cfrds_sql_exportedkeys_free(cfrds_sql_exportedkeys *value)
     if (value == NULL)
         return;
 
-    cfrds_sql_keyitems_free((cfrds_sql_foreignkeysitem *)value->items, value->cnt);
-    free(value);
+    cfrds_arena_free(value->arena);
 }
 
 size_t cfrds_sql_exportedkeys_count(const cfrds_sql_exportedkeys *value)
@@ -317,13 +315,21 @@ size_t cfrds_sql_exportedkeys_count(const cfrds_sql_exportedkeys *value)
 }
 
 DEFINE_STRING_ACCESSOR(cfrds_sql_exportedkeys_get_pkcatalog, cfrds_sql_exportedkeys, pkTableCatalog)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_exportedkeys_get_pkcatalog_len, cfrds_sql_exportedkeys, pkTableCatalog)
 DEFINE_STRING_ACCESSOR(cfrds_sql_exportedkeys_get_pkowner, cfrds_sql_exportedkeys, pkTableOwner)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_exportedkeys_get_pkowner_len, cfrds_sql_exportedkeys, pkTableOwner)
 DEFINE_STRING_ACCESSOR(cfrds_sql_exportedkeys_get_pktable, cfrds_sql_exportedkeys, pkTableName)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_exportedkeys_get_pktable_len, cfrds_sql_exportedkeys, pkTableName)
 DEFINE_STRING_ACCESSOR(cfrds_sql_exportedkeys_get_pkcolumn, cfrds_sql_exportedkeys, pkColName)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_exportedkeys_get_pkcolumn_len, cfrds_sql_exportedkeys, pkColName)
 DEFINE_STRING_ACCESSOR(cfrds_sql_exportedkeys_get_fkcatalog, cfrds_sql_exportedkeys, fkTableCatalog)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_exportedkeys_get_fkcatalog_len, cfrds_sql_exportedkeys, fkTableCatalog)
 DEFINE_STRING_ACCESSOR(cfrds_sql_exportedkeys_get_fkowner, cfrds_sql_exportedkeys, fkTableOwner)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_exportedkeys_get_fkowner_len, cfrds_sql_exportedkeys, fkTableOwner)
 DEFINE_STRING_ACCESSOR(cfrds_sql_exportedkeys_get_fktable, cfrds_sql_exportedkeys, fkTableName)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_exportedkeys_get_fktable_len, cfrds_sql_exportedkeys, fkTableName)
 DEFINE_STRING_ACCESSOR(cfrds_sql_exportedkeys_get_fkcolumn, cfrds_sql_exportedkeys, fkColName)
+DEFINE_STRING_LEN_ACCESSOR(cfrds_sql_exportedkeys_get_fkcolumn_len, cfrds_sql_exportedkeys, fkColName)
 DEFINE_INT_ACCESSOR(cfrds_sql_exportedkeys_get_key_sequence, cfrds_sql_exportedkeys, keySequence, -1)
 DEFINE_INT_ACCESSOR(cfrds_sql_exportedkeys_get_updaterule, cfrds_sql_exportedkeys, updateRule, -1)
 DEFINE_INT_ACCESSOR(cfrds_sql_exportedkeys_get_deleterule, cfrds_sql_exportedkeys, deleteRule, -1)
@@ -333,12 +339,7 @@ void cfrds_sql_resultset_free(cfrds_sql_resultset *value)
     if (value == NULL)
         return;
 
-    for (size_t i = 0; i < (value->rows + 1) * value->columns; i++)
-    {
-        free(value->values[i]);
-    }
-
-    free(value);
+    cfrds_arena_free(value->arena);
 }
 
 size_t cfrds_sql_resultset_rows(const cfrds_sql_resultset *value)
@@ -365,7 +366,18 @@ const char *cfrds_sql_resultset_column_name(const cfrds_sql_resultset *value, si
     if (column >= value->columns)
         return NULL;
 
-    return value->values[column];
+    return value->values[column].str;
+}
+
+size_t cfrds_sql_resultset_column_name_len(const cfrds_sql_resultset *value, size_t column)
+{
+    if (value == NULL)
+        return 0;
+
+    if (column >= value->columns)
+        return 0;
+
+    return value->values[column].len;
 }
 
 const char *cfrds_sql_resultset_value(const cfrds_sql_resultset *value, size_t row, size_t column)
@@ -379,7 +391,98 @@ const char *cfrds_sql_resultset_value(const cfrds_sql_resultset *value, size_t r
     if (column >= value->columns)
         return NULL;
 
-    return value->values[(row + 1) * value->columns + column];
+    return value->values[(row + 1) * value->columns + column].str;
+}
+
+size_t cfrds_sql_resultset_value_len(const cfrds_sql_resultset *value, size_t row, size_t column)
+{
+    if (value == NULL)
+        return 0;
+
+    if (row >= value->rows)
+        return 0;
+
+    if (column >= value->columns)
+        return 0;
+
+    return value->values[(row + 1) * value->columns + column].len;
+}
+
+static const cfrds_sql_column *cfrds_sql_resultset_column(const cfrds_sql_resultset *value, size_t column, cfrds_sql_column_type type)
+{
+    if ((value == NULL)||(value->column_data == NULL))
+        return NULL;
+
+    if (column >= value->columns)
+        return NULL;
+
+    if ((type != CFRDS_SQL_COLUMN_NONE)&&(value->column_data[column].type != type))
+        return NULL;
+
+    return &value->column_data[column];
+}
+
+cfrds_sql_column_type cfrds_sql_resultset_column_type(const cfrds_sql_resultset *value, size_t column)
+{
+    const cfrds_sql_column *data = cfrds_sql_resultset_column(value, column, CFRDS_SQL_COLUMN_NONE);
+    if (data == NULL)
+        return CFRDS_SQL_COLUMN_NONE;
+
+    return data->type;
+}
+
+bool cfrds_sql_resultset_column_text(const cfrds_sql_resultset *value, size_t column, const size_t **offsets, const char **heap)
+{
+    const cfrds_sql_column *data = cfrds_sql_resultset_column(value, column, CFRDS_SQL_COLUMN_NONE);
+    if ((data == NULL)||(offsets == NULL)||(heap == NULL))
+        return false;
+
+    *offsets = data->offsets;
+    *heap = data->heap;
+
+    return true;
+}
+
+bool cfrds_sql_resultset_column_int64(const cfrds_sql_resultset *value, size_t column, const int64_t **values)
+{
+    const cfrds_sql_column *data = cfrds_sql_resultset_column(value, column, CFRDS_SQL_COLUMN_INT64);
+    if ((data == NULL)||(values == NULL))
+        return false;
+
+    *values = data->values;
+
+    return true;
+}
+
+bool cfrds_sql_resultset_column_double(const cfrds_sql_resultset *value, size_t column, const double **values)
+{
+    const cfrds_sql_column *data = cfrds_sql_resultset_column(value, column, CFRDS_SQL_COLUMN_DOUBLE);
+    if ((data == NULL)||(values == NULL))
+        return false;
+
+    *values = data->values;
+
+    return true;
+}
+
+bool cfrds_sql_resultset_column_bool(const cfrds_sql_resultset *value, size_t column, const bool **values)
+{
+    const cfrds_sql_column *data = cfrds_sql_resultset_column(value, column, CFRDS_SQL_COLUMN_BOOL);
+    if ((data == NULL)||(values == NULL))
+        return false;
+
+    *values = data->values;
+
+    return true;
+}
+
+const uint8_t *cfrds_sql_resultset_column_nulls(const cfrds_sql_resultset *value, size_t column)
+{
+    const cfrds_sql_column *data = cfrds_sql_resultset_column(value, column, CFRDS_SQL_COLUMN_NONE);
+    if (data == NULL)
+        return NULL;
+
+    return data->nulls;
 }
 
 void cfrds_sql_metadata_free(cfrds_sql_metadata *value)
@@ -387,14 +490,7 @@ void cfrds_sql_metadata_free(cfrds_sql_metadata *value)
     if (value == NULL)
         return;
 
-    for (size_t c = 0; c < value->cnt; c++)
-    {
-        free(value->items[c].name);
-        free(value->items[c].type);
-        free(value->items[c].jtype);
-    }
-
-    free(value);
+    cfrds_arena_free(value->arena);
 }
 
 size_t cfrds_sql_metadata_count(const cfrds_sql_metadata *value)
@@ -413,7 +509,18 @@ const char *cfrds_sql_metadata_get_name(const cfrds_sql_metadata *value, size_t
     if (column >= value->cnt)
         return NULL;
 
-    return value->items[column].name;
+    return value->items[column].name.str;
+}
+
+size_t cfrds_sql_metadata_get_name_len(const cfrds_sql_metadata *value, size_t column)
+{
+    if (value == NULL)
+        return 0;
+
+    if (column >= value->cnt)
+        return 0;
+
+    return value->items[column].name.len;
 }
 
 const char *cfrds_sql_metadata_get_type(const cfrds_sql_metadata *value, size_t column)
@@ -424,7 +531,18 @@ const char *cfrds_sql_metadata_get_type(const cfrds_sql_metadata *value, size_t
     if (column >= value->cnt)
         return NULL;
 
-    return value->items[column].type;
+    return value->items[column].type.str;
+}
+
+size_t cfrds_sql_metadata_get_type_len(const cfrds_sql_metadata *value, size_t column)
+{
+    if (value == NULL)
+        return 0;
+
+    if (column >= value->cnt)
+        return 0;
+
+    return value->items[column].type.len;
 }
 
 const char *cfrds_sql_metadata_get_jtype(const cfrds_sql_metadata *value, size_t column)
@@ -435,7 +553,18 @@ const char *cfrds_sql_metadata_get_jtype(const cfrds_sql_metadata *value, size_t
     if (column >= value->cnt)
         return NULL;
 
-    return value->items[column].jtype;
+    return value->items[column].jtype.str;
+}
+
+size_t cfrds_sql_metadata_get_jtype_len(const cfrds_sql_metadata *value, size_t column)
+{
+    if (value == NULL)
+        return 0;
+
+    if (column >= value->cnt)
+        return 0;
+
+    return value->items[column].jtype.len;
 }
 
 void cfrds_sql_supportedcommands_free(cfrds_sql_supportedcommands *value)
@@ -443,12 +572,7 @@ void cfrds_sql_supportedcommands_free(cfrds_sql_supportedcommands *value)
     if (value == NULL)
         return;
 
-    for (size_t c = 0; c < value->cnt; c++)
-    {
-        free(value->commands[c]);
-    }
-
-    free(value);
+    cfrds_arena_free(value->arena);
 }
 
 size_t cfrds_sql_supportedcommands_count(const cfrds_sql_supportedcommands *value)
@@ -467,7 +591,18 @@ const char *cfrds_sql_supportedcommands_get(const cfrds_sql_supportedcommands *v
     if (ndx >= value->cnt)
         return NULL;
 
-    return value->commands[ndx];
+    return value->commands[ndx].str;
+}
+
+size_t cfrds_sql_supportedcommands_get_len(const cfrds_sql_supportedcommands *value, size_t ndx)
+{
+    if (value == NULL)
+        return 0;
+
+    if (ndx >= value->cnt)
+        return 0;
+
+    return value->commands[ndx].len;
 }
 
 void cfrds_security_analyzer_result_free(cfrds_security_analyzer_result *buf)
@@ -824,7 +959,7 @@ cfrds_status cfrds_command_ide_default(cfrds_server *server, int version, int *n
     /* Protocol quirk: IDE_DEFAULT expects version argument formatted with a trailing comma (e.g. "N,") */
     snprintf(param, sizeof(param), "%d,", version);
 
-    ret = cfrds_send_command(server, &response, "IDE_DEFAULT", (const char *[]){ "", param, NULL});
+    ret = cfrds_send_idempotent_command(server, &response, "IDE_DEFAULT", (const char *[]){ "", param, NULL});
     if (ret == CFRDS_STATUS_OK)
     {
         cfrds_str_defer(_num1);
@@ -839,49 +974,49 @@ cfrds_status cfrds_command_ide_default(cfrds_server *server, int version, int *n
         int64_t count = 0;
         if (!cfrds_buffer_parse_number(&response_data, &response_size, &count))
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
         if (count != 5)
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
         if (!cfrds_buffer_parse_string(&response_data, &response_size, &_num1))
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
         if (!cfrds_buffer_parse_string(&response_data, &response_size, &_server_version))
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
         if (!cfrds_buffer_parse_string(&response_data, &response_size, &_client_version))
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
         if (!cfrds_buffer_parse_string(&response_data, &response_size, &_num2))
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
         if (!cfrds_buffer_parse_string(&response_data, &response_size, &_num3))
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
         if (response_size != 0)
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
@@ -919,25 +1054,25 @@ cfrds_status cfrds_command_adminapi_debugging_getlogproperty(cfrds_server *serve
         int64_t count = 0;
         if (!cfrds_buffer_parse_number(&response_data, &response_size, &count))
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
         if (count != 1)
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
         if (!cfrds_buffer_parse_string(&response_data, &response_size, &xml))
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
         if (response_size != 0)
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
@@ -982,32 +1117,32 @@ cfrds_status cfrds_command_adminapi_extensions_getcustomtagpaths(cfrds_server *s
         int64_t count = 0;
         if (!cfrds_buffer_parse_number(&response_data, &response_size, &count))
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
         if (count != 1)
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
         if (!cfrds_buffer_parse_string(&response_data, &response_size, &xml))
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
         if (response_size != 0)
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
         *result = wddx_from_xml(xml);
         if (!*result)
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
     }
@@ -1090,19 +1225,19 @@ cfrds_status cfrds_command_adminapi_extensions_setmapping(cfrds_server *server,
         int64_t count = 0;
         if (!cfrds_buffer_parse_number(&response_data, &response_size, &count))
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
         if (count != 1)
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
         if (!cfrds_buffer_parse_string(&response_data, &response_size, &xml))
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
@@ -1139,19 +1274,19 @@ cfrds_status cfrds_command_adminapi_extensions_deletemapping(cfrds_server *serve
         int64_t count = 0;
         if (!cfrds_buffer_parse_number(&response_data, &response_size, &count))
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
         if (count != 1)
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
         if (!cfrds_buffer_parse_string(&response_data, &response_size, &xml))
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
@@ -1187,25 +1322,25 @@ cfrds_status cfrds_command_adminapi_extensions_getmappings(cfrds_server *server,
         int64_t count = 0;
         if (!cfrds_buffer_parse_number(&response_data, &response_size, &count))
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
         if (count != 1)
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
         if (!cfrds_buffer_parse_string(&response_data, &response_size, &xml))
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
         if (response_size != 0)
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
@@ -1295,7 +1430,7 @@ cfrds_status cfrds_command_graphing(cfrds_server *server, cfrds_buffer **out_buf
     const char **list = malloc((total_params + 1) * sizeof(const char *));
     if (list == NULL)
     {
-        server->error_code = -1;
+        cfrds_server_error_ctx(server)->error_code = -1;
         return CFRDS_STATUS_RESPONSE_ERROR;
     }
 
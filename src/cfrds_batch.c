@@ -0,0 +1,642 @@
+#include <cfrds.h>
+#include <internal/explicit_bzero.h>
+#include <internal/cfrds_int.h>
+#include <internal/cfrds_buffer.h>
+#include <internal/cfrds_http.h>
+#include <../tracing/tracing.h>
+
+#ifdef _WIN32
+#include <WinSock2.h>
+#else
+#include <sys/socket.h>
+#include <poll.h>
+#endif
+
+#include <string.h>
+#include <stdlib.h>
+#include <limits.h>
+
+#define CFRDS_BATCH_RECV_SIZE (64 * 1024)
+#define CFRDS_BATCH_MAX_ATTEMPTS 3
+
+#ifdef _WIN32
+typedef WSAPOLLFD cfrds_batch_pollfd;
+#else
+typedef struct pollfd cfrds_batch_pollfd;
+#endif
+
+typedef struct {
+    cfrds_buffer *request;        ///< Request headers followed by the RDS body.
+    cfrds_sql_parser_fn parse;
+    cfrds_loop_done_fn done;
+    void *ctx;
+    unsigned int attempts;        ///< Connections the request was sent on.
+    bool idempotent;              ///< May be sent again when its connection closes before answering it.
+} cfrds_batch_request;
+
+struct cfrds_batch {
+    cfrds_server *server;
+    size_t max_connections;
+    size_t cnt;
+    size_t allocated;
+    cfrds_batch_request *requests;
+};
+
+/* One connection carrying a pipeline: requests are written back to back, responses come back in the same order. */
+typedef struct {
+    cfrds_socket sockfd;
+    size_t *queue;                ///< Indexes of the requests pipelined on the connection, in send order.
+    size_t cnt;
+    size_t sent;                  ///< Requests written completely.
+    size_t offset;                ///< Bytes of `queue[sent]` written.
+    size_t answered;              ///< Responses read completely.
+    size_t received;              ///< Bytes of the current response read.
+    cfrds_http_parser parser;
+    cfrds_buffer *response;
+    uint64_t first_byte_deadline; ///< Set once all requests are written.
+    bool closed;
+} cfrds_batch_conn;
+
+/* Execution state of one `cfrds_batch_execute` call. */
+typedef struct {
+    cfrds_batch *batch;
+    size_t *retry;                ///< Requests to send again on a new connection.
+    size_t retry_cnt;
+    cfrds_status status;          ///< First failure reported to a callback.
+    uint64_t deadline;            ///< Total deadline of the current round.
+} cfrds_batch_run;
+
+static cfrds_status batch_append_body(void *ctx, const char *data, size_t size)
+{
+    if (!cfrds_buffer_append_bytes((cfrds_buffer *)ctx, data, size))
+        return CFRDS_STATUS_MEMORY_ERROR;
+
+    return CFRDS_STATUS_OK;
+}
+
+void cfrds_batch_cleanup(cfrds_batch **batch)
+{
+    if (batch && *batch) {
+        cfrds_batch_free(*batch);
+        *batch = NULL;
+    }
+}
+
+static void batch_clear(cfrds_batch *batch)
+{
+    for (size_t c = 0; c < batch->cnt; c++)
+        cfrds_buffer_free(batch->requests[c].request);
+
+    batch->cnt = 0;
+}
+
+cfrds_status cfrds_batch_begin(cfrds_server *server, size_t max_connections, cfrds_batch **batch)
+{
+    if (batch == NULL)
+        return CFRDS_STATUS_PARAM_IS_NULL;
+
+    if (server == NULL)
+        return CFRDS_STATUS_SERVER_IS_NULL;
+
+    cfrds_server_clear_error(server);
+
+    if (!server->keepalive)
+    {
+        cfrds_server_set_error(server, CFRDS_STATUS_INVALID_INPUT_PARAMETER, "keep-alive is disabled, requests can not be pipelined");
+        return CFRDS_STATUS_INVALID_INPUT_PARAMETER;
+    }
+
+    cfrds_batch *ret = malloc(sizeof(cfrds_batch));
+    if (ret == NULL)
+        return CFRDS_STATUS_MEMORY_ERROR;
+
+    explicit_bzero(ret, sizeof(cfrds_batch));
+    ret->server = server;
+    ret->max_connections = max_connections ? max_connections : server->keepalive_max_idle;
+    if (ret->max_connections == 0)
+        ret->max_connections = 1;
+
+    *batch = ret;
+
+    return CFRDS_STATUS_OK;
+}
+
+void cfrds_batch_free(cfrds_batch *batch)
+{
+    if (batch == NULL)
+        return;
+
+    batch_clear(batch);
+    free(batch->requests);
+    free(batch);
+}
+
+size_t cfrds_batch_count(const cfrds_batch *batch)
+{
+    if (batch == NULL)
+        return 0;
+
+    return batch->cnt;
+}
+
+cfrds_status cfrds_batch_add(cfrds_batch *batch, const char *command, const char *list[], bool idempotent, cfrds_sql_parser_fn parser, cfrds_loop_done_fn done, void *ctx)
+{
+    cfrds_buffer_defer(payload);
+    cfrds_buffer_defer(request);
+    cfrds_status status;
+
+    if ((batch == NULL)||(command == NULL)||(list == NULL)||(done == NULL))
+        return CFRDS_STATUS_PARAM_IS_NULL;
+
+    cfrds_server *server = batch->server;
+    cfrds_server_clear_error(server);
+
+    if (batch->cnt == batch->allocated)
+    {
+        size_t allocated = batch->allocated ? batch->allocated * 2 : 16;
+        cfrds_batch_request *requests = realloc(batch->requests, sizeof(cfrds_batch_request) * allocated);
+        if (requests == NULL)
+            return CFRDS_STATUS_MEMORY_ERROR;
+
+        batch->requests = requests;
+        batch->allocated = allocated;
+    }
+
+    status = cfrds_build_command_payload(server, list, &payload);
+    if (status != CFRDS_STATUS_OK)
+        return status;
+
+    if (!cfrds_buffer_create(&request)) {
+        cfrds_server_set_error(server, CFRDS_STATUS_MEMORY_ERROR, "cfrds_buffer_create failed for request");
+        return CFRDS_STATUS_MEMORY_ERROR;
+    }
+
+    /* batched requests are small, headers and body go out as one piece */
+    status = cfrds_http_build_header(server, command, cfrds_buffer_data_size(payload), request);
+    if (status != CFRDS_STATUS_OK)
+        return status;
+
+    if (!cfrds_buffer_append_buffer(request, payload)) {
+        cfrds_server_set_error(server, CFRDS_STATUS_MEMORY_ERROR, "buffer append failed building request");
+        return CFRDS_STATUS_MEMORY_ERROR;
+    }
+
+    cfrds_batch_request *req = &batch->requests[batch->cnt++];
+    req->request = request; request = NULL;
+    req->parse = parser;
+    req->done = done;
+    req->ctx = ctx;
+    req->attempts = 0;
+    req->idempotent = idempotent;
+
+    return CFRDS_STATUS_OK;
+}
+
+/* Reports a received response to its callback, with the server error state describing it. */
+static void batch_complete(cfrds_batch_run *run, size_t index, cfrds_batch_conn *conn)
+{
+    cfrds_server *server = run->batch->server;
+    cfrds_batch_request *req = &run->batch->requests[index];
+    cfrds_status status = CFRDS_STATUS_OK;
+    void *result = NULL;
+
+    cfrds_server_clear_error(server);
+
+    if (conn->parser.status_code != 200)
+    {
+        status = CFRDS_STATUS_RESPONSE_ERROR;
+        cfrds_server_set_error(server, status, "Invalid server response...");
+    }
+
+    if (status == CFRDS_STATUS_OK)
+        status = cfrds_http_parse_rds_status(server, conn->response);
+
+    if ((status == CFRDS_STATUS_OK)&&(req->parse))
+    {
+        result = req->parse(conn->response);
+        if (result == NULL)
+        {
+            cfrds_server_error_ctx(server)->error_code = -1;
+            status = CFRDS_STATUS_RESPONSE_ERROR;
+        }
+    }
+
+    if ((status != CFRDS_STATUS_OK)&&(run->status == CFRDS_STATUS_OK))
+        run->status = status;
+
+    req->done(server, status, result, req->ctx);
+}
+
+static void batch_fail(cfrds_batch_run *run, size_t index, cfrds_status status, const char *error)
+{
+    cfrds_server *server = run->batch->server;
+    cfrds_batch_request *req = &run->batch->requests[index];
+
+    cfrds_server_clear_error(server);
+    cfrds_server_set_error(server, status, error);
+
+    if (run->status == CFRDS_STATUS_OK)
+        run->status = status;
+
+    req->done(server, status, NULL, req->ctx);
+}
+
+/*
+ * Ends a connection that can not carry more responses. Requests the server has not started
+ * answering go to the next round (HTTP servers answer pipelined requests one by one, so they
+ * were not processed), up to CFRDS_BATCH_MAX_ATTEMPTS connections each. Non-idempotent requests
+ * fail instead: a server that closes the connection may still have run them.
+ */
+static void batch_conn_abort(cfrds_batch_run *run, cfrds_batch_conn *conn, cfrds_status status, const char *error)
+{
+    conn->closed = true;
+    cfrds_sock_cleanup(&conn->sockfd);
+
+    if ((conn->answered < conn->cnt)&&(conn->received > 0))
+    {
+        /* the current response was cut off: its request may have run, it is not sent again */
+        batch_fail(run, conn->queue[conn->answered], status, error);
+        conn->answered++;
+    }
+
+    for (; conn->answered < conn->cnt; conn->answered++)
+    {
+        size_t index = conn->queue[conn->answered];
+
+        cfrds_batch_request *req = &run->batch->requests[index];
+
+        if ((req->idempotent)&&(req->attempts < CFRDS_BATCH_MAX_ATTEMPTS))
+            run->retry[run->retry_cnt++] = index;
+        else
+            batch_fail(run, index, status, error);
+    }
+}
+
+static bool batch_conn_reset_parser(cfrds_server *server, cfrds_batch_conn *conn)
+{
+    cfrds_http_parser_cleanup(&conn->parser);
+    cfrds_buffer_slice(conn->response, 0, 0);
+    conn->received = 0;
+
+    if (!cfrds_http_parser_init(&conn->parser, batch_append_body, conn->response))
+        return false;
+
+    conn->parser.max_body_size = server->max_response_size;
+
+    return true;
+}
+
+static void batch_conn_send(cfrds_batch_run *run, cfrds_batch_conn *conn)
+{
+    while (conn->sent < conn->cnt)
+    {
+        cfrds_http_segment segs[CFRDS_HTTP_MAX_SEGMENTS];
+        size_t segs_cnt = 0;
+
+        for (size_t c = conn->sent; (c < conn->cnt)&&(segs_cnt < CFRDS_HTTP_MAX_SEGMENTS); c++)
+        {
+            cfrds_buffer *request = run->batch->requests[conn->queue[c]].request;
+
+            segs[segs_cnt].data = cfrds_buffer_data(request);
+            segs[segs_cnt].size = cfrds_buffer_data_size(request);
+            segs_cnt++;
+        }
+
+        trace_net_start("send");
+        ssize_t written = cfrds_http_send_segments(conn->sockfd, segs, segs_cnt, conn->offset);
+        trace_net_end();
+        if (written < 0)
+        {
+            int err = GET_SOCKET_ERRNO();
+            if (IS_SOCKET_EWOULDBLOCK(err)||IS_SOCKET_EINTR(err))
+                return;
+
+            cfrds_server_error_ctx(run->batch->server)->_errno = err;
+            batch_conn_abort(run, conn, CFRDS_STATUS_WRITING_TO_SOCKET_FAILED, "failed to write to socket...");
+            return;
+        }
+
+        size_t left = conn->offset + (size_t)written;
+        conn->offset = 0;
+
+        while ((conn->sent < conn->cnt)&&(left > 0))
+        {
+            size_t size = cfrds_buffer_data_size(run->batch->requests[conn->queue[conn->sent]].request);
+            if (left < size)
+            {
+                conn->offset = left;
+                break;
+            }
+
+            left -= size;
+            conn->sent++;
+        }
+    }
+
+    conn->first_byte_deadline = cfrds_http_deadline(run->batch->server->first_byte_timeout_ms, run->deadline);
+}
+
+static void batch_conn_receive(cfrds_batch_run *run, cfrds_batch_conn *conn)
+{
+    char recv_buf[CFRDS_BATCH_RECV_SIZE];
+    cfrds_status status;
+
+    trace_net_start("recv");
+    ssize_t nread = recv(conn->sockfd, recv_buf, sizeof(recv_buf), 0);
+    trace_net_end();
+    if (nread < 0)
+    {
+        int err = GET_SOCKET_ERRNO();
+        if (IS_SOCKET_EWOULDBLOCK(err)||IS_SOCKET_EINTR(err))
+            return;
+
+        cfrds_server_error_ctx(run->batch->server)->_errno = err;
+        batch_conn_abort(run, conn, CFRDS_STATUS_READING_FROM_SOCKET_FAILED, "failed to read from socket...");
+        return;
+    }
+
+    if (nread == 0)
+    {
+        /* a body framed by the connection close ends here */
+        if ((conn->received > 0)&&(cfrds_http_parser_finish(&conn->parser) == CFRDS_STATUS_OK))
+        {
+            batch_complete(run, conn->queue[conn->answered++], conn);
+            conn->received = 0;
+        }
+
+        batch_conn_abort(run, conn, CFRDS_STATUS_READING_FROM_SOCKET_FAILED, "connection closed before end of response");
+        return;
+    }
+
+    size_t pos = 0;
+
+    while ((pos < (size_t)nread)&&(conn->answered < conn->cnt))
+    {
+        size_t consumed = 0;
+
+        status = cfrds_http_parser_feed(&conn->parser, recv_buf + pos, (size_t)nread - pos, &consumed);
+        if (status != CFRDS_STATUS_OK)
+        {
+            conn->received += consumed + 1;
+            batch_conn_abort(run, conn, status, conn->parser.error ? conn->parser.error : "invalid server response");
+            return;
+        }
+
+        pos += consumed;
+        conn->received += consumed;
+
+        if (conn->parser.state != CFRDS_HTTP_STATE_DONE)
+            continue;
+
+        bool keep_alive = conn->parser.keep_alive;
+
+        batch_complete(run, conn->queue[conn->answered++], conn);
+
+        if (!batch_conn_reset_parser(run->batch->server, conn))
+        {
+            batch_conn_abort(run, conn, CFRDS_STATUS_MEMORY_ERROR, "cfrds_buffer_create failed for response header");
+            return;
+        }
+
+        if (!keep_alive)
+        {
+            /* the server closes after this response, the rest is retried */
+            batch_conn_abort(run, conn, CFRDS_STATUS_READING_FROM_SOCKET_FAILED, "server closed the connection");
+            return;
+        }
+    }
+
+    if ((pos < (size_t)nread)&&(!conn->closed))
+    {
+        /* bytes past the last expected response break the framing */
+        conn->closed = true;
+        cfrds_sock_cleanup(&conn->sockfd);
+    }
+}
+
+static cfrds_status batch_conn_open(cfrds_server *server, uint64_t deadline, cfrds_batch_conn *conn)
+{
+    if (!cfrds_http_pool_acquire(server, &conn->sockfd))
+    {
+        cfrds_status status = cfrds_http_connect(server, cfrds_http_deadline(server->connect_timeout_ms, deadline), &conn->sockfd);
+        if (status != CFRDS_STATUS_OK)
+            return status;
+    }
+
+    if ((!cfrds_buffer_create(&conn->response))||(!cfrds_http_parser_init(&conn->parser, batch_append_body, conn->response)))
+    {
+        cfrds_server_set_error(server, CFRDS_STATUS_MEMORY_ERROR, "cfrds_buffer_create failed for response");
+        return CFRDS_STATUS_MEMORY_ERROR;
+    }
+    conn->parser.max_body_size = server->max_response_size;
+    cfrds_buffer_set_spill_threshold(conn->response, server->spill_threshold);
+    cfrds_buffer_set_result_views(conn->response, server->result_views);
+
+    return CFRDS_STATUS_OK;
+}
+
+/* Sends the requests in `pending` over up to `max_connections` pipelines and reads all responses. */
+static cfrds_status batch_round(cfrds_batch_run *run, const size_t *pending, size_t pending_cnt)
+{
+    cfrds_batch *batch = run->batch;
+    cfrds_server *server = batch->server;
+    size_t conns_cnt = (pending_cnt < batch->max_connections) ? pending_cnt : batch->max_connections;
+
+    cfrds_batch_conn *conns = calloc(conns_cnt, sizeof(cfrds_batch_conn));
+    cfrds_batch_pollfd *pfds = calloc(conns_cnt, sizeof(cfrds_batch_pollfd));
+    cfrds_batch_conn **pfd_conns = calloc(conns_cnt, sizeof(cfrds_batch_conn *));
+    size_t *queues = malloc(sizeof(size_t) * pending_cnt);
+
+    if ((conns == NULL)||(pfds == NULL)||(pfd_conns == NULL)||(queues == NULL))
+    {
+        free(conns); free(pfds); free(pfd_conns); free(queues);
+        return CFRDS_STATUS_MEMORY_ERROR;
+    }
+
+    /* round robin, so the callbacks come roughly in the order the requests were added */
+    size_t used = 0;
+    for (size_t c = 0; c < conns_cnt; c++)
+    {
+        cfrds_batch_conn *conn = &conns[c];
+
+        conn->sockfd = CFRDS_INVALID_SOCKET;
+        conn->queue = queues + used;
+        for (size_t r = c; r < pending_cnt; r += conns_cnt)
+        {
+            conn->queue[conn->cnt++] = pending[r];
+            batch->requests[pending[r]].attempts++;
+        }
+        used += conn->cnt;
+    }
+
+    run->deadline = cfrds_http_deadline(server->total_timeout_ms, UINT64_MAX);
+
+    for (size_t c = 0; c < conns_cnt; c++)
+    {
+        cfrds_batch_conn *conn = &conns[c];
+
+        cfrds_status status = batch_conn_open(server, run->deadline, conn);
+        if (status != CFRDS_STATUS_OK)
+        {
+            const char *error = cfrds_server_get_error(server);
+            char *message = strdup(error ? error : "failed to establish connection to the server...");
+
+            conn->closed = true;
+            cfrds_sock_cleanup(&conn->sockfd);
+            for (; conn->answered < conn->cnt; conn->answered++)
+                batch_fail(run, conn->queue[conn->answered], status, message ? message : "failed to establish connection to the server...");
+            free(message);
+        }
+    }
+
+    while (1)
+    {
+        size_t pfds_cnt = 0;
+
+        for (size_t c = 0; c < conns_cnt; c++)
+        {
+            cfrds_batch_conn *conn = &conns[c];
+
+            if ((conn->closed)||(conn->answered == conn->cnt))
+                continue;
+
+            pfds[pfds_cnt].fd = conn->sockfd;
+            pfds[pfds_cnt].events = (conn->sent < conn->cnt) ? (POLLIN | POLLOUT) : POLLIN;
+            pfds[pfds_cnt].revents = 0;
+            pfd_conns[pfds_cnt] = conn;
+            pfds_cnt++;
+        }
+
+        if (pfds_cnt == 0)
+            break;
+
+        uint64_t now = cfrds_http_now_ms();
+        uint64_t wake = UINT64_MAX;
+        bool expired = false;
+
+        for (size_t c = 0; c < pfds_cnt; c++)
+        {
+            cfrds_batch_conn *conn = pfd_conns[c];
+            bool first_byte = (conn->sent == conn->cnt)&&(conn->answered == 0)&&(conn->received == 0);
+            uint64_t deadline = first_byte ? conn->first_byte_deadline : run->deadline;
+
+            if (now >= deadline)
+            {
+                /* timed out requests are not retried */
+                for (size_t r = conn->answered; r < conn->cnt; r++)
+                    batch->requests[conn->queue[r]].attempts = CFRDS_BATCH_MAX_ATTEMPTS;
+                cfrds_server_error_ctx(server)->_errno = SOCKET_ETIMEDOUT;
+                batch_conn_abort(run, conn, CFRDS_STATUS_READING_FROM_SOCKET_FAILED, ((first_byte)&&(now < run->deadline)) ?
+                                 "response read timed out (first byte deadline exceeded)" :
+                                 "response read timed out (overall deadline exceeded)");
+                expired = true;
+            }
+            else if (deadline < wake)
+            {
+                wake = deadline;
+            }
+        }
+
+        if (expired)
+            continue;
+
+        int timeout = (wake - now > INT_MAX) ? INT_MAX : (int)(wake - now);
+
+#ifdef _WIN32
+        int res = WSAPoll(pfds, (ULONG)pfds_cnt, (INT)timeout);
+#else
+        int res = poll(pfds, (nfds_t)pfds_cnt, timeout);
+#endif
+        if (res < 0)
+        {
+            int err = GET_SOCKET_ERRNO();
+            if (IS_SOCKET_EINTR(err))
+                continue;
+
+            cfrds_server_error_ctx(server)->_errno = err;
+            for (size_t c = 0; c < pfds_cnt; c++)
+                batch_conn_abort(run, pfd_conns[c], CFRDS_STATUS_COMMAND_FAILED, "failed to wait for socket events");
+            break;
+        }
+
+        for (size_t c = 0; c < pfds_cnt; c++)
+        {
+            cfrds_batch_conn *conn = pfd_conns[c];
+
+            if ((!conn->closed)&&(pfds[c].revents & POLLOUT))
+                batch_conn_send(run, conn);
+
+            if ((!conn->closed)&&(pfds[c].revents & (POLLIN | POLLERR | POLLHUP)))
+                batch_conn_receive(run, conn);
+        }
+    }
+
+    for (size_t c = 0; c < conns_cnt; c++)
+    {
+        cfrds_batch_conn *conn = &conns[c];
+
+        if ((!conn->closed)&&(conn->received == 0))
+            cfrds_http_pool_release(server, &conn->sockfd);
+
+        cfrds_sock_cleanup(&conn->sockfd);
+        cfrds_http_parser_cleanup(&conn->parser);
+        cfrds_buffer_free(conn->response);
+    }
+
+    free(conns);
+    free(pfds);
+    free(pfd_conns);
+    free(queues);
+
+    return CFRDS_STATUS_OK;
+}
+
+cfrds_status cfrds_batch_execute(cfrds_batch *batch)
+{
+    cfrds_batch_run run;
+    size_t *pending = NULL;
+    size_t pending_cnt = 0;
+
+    if (batch == NULL)
+        return CFRDS_STATUS_PARAM_IS_NULL;
+
+    if (batch->cnt == 0)
+        return CFRDS_STATUS_OK;
+
+    explicit_bzero(&run, sizeof(run));
+    run.batch = batch;
+    run.status = CFRDS_STATUS_OK;
+
+    pending = malloc(sizeof(size_t) * batch->cnt);
+    run.retry = malloc(sizeof(size_t) * batch->cnt);
+    if ((pending == NULL)||(run.retry == NULL))
+    {
+        free(pending);
+        free(run.retry);
+        return CFRDS_STATUS_MEMORY_ERROR;
+    }
+
+    for (size_t c = 0; c < batch->cnt; c++)
+        pending[pending_cnt++] = c;
+
+    while (pending_cnt > 0)
+    {
+        run.retry_cnt = 0;
+
+        if (batch_round(&run, pending, pending_cnt) != CFRDS_STATUS_OK)
+        {
+            for (size_t c = 0; c < pending_cnt; c++)
+                batch_fail(&run, pending[c], CFRDS_STATUS_MEMORY_ERROR, "failed to allocate the batch connections");
+            break;
+        }
+
+        memcpy(pending, run.retry, sizeof(size_t) * run.retry_cnt);
+        pending_cnt = run.retry_cnt;
+    }
+
+    free(pending);
+    free(run.retry);
+    batch_clear(batch);
+
+    return run.status;
+}
@@ -15,13 +15,31 @@
 #include <windows.h>
 #else
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #endif
 
 #include <stdio.h>
 #include <errno.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #define CFRDS_MAX_PARSER_ITEMS 10000
 
+/* Paths into the WDDX packets, compiled on first use by wddx_path_static() */
+static wddx_path *path_status;
+static wddx_path *path_debug_server_port;
+
+#ifdef _WIN32
+typedef HANDLE cfrds_spill_file;
+#define CFRDS_SPILL_NONE INVALID_HANDLE_VALUE
+#else
+typedef int cfrds_spill_file;
+#define CFRDS_SPILL_NONE (-1)
+#endif
+
 static bool cfrds_buffer_append_char(cfrds_buffer *buffer, const char ch);
 
 
@@ -29,8 +47,26 @@ struct cfrds_buffer {
     size_t allocated;
     size_t size;
     uint8_t *data;
+    size_t spill_threshold;
+    cfrds_spill_file spill;
+    bool result_views;
 };
 
+typedef struct cfrds_arena_chunk {
+    struct cfrds_arena_chunk *next;
+    size_t size;
+    size_t used;
+    max_align_t data[];
+} cfrds_arena_chunk;
+
+/* Lives at the start of its first chunk, `chunk` is the newest one. */
+struct cfrds_arena {
+    cfrds_arena_chunk *chunk;
+    cfrds_buffer response;  ///< Storage of a response the result points into, if any.
+};
+
+#define CFRDS_ARENA_ALIGN(size) (((size) + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1))
+
 
 void cfrds_str_cleanup(cfrds_str *str) {
     if (*str) {
@@ -68,10 +104,169 @@ CFRDS_DEFINE_CLEANUP(cfrds_sql_metadata, cfrds_sql_metadata_free)
 CFRDS_DEFINE_CLEANUP(cfrds_sql_supportedcommands, cfrds_sql_supportedcommands_free)
 CFRDS_DEFINE_CLEANUP(cfrds_debugger_event, cfrds_debugger_event_free)
 
-static bool cfrds_buffer_realloc_if_needed(cfrds_buffer *buffer, size_t len)
+#ifdef _WIN32
+static cfrds_spill_file cfrds_buffer_spill_open(void)
+{
+    char dir[MAX_PATH + 1];
+    char path[MAX_PATH + 1];
+
+    DWORD len = GetTempPathA(sizeof(dir), dir);
+    if ((len == 0)||(len > sizeof(dir)))
+        return CFRDS_SPILL_NONE;
+
+    if (GetTempFileNameA(dir, "rds", 0, path) == 0)
+        return CFRDS_SPILL_NONE;
+
+    /* removed by the system when the handle is closed */
+    return CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+                       FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, NULL);
+}
+
+static void *cfrds_buffer_spill_map(cfrds_spill_file file, void *old, size_t oldsize, size_t newsize)
+{
+    uint64_t size = (uint64_t)newsize + 1;
+    (void)oldsize;
+
+    /* a mapping of the new size extends the file, the view keeps the mapping alive */
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE, (DWORD)(size >> 32), (DWORD)size, NULL);
+    if (mapping == NULL)
+        return NULL;
+
+    void *view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, (SIZE_T)size);
+    CloseHandle(mapping);
+    if (view == NULL)
+        return NULL;
+
+    if (old)
+        UnmapViewOfFile(old);
+
+    return view;
+}
+
+static void cfrds_buffer_spill_close(cfrds_spill_file file, void *view, size_t size)
+{
+    (void)size;
+
+    UnmapViewOfFile(view);
+    CloseHandle(file);
+}
+#else
+static cfrds_spill_file cfrds_buffer_spill_open(void)
+{
+    char path[4096];
+    const char *dir = getenv("TMPDIR");
+
+    if ((dir == NULL)||(dir[0] == '\0'))
+        dir = "/tmp";
+
+    int n = snprintf(path, sizeof(path), "%s/cfrds-XXXXXX", dir);
+    if ((n < 0)||((size_t)n >= sizeof(path)))
+        return CFRDS_SPILL_NONE;
+
+    int fd = mkstemp(path);
+    if (fd == -1)
+        return CFRDS_SPILL_NONE;
+
+    /* nothing but this descriptor refers to the file */
+    unlink(path);
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+    return fd;
+}
+
+static void *cfrds_buffer_spill_map(cfrds_spill_file fd, void *old, size_t oldsize, size_t newsize)
+{
+    void *map = MAP_FAILED;
+
+    /* the file grows with zeroes, which keeps the null sentinel */
+    if (ftruncate(fd, (off_t)newsize + 1) != 0)
+        return NULL;
+
+#ifdef MREMAP_MAYMOVE
+    if (old)
+    {
+        map = mremap(old, oldsize + 1, newsize + 1, MREMAP_MAYMOVE);
+        return (map == MAP_FAILED) ? NULL : map;
+    }
+#endif
+
+    map = mmap(NULL, newsize + 1, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED)
+        return NULL;
+
+    /* both views share the file pages, nothing to copy */
+    if (old)
+        munmap(old, oldsize + 1);
+
+    return map;
+}
+
+static void cfrds_buffer_spill_close(cfrds_spill_file fd, void *map, size_t size)
+{
+    munmap(map, size + 1);
+    close(fd);
+}
+#endif
+
+/* Moves the data to `newsize` bytes of storage (plus the null sentinel), spilling it to a mapped temporary file past the threshold. */
+static bool cfrds_buffer_resize(cfrds_buffer *buffer, size_t newsize)
 {
-    void *tmp = NULL;
+    bool spilling = (buffer->spill == CFRDS_SPILL_NONE)&&(buffer->spill_threshold > 0)&&(newsize > buffer->spill_threshold);
 
+    if ((buffer->spill == CFRDS_SPILL_NONE)&&(!spilling))
+    {
+        /* +1: always keep a null sentinel byte past the data */
+        void *tmp = realloc(buffer->data, newsize + 1);
+        if (tmp == NULL)
+            return false;
+
+        size_t oldsize = buffer->allocated;
+        buffer->data = tmp;
+        explicit_bzero(buffer->data + oldsize, newsize + 1 - oldsize);
+        buffer->allocated = newsize;
+
+        return true;
+    }
+
+    if (spilling)
+    {
+        buffer->spill = cfrds_buffer_spill_open();
+        if (buffer->spill == CFRDS_SPILL_NONE)
+            return false;
+    }
+
+    void *map = cfrds_buffer_spill_map(buffer->spill, spilling ? NULL : buffer->data, buffer->allocated, newsize);
+    if (map == NULL)
+    {
+        if (spilling)
+        {
+#ifdef _WIN32
+            CloseHandle(buffer->spill);
+#else
+            close(buffer->spill);
+#endif
+            buffer->spill = CFRDS_SPILL_NONE;
+        }
+
+        return false;
+    }
+
+    if (spilling)
+    {
+        if (buffer->size > 0)
+            memcpy(map, buffer->data, buffer->size);
+
+        free(buffer->data);
+    }
+
+    buffer->data = map;
+    buffer->allocated = newsize;
+
+    return true;
+}
+
+static bool cfrds_buffer_realloc_if_needed(cfrds_buffer *buffer, size_t len)
+{
     if (buffer == NULL)
         return false;
 
@@ -90,15 +285,8 @@ static bool cfrds_buffer_realloc_if_needed(cfrds_buffer *buffer, size_t len)
         if (newsize < required || newsize == SIZE_MAX)
             return false;
 
-        /* +1: always keep a null sentinel byte past the data */
-        tmp = realloc(buffer->data, newsize + 1);
-        if (tmp == NULL)
+        if (!cfrds_buffer_resize(buffer, newsize))
             return false;
-
-        size_t oldsize = buffer->allocated;
-        buffer->data = tmp;
-        explicit_bzero(buffer->data + oldsize, newsize + 1 - oldsize);
-        buffer->allocated = newsize;
     }
 
     return true;
@@ -118,6 +306,9 @@ bool cfrds_buffer_create(cfrds_buffer **buffer)
     tmp->allocated = 0;
     tmp->size = 0;
     tmp->data = NULL;
+    tmp->spill_threshold = 0;
+    tmp->spill = CFRDS_SPILL_NONE;
+    tmp->result_views = false;
 
     *buffer = tmp;
 
@@ -186,6 +377,154 @@ bool cfrds_buffer_append_escaped(cfrds_buffer *buffer, const char *str)
     return true;
 }
 
+/* Replacement for a byte libxml2 escapes when it writes text or, with `attribute`, an attribute value. */
+static const char *cfrds_xml_entity(char ch, bool attribute)
+{
+    switch (ch)
+    {
+    case '<':
+        return "&lt;";
+    case '>':
+        return "&gt;";
+    case '&':
+        return "&amp;";
+    case '\r':
+        return "&#13;";
+    case '"':
+        return attribute ? "&quot;" : NULL;
+    case '\n':
+        return attribute ? "&#10;" : NULL;
+    case '\t':
+        return attribute ? "&#9;" : NULL;
+    default:
+        return NULL;
+    }
+}
+
+/* Number of bytes at the start of `str` that are copied as they are. */
+static size_t cfrds_xml_plain_span(const char *str, size_t len, bool attribute)
+{
+    size_t pos = 0;
+
+#if defined(__SSE2__)
+    const __m128i lt = _mm_set1_epi8('<');
+    const __m128i gt = _mm_set1_epi8('>');
+    const __m128i amp = _mm_set1_epi8('&');
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i quot = _mm_set1_epi8('"');
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i tab = _mm_set1_epi8('\t');
+
+    for (; pos + 16 <= len; pos += 16)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(str + pos));
+        __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, lt), _mm_cmpeq_epi8(chunk, gt)),
+                                   _mm_or_si128(_mm_cmpeq_epi8(chunk, amp), _mm_cmpeq_epi8(chunk, cr)));
+        if (attribute)
+            hit = _mm_or_si128(hit, _mm_or_si128(_mm_cmpeq_epi8(chunk, quot),
+                                                 _mm_or_si128(_mm_cmpeq_epi8(chunk, lf), _mm_cmpeq_epi8(chunk, tab))));
+
+        int mask = _mm_movemask_epi8(hit);
+        if (attribute)
+            mask |= _mm_movemask_epi8(chunk);
+        if (mask)
+            return pos + (size_t)__builtin_ctz((unsigned)mask);
+    }
+#endif
+
+    for (; pos < len; pos++)
+    {
+        if ((cfrds_xml_entity(str[pos], attribute))||((attribute)&&((unsigned char)str[pos] >= 0x80)))
+            break;
+    }
+
+    return pos;
+}
+
+/*
+ * Appends the non-ASCII character at `str` of an attribute value as a character reference,
+ * decoding it like libxml2 does for a document without an encoding. Returns the bytes used.
+ */
+static size_t cfrds_xml_append_char_ref(cfrds_buffer *buffer, const unsigned char *str, size_t len)
+{
+    uint32_t val = str[0];
+    size_t used = 1;
+    char ref[16];
+
+    /* libxml2 copies a last byte as it is */
+    if (len == 1)
+        return cfrds_buffer_append_bytes(buffer, str, 1) ? 1 : 0;
+
+    if ((str[0] >= 0xC0)&&(str[0] < 0xE0)) {
+        val = ((str[0] & 0x1Fu) << 6) | (str[1] & 0x3Fu);
+        used = 2;
+    } else if ((str[0] >= 0xE0)&&(str[0] < 0xF0)&&(len > 2)) {
+        val = ((str[0] & 0x0Fu) << 12) | ((str[1] & 0x3Fu) << 6) | (str[2] & 0x3Fu);
+        used = 3;
+    } else if ((str[0] >= 0xF0)&&(str[0] < 0xF8)&&(len > 3)) {
+        val = ((str[0] & 0x07u) << 18) | ((str[1] & 0x3Fu) << 12) | ((str[2] & 0x3Fu) << 6) | (str[3] & 0x3Fu);
+        used = 4;
+    }
+
+    bool is_char = (val == 0x9)||(val == 0xA)||(val == 0xD)||((val >= 0x20)&&(val <= 0xD7FF))||
+                   ((val >= 0xE000)&&(val <= 0xFFFD))||((val >= 0x10000)&&(val <= 0x10FFFF));
+
+    /* not UTF-8, the byte itself is referenced */
+    if ((used == 1)||(!is_char))
+    {
+        val = str[0];
+        used = 1;
+    }
+
+    snprintf(ref, sizeof(ref), "&#x%X;", (unsigned)val);
+
+    return cfrds_buffer_append(buffer, ref) ? used : 0;
+}
+
+bool cfrds_buffer_append_xml_escaped(cfrds_buffer *buffer, const char *str, bool attribute)
+{
+    if ((!buffer) || (!str))
+    {
+        return false;
+    }
+
+    size_t len = strlen(str);
+
+    /* most values need no escaping at all */
+    if (cfrds_buffer_realloc_if_needed(buffer, len) == false)
+        return false;
+
+    while (len > 0)
+    {
+        size_t plain = cfrds_xml_plain_span(str, len, attribute);
+
+        if (!cfrds_buffer_append_bytes(buffer, str, plain))
+            return false;
+
+        if (plain == len)
+            break;
+
+        str += plain;
+        len -= plain;
+
+        const char *entity = cfrds_xml_entity(*str, attribute);
+        size_t used = 1;
+
+        if (entity == NULL)
+            used = cfrds_xml_append_char_ref(buffer, (const unsigned char *)str, len);
+        else if (!cfrds_buffer_append(buffer, entity))
+            used = 0;
+
+        if (used == 0)
+            return false;
+
+        str += used;
+        len -= used;
+    }
+
+    return true;
+}
+
 static __attribute__((unused)) bool cfrds_buffer_append_int(cfrds_buffer *buffer, int number)
 {
     char str[16];
@@ -287,11 +626,22 @@ bool cfrds_buffer_append_rds_string(cfrds_buffer *buffer, const char *str)
 }
 
 bool cfrds_buffer_append_rds_bytes(cfrds_buffer *buffer, const void *data, size_t length)
+{
+    if ((buffer == NULL)||(data == NULL))
+        return false;
+
+    if (cfrds_buffer_append_rds_bytes_prefix(buffer, length) == false) return false;
+    if (cfrds_buffer_append_bytes(buffer, data, length) == false) return false;
+
+    return true;
+}
+
+bool cfrds_buffer_append_rds_bytes_prefix(cfrds_buffer *buffer, size_t length)
 {
     char str_len[16] = {0, };
     int n = 0;
 
-    if ((buffer == NULL)||(data == NULL))
+    if (buffer == NULL)
         return false;
 
     n = snprintf(str_len, sizeof(str_len), "%zu", length);
@@ -300,7 +650,6 @@ bool cfrds_buffer_append_rds_bytes(cfrds_buffer *buffer, const void *data, size_
         if (cfrds_buffer_append(buffer, "STR:") == false) return false;
         if (cfrds_buffer_append(buffer, str_len) == false) return false;
         if (cfrds_buffer_append_char(buffer, ':') == false) return false;
-        if (cfrds_buffer_append_bytes(buffer, data, length) == false) return false;
     }
 
     return true;
@@ -324,8 +673,6 @@ static bool cfrds_buffer_append_char(cfrds_buffer *buffer, const char ch)
 
 bool cfrds_buffer_reserve_above_size(cfrds_buffer *buffer, size_t size)
 {
-    void *tmp = NULL;
-
     if (buffer == NULL)
         return false;
 
@@ -339,16 +686,8 @@ bool cfrds_buffer_reserve_above_size(cfrds_buffer *buffer, size_t size)
         if (required == SIZE_MAX)
             return false;
 
-        size_t newsize = required;
-
-        tmp = realloc(buffer->data, newsize + 1);
-        if (tmp == NULL)
+        if (!cfrds_buffer_resize(buffer, required))
             return false;
-
-        size_t oldsize = buffer->allocated;
-        buffer->data = tmp;
-        explicit_bzero(buffer->data + oldsize, newsize + 1 - oldsize);
-        buffer->allocated = newsize;
     }
 
     return true;
@@ -373,20 +712,228 @@ bool cfrds_buffer_expand(cfrds_buffer *buffer, size_t size)
     return true;
 }
 
-void cfrds_buffer_free(cfrds_buffer *buffer)
+char *cfrds_buffer_spare(cfrds_buffer *buffer, size_t size)
+{
+    if (cfrds_buffer_realloc_if_needed(buffer, size) == false)
+        return NULL;
+
+    if (buffer->data == NULL)
+        return NULL;
+
+    return (char *)buffer->data + buffer->size;
+}
+
+bool cfrds_buffer_commit(cfrds_buffer *buffer, size_t size)
 {
     if (buffer == NULL)
-        return;
+        return false;
+
+    if (size > buffer->allocated - buffer->size)
+        return false;
+
+    buffer->size += size;
+    if (buffer->data)
+        buffer->data[buffer->size] = '\0';
+
+    return true;
+}
+
+bool cfrds_buffer_slice(cfrds_buffer *buffer, size_t offset, size_t size)
+{
+    if (buffer == NULL)
+        return false;
+
+    if ((offset > buffer->size)||(size > buffer->size - offset))
+        return false;
+
+    if ((offset > 0)&&(size > 0))
+        memmove(buffer->data, buffer->data + offset, size);
+
+    buffer->size = size;
+    if (buffer->data)
+        buffer->data[size] = '\0';
+
+    return true;
+}
 
-    if (buffer->data != NULL)
+bool cfrds_buffer_set_spill_threshold(cfrds_buffer *buffer, size_t threshold)
+{
+    if (buffer == NULL)
+        return false;
+
+    buffer->spill_threshold = threshold;
+
+    return true;
+}
+
+bool cfrds_buffer_spilled(cfrds_buffer *buffer)
+{
+    return (buffer != NULL)&&(buffer->spill != CFRDS_SPILL_NONE);
+}
+
+bool cfrds_buffer_set_result_views(cfrds_buffer *buffer, bool enabled)
+{
+    if (buffer == NULL)
+        return false;
+
+    buffer->result_views = enabled;
+
+    return true;
+}
+
+static void cfrds_buffer_release(cfrds_buffer *buffer)
+{
+    if (buffer->spill != CFRDS_SPILL_NONE)
+    {
+        cfrds_buffer_spill_close(buffer->spill, buffer->data, buffer->allocated);
+        buffer->spill = CFRDS_SPILL_NONE;
+    }
+    else
     {
         free(buffer->data);
-        buffer->data = NULL;
     }
+    buffer->data = NULL;
+    buffer->allocated = 0;
+    buffer->size = 0;
+}
+
+void cfrds_buffer_free(cfrds_buffer *buffer)
+{
+    if (buffer == NULL)
+        return;
+
+    cfrds_buffer_release(buffer);
 
     free(buffer);
 }
 
+static cfrds_arena_chunk *cfrds_arena_chunk_create(size_t size)
+{
+    if (size > SIZE_MAX - sizeof(cfrds_arena_chunk))
+        return NULL;
+
+    cfrds_arena_chunk *ret = malloc(sizeof(cfrds_arena_chunk) + size);
+    if (ret == NULL)
+        return NULL;
+
+    ret->next = NULL;
+    ret->size = size;
+    ret->used = 0;
+
+    return ret;
+}
+
+cfrds_arena *cfrds_arena_create(size_t capacity)
+{
+    size_t header = CFRDS_ARENA_ALIGN(sizeof(cfrds_arena));
+
+    if (capacity > SIZE_MAX - header - sizeof(cfrds_arena_chunk) - _Alignof(max_align_t))
+        return NULL;
+
+    cfrds_arena_chunk *chunk = cfrds_arena_chunk_create(CFRDS_ARENA_ALIGN(header + capacity));
+    if (chunk == NULL)
+        return NULL;
+
+    cfrds_arena *ret = (cfrds_arena *)chunk->data;
+    ret->chunk = chunk;
+    ret->response.allocated = 0;
+    ret->response.size = 0;
+    ret->response.data = NULL;
+    ret->response.spill = CFRDS_SPILL_NONE;
+    chunk->used = header;
+
+    return ret;
+}
+
+/* Returns `size` bytes starting at an offset rounded up to `align`, growing the arena if needed. */
+static char *cfrds_arena_bump(cfrds_arena *arena, size_t size, size_t align)
+{
+    if (arena == NULL)
+        return NULL;
+
+    cfrds_arena_chunk *chunk = arena->chunk;
+    size_t offset = (chunk->used + align - 1) & ~(align - 1);
+
+    if ((offset > chunk->size)||(size > chunk->size - offset))
+    {
+        size_t new_size = chunk->size;
+        if (new_size > SIZE_MAX / 2)
+            return NULL;
+        new_size *= 2;
+        if (new_size < size)
+            new_size = size;
+
+        cfrds_arena_chunk *new_chunk = cfrds_arena_chunk_create(new_size);
+        if (new_chunk == NULL)
+            return NULL;
+
+        new_chunk->next = chunk;
+        arena->chunk = chunk = new_chunk;
+        offset = 0;
+    }
+
+    chunk->used = offset + size;
+
+    return (char *)chunk->data + offset;
+}
+
+void *cfrds_arena_alloc(cfrds_arena *arena, size_t size)
+{
+    void *ret = cfrds_arena_bump(arena, size, _Alignof(max_align_t));
+    if (ret == NULL)
+        return NULL;
+
+    memset(ret, 0, size);
+
+    return ret;
+}
+
+char *cfrds_arena_strndup(cfrds_arena *arena, const char *str, size_t len)
+{
+    if (len == SIZE_MAX)
+        return NULL;
+
+    char *ret = cfrds_arena_bump(arena, len + 1, 1);
+    if (ret == NULL)
+        return NULL;
+
+    memcpy(ret, str, len);
+    ret[len] = '\0';
+
+    return ret;
+}
+
+/* Moves the storage of `buffer` into the arena, `buffer` is left empty and reusable. */
+static void cfrds_arena_adopt(cfrds_arena *arena, cfrds_buffer *buffer)
+{
+    arena->response.allocated = buffer->allocated;
+    arena->response.size = buffer->size;
+    arena->response.data = buffer->data;
+    arena->response.spill = buffer->spill;
+
+    buffer->allocated = 0;
+    buffer->size = 0;
+    buffer->data = NULL;
+    buffer->spill = CFRDS_SPILL_NONE;
+}
+
+void cfrds_arena_free(cfrds_arena *arena)
+{
+    if (arena == NULL)
+        return;
+
+    cfrds_buffer_release(&arena->response);
+
+    /* the first chunk holds the arena itself and is freed last */
+    cfrds_arena_chunk *chunk = arena->chunk;
+    while (chunk)
+    {
+        cfrds_arena_chunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+}
+
 bool cfrds_buffer_parse_number(const char **data, size_t *remaining, int64_t *out)
 {
     const char *end = NULL;
@@ -412,107 +959,315 @@ bool cfrds_buffer_parse_number(const char **data, size_t *remaining, int64_t *ou
     return true;
 }
 
-static bool cfrds_buffer_parse_bytearray(const char **data, size_t *remaining, char **out, size_t *out_size)
+/* Parses a length-prefixed RDS string in place: `*out` points into the response, it is not terminated. */
+static bool cfrds_buffer_parse_view(const char **data, size_t *remaining, const char **out, size_t *out_size)
+{
+    size_t size = 0;
+    int64_t tmp = 0;
+
+    if (out == NULL)
+        return false;
+
+    const char *data_start = *data;
+    size_t rem_start = *remaining;
+
+    if (!cfrds_buffer_parse_number(data, remaining, &tmp))
+        return false;
+
+    if (tmp < 0) {
+        *data = data_start;
+        *remaining = rem_start;
+        return false;
+    }
+
+    size = (size_t)tmp;
+    if (size > *remaining) {
+        *data = data_start;
+        *remaining = rem_start;
+        return false;
+    }
+
+    *out = *data;
+    *out_size = size;
+
+    *remaining -= size;
+    *data += size;
+
+    return true;
+}
+
+static bool cfrds_buffer_parse_bytearray(const char **data, size_t *remaining, char **out, size_t *out_size)
+{
+    const char *view = NULL;
+    size_t size = 0;
+
+    if (out == NULL)
+        return false;
+
+    const char *data_start = *data;
+    size_t rem_start = *remaining;
+
+    if (!cfrds_buffer_parse_view(data, remaining, &view, &size))
+        return false;
+
+    *out = malloc(size + 1);
+    if (*out == NULL) {
+        *data = data_start;
+        *remaining = rem_start;
+        return false;
+    }
+
+    memcpy(*out, view, size);
+    (*out)[size] = 0;
+
+    if (out_size)
+        *out_size = size;
+
+    return true;
+}
+
+bool cfrds_buffer_parse_string(const char **data, size_t *remaining, char **out)
+{
+    return cfrds_buffer_parse_bytearray(data, remaining, out, NULL);
+}
+
+/* Parses one item of a comma separated, optionally quoted list in place. */
+static bool cfrds_buffer_parse_list_view(const char **data, size_t *remaining, const char **out, size_t *out_size)
+{
+    bool with_quotes = false;
+    const char *endstr = NULL;
+    size_t len = 0;
+
+    if ((data == NULL)||(out == NULL)||(*remaining < 2))
+        return false;
+
+    if ((*data)[0] == '"')
+    {
+        with_quotes = true;
+        (*data)++; (*remaining)--;
+
+        endstr = memchr(*data, '"', *remaining);
+        if (endstr == NULL)
+            return false;
+        len = (size_t)(endstr - *data);
+    }
+    else
+    {
+        endstr = memchr(*data, ',', *remaining);
+        if (endstr == NULL)
+            len = *remaining;
+        else
+            len = (size_t)(endstr - *data);
+    }
+
+    *out = *data;
+    *out_size = len;
+
+    (*data)+=len; (*remaining)-=len;
+    if (with_quotes) {
+        if (*remaining == 0 || (*data)[0] != '"') {
+            return false;
+        }
+
+        (*data)++; (*remaining)--;
+    }
+    if (*remaining > 0 && (*data)[0] == ',') {
+        (*data)++; (*remaining)--;
+    }
+
+    return true;
+}
+
+static bool cfrds_buffer_parse_string_list_item(const char **data, size_t *remaining, char **out)
+{
+    const char *view = NULL;
+    size_t len = 0;
+
+    if (!cfrds_buffer_parse_list_view(data, remaining, &view, &len))
+        return false;
+
+    char *tmp = malloc(len + 1);
+    if (tmp == NULL)
+        return false;
+
+    memcpy(tmp, view, len);
+    tmp[len] = '\0';
+
+    *out = tmp;
+
+    return true;
+}
+
+/* Parses a row string of the response, sized as the C string the row used to be copied into. */
+static bool cfrds_buffer_parse_row(const char **data, size_t *remaining, const char **row, size_t *row_size)
+{
+    if (!cfrds_buffer_parse_view(data, remaining, row, row_size))
+        return false;
+
+    *row_size = strnlen(*row, *row_size);
+
+    return true;
+}
+
+/* Copies a short numeric field into `buf` for the strto* functions, false if it does not fit. */
+static bool cfrds_buffer_view_copy(const char *view, size_t len, char *buf, size_t buf_size)
+{
+    if (len >= buf_size)
+        return false;
+
+    memcpy(buf, view, len);
+    buf[len] = '\0';
+
+    return true;
+}
+
+static int cfrds_buffer_view_atoi(const char *view, size_t len)
+{
+    char buf[32];
+
+    if (!cfrds_buffer_view_copy(view, len, buf, sizeof(buf)))
+        return 0;
+
+    return atoi(buf);
+}
+
+/* Where the strings of one result go: copied into its arena, or terminated in place in the response or a copy of it. */
+typedef struct {
+    cfrds_arena *arena;
+    cfrds_buffer *views;    ///< Response the result takes over when it is done, NULL when strings are copied.
+    bool in_place;          ///< Strings are terminated where they were parsed.
+    char *pending;          ///< End of the last length-prefixed string, terminated once the next one is parsed.
+} cfrds_result_ctx;
+
+/* Allocates a zeroed result whose first member is its arena, with `reserve` more bytes for copied strings. */
+static void *cfrds_buffer_result_create(cfrds_buffer *buffer, size_t size, size_t reserve, cfrds_result_ctx *ctx)
+{
+    if (buffer->result_views)
+        reserve = 0;
+
+    if (reserve > SIZE_MAX - size)
+        return NULL;
+
+    cfrds_arena *arena = cfrds_arena_create(size + reserve);
+    if (arena == NULL)
+        return NULL;
+
+    cfrds_arena **ret = cfrds_arena_alloc(arena, size);
+    if (ret == NULL)
+    {
+        cfrds_arena_free(arena);
+        return NULL;
+    }
+
+    *ret = arena;
+
+    ctx->arena = arena;
+    ctx->views = buffer->result_views ? buffer : NULL;
+    ctx->in_place = buffer->result_views;
+    ctx->pending = NULL;
+
+    return ret;
+}
+
+/* Notes that a length-prefixed string ending at `end` was parsed; its end is still the next prefix. */
+static void cfrds_result_advance(cfrds_result_ctx *ctx, const char *end)
+{
+    if (!ctx->in_place)
+        return;
+
+    if (ctx->pending)
+        *ctx->pending = '\0';
+
+    ctx->pending = (char *)end;
+}
+
+static bool cfrds_result_row(cfrds_result_ctx *ctx, const char **data, size_t *remaining, const char **row, size_t *row_size)
 {
-    size_t size = 0;
-    int64_t tmp = 0;
-
-    if (out == NULL)
+    if (!cfrds_buffer_parse_row(data, remaining, row, row_size))
         return false;
 
-    const char *data_start = *data;
-    size_t rem_start = *remaining;
+    cfrds_result_advance(ctx, *row + *row_size);
 
-    if (!cfrds_buffer_parse_number(data, remaining, &tmp))
-        return false;
+    return true;
+}
 
-    if (tmp < 0) {
-        *data = data_start;
-        *remaining = rem_start;
-        return false;
-    }
+static bool cfrds_result_field(cfrds_result_ctx *ctx, cfrds_str_view *out, const char *str, size_t len)
+{
+    if (ctx->in_place)
+    {
+        /* a string ending with its row ends at the next length prefix, cfrds_result_advance() terminates it */
+        if (str + len != ctx->pending)
+            ((char *)str)[len] = '\0';
 
-    size = (size_t)tmp;
-    if (size > *remaining) {
-        *data = data_start;
-        *remaining = rem_start;
-        return false;
+        out->str = (char *)str;
     }
-
-    *out = malloc(size + 1);
-    if (*out == NULL) {
-        *data = data_start;
-        *remaining = rem_start;
-        return false;
+    else
+    {
+        out->str = cfrds_arena_strndup(ctx->arena, str, len);
+        if (out->str == NULL)
+            return false;
     }
 
-    memcpy(*out, *data, size);
-    (*out)[size] = 0;
-
-    *remaining -= size;
-    *data += size;
-
-    if (out_size)
-        *out_size = size;
+    out->len = len;
 
     return true;
 }
 
-bool cfrds_buffer_parse_string(const char **data, size_t *remaining, char **out)
+static bool cfrds_result_bytes(cfrds_result_ctx *ctx, const char **data, size_t *remaining, cfrds_str_view *out)
 {
-    return cfrds_buffer_parse_bytearray(data, remaining, out, NULL);
+    const char *view = NULL;
+    size_t size = 0;
+
+    if (!cfrds_buffer_parse_view(data, remaining, &view, &size))
+        return false;
+
+    cfrds_result_advance(ctx, view + size);
+
+    return cfrds_result_field(ctx, out, view, size);
 }
 
-static bool cfrds_buffer_parse_string_list_item(const char **data, size_t *remaining, char **out)
+static bool cfrds_result_list_item(cfrds_result_ctx *ctx, const char **data, size_t *remaining, cfrds_str_view *out)
 {
-    bool with_quotes = false;
-    const char *endstr = NULL;
-    cfrds_str_defer(tmp);
+    const char *view = NULL;
     size_t len = 0;
 
-    if ((data == NULL)||(out == NULL)||(*remaining < 2))
+    if (!cfrds_buffer_parse_list_view(data, remaining, &view, &len))
         return false;
 
-    if ((*data)[0] == '"')
-    {
-        with_quotes = true;
-        (*data)++; (*remaining)--;
+    return cfrds_result_field(ctx, out, view, len);
+}
 
-        endstr = memchr(*data, '"', *remaining);
-        if (endstr == NULL)
-            return false;
-        len = (size_t)(endstr - *data);
-    }
-    else
-    {
-        endstr = memchr(*data, ',', *remaining);
-        if (endstr == NULL)
-            len = *remaining;
-        else
-            len = (size_t)(endstr - *data);
-    }
+/*
+ * Copies the rest of a response into the arena as one string heap, parsed on in place like views
+ * but leaving the response untouched. Returns where the caller continues parsing `data`: the copy,
+ * or `data` itself for view results. NULL when out of memory.
+ */
+static const char *cfrds_result_heap(cfrds_result_ctx *ctx, const char *data, size_t size)
+{
+    if (ctx->in_place)
+        return data;
 
-    tmp = malloc(len + 1);
-    if (tmp == NULL)
-        return false;
+    if (size == SIZE_MAX)
+        return NULL;
 
-    memcpy(tmp, *data, len);
-    tmp[len] = '\0';
-    (*data)+=len; (*remaining)-=len;
-    if (with_quotes) {
-        if (*remaining == 0 || (*data)[0] != '"') {
-            return false;
-        }
+    char *heap = cfrds_arena_alloc(ctx->arena, size + 1);
+    if (heap == NULL)
+        return NULL;
 
-        (*data)++; (*remaining)--;
-    }
-    if (*remaining > 0 && (*data)[0] == ',') {
-        (*data)++; (*remaining)--;
-    }
+    memcpy(heap, data, size);
+    ctx->in_place = true;
 
-    *out = tmp; tmp = NULL;
+    return heap;
+}
 
-    return true;
+/* Completes a successful parse; in place strings get their last terminator, a view result takes over the response storage. */
+static void cfrds_result_finish(cfrds_result_ctx *ctx)
+{
+    if ((ctx->in_place)&&(ctx->pending))
+        *ctx->pending = '\0';
+
+    if (ctx->views)
+        cfrds_arena_adopt(ctx->arena, ctx->views);
 }
 
 cfrds_browse_dir *cfrds_buffer_to_browse_dir(cfrds_buffer *buffer)
@@ -520,6 +1275,7 @@ cfrds_browse_dir *cfrds_buffer_to_browse_dir(cfrds_buffer *buffer)
     cfrds_browse_dir *ret = NULL;
 
     cfrds_browse_dir_defer(tmp);
+    cfrds_result_ctx ctx;
     size_t malloc_size = 0;
     int64_t total = 0;
     int64_t cnt = 0;
@@ -544,68 +1300,68 @@ cfrds_browse_dir *cfrds_buffer_to_browse_dir(cfrds_buffer *buffer)
     size_t ucnt = (size_t)cnt;
     malloc_size = offsetof(cfrds_browse_dir, items) + ucnt * sizeof(cfrds_browse_dir_item);
 
-    tmp = malloc(malloc_size);
+    tmp = cfrds_buffer_result_create(buffer, malloc_size, size, &ctx);
     if (tmp == NULL)
         return NULL;
 
-    explicit_bzero(tmp, malloc_size);
-
     tmp->cnt = ucnt;
 
     for(int64_t c = 0; c < cnt; c++)
     {
-        cfrds_str_defer(str_kind);
-        cfrds_str_defer(filename);
-        cfrds_str_defer(str_permissions);
-        cfrds_str_defer(str_filesize);
-        cfrds_str_defer(str_timestamp);
+        const char *str_kind = NULL;
+        const char *filename = NULL;
+        const char *str_permissions = NULL;
+        const char *str_filesize = NULL;
+        const char *str_timestamp = NULL;
+        size_t kind_len = 0, filename_len = 0, permissions_len = 0, filesize_len = 0, timestamp_len = 0;
+        char num_buf[64];
 
         char file_type = '\0';
         ssize_t permissions = -1;
         ssize_t filesize = -1;
         uint64_t modified = UINT64_MAX;
 
-        if (!cfrds_buffer_parse_string(&data, &size, &str_kind))
+        if (!cfrds_result_row(&ctx, &data, &size, &str_kind, &kind_len))
             return NULL;
-        if (!cfrds_buffer_parse_string(&data, &size, &filename))
+        if (!cfrds_result_row(&ctx, &data, &size, &filename, &filename_len))
             return NULL;
-        if (!cfrds_buffer_parse_string(&data, &size, &str_permissions))
+        if (!cfrds_result_row(&ctx, &data, &size, &str_permissions, &permissions_len))
             return NULL;
-        if (!cfrds_buffer_parse_string(&data, &size, &str_filesize))
+        if (!cfrds_result_row(&ctx, &data, &size, &str_filesize, &filesize_len))
             return NULL;
-        if (!cfrds_buffer_parse_string(&data, &size, &str_timestamp))
+        if (!cfrds_result_row(&ctx, &data, &size, &str_timestamp, &timestamp_len))
             return NULL;
 
-        if (str_kind)
-        {
-            if (strcmp(str_kind, "F:") == 0)
-              file_type = 'F';
-            else
-              if (strcmp(str_kind, "D:") == 0)
-                file_type = 'D';
-        }
+        if ((kind_len == 2)&&(memcmp(str_kind, "F:", 2) == 0))
+            file_type = 'F';
+        else
+          if ((kind_len == 2)&&(memcmp(str_kind, "D:", 2) == 0))
+            file_type = 'D';
 
-        if (str_permissions)
         {
             char *endptr = NULL;
-            permissions = strtol(str_permissions, &endptr, 10);
-            if (endptr == str_permissions || *endptr != '\0')
+            if (!cfrds_buffer_view_copy(str_permissions, permissions_len, num_buf, sizeof(num_buf)))
+                return NULL;
+            permissions = strtol(num_buf, &endptr, 10);
+            if (endptr == num_buf || *endptr != '\0')
                 return NULL;
         }
 
-        if (str_filesize)
         {
             char *endptr = NULL;
-            filesize = strtol(str_filesize, &endptr, 10);
-            if (endptr == str_filesize || *endptr != '\0')
+            if (!cfrds_buffer_view_copy(str_filesize, filesize_len, num_buf, sizeof(num_buf)))
+                return NULL;
+            filesize = strtol(num_buf, &endptr, 10);
+            if (endptr == num_buf || *endptr != '\0')
                 return NULL;
         }
 
-        if (str_timestamp)
         {
             char *endptr = NULL;
-            uint32_t num1 = (uint32_t)strtoul(str_timestamp, &endptr, 10);
-            if (endptr == str_timestamp || *endptr != ',')
+            if (!cfrds_buffer_view_copy(str_timestamp, timestamp_len, num_buf, sizeof(num_buf)))
+                return NULL;
+            uint32_t num1 = (uint32_t)strtoul(num_buf, &endptr, 10);
+            if (endptr == num_buf || *endptr != ',')
                 return NULL;
 
             const char *str_num2 = endptr + 1;
@@ -619,16 +1375,20 @@ cfrds_browse_dir *cfrds_buffer_to_browse_dir(cfrds_buffer *buffer)
             modified -= 11644473600000L;
         }
 
-        if(((file_type != 'D')&&(file_type != 'F'))||(!filename)||(permissions < 0)||(permissions > 0xff)||(filesize < 0))
+        if(((file_type != 'D')&&(file_type != 'F'))||(permissions < 0)||(permissions > 0xff)||(filesize < 0))
+            return NULL;
+
+        if (!cfrds_result_field(&ctx, &tmp->items[c].name, filename, filename_len))
             return NULL;
 
         tmp->items[c].kind = file_type;
-        tmp->items[c].name = filename; filename = NULL;
         tmp->items[c].permissions = (uint8_t)permissions;
         tmp->items[c].size = (size_t)filesize;
         tmp->items[c].modified = modified;
     }
 
+    cfrds_result_finish(&ctx);
+
     ret = tmp; tmp = NULL;
     return ret;
 }
@@ -637,6 +1397,7 @@ cfrds_file_content *cfrds_buffer_to_file_content(cfrds_buffer *buffer)
 {
     cfrds_file_content *ret = NULL;
     cfrds_file_content_defer(tmp);
+    cfrds_result_ctx ctx;
     int64_t total = 0;
 
     if (buffer == NULL)
@@ -651,19 +1412,19 @@ cfrds_file_content *cfrds_buffer_to_file_content(cfrds_buffer *buffer)
     if (total != 3)
         return NULL;
 
-    tmp = malloc(sizeof(cfrds_file_content));
+    tmp = cfrds_buffer_result_create(buffer, sizeof(cfrds_file_content), size, &ctx);
     if (tmp == NULL)
         return NULL;
 
-    explicit_bzero(tmp, sizeof(cfrds_file_content));
-
-    if (!cfrds_buffer_parse_bytearray(&data, &size, &tmp->data, &tmp->size) ||
-        !cfrds_buffer_parse_string(&data, &size, &tmp->modified) ||
-        !cfrds_buffer_parse_string(&data, &size, &tmp->permission))
+    if (!cfrds_result_bytes(&ctx, &data, &size, &tmp->data) ||
+        !cfrds_result_bytes(&ctx, &data, &size, &tmp->modified) ||
+        !cfrds_result_bytes(&ctx, &data, &size, &tmp->permission))
     {
         return NULL;
     }
 
+    cfrds_result_finish(&ctx);
+
     ret = tmp;
     tmp = NULL;
 
@@ -675,6 +1436,10 @@ cfrds_sql_dsninfo *cfrds_buffer_to_sql_dsninfo(cfrds_buffer *buffer)
     cfrds_sql_dsninfo *ret = NULL;
 
     cfrds_sql_dsninfo_defer(tmp);
+    cfrds_result_ctx ctx;
+
+    if (buffer == NULL)
+        return NULL;
 
     const char *response_data = cfrds_buffer_data(buffer);
     size_t response_size = cfrds_buffer_data_size(buffer);
@@ -690,47 +1455,39 @@ cfrds_sql_dsninfo *cfrds_buffer_to_sql_dsninfo(cfrds_buffer *buffer)
           return NULL;
 
       size_t ucnt = (size_t)cnt;
-      size_t malloc_size = offsetof(cfrds_sql_dsninfo, names) + sizeof(char *) * ucnt;
-      tmp = malloc(malloc_size);
+      size_t malloc_size = offsetof(cfrds_sql_dsninfo, names) + sizeof(cfrds_str_view) * ucnt;
+      tmp = cfrds_buffer_result_create(buffer, malloc_size, response_size, &ctx);
       if (tmp == NULL)
           return NULL;
 
-      explicit_bzero(tmp, malloc_size);
-
       tmp->cnt = ucnt;
 
       for(int c = 0; c < cnt; c++)
       {
-          cfrds_str_defer(item);
+          const char *item = NULL;
+          size_t len = 0;
 
-          if (!cfrds_buffer_parse_string(&response_data, &response_size, &item))
+          if (!cfrds_result_row(&ctx, &response_data, &response_size, &item, &len))
               return NULL;
 
-          if (item)
+          /* the name is quoted inside the item */
+          const char *pos1 = memchr(item, '"', len);
+          if (pos1)
           {
-              const char *pos1 = strchr(item, '"');
-              if (pos1)
+              const char *pos2 = memchr(pos1 + 1, '"', len - (size_t)(pos1 + 1 - item));
+              if (pos2)
               {
-                  const char *pos2 = strchr(pos1 + 1, '"');
-                  if (pos2)
-                  {
-                      size_t len = (size_t)(pos2 - pos1 - 1);
-
-                      char *str_tmp = malloc(len + 1);
-                      if (str_tmp == NULL)
-                          return NULL;
-
-                      memcpy(str_tmp, pos1 + 1, len);
-                      str_tmp[len] = '\0';
-                      free(item);
-                      item = str_tmp;
-                  }
+                  item = pos1 + 1;
+                  len = (size_t)(pos2 - pos1 - 1);
               }
-
-              tmp->names[c] = item; item = NULL;
           }
+
+          if (!cfrds_result_field(&ctx, &tmp->names[c], item, len))
+              return NULL;
       }
 
+    cfrds_result_finish(&ctx);
+
     ret = tmp; tmp = NULL;
 
     return ret;
@@ -741,6 +1498,10 @@ cfrds_sql_tableinfo *cfrds_buffer_to_sql_tableinfo(cfrds_buffer *buffer)
     cfrds_sql_tableinfo *ret = NULL;
 
     cfrds_sql_tableinfo_defer(tmp);
+    cfrds_result_ctx ctx;
+
+    if (buffer == NULL)
+        return NULL;
 
     const char *response_data = cfrds_buffer_data(buffer);
     size_t response_size = cfrds_buffer_data_size(buffer);
@@ -757,47 +1518,36 @@ cfrds_sql_tableinfo *cfrds_buffer_to_sql_tableinfo(cfrds_buffer *buffer)
 
     size_t malloc_size = offsetof(cfrds_sql_tableinfo, items) + sizeof(cfrds_sql_tableinfoitem) * (size_t)cnt;
 
-    tmp = malloc(malloc_size);
+    tmp = cfrds_buffer_result_create(buffer, malloc_size, response_size, &ctx);
     if (tmp == NULL)
         return NULL;
 
-    explicit_bzero(tmp, malloc_size);
-
     tmp->cnt = 0;
 
     for(int c = 0; c < cnt; c++)
     {
-        cfrds_str_defer(item);
+        const char *column_buf = NULL;
+        size_t list_remaining = 0;
 
-        if (!cfrds_buffer_parse_string(&response_data, &response_size, &item))
+        if (!cfrds_result_row(&ctx, &response_data, &response_size, &column_buf, &list_remaining))
             return NULL;
-        if (item)
-        {
-            cfrds_str_defer(field1);
-            cfrds_str_defer(field2);
-            cfrds_str_defer(field3);
-            cfrds_str_defer(field4);
-
-            const char *column_buf = item;
-            size_t list_remaining = strlen(column_buf);
-
-            if (!cfrds_buffer_parse_string_list_item(&column_buf, &list_remaining, &field1) ||
-                !cfrds_buffer_parse_string_list_item(&column_buf, &list_remaining, &field2) ||
-                !cfrds_buffer_parse_string_list_item(&column_buf, &list_remaining, &field3) ||
-                !cfrds_buffer_parse_string_list_item(&column_buf, &list_remaining, &field4) ||
-                list_remaining != 0)
-            {
-                return NULL;
-            }
 
-            tmp->items[tmp->cnt].unknown = field1; field1 = NULL;
-            tmp->items[tmp->cnt].schema  = field2; field2 = NULL;
-            tmp->items[tmp->cnt].name    = field3; field3 = NULL;
-            tmp->items[tmp->cnt].type    = field4; field4 = NULL;
-            tmp->cnt++;
+        cfrds_sql_tableinfoitem *item = &tmp->items[tmp->cnt];
+
+        if (!cfrds_result_list_item(&ctx, &column_buf, &list_remaining, &item->unknown) ||
+            !cfrds_result_list_item(&ctx, &column_buf, &list_remaining, &item->schema) ||
+            !cfrds_result_list_item(&ctx, &column_buf, &list_remaining, &item->name) ||
+            !cfrds_result_list_item(&ctx, &column_buf, &list_remaining, &item->type) ||
+            list_remaining != 0)
+        {
+            return NULL;
         }
+
+        tmp->cnt++;
     }
 
+    cfrds_result_finish(&ctx);
+
     ret = tmp; tmp = NULL;
 
     return ret;
@@ -808,6 +1558,7 @@ cfrds_sql_columninfo *cfrds_buffer_to_sql_columninfo(cfrds_buffer *buffer)
     cfrds_sql_columninfo *ret = NULL;
 
     cfrds_sql_columninfo_defer(tmp);
+    cfrds_result_ctx ctx;
 
     int64_t columns = 0;
 
@@ -825,80 +1576,55 @@ cfrds_sql_columninfo *cfrds_buffer_to_sql_columninfo(cfrds_buffer *buffer)
 
     size_t ucolumns = (size_t)columns;
     size_t malloc_size = offsetof(cfrds_sql_columninfo, items) + sizeof(cfrds_sql_columninfoitem) * ucolumns;
-    tmp = malloc(malloc_size);
+    tmp = cfrds_buffer_result_create(buffer, malloc_size, size, &ctx);
     if (tmp == NULL)
         return NULL;
 
-    explicit_bzero(tmp, malloc_size);
     tmp->cnt = ucolumns;
 
     for(int64_t column = 0; column < columns; column++)
     {
-        cfrds_str_defer(row_buf);
+        const char *column_buf = NULL;
+        size_t list_remaining = 0;
+        const char *fields[12] = { NULL, };
+        size_t lens[12] = { 0, };
 
-        if (!cfrds_buffer_parse_string(&data, &size, &row_buf))
+        if (!cfrds_result_row(&ctx, &data, &size, &column_buf, &list_remaining))
             return NULL;
 
-        const char *column_buf = row_buf;
-
-        size_t list_remaining = strlen(column_buf);
-
-        cfrds_str_defer(field1);
-        cfrds_str_defer(field2);
-        cfrds_str_defer(field3);
-        cfrds_str_defer(field4);
-        cfrds_str_defer(field5);
-        cfrds_str_defer(field6);
-        cfrds_str_defer(field7);
-        cfrds_str_defer(field8);
-        cfrds_str_defer(field9);
-        cfrds_str_defer(field10);
-        cfrds_str_defer(field11);
-        cfrds_str_defer(field12);
-
-        if (!cfrds_buffer_parse_string_list_item(&column_buf, &list_remaining, &field1))
-            return NULL;
-        if (!cfrds_buffer_parse_string_list_item(&column_buf, &list_remaining, &field2))
-            return NULL;
-        if (!cfrds_buffer_parse_string_list_item(&column_buf, &list_remaining, &field3))
-            return NULL;
-        if (!cfrds_buffer_parse_string_list_item(&column_buf, &list_remaining, &field4))
-            return NULL;
-        if (!cfrds_buffer_parse_string_list_item(&column_buf, &list_remaining, &field5))
-            return NULL;
-        if (!cfrds_buffer_parse_string_list_item(&column_buf, &list_remaining, &field6))
-            return NULL;
-        if (!cfrds_buffer_parse_string_list_item(&column_buf, &list_remaining, &field7))
-            return NULL;
-        if (!cfrds_buffer_parse_string_list_item(&column_buf, &list_remaining, &field8))
-            return NULL;
-        if (!cfrds_buffer_parse_string_list_item(&column_buf, &list_remaining, &field9))
-            return NULL;
-        if (!cfrds_buffer_parse_string_list_item(&column_buf, &list_remaining, &field10))
-            return NULL;
-        if (!cfrds_buffer_parse_string_list_item(&column_buf, &list_remaining, &field11))
-            return NULL;
-        if (list_remaining > 0)
+        /* 11 fields, the 12th is optional */
+        for (size_t f = 0; f < 12; f++)
         {
-            if (!cfrds_buffer_parse_string_list_item(&column_buf, &list_remaining, &field12))
+            if ((f == 11)&&(list_remaining == 0))
+                break;
+
+            if (!cfrds_buffer_parse_list_view(&column_buf, &list_remaining, &fields[f], &lens[f]))
                 return NULL;
         }
         if (list_remaining != 0)
             return NULL;
 
-        tmp->items[column].schema    = field1; field1 = NULL;
-        tmp->items[column].owner     = field2; field2 = NULL;
-        tmp->items[column].table     = field3; field3 = NULL;
-        tmp->items[column].name      = field4; field4 = NULL;
-        tmp->items[column].type      = atoi(field5);
-        tmp->items[column].typeStr   = field6; field6 = NULL;
-        tmp->items[column].precision = atoi(field7);
-        tmp->items[column].length    = atoi(field8);
-        tmp->items[column].scale     = atoi(field9);
-        tmp->items[column].radix     = atoi(field10);
-        tmp->items[column].nullable  = atoi(field11);
+        cfrds_sql_columninfoitem *item = &tmp->items[column];
+
+        item->type      = cfrds_buffer_view_atoi(fields[4], lens[4]);
+        item->precision = cfrds_buffer_view_atoi(fields[6], lens[6]);
+        item->length    = cfrds_buffer_view_atoi(fields[7], lens[7]);
+        item->scale     = cfrds_buffer_view_atoi(fields[8], lens[8]);
+        item->radix     = cfrds_buffer_view_atoi(fields[9], lens[9]);
+        item->nullable  = cfrds_buffer_view_atoi(fields[10], lens[10]);
+
+        if (!cfrds_result_field(&ctx, &item->schema, fields[0], lens[0]) ||
+            !cfrds_result_field(&ctx, &item->owner, fields[1], lens[1]) ||
+            !cfrds_result_field(&ctx, &item->table, fields[2], lens[2]) ||
+            !cfrds_result_field(&ctx, &item->name, fields[3], lens[3]) ||
+            !cfrds_result_field(&ctx, &item->typeStr, fields[5], lens[5]))
+        {
+            return NULL;
+        }
     }
 
+    cfrds_result_finish(&ctx);
+
     ret = tmp; tmp = NULL;
 
     return ret;
@@ -909,6 +1635,7 @@ cfrds_sql_primarykeys *cfrds_buffer_to_sql_primarykeys(cfrds_buffer *buffer)
     cfrds_sql_primarykeys *ret = NULL;
 
     cfrds_sql_primarykeys_defer(tmp);
+    cfrds_result_ctx ctx;
     int64_t cnt = 0;
 
     if (buffer == NULL)
@@ -925,110 +1652,80 @@ cfrds_sql_primarykeys *cfrds_buffer_to_sql_primarykeys(cfrds_buffer *buffer)
 
     size_t ucnt = (size_t)cnt;
     size_t malloc_size = offsetof(cfrds_sql_primarykeys, items) + sizeof(cfrds_sql_primarykeysitem) * ucnt;
-    tmp = malloc(malloc_size);
+    tmp = cfrds_buffer_result_create(buffer, malloc_size, size, &ctx);
     if (tmp == NULL)
         return NULL;
 
-    explicit_bzero(tmp, malloc_size);
-
     tmp->cnt = ucnt;
 
     for(int64_t c = 0; c < cnt; c++)
     {
-        cfrds_str_defer(item);
+        const char *column_buf = NULL;
+        size_t list_remaining = 0;
+        const char *keySequence = NULL;
+        size_t keySequence_len = 0;
 
-        if (!cfrds_buffer_parse_string(&data, &size, &item))
+        if (!cfrds_result_row(&ctx, &data, &size, &column_buf, &list_remaining))
             return NULL;
 
-        const char *column_buf = item;
-
-        size_t list_remaining = strlen(column_buf);
-
-        cfrds_str_defer(tableCatalog);
-        cfrds_str_defer(tableOwner);
-        cfrds_str_defer(tableName);
-        cfrds_str_defer(colName);
-        cfrds_str_defer(keySequence);
+        cfrds_sql_primarykeysitem *item = &tmp->items[c];
 
-        if (!cfrds_buffer_parse_string_list_item(&column_buf, &list_remaining, &tableCatalog))
+        if (!cfrds_result_list_item(&ctx, &column_buf, &list_remaining, &item->tableCatalog))
             return NULL;
-        if (!cfrds_buffer_parse_string_list_item(&column_buf, &list_remaining, &tableOwner))
+        if (!cfrds_result_list_item(&ctx, &column_buf, &list_remaining, &item->tableOwner))
             return NULL;
-        if (!cfrds_buffer_parse_string_list_item(&column_buf, &list_remaining, &tableName))
+        if (!cfrds_result_list_item(&ctx, &column_buf, &list_remaining, &item->tableName))
             return NULL;
-        if (!cfrds_buffer_parse_string_list_item(&column_buf, &list_remaining, &colName))
+        if (!cfrds_result_list_item(&ctx, &column_buf, &list_remaining, &item->colName))
             return NULL;
-        if (!cfrds_buffer_parse_string_list_item(&column_buf, &list_remaining, &keySequence))
+        if (!cfrds_buffer_parse_list_view(&column_buf, &list_remaining, &keySequence, &keySequence_len))
             return NULL;
         if (list_remaining != 0)
             return NULL;
 
-        tmp->items[c].tableCatalog = tableCatalog; tableCatalog = NULL;
-        tmp->items[c].tableOwner   = tableOwner; tableOwner = NULL;
-        tmp->items[c].tableName    = tableName; tableName = NULL;
-        tmp->items[c].colName      = colName; colName = NULL;
-        tmp->items[c].keySequence  = atoi(keySequence);
+        item->keySequence = cfrds_buffer_view_atoi(keySequence, keySequence_len);
     }
 
+    cfrds_result_finish(&ctx);
+
     ret = tmp; tmp = NULL;
 
     return ret;
 }
 
-static bool cfrds_buffer_parse_keyinfo_items(const char **data_ptr, size_t *size_ptr, void *target_items, size_t count, size_t item_stride)
+static bool cfrds_buffer_parse_keyinfo_items(cfrds_result_ctx *ctx, const char **data_ptr, size_t *size_ptr, cfrds_sql_keyinfoitem *items, size_t count)
 {
-    uint8_t *items_bytes = (uint8_t *)target_items;
-
     for (size_t c = 0; c < count; c++)
     {
-        cfrds_str_defer(item);
+        const char *column_buf = NULL;
+        size_t list_remaining = 0;
+        const char *keySequence = NULL, *updateRule = NULL, *deleteRule = NULL;
+        size_t keySequence_len = 0, updateRule_len = 0, deleteRule_len = 0;
 
-        if (!cfrds_buffer_parse_string(data_ptr, size_ptr, &item))
+        if (!cfrds_result_row(ctx, data_ptr, size_ptr, &column_buf, &list_remaining))
             return false;
 
-        const char *column_buf = item;
-        size_t list_remaining = strlen(column_buf);
-
-        cfrds_str_defer(pkTableCatalog);
-        cfrds_str_defer(pkTableOwner);
-        cfrds_str_defer(pkTableName);
-        cfrds_str_defer(pkColName);
-        cfrds_str_defer(fkTableCatalog);
-        cfrds_str_defer(fkTableOwner);
-        cfrds_str_defer(fkTableName);
-        cfrds_str_defer(fkColName);
-        cfrds_str_defer(keySequence);
-        cfrds_str_defer(updateRule);
-        cfrds_str_defer(deleteRule);
-
-        if (!cfrds_buffer_parse_string_list_item(&column_buf, &list_remaining, &pkTableCatalog) ||
-            !cfrds_buffer_parse_string_list_item(&column_buf, &list_remaining, &pkTableOwner) ||
-            !cfrds_buffer_parse_string_list_item(&column_buf, &list_remaining, &pkTableName) ||
-            !cfrds_buffer_parse_string_list_item(&column_buf, &list_remaining, &pkColName) ||
-            !cfrds_buffer_parse_string_list_item(&column_buf, &list_remaining, &fkTableCatalog) ||
-            !cfrds_buffer_parse_string_list_item(&column_buf, &list_remaining, &fkTableOwner) ||
-            !cfrds_buffer_parse_string_list_item(&column_buf, &list_remaining, &fkTableName) ||
-            !cfrds_buffer_parse_string_list_item(&column_buf, &list_remaining, &fkColName) ||
-            !cfrds_buffer_parse_string_list_item(&column_buf, &list_remaining, &keySequence) ||
-            !cfrds_buffer_parse_string_list_item(&column_buf, &list_remaining, &updateRule) ||
-            !cfrds_buffer_parse_string_list_item(&column_buf, &list_remaining, &deleteRule) ||
+        cfrds_sql_keyinfoitem *target = &items[c];
+
+        if (!cfrds_result_list_item(ctx, &column_buf, &list_remaining, &target->pkTableCatalog) ||
+            !cfrds_result_list_item(ctx, &column_buf, &list_remaining, &target->pkTableOwner) ||
+            !cfrds_result_list_item(ctx, &column_buf, &list_remaining, &target->pkTableName) ||
+            !cfrds_result_list_item(ctx, &column_buf, &list_remaining, &target->pkColName) ||
+            !cfrds_result_list_item(ctx, &column_buf, &list_remaining, &target->fkTableCatalog) ||
+            !cfrds_result_list_item(ctx, &column_buf, &list_remaining, &target->fkTableOwner) ||
+            !cfrds_result_list_item(ctx, &column_buf, &list_remaining, &target->fkTableName) ||
+            !cfrds_result_list_item(ctx, &column_buf, &list_remaining, &target->fkColName) ||
+            !cfrds_buffer_parse_list_view(&column_buf, &list_remaining, &keySequence, &keySequence_len) ||
+            !cfrds_buffer_parse_list_view(&column_buf, &list_remaining, &updateRule, &updateRule_len) ||
+            !cfrds_buffer_parse_list_view(&column_buf, &list_remaining, &deleteRule, &deleteRule_len) ||
             list_remaining != 0)
         {
             return false;
         }
 
-        cfrds_sql_foreignkeysitem *target = (cfrds_sql_foreignkeysitem *)(items_bytes + c * item_stride);
-        target->pkTableCatalog = pkTableCatalog; pkTableCatalog = NULL;
-        target->pkTableOwner   = pkTableOwner; pkTableOwner = NULL;
-        target->pkTableName    = pkTableName; pkTableName = NULL;
-        target->pkColName      = pkColName; pkColName = NULL;
-        target->fkTableCatalog = fkTableCatalog; fkTableCatalog = NULL;
-        target->fkTableOwner   = fkTableOwner; fkTableOwner = NULL;
-        target->fkTableName    = fkTableName; fkTableName = NULL;
-        target->fkColName      = fkColName; fkColName = NULL;
-        target->keySequence    = atoi(keySequence);
-        target->updateRule     = atoi(updateRule);
-        target->deleteRule     = atoi(deleteRule);
+        target->keySequence    = cfrds_buffer_view_atoi(keySequence, keySequence_len);
+        target->updateRule     = cfrds_buffer_view_atoi(updateRule, updateRule_len);
+        target->deleteRule     = cfrds_buffer_view_atoi(deleteRule, deleteRule_len);
     }
 
     return true;
@@ -1036,7 +1733,7 @@ static bool cfrds_buffer_parse_keyinfo_items(const char **data_ptr, size_t *size
 
 static struct cfrds_sql_keyinfo *cfrds_buffer_to_sql_keyinfo(cfrds_buffer *buffer)
 {
-    struct cfrds_sql_keyinfo *ret = NULL;
+    cfrds_result_ctx ctx;
     int64_t cnt = 0;
 
     if (buffer == NULL)
@@ -1050,32 +1747,21 @@ static struct cfrds_sql_keyinfo *cfrds_buffer_to_sql_keyinfo(cfrds_buffer *buffe
 
     size_t ucnt = (size_t)cnt;
     size_t malloc_size = offsetof(struct cfrds_sql_keyinfo, items) + sizeof(cfrds_sql_keyinfoitem) * ucnt;
-    struct cfrds_sql_keyinfo *tmp = malloc(malloc_size);
+    struct cfrds_sql_keyinfo *tmp = cfrds_buffer_result_create(buffer, malloc_size, size, &ctx);
     if (tmp == NULL)
         return NULL;
 
-    explicit_bzero(tmp, malloc_size);
     tmp->cnt = ucnt;
 
-    if (!cfrds_buffer_parse_keyinfo_items(&data, &size, tmp->items, ucnt, sizeof(cfrds_sql_keyinfoitem)))
+    if (!cfrds_buffer_parse_keyinfo_items(&ctx, &data, &size, tmp->items, ucnt))
     {
-        for (size_t c = 0; c < tmp->cnt; c++)
-        {
-            free(tmp->items[c].pkTableCatalog);
-            free(tmp->items[c].pkTableOwner);
-            free(tmp->items[c].pkTableName);
-            free(tmp->items[c].pkColName);
-            free(tmp->items[c].fkTableCatalog);
-            free(tmp->items[c].fkTableOwner);
-            free(tmp->items[c].fkTableName);
-            free(tmp->items[c].fkColName);
-        }
-        free(tmp);
+        cfrds_arena_free(tmp->arena);
         return NULL;
     }
 
-    ret = tmp;
-    return ret;
+    cfrds_result_finish(&ctx);
+
+    return tmp;
 }
 
 cfrds_sql_foreignkeys *cfrds_buffer_to_sql_foreignkeys(cfrds_buffer *buffer)
@@ -1093,14 +1779,23 @@ cfrds_sql_exportedkeys *cfrds_buffer_to_sql_exportedkeys(cfrds_buffer *buffer)
     return (cfrds_sql_exportedkeys *)cfrds_buffer_to_sql_keyinfo(buffer);
 }
 
+/* Header fields kept as views while the column count is learned; wider headers resume parsing in place. */
+#define CFRDS_SQLSTMNT_HEADER_VIEWS 64
+
 cfrds_sql_resultset *cfrds_buffer_to_sql_sqlstmnt(cfrds_buffer *buffer)
 {
     cfrds_sql_resultset *ret = NULL;
 
     cfrds_sql_resultset_defer(tmp);
+    cfrds_result_ctx ctx;
+    struct {
+        const char *str;
+        size_t len;
+    } header[CFRDS_SQLSTMNT_HEADER_VIEWS];
+    const char *header_rest = NULL;
+    size_t header_rest_size = 0;
     int64_t cnt = 0;
-    int64_t cols = 0;
-    int64_t rows = 0;
+    size_t cols = 0;
     size_t buf_size = 0;
 
     if (buffer == NULL)
@@ -1115,24 +1810,28 @@ cfrds_sql_resultset *cfrds_buffer_to_sql_sqlstmnt(cfrds_buffer *buffer)
     if (cnt < 1 || cnt > CFRDS_MAX_PARSER_ITEMS)
         return NULL;
 
-    const char *response_start_data = response_data;
-    size_t response_start_size = response_size;
+    const char *header_row = NULL;
+    size_t header_size = 0;
+    if (!cfrds_buffer_parse_row(&response_data, &response_size, &header_row, &header_size))
+        return NULL;
 
-    rows = cnt - 1;
+    const char *row_walker = header_row;
+    size_t row_size = header_size;
+    while(row_size)
     {
-        cfrds_str_defer(col_row);
-        if (!cfrds_buffer_parse_string(&response_data, &response_size, &col_row))
+        const char *field = NULL;
+        size_t field_len = 0;
+        if (!cfrds_buffer_parse_list_view(&row_walker, &row_size, &field, &field_len))
             return NULL;
 
-        const char *row_walker = col_row;
-        size_t row_size = strlen(row_walker);
-        while(row_size)
+        if (cols < CFRDS_SQLSTMNT_HEADER_VIEWS)
         {
-            cfrds_str_defer(field);
-            if (!cfrds_buffer_parse_string_list_item(&row_walker, &row_size, &field))
-                return NULL;
-            cols++;
+            header[cols].str = field;
+            header[cols].len = field_len;
+            header_rest = row_walker;
+            header_rest_size = row_size;
         }
+        cols++;
     }
 
     if (cols < 1)
@@ -1140,50 +1839,257 @@ cfrds_sql_resultset *cfrds_buffer_to_sql_sqlstmnt(cfrds_buffer *buffer)
 
     size_t ucnt = (size_t)cnt;
 
-    buf_size = offsetof(cfrds_sql_resultset, values) + sizeof(char *) * ucnt * (size_t)cols;
-    tmp = malloc(buf_size);
+    if (cols > SIZE_MAX / sizeof(cfrds_str_view) / ucnt)
+        return NULL;
+
+    /* the rows, header included, become the string heap the cells point into */
+    size_t rows_size = (size_t)(response_data - header_row) + response_size;
+
+    buf_size = offsetof(cfrds_sql_resultset, values) + sizeof(cfrds_str_view) * ucnt * cols;
+    tmp = cfrds_buffer_result_create(buffer, buf_size, rows_size + _Alignof(max_align_t), &ctx);
     if (tmp == NULL)
         return NULL;
 
-    explicit_bzero(tmp, buf_size);
+    tmp->columns = cols;
+    tmp->rows = ucnt - 1;
 
-    tmp->columns = (size_t)cols;
-    tmp->rows = (size_t)rows;
+    const char *heap = cfrds_result_heap(&ctx, header_row, rows_size);
+    if (heap == NULL)
+        return NULL;
 
-    response_data = response_start_data;
-    response_size = response_start_size;
+    response_data = heap + (response_data - header_row);
+    header_rest = heap + (header_rest - header_row);
 
-    for(int64_t r = 0; r <= rows; r++)
+    cfrds_result_advance(&ctx, heap + header_size);
+    for(size_t c = 0; c < cols; c++)
     {
-        cfrds_str_defer(row);
-        if (!cfrds_buffer_parse_string(&response_data, &response_size, &row))
+        if (c < CFRDS_SQLSTMNT_HEADER_VIEWS)
+        {
+            if (!cfrds_result_field(&ctx, &tmp->values[c], heap + (header[c].str - header_row), header[c].len))
+                return NULL;
+        }
+        else if (!cfrds_result_list_item(&ctx, &header_rest, &header_rest_size, &tmp->values[c]))
+        {
             return NULL;
-        if (row == NULL)
+        }
+    }
+
+    cfrds_str_view *cell = &tmp->values[cols];
+    for(size_t r = 1; r < ucnt; r++)
+    {
+        if (!cfrds_result_row(&ctx, &response_data, &response_size, &row_walker, &row_size))
             return NULL;
-        const char *row_walker = row;
-        size_t row_size = strlen(row_walker);
 
-        for(int64_t c = 0; c < cols; c++)
+        for(size_t c = 0; c < cols; c++)
         {
-            char *field = NULL;
-
-            if (!cfrds_buffer_parse_string_list_item(&row_walker, &row_size, &field))
+            if (!cfrds_result_list_item(&ctx, &row_walker, &row_size, cell++))
                 return NULL;
-
-            tmp->values[r * cols + c] = field;
         }
     }
 
+    cfrds_result_finish(&ctx);
+
     ret = tmp; tmp = NULL;
 
     return ret;
 }
 
+bool cfrds_buffer_split_row(char *row, size_t size, cfrds_str_view *fields, size_t max, size_t *cnt)
+{
+    const char *walker = row;
+    size_t remaining = row ? strnlen(row, size) : 0;
+    size_t count = 0;
+
+    while (remaining)
+    {
+        const char *field = NULL;
+        size_t field_len = 0;
+
+        if ((count >= max)||(!cfrds_buffer_parse_list_view(&walker, &remaining, &field, &field_len)))
+            return false;
+
+        if (fields)
+        {
+            /* the separator or closing quote was consumed, the row keeps no other use for it */
+            fields[count].str = row + (field - row);
+            fields[count].len = field_len;
+            fields[count].str[field_len] = '\0';
+        }
+        count++;
+    }
+
+    *cnt = count;
+
+    return true;
+}
+
+/* ASCII case-insensitive comparison of a view with a NUL-terminated word. */
+static bool cfrds_view_equals_nocase(const cfrds_str_view *view, const char *word)
+{
+    size_t len = strlen(word);
+
+    if (view->len != len)
+        return false;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        char ch = view->str[i];
+        if ((ch >= 'a')&&(ch <= 'z'))
+            ch = (char)(ch - 'a' + 'A');
+        if (ch != word[i])
+            return false;
+    }
+
+    return true;
+}
+
+/* Column storage for a metadata jtype, given as a java.sql.Types code or name. */
+static cfrds_sql_column_type cfrds_sql_column_type_from_jtype(const cfrds_str_view *jtype)
+{
+    static const struct {
+        const char *name;
+        long code;
+        cfrds_sql_column_type type;
+    } types[] = {
+        { "BIT",      -7, CFRDS_SQL_COLUMN_BOOL },
+        { "BOOLEAN",  16, CFRDS_SQL_COLUMN_BOOL },
+        { "TINYINT",  -6, CFRDS_SQL_COLUMN_INT64 },
+        { "SMALLINT",  5, CFRDS_SQL_COLUMN_INT64 },
+        { "INTEGER",   4, CFRDS_SQL_COLUMN_INT64 },
+        { "BIGINT",   -5, CFRDS_SQL_COLUMN_INT64 },
+        { "FLOAT",     6, CFRDS_SQL_COLUMN_DOUBLE },
+        { "REAL",      7, CFRDS_SQL_COLUMN_DOUBLE },
+        { "DOUBLE",    8, CFRDS_SQL_COLUMN_DOUBLE },
+        { "NUMERIC",   2, CFRDS_SQL_COLUMN_DOUBLE },
+        { "DECIMAL",   3, CFRDS_SQL_COLUMN_DOUBLE },
+    };
+    char *end = NULL;
+
+    if (jtype->len == 0)
+        return CFRDS_SQL_COLUMN_TEXT;
+
+    long code = strtol(jtype->str, &end, 10);
+    bool numeric = (end == jtype->str + jtype->len);
+
+    for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++)
+    {
+        if (numeric ? (code == types[i].code) : cfrds_view_equals_nocase(jtype, types[i].name))
+            return types[i].type;
+    }
+
+    return CFRDS_SQL_COLUMN_TEXT;
+}
+
+/* Converts one cell of a typed column, false leaves it NULL. Cells are NUL-terminated. */
+static bool cfrds_sql_cell_convert(cfrds_sql_column_type type, const cfrds_str_view *cell, void *values, size_t row)
+{
+    char *end = NULL;
+
+    if ((cell->len == 0)||(cfrds_view_equals_nocase(cell, "NULL")))
+        return false;
+
+    switch (type)
+    {
+    case CFRDS_SQL_COLUMN_INT64:
+    {
+        errno = 0;
+        long long number = strtoll(cell->str, &end, 10);
+        if ((errno != 0)||(end != cell->str + cell->len))
+            return false;
+        ((int64_t *)values)[row] = (int64_t)number;
+        return true;
+    }
+    case CFRDS_SQL_COLUMN_DOUBLE:
+    {
+        errno = 0;
+        double number = strtod(cell->str, &end);
+        if ((errno != 0)||(end != cell->str + cell->len))
+            return false;
+        ((double *)values)[row] = number;
+        return true;
+    }
+    case CFRDS_SQL_COLUMN_BOOL:
+        if ((cfrds_view_equals_nocase(cell, "1"))||(cfrds_view_equals_nocase(cell, "TRUE"))||(cfrds_view_equals_nocase(cell, "YES")))
+            ((bool *)values)[row] = true;
+        else if ((cfrds_view_equals_nocase(cell, "0"))||(cfrds_view_equals_nocase(cell, "FALSE"))||(cfrds_view_equals_nocase(cell, "NO")))
+            ((bool *)values)[row] = false;
+        else
+            return false;
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool cfrds_sql_resultset_make_columnar(cfrds_sql_resultset *value, const cfrds_sql_metadata *metadata)
+{
+    static const size_t value_size[] = {
+        [CFRDS_SQL_COLUMN_INT64] = sizeof(int64_t),
+        [CFRDS_SQL_COLUMN_DOUBLE] = sizeof(double),
+        [CFRDS_SQL_COLUMN_BOOL] = sizeof(bool),
+    };
+
+    if (value == NULL)
+        return false;
+
+    if ((metadata)&&(metadata->cnt != value->columns))
+        return false;
+
+    size_t cols = value->columns;
+    size_t rows = value->rows;
+
+    cfrds_sql_column *columns = cfrds_arena_alloc(value->arena, sizeof(cfrds_sql_column) * cols);
+    if (columns == NULL)
+        return false;
+
+    for (size_t c = 0; c < cols; c++)
+    {
+        cfrds_sql_column *column = &columns[c];
+        const cfrds_str_view *cells = &value->values[cols + c];
+        size_t heap_size = 0;
+
+        for (size_t r = 0; r < rows; r++)
+            heap_size += cells[r * cols].len;
+
+        column->offsets = cfrds_arena_alloc(value->arena, sizeof(size_t) * (rows + 1));
+        column->heap = cfrds_arena_alloc(value->arena, heap_size + 1);
+        if ((column->offsets == NULL)||(column->heap == NULL))
+            return false;
+
+        for (size_t r = 0; r < rows; r++)
+        {
+            const cfrds_str_view *cell = &cells[r * cols];
+            memcpy(column->heap + column->offsets[r], cell->str, cell->len);
+            column->offsets[r + 1] = column->offsets[r] + cell->len;
+        }
+
+        column->type = metadata ? cfrds_sql_column_type_from_jtype(&metadata->items[c].jtype) : CFRDS_SQL_COLUMN_TEXT;
+        if (column->type == CFRDS_SQL_COLUMN_TEXT)
+            continue;
+
+        column->nulls = cfrds_arena_alloc(value->arena, (rows + 7) / 8);
+        column->values = cfrds_arena_alloc(value->arena, value_size[column->type] * rows);
+        if ((column->nulls == NULL)||(column->values == NULL))
+            return false;
+
+        for (size_t r = 0; r < rows; r++)
+        {
+            if (!cfrds_sql_cell_convert(column->type, &cells[r * cols], column->values, r))
+                column->nulls[r / 8] |= (uint8_t)(1u << (r % 8));
+        }
+    }
+
+    value->column_data = columns;
+
+    return true;
+}
+
 cfrds_sql_metadata *cfrds_buffer_to_sql_metadata(cfrds_buffer *buffer)
 {
     cfrds_sql_metadata *ret = NULL;
 
     cfrds_sql_metadata_defer(tmp);
+    cfrds_result_ctx ctx;
     int64_t cnt = 0;
     size_t buf_size = 0;
 
@@ -1201,38 +2107,32 @@ cfrds_sql_metadata *cfrds_buffer_to_sql_metadata(cfrds_buffer *buffer)
 
     size_t ucnt = (size_t)cnt;
     buf_size = offsetof(cfrds_sql_metadata, items) + sizeof(cfrds_sql_metadataitem) * ucnt;
-    tmp = malloc(buf_size);
+    tmp = cfrds_buffer_result_create(buffer, buf_size, response_size, &ctx);
     if (tmp == NULL)
         return NULL;
 
-    explicit_bzero(tmp, buf_size);
-
     tmp->cnt = ucnt;
 
     for(int64_t c = 0; c < cnt; c++)
     {
-        char *field = NULL;
-        cfrds_str_defer(row);
+        const char *row_walker = NULL;
+        size_t row_size = 0;
 
-        if (!cfrds_buffer_parse_string(&response_data, &response_size, &row))
+        if (!cfrds_result_row(&ctx, &response_data, &response_size, &row_walker, &row_size))
             return NULL;
 
-        const char *row_walker = row;
-        size_t row_size = strlen(row_walker);
-
-        if (!cfrds_buffer_parse_string_list_item(&row_walker, &row_size, &field))
+        if (!cfrds_result_list_item(&ctx, &row_walker, &row_size, &tmp->items[c].name))
             return NULL;
-        tmp->items[c].name = field;
 
-        if (!cfrds_buffer_parse_string_list_item(&row_walker, &row_size, &field))
+        if (!cfrds_result_list_item(&ctx, &row_walker, &row_size, &tmp->items[c].type))
             return NULL;
-        tmp->items[c].type = field;
 
-        if (!cfrds_buffer_parse_string_list_item(&row_walker, &row_size, &field))
+        if (!cfrds_result_list_item(&ctx, &row_walker, &row_size, &tmp->items[c].jtype))
             return NULL;
-        tmp->items[c].jtype = field;
     }
 
+    cfrds_result_finish(&ctx);
+
     ret = tmp; tmp = NULL;
 
     return ret;
@@ -1243,6 +2143,7 @@ cfrds_sql_supportedcommands *cfrds_buffer_to_sql_supportedcommands(cfrds_buffer
     cfrds_sql_supportedcommands *ret = NULL;
 
     cfrds_sql_supportedcommands_defer(tmp);
+    cfrds_result_ctx ctx;
 
     int64_t rows = 0;
     int64_t row_size = 0;
@@ -1272,31 +2173,29 @@ cfrds_sql_supportedcommands *cfrds_buffer_to_sql_supportedcommands(cfrds_buffer
         size_t start_size = size - 1;
         while(start_size)
         {
-            cfrds_str_defer(field);
-            if (!cfrds_buffer_parse_string_list_item(&start_data, &start_size, &field))
+            const char *field = NULL;
+            size_t field_len = 0;
+            if (!cfrds_buffer_parse_list_view(&start_data, &start_size, &field, &field_len))
                 return NULL;
             cnt++;
         }
     }
 
-    buf_size = offsetof(cfrds_sql_supportedcommands, commands) + sizeof(char *) * cnt;
-    tmp = malloc(buf_size);
+    buf_size = offsetof(cfrds_sql_supportedcommands, commands) + sizeof(cfrds_str_view) * cnt;
+    tmp = cfrds_buffer_result_create(buffer, buf_size, size, &ctx);
     if (tmp == NULL)
         return NULL;
 
-    explicit_bzero(tmp, buf_size);
-
     tmp->cnt = cnt;
 
     for(size_t c = 0; c < cnt; c++)
     {
-        char *field = NULL;
-
-        if (!cfrds_buffer_parse_string_list_item(&data, &size, &field))
+        if (!cfrds_result_list_item(&ctx, &data, &size, &tmp->commands[c]))
             return NULL;
-        tmp->commands[c] = field;
     }
 
+    cfrds_result_finish(&ctx);
+
     ret = tmp; tmp = NULL;
 
     return ret;
@@ -1311,7 +2210,8 @@ char *cfrds_buffer_to_sql_dbdescription(cfrds_buffer *buffer)
     char *ret = NULL;
 
     int64_t rows = 0;
-    cfrds_str_defer(row);
+    const char *row = NULL;
+    size_t row_size = 0;
 
     const char *data = (const char *)buffer->data;
     size_t size = buffer->size;
@@ -1321,13 +2221,10 @@ char *cfrds_buffer_to_sql_dbdescription(cfrds_buffer *buffer)
     if (rows != 1)
         return NULL;
 
-    if (!cfrds_buffer_parse_string(&data, &size, &row))
+    if (!cfrds_buffer_parse_row(&data, &size, &row, &row_size))
         return NULL;
 
-    data = row;
-    size = strlen(data);
-
-    if (!cfrds_buffer_parse_string_list_item(&data, &size, &ret))
+    if (!cfrds_buffer_parse_string_list_item(&row, &row_size, &ret))
         return NULL;
 
     return ret;
@@ -1378,7 +2275,7 @@ bool cfrds_buffer_to_debugger_stop(cfrds_buffer *buffer)
 
         result = wddx_from_xml(xml);
 
-        const char *status = wddx_get_string(result, "0,STATUS");
+        const char *status = wddx_get_string_compiled(result, wddx_path_static(&path_status, "0,STATUS"));
         if (status == NULL)
             return false;
 
@@ -1414,11 +2311,11 @@ int cfrds_buffer_to_debugger_info(cfrds_buffer *buffer)
 
         result = wddx_from_xml(ret);
 
-        const char *status = wddx_get_string(result, "0,STATUS");
+        const char *status = wddx_get_string_compiled(result, wddx_path_static(&path_status, "0,STATUS"));
         if ((status == NULL)||(strcmp(status, "RDS_OK") != 0))
             return -1;
 
-        return (int)wddx_get_number(result, "0,DEBUG_SERVER_PORT", NULL);
+        return (int)wddx_get_number_compiled(result, wddx_path_static(&path_debug_server_port, "0,DEBUG_SERVER_PORT"), NULL);
     }
 
     return -1;
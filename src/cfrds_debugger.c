@@ -10,6 +10,21 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+/* Paths into the WDDX packets, compiled on first use by wddx_path_static() */
+static wddx_path *path_event;
+static wddx_path *path_source;
+static wddx_path *path_line;
+static wddx_path *path_scopes;
+static wddx_path *path_thread;
+static wddx_path *path_cfml_path;
+static wddx_path *path_req_line_num;
+static wddx_path *path_actual_line_num;
+static wddx_path *path_threads;
+static wddx_path *path_watch;
+static wddx_path *path_cf_trace;
+static wddx_path *path_java_trace;
+static wddx_path *path_value;
+
 void cfrds_debugger_event_free(cfrds_debugger_event *event)
 {
     wddx_cleanup(&event);
@@ -22,7 +37,7 @@ cfrds_debugger_type cfrds_debugger_event_get_type(const cfrds_debugger_event *ev
         return CFRDS_DEBUGGER_EVENT_UNKNOWN;
     }
 
-    const char *event_name = wddx_get_string(event, "0,EVENT");
+    const char *event_name = wddx_get_string_compiled(event, wddx_path_static(&path_event, "0,EVENT"));
 
     if (event_name == NULL)
         return CFRDS_DEBUGGER_EVENT_UNKNOWN;
@@ -39,42 +54,42 @@ cfrds_debugger_type cfrds_debugger_event_get_type(const cfrds_debugger_event *ev
 
 const char *cfrds_debugger_event_breakpoint_get_source(const cfrds_debugger_event *event)
 {
-    return wddx_get_string(event, "0,SOURCE");
+    return wddx_get_string_compiled(event, wddx_path_static(&path_source, "0,SOURCE"));
 }
 
 int cfrds_debugger_event_breakpoint_get_line(const cfrds_debugger_event *event)
 {
-    return (int)wddx_get_number(event, "0,LINE", NULL);
+    return (int)wddx_get_number_compiled(event, wddx_path_static(&path_line, "0,LINE"), NULL);
 }
 
 const cfrds_variable *cfrds_debugger_event_breakpoint_get_scopes(const cfrds_debugger_event *event)
 {
-    return wddx_get_var(event, "0,SCOPES");
+    return wddx_get_var_compiled(event, wddx_path_static(&path_scopes, "0,SCOPES"));
 }
 
 const char *cfrds_debugger_event_breakpoint_get_thread_name(const cfrds_debugger_event *event)
 {
-    return wddx_get_string(event, "0,THREAD");
+    return wddx_get_string_compiled(event, wddx_path_static(&path_thread, "0,THREAD"));
 }
 
 const char *cfrds_debugger_event_breakpoint_set_get_pathname(const cfrds_debugger_event *event)
 {
-    return wddx_get_string(event, "0,CFML_PATH");
+    return wddx_get_string_compiled(event, wddx_path_static(&path_cfml_path, "0,CFML_PATH"));
 }
 
 int cfrds_debugger_event_breakpoint_set_get_req_line(const cfrds_debugger_event *event)
 {
-    return (int)wddx_get_number(event, "0,REQ_LINE_NUM", NULL);
+    return (int)wddx_get_number_compiled(event, wddx_path_static(&path_req_line_num, "0,REQ_LINE_NUM"), NULL);
 }
 
 int cfrds_debugger_event_breakpoint_set_get_act_line(const cfrds_debugger_event *event)
 {
-    return (int)wddx_get_number(event, "0,ACTUAL_LINE_NUM", NULL);
+    return (int)wddx_get_number_compiled(event, wddx_path_static(&path_actual_line_num, "0,ACTUAL_LINE_NUM"), NULL);
 }
 
 int cfrds_debugger_event_get_scopes_count(const cfrds_debugger_event *event)
 {
-    return wddx_node_array_size(wddx_get_var(event, "0,SCOPES"));
+    return wddx_node_array_size(wddx_get_var_compiled(event, wddx_path_static(&path_scopes, "0,SCOPES")));
 }
 
 const char *cfrds_debugger_event_get_scopes_item(const cfrds_debugger_event *event, size_t ndx)
@@ -82,7 +97,7 @@ const char *cfrds_debugger_event_get_scopes_item(const cfrds_debugger_event *eve
     if (event == NULL)
         return NULL;
 
-    const WDDX_NODE *array_node = wddx_get_var(event, "0,SCOPES");
+    const WDDX_NODE *array_node = wddx_get_var_compiled(event, wddx_path_static(&path_scopes, "0,SCOPES"));
     const WDDX_NODE *item = wddx_node_array_at(array_node, ndx);
 
     if (wddx_node_type(item) != WDDX_STRING)
@@ -93,7 +108,7 @@ const char *cfrds_debugger_event_get_scopes_item(const cfrds_debugger_event *eve
 
 int cfrds_debugger_event_get_threads_count(const cfrds_debugger_event *event)
 {
-    return wddx_node_array_size(wddx_get_var(event, "0,THREADS"));
+    return wddx_node_array_size(wddx_get_var_compiled(event, wddx_path_static(&path_threads, "0,THREADS")));
 }
 
 const char *cfrds_debugger_event_get_threads_item(const cfrds_debugger_event *event, size_t ndx)
@@ -101,7 +116,7 @@ const char *cfrds_debugger_event_get_threads_item(const cfrds_debugger_event *ev
     if (event == NULL)
         return NULL;
 
-    const WDDX_NODE *array_node = wddx_get_var(event, "0,THREADS");
+    const WDDX_NODE *array_node = wddx_get_var_compiled(event, wddx_path_static(&path_threads, "0,THREADS"));
     const WDDX_NODE *item = wddx_node_array_at(array_node, ndx);
 
     if (wddx_node_type(item) != WDDX_STRING)
@@ -112,7 +127,7 @@ const char *cfrds_debugger_event_get_threads_item(const cfrds_debugger_event *ev
 
 int cfrds_debugger_event_get_watch_count(const cfrds_debugger_event *event)
 {
-    return wddx_node_array_size(wddx_get_var(event, "0,WATCH"));
+    return wddx_node_array_size(wddx_get_var_compiled(event, wddx_path_static(&path_watch, "0,WATCH")));
 }
 
 const char *cfrds_debugger_event_get_watch_item(const cfrds_debugger_event *event, size_t ndx)
@@ -120,7 +135,7 @@ const char *cfrds_debugger_event_get_watch_item(const cfrds_debugger_event *even
     if (event == NULL)
         return NULL;
 
-    const WDDX_NODE *array_node = wddx_get_var(event, "0,WATCH");
+    const WDDX_NODE *array_node = wddx_get_var_compiled(event, wddx_path_static(&path_watch, "0,WATCH"));
     const WDDX_NODE *item = wddx_node_array_at(array_node, ndx);
 
     if (wddx_node_type(item) != WDDX_STRING)
@@ -131,22 +146,19 @@ const char *cfrds_debugger_event_get_watch_item(const cfrds_debugger_event *even
 
 int cfrds_debugger_event_get_cf_trace_count(const cfrds_debugger_event *event)
 {
-    return wddx_node_array_size(wddx_get_var(event, "0,CF_TRACE"));
+    return wddx_node_array_size(wddx_get_var_compiled(event, wddx_path_static(&path_cf_trace, "0,CF_TRACE")));
 }
 
 const char *cfrds_debugger_event_get_cf_trace_item(const cfrds_debugger_event *event, size_t ndx)
 {
-    char key[32];
-    int n;
-
     if (event == NULL)
         return NULL;
 
-    n = snprintf(key, sizeof(key), "0,CF_TRACE,%zu", ndx);
-    if (n < 0)
+    const WDDX_NODE *array_node = wddx_get_var_compiled(event, wddx_path_static(&path_cf_trace, "0,CF_TRACE"));
+    if (wddx_node_type(array_node) != WDDX_ARRAY)
         return NULL;
 
-    const WDDX_NODE *node = wddx_get_var(event, key);
+    const WDDX_NODE *node = wddx_node_array_at(array_node, ndx);
 
     if (wddx_node_type(node) != WDDX_STRING)
         return NULL;
@@ -156,22 +168,19 @@ const char *cfrds_debugger_event_get_cf_trace_item(const cfrds_debugger_event *e
 
 int cfrds_debugger_event_get_java_trace_count(const cfrds_debugger_event *event)
 {
-    return wddx_node_array_size(wddx_get_var(event, "0,JAVA_TRACE"));
+    return wddx_node_array_size(wddx_get_var_compiled(event, wddx_path_static(&path_java_trace, "0,JAVA_TRACE")));
 }
 
 const char *cfrds_debugger_event_get_java_trace_item(const cfrds_debugger_event *event, size_t ndx)
 {
-    char key[32];
-    int n;
-
     if (event == NULL)
         return NULL;
 
-    n = snprintf(key, sizeof(key), "0,JAVA_TRACE,%zu", ndx);
-    if (n < 0)
+    const WDDX_NODE *array_node = wddx_get_var_compiled(event, wddx_path_static(&path_java_trace, "0,JAVA_TRACE"));
+    if (wddx_node_type(array_node) != WDDX_ARRAY)
         return NULL;
 
-    const WDDX_NODE *node = wddx_get_var(event, key);
+    const WDDX_NODE *node = wddx_node_array_at(array_node, ndx);
 
     if (wddx_node_type(node) != WDDX_STRING)
         return NULL;
@@ -205,7 +214,7 @@ cfrds_status cfrds_command_debugger_start(cfrds_server *server, cfrds_str *sessi
         *session_id = cfrds_buffer_to_debugger_start(response);
         if (*session_id == NULL)
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
     }
@@ -234,7 +243,7 @@ cfrds_status cfrds_command_debugger_stop(cfrds_server *server, const char *sessi
     {
         if (cfrds_buffer_to_debugger_stop(response) == false)
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
     }
@@ -264,7 +273,7 @@ cfrds_status cfrds_command_debugger_get_server_info(cfrds_server *server, const
         int val = cfrds_buffer_to_debugger_info(response);
         if ((val < 0) || (val > UINT16_MAX))
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
@@ -301,7 +310,7 @@ cfrds_status cfrds_command_debugger_breakpoint_on_exception(cfrds_server *server
         int val = cfrds_buffer_to_debugger_info(response);
         if (val == -1)
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
     }
@@ -337,7 +346,7 @@ static bool cfrds_buffer_to_debugger_response_ok(cfrds_buffer *buffer)
             return false;
 
         bool ok = false;
-        double val = wddx_get_number(result, "0,VALUE", &ok);
+        double val = wddx_get_number_compiled(result, wddx_path_static(&path_value, "0,VALUE"), &ok);
         if (ok && val == -1)
             return false;
 
@@ -378,7 +387,7 @@ cfrds_status cfrds_command_debugger_breakpoint(cfrds_server *server, const char
     {
         if (!cfrds_buffer_to_debugger_response_ok(response))
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
     }
@@ -411,7 +420,7 @@ cfrds_status cfrds_command_debugger_clear_all_breakpoints(cfrds_server *server,
     {
         if (!cfrds_buffer_to_debugger_response_ok(response))
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
     }
@@ -498,7 +507,7 @@ static cfrds_status cfrds_command_debugger_thread_action(cfrds_server *server, c
     {
         if (!cfrds_buffer_to_debugger_response_ok(response))
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
     }
@@ -675,19 +684,19 @@ cfrds_status cfrds_command_debugger_get_output(cfrds_server *server, const char
         int64_t count = 0;
         if (!cfrds_buffer_parse_number(&response_data, &response_size, &count))
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
         if (count != 1)
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
         if (!cfrds_buffer_parse_string(&response_data, &response_size, &xml))
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
@@ -697,11 +706,11 @@ cfrds_status cfrds_command_debugger_get_output(cfrds_server *server, const char
             result = wddx_from_xml(xml);
             if (!result)
             {
-                server->error_code = -1;
+                cfrds_server_error_ctx(server)->error_code = -1;
                 return CFRDS_STATUS_RESPONSE_ERROR;
             }
 
-            const char *val_str = wddx_get_string(result, "0,VALUE");
+            const char *val_str = wddx_get_string_compiled(result, wddx_path_static(&path_value, "0,VALUE"));
             if (val_str)
             {
                 *output = strdup(val_str);
@@ -1,12 +1,27 @@
+#include <internal/explicit_bzero.h>
 #include <internal/cfrds_buffer.h>
 #include <internal/cfrds_http.h>
 #include <internal/cfrds_int.h>
 #include <cfrds.h>
 
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <limits.h>
+#include <errno.h>
 
 cfrds_status cfrds_command_browse_dir(cfrds_server *server, const char *path, cfrds_browse_dir **out)
 {
@@ -18,7 +33,7 @@ cfrds_status cfrds_command_browse_dir(cfrds_server *server, const char *path, cf
         return CFRDS_STATUS_PARAM_IS_NULL;
     }
 
-    ret = cfrds_send_command(server, &response, "BROWSEDIR", (const char *[]){ path, "", NULL});
+    ret = cfrds_send_idempotent_command(server, &response, "BROWSEDIR", (const char *[]){ path, "", NULL});
     if (ret == CFRDS_STATUS_OK)
     {
         *out = cfrds_buffer_to_browse_dir(response);
@@ -37,7 +52,7 @@ cfrds_status cfrds_command_file_read(cfrds_server *server, const char *pathname,
         return CFRDS_STATUS_PARAM_IS_NULL;
     }
 
-    ret = cfrds_send_command(server, &response, "FILEIO", (const char *[]){ pathname, "READ", "", NULL});
+    ret = cfrds_send_idempotent_command(server, &response, "FILEIO", (const char *[]){ pathname, "READ", "", NULL});
     if (ret == CFRDS_STATUS_OK)
     {
         *out = cfrds_buffer_to_file_content(response);
@@ -46,19 +61,269 @@ cfrds_status cfrds_command_file_read(cfrds_server *server, const char *pathname,
     return ret;
 }
 
-cfrds_status cfrds_command_file_write(cfrds_server *server, const char *pathname, const void *data, size_t length)
+typedef enum {
+    CFRDS_FILE_READER_HEAD,
+    CFRDS_FILE_READER_DATA,
+    CFRDS_FILE_READER_TAIL,
+    CFRDS_FILE_READER_SERVER_ERROR
+} cfrds_file_reader_state;
+
+/* Incremental parser of a FILEIO READ response: `3:<len>:<data><len>:<modified><len>:<permission>` */
+typedef struct {
+    cfrds_file_reader_state state;
+    cfrds_buffer *head;           ///< Bytes up to the data length prefix, or the server error message.
+    uint64_t size;
+    uint64_t remaining;
+    cfrds_file_read_fn on_data;
+    void *ctx;
+    const char *error;
+} cfrds_file_reader;
+
+/* Returns 1 when a number was parsed, 0 if it is not complete yet, -1 if it is malformed. */
+static int cfrds_file_reader_number(const char **data, size_t *remaining, int64_t *out)
 {
-    cfrds_status ret = CFRDS_STATUS_OK;
+    if (memchr(*data, ':', *remaining) == NULL)
+        return (*remaining < 24) ? 0 : -1;
+
+    return cfrds_buffer_parse_number(data, remaining, out) ? 1 : -1;
+}
+
+static cfrds_status cfrds_file_reader_data(cfrds_file_reader *reader, const char *data, size_t size)
+{
+    size_t n = (reader->remaining < size) ? (size_t)reader->remaining : size;
+
+    if (n > 0)
+    {
+        cfrds_status status = reader->on_data(reader->ctx, data, n);
+        if (status != CFRDS_STATUS_OK)
+        {
+            reader->error = "file read aborted by the data callback";
+            return status;
+        }
 
+        reader->remaining -= n;
+    }
+
+    /* modified time and permissions follow the data, they are not reported */
+    if (reader->remaining == 0)
+        reader->state = CFRDS_FILE_READER_TAIL;
+
+    return CFRDS_STATUS_OK;
+}
+
+static cfrds_status cfrds_file_reader_feed(void *ctx, const char *data, size_t size)
+{
+    cfrds_file_reader *reader = ctx;
+
+    switch (reader->state)
+    {
+    case CFRDS_FILE_READER_HEAD:
+        /* buffer the prefix one number at a time, the bytes after it are already file data */
+        while ((reader->state == CFRDS_FILE_READER_HEAD)&&(size > 0))
+        {
+            const char *colon = memchr(data, ':', size);
+            size_t take = colon ? (size_t)(colon - data) + 1 : size;
+
+            if (cfrds_buffer_data_size(reader->head) + take > CFRDS_MAX_HEADER_SIZE)
+            {
+                reader->error = "invalid file read response";
+                return CFRDS_STATUS_RESPONSE_ERROR;
+            }
+
+            if (!cfrds_buffer_append_bytes(reader->head, data, take))
+                return CFRDS_STATUS_MEMORY_ERROR;
+
+            data += take;
+            size -= take;
+
+            const char *head = cfrds_buffer_data(reader->head);
+            size_t remaining = cfrds_buffer_data_size(reader->head);
+            int64_t cnt = 0;
+            int64_t len = 0;
+
+            int res = cfrds_file_reader_number(&head, &remaining, &cnt);
+            if (res == 0)
+                continue;
+
+            if ((res > 0)&&(cnt < 0))
+            {
+                reader->state = CFRDS_FILE_READER_SERVER_ERROR;
+                break;
+            }
+
+            if ((res < 0)||(cnt != 3))
+            {
+                reader->error = "invalid file read response";
+                return CFRDS_STATUS_RESPONSE_ERROR;
+            }
+
+            res = cfrds_file_reader_number(&head, &remaining, &len);
+            if (res == 0)
+                continue;
+
+            if ((res < 0)||(len < 0))
+            {
+                reader->error = "invalid file read response";
+                return CFRDS_STATUS_RESPONSE_ERROR;
+            }
+
+            reader->size = (uint64_t)len;
+            reader->remaining = (uint64_t)len;
+            reader->state = CFRDS_FILE_READER_DATA;
+
+            return cfrds_file_reader_data(reader, data, size);
+        }
+
+        if (reader->state != CFRDS_FILE_READER_SERVER_ERROR)
+            break;
+        /* fall through: the rest is the error message */
+    case CFRDS_FILE_READER_SERVER_ERROR:
+        /* keep the beginning of the error message */
+        if (cfrds_buffer_data_size(reader->head) + size > CFRDS_MAX_HEADER_SIZE)
+            size = CFRDS_MAX_HEADER_SIZE - cfrds_buffer_data_size(reader->head);
+
+        if (!cfrds_buffer_append_bytes(reader->head, data, size))
+            return CFRDS_STATUS_MEMORY_ERROR;
+        break;
+    case CFRDS_FILE_READER_DATA:
+        return cfrds_file_reader_data(reader, data, size);
+    case CFRDS_FILE_READER_TAIL:
+        break;
+    }
+
+    return CFRDS_STATUS_OK;
+}
+
+cfrds_status cfrds_command_file_read_stream(cfrds_server *server, const char *pathname, cfrds_file_read_fn on_data, void *ctx, size_t *size)
+{
     cfrds_buffer_defer(post);
-    size_t total_cnt = 0;
+    cfrds_buffer_defer(head);
+    cfrds_file_reader reader;
+    cfrds_status ret;
 
-    if ((server == NULL)||(pathname == NULL)||((data == NULL)&&(length > 0)))
+    if ((server == NULL)||(pathname == NULL)||(on_data == NULL))
     {
         return CFRDS_STATUS_PARAM_IS_NULL;
     }
 
-    server->_errno = 0;
+    cfrds_server_error_ctx(server)->_errno = 0;
+
+    cfrds_server_clear_error(server);
+
+    ret = cfrds_build_command_payload(server, (const char *[]){ pathname, "READ", "", NULL}, &post);
+    if (ret != CFRDS_STATUS_OK)
+        return ret;
+
+    if (!cfrds_buffer_create(&head))
+        return CFRDS_STATUS_MEMORY_ERROR;
+
+    explicit_bzero(&reader, sizeof(reader));
+    reader.state = CFRDS_FILE_READER_HEAD;
+    reader.head = head;
+    reader.on_data = on_data;
+    reader.ctx = ctx;
+
+    const cfrds_http_segment body = { .data = cfrds_buffer_data(post), .size = cfrds_buffer_data_size(post) };
+
+    /* nothing is buffered, so the response size limit does not apply */
+    ret = cfrds_http_post_stream(server, "FILEIO", &body, 1, UINT64_MAX, cfrds_file_reader_feed, &reader, true);
+    if ((ret != CFRDS_STATUS_OK)&&(reader.error))
+        cfrds_server_set_error(server, ret, reader.error);
+    if (ret != CFRDS_STATUS_OK)
+        return ret;
+
+    if (reader.state == CFRDS_FILE_READER_SERVER_ERROR)
+        return cfrds_http_parse_rds_status(server, head);
+
+    if ((reader.state != CFRDS_FILE_READER_TAIL)||(reader.size > SIZE_MAX))
+    {
+        cfrds_server_error_ctx(server)->error_code = -1;
+        cfrds_server_set_error(server, CFRDS_STATUS_RESPONSE_ERROR, "truncated file read response");
+        return CFRDS_STATUS_RESPONSE_ERROR;
+    }
+
+    cfrds_server_error_ctx(server)->error_code = 3;
+
+    if (size)
+        *size = (size_t)reader.size;
+
+    return CFRDS_STATUS_OK;
+}
+
+typedef struct {
+    int fd;
+    int err;
+} cfrds_file_fd_sink;
+
+static cfrds_status cfrds_file_write_to_fd(void *ctx, const void *data, size_t size)
+{
+    cfrds_file_fd_sink *sink = ctx;
+
+    while (size > 0)
+    {
+#ifdef _WIN32
+        int written = _write(sink->fd, data, (size > INT_MAX) ? INT_MAX : (unsigned int)size);
+#else
+        ssize_t written = write(sink->fd, data, size);
+#endif
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            sink->err = errno;
+            return CFRDS_STATUS_COMMAND_FAILED;
+        }
+
+        data = (const char *)data + written;
+        size -= (size_t)written;
+    }
+
+    return CFRDS_STATUS_OK;
+}
+
+cfrds_status cfrds_command_file_read_to_fd(cfrds_server *server, const char *pathname, int fd, size_t *size)
+{
+    if ((server == NULL)||(pathname == NULL))
+    {
+        return CFRDS_STATUS_PARAM_IS_NULL;
+    }
+
+    if (fd < 0)
+    {
+        return CFRDS_STATUS_INVALID_INPUT_PARAMETER;
+    }
+
+    cfrds_file_fd_sink sink = { .fd = fd, .err = 0 };
+
+    cfrds_status ret = cfrds_command_file_read_stream(server, pathname, cfrds_file_write_to_fd, &sink, size);
+    if (sink.err != 0)
+    {
+        cfrds_server_error_ctx(server)->_errno = sink.err;
+        cfrds_server_set_error(server, ret, "failed to write to the local file");
+    }
+
+    return ret;
+}
+
+static void cfrds_file_close_fd(int fd)
+{
+#ifdef _WIN32
+    _close(fd);
+#else
+    close(fd);
+#endif
+}
+
+static cfrds_status cfrds_file_write_segment(cfrds_server *server, const char *pathname, const cfrds_http_segment *content)
+{
+    cfrds_status ret = CFRDS_STATUS_OK;
+
+    cfrds_buffer_defer(post);
+    cfrds_buffer_defer(post_tail);
+    size_t total_cnt = 0;
+
+    cfrds_server_error_ctx(server)->_errno = 0;
 
     total_cnt = 4;
 
@@ -67,7 +332,7 @@ cfrds_status cfrds_command_file_write(cfrds_server *server, const char *pathname
 
     cfrds_server_clear_error(server);
 
-    if (!cfrds_buffer_create(&post))
+    if ((!cfrds_buffer_create(&post))||(!cfrds_buffer_create(&post_tail)))
         return CFRDS_STATUS_MEMORY_ERROR;
 
     if (!cfrds_buffer_append_rds_count(post, total_cnt))
@@ -78,15 +343,105 @@ cfrds_status cfrds_command_file_write(cfrds_server *server, const char *pathname
         return CFRDS_STATUS_MEMORY_ERROR;
     if (!cfrds_buffer_append_rds_string(post, ""))
         return CFRDS_STATUS_MEMORY_ERROR;
-    if (!cfrds_buffer_append_rds_bytes(post, data, length))
+    if (!cfrds_buffer_append_rds_bytes_prefix(post, content->size))
         return CFRDS_STATUS_MEMORY_ERROR;
 
-    if (server->username && !cfrds_buffer_append_rds_string(post, server->username))
+    if (server->username && !cfrds_buffer_append_rds_string(post_tail, server->username))
         return CFRDS_STATUS_MEMORY_ERROR;
-    if (server->password && !cfrds_buffer_append_rds_string(post, server->password))
+    if (server->password && !cfrds_buffer_append_rds_string(post_tail, server->password))
         return CFRDS_STATUS_MEMORY_ERROR;
 
-    ret = cfrds_http_post(server, "FILEIO", post, NULL);
+    /* the file contents are sent straight from the caller's memory or file */
+    const cfrds_http_segment body[] = {
+        { .data = cfrds_buffer_data(post), .size = cfrds_buffer_data_size(post) },
+        *content,
+        { .data = cfrds_buffer_data(post_tail), .size = cfrds_buffer_data_size(post_tail) },
+    };
+
+    ret = cfrds_http_post_segments(server, "FILEIO", body, sizeof(body) / sizeof(body[0]), false, NULL);
+
+    return ret;
+}
+
+cfrds_status cfrds_command_file_write(cfrds_server *server, const char *pathname, const void *data, size_t length)
+{
+    if ((server == NULL)||(pathname == NULL)||((data == NULL)&&(length > 0)))
+    {
+        return CFRDS_STATUS_PARAM_IS_NULL;
+    }
+
+    const cfrds_http_segment content = { .data = (length > 0) ? data : "", .size = length };
+
+    return cfrds_file_write_segment(server, pathname, &content);
+}
+
+cfrds_status cfrds_command_file_write_fd(cfrds_server *server, const char *pathname, int fd, size_t length)
+{
+    if ((server == NULL)||(pathname == NULL))
+    {
+        return CFRDS_STATUS_PARAM_IS_NULL;
+    }
+
+    if (fd < 0)
+    {
+        return CFRDS_STATUS_INVALID_INPUT_PARAMETER;
+    }
+
+#ifdef _WIN32
+    __int64 pos = _lseeki64(fd, 0, SEEK_CUR);
+#else
+    off_t pos = lseek(fd, 0, SEEK_CUR);
+#endif
+    if (pos < 0)
+    {
+        cfrds_server_error_ctx(server)->_errno = errno;
+        cfrds_server_set_error(server, CFRDS_STATUS_INVALID_INPUT_PARAMETER, "source file is not seekable");
+        return CFRDS_STATUS_INVALID_INPUT_PARAMETER;
+    }
+
+    const cfrds_http_segment content = { .data = NULL, .size = length, .fd = fd, .file_offset = (uint64_t)pos };
+
+    return cfrds_file_write_segment(server, pathname, &content);
+}
+
+cfrds_status cfrds_command_file_write_from_path(cfrds_server *server, const char *pathname, const char *local_path)
+{
+    cfrds_status ret;
+
+    if ((server == NULL)||(pathname == NULL)||(local_path == NULL))
+    {
+        return CFRDS_STATUS_PARAM_IS_NULL;
+    }
+
+#ifdef _WIN32
+    struct _stat64 st;
+    int fd = _open(local_path, _O_RDONLY | _O_BINARY);
+#else
+    struct stat st;
+    int fd = open(local_path, O_RDONLY | O_CLOEXEC);
+#endif
+    if (fd < 0)
+    {
+        cfrds_server_error_ctx(server)->_errno = errno;
+        cfrds_server_set_error(server, CFRDS_STATUS_INVALID_INPUT_PARAMETER, "failed to open source file");
+        return CFRDS_STATUS_INVALID_INPUT_PARAMETER;
+    }
+
+#ifdef _WIN32
+    if ((_fstat64(fd, &st) != 0)||(st.st_size < 0))
+#else
+    if ((fstat(fd, &st) != 0)||(!S_ISREG(st.st_mode)))
+#endif
+    {
+        cfrds_server_error_ctx(server)->_errno = errno;
+        cfrds_file_close_fd(fd);
+        cfrds_server_set_error(server, CFRDS_STATUS_INVALID_INPUT_PARAMETER, "source is not a regular file");
+        return CFRDS_STATUS_INVALID_INPUT_PARAMETER;
+    }
+
+    ret = cfrds_command_file_write_fd(server, pathname, fd, (size_t)st.st_size);
+
+    cfrds_file_close_fd(fd);
 
     return ret;
 }
@@ -137,16 +492,18 @@ cfrds_status cfrds_command_file_exists(cfrds_server *server, const char *pathnam
 
     static const char response_file_not_found_start[] = "The system cannot find the path specified: ";
 
-    ret = cfrds_send_command(server, NULL, "FILEIO", (const char *[]){ pathname, "EXISTENCE", "", "", NULL});
+    ret = cfrds_send_idempotent_command(server, NULL, "FILEIO", (const char *[]){ pathname, "EXISTENCE", "", "", NULL});
     if (ret == CFRDS_STATUS_OK)
     {
         *out = true;
     } else {
-        if ((server->error_code == -1)&&(server->error)&&(strncmp(server->error, response_file_not_found_start, strlen(response_file_not_found_start)) == 0))
+        cfrds_error_ctx *ctx = cfrds_server_error_ctx(server);
+
+        if ((ctx->error_code == -1)&&(ctx->error)&&(strncmp(ctx->error, response_file_not_found_start, strlen(response_file_not_found_start)) == 0))
         {
-            server->error_code = 1;
-            free(server->error);
-            server->error = NULL;
+            ctx->error_code = 1;
+            free(ctx->error);
+            ctx->error = NULL;
 
             *out = false;
 
@@ -178,24 +535,95 @@ cfrds_status cfrds_command_file_get_root_dir(cfrds_server *server, cfrds_str *ou
         return CFRDS_STATUS_PARAM_IS_NULL;
     }
 
-    ret = cfrds_send_command(server, &response, "FILEIO", (const char *[]){ "", "CF_DIRECTORY", NULL});
+    ret = cfrds_send_idempotent_command(server, &response, "FILEIO", (const char *[]){ "", "CF_DIRECTORY", NULL});
     if (ret == CFRDS_STATUS_OK)
     {
         const char *response_data = cfrds_buffer_data(response);
         size_t response_size = cfrds_buffer_data_size(response);
 
-        if (!cfrds_buffer_parse_number(&response_data, &response_size, &server->error_code))
+        if (!cfrds_buffer_parse_number(&response_data, &response_size, &cfrds_server_error_ctx(server)->error_code))
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
         if (!cfrds_buffer_parse_string(&response_data, &response_size, out))
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
     }
 
     return ret;
 }
+
+static void *cfrds_buffer_to_root_dir(cfrds_buffer *buffer)
+{
+    const char *response_data = cfrds_buffer_data(buffer);
+    size_t response_size = cfrds_buffer_data_size(buffer);
+    int64_t cnt = 0;
+    char *ret = NULL;
+
+    if (!cfrds_buffer_parse_number(&response_data, &response_size, &cnt))
+        return NULL;
+
+    if (!cfrds_buffer_parse_string(&response_data, &response_size, &ret))
+        return NULL;
+
+    return ret;
+}
+
+cfrds_status cfrds_loop_submit_browse_dir(cfrds_loop *loop, cfrds_server *server, const char *path, cfrds_loop_done_fn done, void *ctx)
+{
+    if ((server == NULL)||(path == NULL))
+    {
+        return CFRDS_STATUS_PARAM_IS_NULL;
+    }
+
+    return cfrds_loop_submit(loop, server, "BROWSEDIR", (const char *[]){ path, "", NULL}, true, (cfrds_sql_parser_fn)cfrds_buffer_to_browse_dir, done, ctx);
+}
+
+cfrds_status cfrds_loop_submit_file_read(cfrds_loop *loop, cfrds_server *server, const char *pathname, cfrds_loop_done_fn done, void *ctx)
+{
+    if ((server == NULL)||(pathname == NULL))
+    {
+        return CFRDS_STATUS_PARAM_IS_NULL;
+    }
+
+    return cfrds_loop_submit(loop, server, "FILEIO", (const char *[]){ pathname, "READ", "", NULL}, true, (cfrds_sql_parser_fn)cfrds_buffer_to_file_content, done, ctx);
+}
+
+cfrds_status cfrds_loop_submit_file_get_root_dir(cfrds_loop *loop, cfrds_server *server, cfrds_loop_done_fn done, void *ctx)
+{
+    if (server == NULL)
+    {
+        return CFRDS_STATUS_PARAM_IS_NULL;
+    }
+
+    return cfrds_loop_submit(loop, server, "FILEIO", (const char *[]){ "", "CF_DIRECTORY", NULL}, true, cfrds_buffer_to_root_dir, done, ctx);
+}
+
+cfrds_status cfrds_batch_add_browse_dir(cfrds_batch *batch, const char *path, cfrds_loop_done_fn done, void *ctx)
+{
+    if (path == NULL)
+    {
+        return CFRDS_STATUS_PARAM_IS_NULL;
+    }
+
+    return cfrds_batch_add(batch, "BROWSEDIR", (const char *[]){ path, "", NULL}, true, (cfrds_sql_parser_fn)cfrds_buffer_to_browse_dir, done, ctx);
+}
+
+cfrds_status cfrds_batch_add_file_read(cfrds_batch *batch, const char *pathname, cfrds_loop_done_fn done, void *ctx)
+{
+    if (pathname == NULL)
+    {
+        return CFRDS_STATUS_PARAM_IS_NULL;
+    }
+
+    return cfrds_batch_add(batch, "FILEIO", (const char *[]){ pathname, "READ", "", NULL}, true, (cfrds_sql_parser_fn)cfrds_buffer_to_file_content, done, ctx);
+}
+
+cfrds_status cfrds_batch_add_file_get_root_dir(cfrds_batch *batch, cfrds_loop_done_fn done, void *ctx)
+{
+    return cfrds_batch_add(batch, "FILEIO", (const char *[]){ "", "CF_DIRECTORY", NULL}, true, cfrds_buffer_to_root_dir, done, ctx);
+}
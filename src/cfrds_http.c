@@ -11,78 +11,61 @@
 #else
 #include <sys/socket.h>
 #include <sys/time.h>
+#include <sys/uio.h>
+#include <signal.h>
+#include <poll.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <netdb.h>
 #endif
 
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+
+#ifdef _WIN32
+#include <io.h>
+#endif
+
+#ifdef CFRDS_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
 #include <string.h>
 #include <stdlib.h>
 #include <stddef.h>
+#include <limits.h>
 #include <stdio.h>
 #include <errno.h>
 
 
 #include <time.h>
 
-#define CFRDS_MAX_RESPONSE_SIZE (100 * 1024 * 1024)
-#define CFRDS_MAX_RESPONSE_TIMEOUT_SEC 60
-
-#ifdef _WIN32
-typedef SOCKET cfrds_socket;
-#define CFRDS_INVALID_SOCKET INVALID_SOCKET
-#define GET_SOCKET_ERRNO() WSAGetLastError()
-#define IS_SOCKET_EINTR(err) ((err) == WSAEINTR)
-#else
-typedef int cfrds_socket;
-#define CFRDS_INVALID_SOCKET (-1)
-#define GET_SOCKET_ERRNO() errno
-#ifdef EINTR
-#define IS_SOCKET_EINTR(err) ((err) == EINTR)
-#else
-#define IS_SOCKET_EINTR(err) false
-#endif
-#endif
-
-static void cfrds_sock_cleanup(cfrds_socket* sock);
-#define cfrds_sock_defer(var) cfrds_socket var __attribute__((cleanup(cfrds_sock_cleanup))) = CFRDS_INVALID_SOCKET
-
-static bool cfrds_buffer_skip_httpheader(const char **data, size_t *remaining)
-{
-    if ((data == NULL) || (*data == NULL) || (remaining == NULL))
-        return false;
-
-    if (*remaining < 4)
-        return false;
-
-    const char *p = *data;
-    size_t limit = *remaining - 3;
-    const char *body = NULL;
-
-    for (size_t i = 0; i < limit; i++) {
-        if (p[i] == '\r' && p[i+1] == '\n' && p[i+2] == '\r' && p[i+3] == '\n') {
-            body = p + i;
-            break;
-        }
-    }
-
-    if (body == NULL)
-        return false;
+#define CFRDS_HTTP_FILE_COPY_SIZE (64 * 1024)
+#define CFRDS_HTTP_SENDFILE_MAX (1024 * 1024 * 1024)
+#define CFRDS_HTTP_RECV_SIZE (64 * 1024)
+#define CFRDS_HTTP_RECV_MAX_SIZE (1024 * 1024)
+#define CFRDS_HTTP_CONNECT_MAX_ATTEMPTS 16
 
-    size_t header_len = (size_t)(body - *data);
-    *data = body + 4;
-    *remaining -= (header_len + 4);
+typedef struct {
+    cfrds_socket sockfd;
+    time_t last_used;
+} cfrds_http_idle_conn;
 
-    return true;
-}
+struct cfrds_http_pool {
+    size_t cnt;
+    size_t max;
+    cfrds_http_idle_conn conns[];
+};
 
-static cfrds_status http_build_request(cfrds_server *server, const char *command, cfrds_buffer *payload, cfrds_buffer *send_buf)
+cfrds_status cfrds_http_build_header(cfrds_server *server, const char *command, size_t content_length, cfrds_buffer *send_buf)
 {
-    char datasize_str[16] = {0, };
+    char datasize_str[24] = {0, };
     uint16_t port = cfrds_server_get_port(server);
 
-    int n = snprintf(datasize_str, sizeof(datasize_str), "%zu", cfrds_buffer_data_size(payload));
+    int n = snprintf(datasize_str, sizeof(datasize_str), "%zu", content_length);
     if (n < 0 || (size_t)n >= sizeof(datasize_str))
     {
         cfrds_server_set_error(server, CFRDS_STATUS_MEMORY_ERROR, "snprintf() returned < 0 or truncated...");
@@ -92,7 +75,7 @@ static cfrds_status http_build_request(cfrds_server *server, const char *command
     bool ok = true;
     ok = ok && cfrds_buffer_append(send_buf, "POST /CFIDE/main/ide.cfm?CFSRV=IDE&ACTION=");
     ok = ok && cfrds_buffer_append(send_buf, command);
-    ok = ok && cfrds_buffer_append(send_buf, " HTTP/1.0\r\nHost: ");
+    ok = ok && cfrds_buffer_append(send_buf, " HTTP/1.1\r\nHost: ");
     ok = ok && cfrds_buffer_append(send_buf, cfrds_server_get_host(server));
     if (port != 80)
     {
@@ -106,10 +89,12 @@ static cfrds_status http_build_request(cfrds_server *server, const char *command
         ok = ok && cfrds_buffer_append(send_buf, ":");
         ok = ok && cfrds_buffer_append(send_buf, port_str);
     }
-    ok = ok && cfrds_buffer_append(send_buf, "\r\nConnection: close\r\nUser-Agent: Mozilla/3.0 (compatible; Macromedia RDS Client)\r\nAccept: text/html, */*\r\nAccept-Encoding: deflate\r\nContent-type: text/html\r\nContent-length: ");
+    ok = ok && cfrds_buffer_append(send_buf, server->keepalive ? "\r\nConnection: keep-alive" : "\r\nConnection: close");
+    ok = ok && cfrds_buffer_append(send_buf, "\r\nUser-Agent: Mozilla/3.0 (compatible; Macromedia RDS Client)\r\nAccept: text/html, */*");
+    ok = ok && cfrds_buffer_append(send_buf, server->compression ? "\r\nAccept-Encoding: gzip, deflate" : "\r\nAccept-Encoding: identity");
+    ok = ok && cfrds_buffer_append(send_buf, "\r\nContent-type: text/html\r\nContent-length: ");
     ok = ok && cfrds_buffer_append(send_buf, datasize_str);
     ok = ok && cfrds_buffer_append(send_buf, "\r\n\r\n");
-    ok = ok && cfrds_buffer_append_buffer(send_buf, payload);
 
     if (!ok)
     {
@@ -120,209 +105,2036 @@ static cfrds_status http_build_request(cfrds_server *server, const char *command
     return CFRDS_STATUS_OK;
 }
 
-static cfrds_status http_connect(cfrds_server *server, cfrds_socket *out_sockfd)
+bool cfrds_http_socket_set_blocking(cfrds_socket sockfd, bool blocking)
+{
+#ifdef _WIN32
+    u_long mode = blocking ? 0 : 1;
+    return ioctlsocket(sockfd, FIONBIO, &mode) == 0;
+#else
+    int flags = fcntl(sockfd, F_GETFL, 0);
+    if (flags < 0)
+        return false;
+
+    flags = blocking ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK);
+
+    return fcntl(sockfd, F_SETFL, flags) == 0;
+#endif
+}
+
+cfrds_status cfrds_http_resolve(cfrds_server *server, cfrds_http_addrs **out, bool *cached)
 {
     struct addrinfo hints;
     struct addrinfo *result = NULL;
     char port_str[16] = {0, };
-    uint16_t port = cfrds_server_get_port(server);
+    time_t now = time(NULL);
+
+    if (cached)
+        *cached = false;
+
+    cfrds_server_lock(server);
+    if ((server->addrs)&&(server->dns_ttl > 0)&&
+        (now >= server->addrs->resolved_at)&&(now - server->addrs->resolved_at < (time_t)server->dns_ttl))
+    {
+        __atomic_add_fetch(&server->addrs->refs, 1, __ATOMIC_RELAXED);
+        *out = server->addrs;
+        cfrds_server_unlock(server);
+        if (cached)
+            *cached = true;
+        return CFRDS_STATUS_OK;
+    }
+    cfrds_server_unlock(server);
 
     explicit_bzero(&hints, sizeof(hints));
     hints.ai_family = AF_UNSPEC;
     hints.ai_socktype = SOCK_STREAM;
     hints.ai_protocol = IPPROTO_TCP;
 
-    int n = snprintf(port_str, sizeof(port_str), "%u", port);
-    if (n < 0 || (size_t)n >= sizeof(port_str)) {
-        cfrds_server_set_error(server, CFRDS_STATUS_MEMORY_ERROR, "failed to format port string");
+    int n = snprintf(port_str, sizeof(port_str), "%u", cfrds_server_get_port(server));
+    if (n < 0 || (size_t)n >= sizeof(port_str))
         return CFRDS_STATUS_MEMORY_ERROR;
-    }
 
     trace_net_start("getaddrinfo");
     int gai_err = getaddrinfo(cfrds_server_get_host(server), port_str, &hints, &result);
     trace_net_end();
-    if (gai_err != 0) {
-        cfrds_server_set_error(server, CFRDS_STATUS_SOCKET_HOST_NOT_FOUND, "failed to resolve hostname...");
+    if (gai_err != 0)
         return CFRDS_STATUS_SOCKET_HOST_NOT_FOUND;
+
+    cfrds_http_addrs *addrs = malloc(sizeof(cfrds_http_addrs));
+    if (addrs == NULL) {
+        freeaddrinfo(result);
+        return CFRDS_STATUS_MEMORY_ERROR;
     }
 
-    int saved_errno = 0;
-    cfrds_socket sockfd = CFRDS_INVALID_SOCKET;
+    addrs->refs = 1;
+    addrs->resolved_at = now;
+    addrs->list = result;
 
-    for (struct addrinfo *rp = result; rp != NULL; rp = rp->ai_next)
+    if (server->dns_ttl > 0)
     {
-        trace_net_start("socket");
-        cfrds_socket fd = socket(rp->ai_family, rp->ai_socktype, rp->ai_protocol);
-        trace_net_end();
-        if (fd == CFRDS_INVALID_SOCKET)
-            continue;
+        addrs->refs++;
+        cfrds_server_lock(server);
+        cfrds_http_addrs_release(server->addrs);
+        server->addrs = addrs;
+        cfrds_server_unlock(server);
+    }
 
-        trace_net_start("connect");
-        int res = connect(fd, rp->ai_addr, rp->ai_addrlen);
-        trace_net_end();
-        if (res == 0) {
-            sockfd = fd;
-            break;
-        }
+    *out = addrs;
 
-        saved_errno = GET_SOCKET_ERRNO();
-        cfrds_sock_cleanup(&fd);
-    }
+    return CFRDS_STATUS_OK;
+}
 
-    freeaddrinfo(result);
+void cfrds_http_addrs_release(cfrds_http_addrs *addrs)
+{
+    if ((addrs == NULL)||(__atomic_sub_fetch(&addrs->refs, 1, __ATOMIC_ACQ_REL) > 0))
+        return;
 
-    if (sockfd == CFRDS_INVALID_SOCKET) {
-        server->_errno = saved_errno;
-        cfrds_server_set_error(server, CFRDS_STATUS_CONNECTION_TO_SERVER_FAILED, "failed to establish connection to the server...");
-        return CFRDS_STATUS_CONNECTION_TO_SERVER_FAILED;
-    }
+    freeaddrinfo(addrs->list);
+    free(addrs);
+}
+
+void cfrds_http_dns_flush(cfrds_server *server)
+{
+    if (server == NULL)
+        return;
+
+    cfrds_server_lock(server);
+    cfrds_http_addrs_release(server->addrs);
+    server->addrs = NULL;
+    cfrds_server_unlock(server);
+}
 
+uint64_t cfrds_http_now_ms(void)
+{
 #ifdef _WIN32
-    DWORD tv = 30000;
-    if (setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, (const char *)&tv, sizeof(tv)) < 0 ||
-        setsockopt(sockfd, SOL_SOCKET, SO_SNDTIMEO, (const char *)&tv, sizeof(tv)) < 0) {
-        server->_errno = GET_SOCKET_ERRNO();
-        cfrds_sock_cleanup(&sockfd);
-        cfrds_server_set_error(server, CFRDS_STATUS_CONNECTION_TO_SERVER_FAILED, "failed to set socket timeout");
-        return CFRDS_STATUS_CONNECTION_TO_SERVER_FAILED;
-    }
+    return GetTickCount64();
 #else
-    struct timeval tv = { .tv_sec = 30, .tv_usec = 0 };
-    if (setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) < 0 ||
-        setsockopt(sockfd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv)) < 0) {
-        server->_errno = GET_SOCKET_ERRNO();
-        cfrds_sock_cleanup(&sockfd);
-        cfrds_server_set_error(server, CFRDS_STATUS_CONNECTION_TO_SERVER_FAILED, "failed to set socket timeout");
-        return CFRDS_STATUS_CONNECTION_TO_SERVER_FAILED;
-    }
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000) + ((uint64_t)ts.tv_nsec / 1000000);
 #endif
+}
 
-    *out_sockfd = sockfd;
-    return CFRDS_STATUS_OK;
+uint64_t cfrds_http_deadline(unsigned int timeout_ms, uint64_t limit)
+{
+    uint64_t deadline = cfrds_http_now_ms() + timeout_ms;
+
+    return (deadline < limit) ? deadline : limit;
 }
 
-static cfrds_status http_send_all(cfrds_server *server, cfrds_socket sockfd, cfrds_buffer *send_buf)
+/* Milliseconds left until `deadline` as a poll timeout, -1 for no deadline. */
+static int http_poll_timeout(uint64_t deadline, uint64_t now)
 {
-    const char *send_ptr = cfrds_buffer_data(send_buf);
-    size_t send_remaining = cfrds_buffer_data_size(send_buf);
+    if (deadline == UINT64_MAX)
+        return -1;
+
+    if (now >= deadline)
+        return 0;
 
-    while (send_remaining > 0)
+    return (deadline - now > INT_MAX) ? INT_MAX : (int)(deadline - now);
+}
+
+/*
+ * Waits until a non-blocking socket is ready for `events`. Returns 1 when ready,
+ * 0 when `deadline` passed first and -1 on error (socket error in errno).
+ */
+static int http_wait(cfrds_socket sockfd, short events, uint64_t deadline)
+{
+    while (1)
     {
-        trace_net_start("send");
-        ssize_t sock_written = send(sockfd, send_ptr, send_remaining, 0);
+#ifdef _WIN32
+        WSAPOLLFD pfd = { .fd = sockfd, .events = events, .revents = 0 };
+#else
+        struct pollfd pfd = { .fd = sockfd, .events = events, .revents = 0 };
+#endif
+        int timeout = http_poll_timeout(deadline, cfrds_http_now_ms());
+        if (timeout == 0)
+            return 0;
+
+        trace_net_start("poll");
+#ifdef _WIN32
+        int res = WSAPoll(&pfd, 1, timeout);
+#else
+        int res = poll(&pfd, 1, timeout);
+#endif
         trace_net_end();
-        if (sock_written < 0)
+        if (res > 0)
+            return 1;
+
+        if ((res < 0)&&(!IS_SOCKET_EINTR(GET_SOCKET_ERRNO())))
+            return -1;
+    }
+}
+
+/* Orders the addresses alternating between families, starting with the resolver's first choice (RFC 8305). */
+static size_t http_interleave_addrs(const struct addrinfo *list, const struct addrinfo **order, size_t max)
+{
+    const struct addrinfo *first = list;
+    const struct addrinfo *other = list;
+    size_t cnt = 0;
+
+    while ((other)&&(other->ai_family == list->ai_family))
+        other = other->ai_next;
+
+    while (((first)||(other))&&(cnt < max))
+    {
+        for (; first != NULL; first = first->ai_next)
         {
-            int err = GET_SOCKET_ERRNO();
-            if (IS_SOCKET_EINTR(err))
-                continue;
-            server->_errno = err;
-            cfrds_server_set_error(server, CFRDS_STATUS_WRITING_TO_SOCKET_FAILED, "failed to write to socket...");
-            return CFRDS_STATUS_WRITING_TO_SOCKET_FAILED;
+            if (first->ai_family == list->ai_family)
+            {
+                order[cnt++] = first;
+                first = first->ai_next;
+                break;
+            }
+        }
+
+        for (; (other != NULL)&&(cnt < max); other = other->ai_next)
+        {
+            if (other->ai_family != list->ai_family)
+            {
+                order[cnt++] = other;
+                other = other->ai_next;
+                break;
+            }
         }
-        send_ptr += sock_written;
-        send_remaining -= (size_t)sock_written;
     }
-    return CFRDS_STATUS_OK;
+
+    return cnt;
 }
 
-static cfrds_status http_receive_response(cfrds_server *server, cfrds_socket sockfd, cfrds_buffer *tmp_response)
+/*
+ * Connects with non-blocking sockets until `deadline`, keeping the first connection that completes.
+ * Sequentially the addresses are tried in resolver order, one at a time. With Happy Eyeballs (`race`)
+ * they alternate between families and the next attempt starts whenever the previous ones have not
+ * finished within CFRDS_HTTP_CONNECT_ATTEMPT_DELAY_MS (or failed).
+ */
+static cfrds_socket http_connect_addrs(const struct addrinfo *list, bool race, uint64_t deadline, int *saved_errno)
 {
-    time_t start_time = time(NULL);
-    while (1)
+    const struct addrinfo *order[CFRDS_HTTP_CONNECT_MAX_ATTEMPTS];
+#ifdef _WIN32
+    WSAPOLLFD pfds[CFRDS_HTTP_CONNECT_MAX_ATTEMPTS];
+#else
+    struct pollfd pfds[CFRDS_HTTP_CONNECT_MAX_ATTEMPTS];
+#endif
+    size_t cnt = 0;
+    size_t next = 0;
+    size_t pending = 0;
+    cfrds_socket winner = CFRDS_INVALID_SOCKET;
+    uint64_t now = cfrds_http_now_ms();
+    uint64_t next_start = now;
+
+    if (race) {
+        cnt = http_interleave_addrs(list, order, CFRDS_HTTP_CONNECT_MAX_ATTEMPTS);
+    } else {
+        for (const struct addrinfo *rp = list; (rp != NULL)&&(cnt < CFRDS_HTTP_CONNECT_MAX_ATTEMPTS); rp = rp->ai_next)
+            order[cnt++] = rp;
+    }
+
+    while (winner == CFRDS_INVALID_SOCKET)
     {
-        if (time(NULL) - start_time > CFRDS_MAX_RESPONSE_TIMEOUT_SEC) {
-            cfrds_server_set_error(server, CFRDS_STATUS_READING_FROM_SOCKET_FAILED, "response read timed out (overall deadline exceeded)");
-            return CFRDS_STATUS_READING_FROM_SOCKET_FAILED;
+        now = cfrds_http_now_ms();
+
+        if (now >= deadline) {
+            *saved_errno = SOCKET_ETIMEDOUT;
+            break;
         }
 
-        char recv_buf[4096];
-        trace_net_start("recv");
-        ssize_t nread = recv(sockfd, recv_buf, sizeof(recv_buf), 0);
-        trace_net_end();
-        if (nread <= 0) {
-            if (nread == -1) {
-                server->_errno = GET_SOCKET_ERRNO();
-                cfrds_server_set_error(server, CFRDS_STATUS_READING_FROM_SOCKET_FAILED, "failed to read from socket...");
-                return CFRDS_STATUS_READING_FROM_SOCKET_FAILED;
+        if ((next < cnt)&&((pending == 0)||((race)&&(now >= next_start))))
+        {
+            const struct addrinfo *rp = order[next++];
+            next_start = now + CFRDS_HTTP_CONNECT_ATTEMPT_DELAY_MS;
+
+            trace_net_start("socket");
+            cfrds_socket fd = socket(rp->ai_family, rp->ai_socktype, rp->ai_protocol);
+            trace_net_end();
+            if (fd == CFRDS_INVALID_SOCKET)
+                continue;
+
+            if (!cfrds_http_socket_set_blocking(fd, false)) {
+                *saved_errno = GET_SOCKET_ERRNO();
+                cfrds_sock_cleanup(&fd);
+                continue;
+            }
+
+            trace_net_start("connect");
+            int res = connect(fd, rp->ai_addr, rp->ai_addrlen);
+            trace_net_end();
+            if (res == 0) {
+                winner = fd;
+                break;
+            }
+
+            int err = GET_SOCKET_ERRNO();
+            if (!IS_SOCKET_EINPROGRESS(err)) {
+                *saved_errno = err;
+                cfrds_sock_cleanup(&fd);
+                continue;
             }
+
+            pfds[pending].fd = fd;
+            pfds[pending].events = POLLOUT;
+            pfds[pending].revents = 0;
+            pending++;
+            continue;
+        }
+
+        if (pending == 0)
+            break;
+
+        uint64_t wake = ((race)&&(next < cnt)&&(next_start < deadline)) ? next_start : deadline;
+
+#ifdef _WIN32
+        int res = WSAPoll(pfds, (ULONG)pending, (INT)http_poll_timeout(wake, now));
+#else
+        int res = poll(pfds, (nfds_t)pending, http_poll_timeout(wake, now));
+#endif
+        if (res < 0)
+        {
+            int err = GET_SOCKET_ERRNO();
+            if (IS_SOCKET_EINTR(err))
+                continue;
+
+            *saved_errno = err;
             break;
         }
 
-        if (!cfrds_buffer_append_bytes(tmp_response, recv_buf, (size_t)nread))
+        for (size_t c = pending; c-- > 0;)
+        {
+            if (pfds[c].revents == 0)
+                continue;
+
+            int err = 0;
+            socklen_t len = sizeof(err);
+            cfrds_socket fd = pfds[c].fd;
+
+            if (getsockopt(fd, SOL_SOCKET, SO_ERROR, (char *)&err, &len) != 0)
+                err = GET_SOCKET_ERRNO();
+
+            pfds[c] = pfds[--pending];
+
+            if ((err == 0)&&(winner == CFRDS_INVALID_SOCKET)) {
+                winner = fd;
+                continue;
+            }
+
+            if (err != 0)
+                *saved_errno = err;
+            cfrds_sock_cleanup(&fd);
+
+            /* a failed attempt does not have to wait for the delay */
+            next_start = now;
+        }
+    }
+
+    for (size_t c = 0; c < pending; c++)
+    {
+        cfrds_socket fd = pfds[c].fd;
+        cfrds_sock_cleanup(&fd);
+    }
+
+    return winner;
+}
+
+cfrds_status cfrds_http_connect(cfrds_server *server, uint64_t deadline, cfrds_socket *out_sockfd)
+{
+    cfrds_socket sockfd = CFRDS_INVALID_SOCKET;
+    int saved_errno = 0;
+
+    for (int attempt = 0; sockfd == CFRDS_INVALID_SOCKET; attempt++)
+    {
+        cfrds_http_addrs *addrs = NULL;
+        bool cached = false;
+
+        cfrds_status status = cfrds_http_resolve(server, &addrs, &cached);
+        if (status == CFRDS_STATUS_MEMORY_ERROR) {
+            cfrds_server_set_error(server, CFRDS_STATUS_MEMORY_ERROR, "failed to allocate resolved addresses");
             return CFRDS_STATUS_MEMORY_ERROR;
+        }
+        if (status != CFRDS_STATUS_OK) {
+            cfrds_server_set_error(server, CFRDS_STATUS_SOCKET_HOST_NOT_FOUND, "failed to resolve hostname...");
+            return CFRDS_STATUS_SOCKET_HOST_NOT_FOUND;
+        }
+
+        sockfd = http_connect_addrs(addrs->list, (server->happy_eyeballs)&&(addrs->list->ai_next), deadline, &saved_errno);
 
-        if (cfrds_buffer_data_size(tmp_response) > CFRDS_MAX_RESPONSE_SIZE) {
-            cfrds_server_set_error(server, CFRDS_STATUS_RESPONSE_TOO_LARGE, "response exceeded maximum size");
-            return CFRDS_STATUS_RESPONSE_TOO_LARGE;
+        cfrds_http_addrs_release(addrs);
+
+        if (sockfd == CFRDS_INVALID_SOCKET)
+        {
+            /* the host may have moved since it was cached: resolve it again once */
+            cfrds_http_dns_flush(server);
+            if ((!cached)||(attempt > 0)||(cfrds_http_now_ms() >= deadline))
+                break;
         }
     }
+
+    if (sockfd == CFRDS_INVALID_SOCKET) {
+        cfrds_server_error_ctx(server)->_errno = saved_errno;
+        cfrds_server_set_error(server, CFRDS_STATUS_CONNECTION_TO_SERVER_FAILED, "failed to establish connection to the server...");
+        return CFRDS_STATUS_CONNECTION_TO_SERVER_FAILED;
+    }
+
+    *out_sockfd = sockfd;
     return CFRDS_STATUS_OK;
 }
 
-cfrds_status cfrds_http_post(cfrds_server *server, const char *command, cfrds_buffer *payload, cfrds_buffer **response)
+ssize_t cfrds_http_send_segments(cfrds_socket sockfd, const cfrds_http_segment *segs, size_t cnt, size_t offset)
 {
-    cfrds_buffer_defer(tmp_response);
-    cfrds_buffer_defer(send_buf);
-    cfrds_sock_defer(sockfd);
-    cfrds_status status;
+#ifdef _WIN32
+    WSABUF bufs[CFRDS_HTTP_MAX_SEGMENTS];
+#else
+    struct iovec bufs[CFRDS_HTTP_MAX_SEGMENTS];
+#endif
+    size_t bufs_cnt = 0;
 
-    if (!cfrds_buffer_create(&send_buf)) {
-        cfrds_server_set_error(server, CFRDS_STATUS_MEMORY_ERROR, "cfrds_buffer_create failed for send_buf");
-        return CFRDS_STATUS_MEMORY_ERROR;
+    for (size_t c = 0; (c < cnt)&&(bufs_cnt < CFRDS_HTTP_MAX_SEGMENTS); c++)
+    {
+        if (offset >= segs[c].size)
+        {
+            offset -= segs[c].size;
+            continue;
+        }
+
+#ifdef _WIN32
+        size_t len = segs[c].size - offset;
+        bufs[bufs_cnt].buf = (char *)segs[c].data + offset;
+        bufs[bufs_cnt].len = (len > ULONG_MAX) ? ULONG_MAX : (ULONG)len;
+#else
+        bufs[bufs_cnt].iov_base = (char *)segs[c].data + offset;
+        bufs[bufs_cnt].iov_len = segs[c].size - offset;
+#endif
+        bufs_cnt++;
+        offset = 0;
     }
 
-    status = http_build_request(server, command, payload, send_buf);
-    if (status != CFRDS_STATUS_OK)
-        return status;
+    if (bufs_cnt == 0)
+        return 0;
 
-    status = http_connect(server, &sockfd);
-    if (status != CFRDS_STATUS_OK)
-        return status;
+#ifdef _WIN32
+    DWORD written = 0;
+    if (WSASend(sockfd, bufs, (DWORD)bufs_cnt, &written, 0, NULL, NULL) != 0)
+        return -1;
 
-    status = http_send_all(server, sockfd, send_buf);
-    if (status != CFRDS_STATUS_OK)
-        return status;
+    return (ssize_t)written;
+#else
+    struct msghdr msg;
 
-    if (!cfrds_buffer_create(&tmp_response)) {
-        cfrds_server_set_error(server, CFRDS_STATUS_MEMORY_ERROR, "cfrds_buffer_create failed for tmp_response");
-        return CFRDS_STATUS_MEMORY_ERROR;
-    }
+    explicit_bzero(&msg, sizeof(msg));
+    msg.msg_iov = bufs;
+    msg.msg_iovlen = bufs_cnt;
 
-    status = http_receive_response(server, sockfd, tmp_response);
-    if (status != CFRDS_STATUS_OK)
-        return status;
+    /* sendmsg rather than writev: takes MSG_NOSIGNAL */
+    return sendmsg(sockfd, &msg, CFRDS_SEND_FLAGS);
+#endif
+}
 
-    const char *response_data = cfrds_buffer_data(tmp_response);
-    size_t response_size = cfrds_buffer_data_size(tmp_response);
+static ssize_t http_send_file_copy(cfrds_socket sockfd, const cfrds_http_segment *seg, size_t offset)
+{
+    char buf[CFRDS_HTTP_FILE_COPY_SIZE];
+    size_t size = seg->size - offset;
+    ssize_t nread;
 
-    const char good_response_http1_1[] = "HTTP/1.1 200 ";
-    size_t min_resp_len = strlen(good_response_http1_1);
+    if (size > sizeof(buf))
+        size = sizeof(buf);
 
-    if (response_size < min_resp_len ||
-        (strncmp(response_data, good_response_http1_1, min_resp_len) != 0 &&
-         strncmp(response_data, "HTTP/1.0 200 ", min_resp_len) != 0))
+#ifdef _WIN32
+    if (_lseeki64(seg->fd, (__int64)(seg->file_offset + offset), SEEK_SET) < 0)
+        return -1;
+    nread = _read(seg->fd, buf, (unsigned int)size);
+#else
+    nread = pread(seg->fd, buf, size, (off_t)(seg->file_offset + offset));
+#endif
+    if (nread <= 0)
     {
-        cfrds_server_set_error(server, CFRDS_STATUS_RESPONSE_ERROR, "Invalid server response...");
-        return CFRDS_STATUS_RESPONSE_ERROR;
+        /* the file is shorter than the length announced in the request */
+        if (nread == 0)
+            errno = EIO;
+        return -1;
     }
 
-    if (cfrds_buffer_skip_httpheader(&response_data, &response_size) == false)
-        return CFRDS_STATUS_HTTP_RESPONSE_NOT_FOUND;
+    /* a partial send is resumed from the file on the next call */
+    return send(sockfd, buf, (size_t)nread, CFRDS_SEND_FLAGS);
+}
+
+#ifdef __linux__
+/* sendfile() has no MSG_NOSIGNAL: keep a SIGPIPE for a closed peer from killing the process. */
+static ssize_t http_sendfile(cfrds_socket sockfd, const cfrds_http_segment *seg, size_t offset, size_t size)
+{
+    sigset_t pipe_set, old_set, pending;
+    off_t pos = (off_t)(seg->file_offset + offset);
+
+    sigemptyset(&pipe_set);
+    sigaddset(&pipe_set, SIGPIPE);
+    sigpending(&pending);
+    bool was_pending = sigismember(&pending, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &pipe_set, &old_set);
+
+    ssize_t ret = sendfile(sockfd, seg->fd, &pos, size);
+    int err = errno;
 
-    if (!cfrds_buffer_parse_number(&response_data, &response_size, &server->error_code))
+    if ((ret < 0)&&(err == EPIPE)&&(!was_pending))
     {
-        server->error_code = -1;
-        cfrds_server_set_error(server, CFRDS_STATUS_RESPONSE_ERROR, "cfrds_buffer_parse_number FAILED...");
-        return CFRDS_STATUS_RESPONSE_ERROR;
+        const struct timespec no_wait = { 0, 0 };
+        sigtimedwait(&pipe_set, NULL, &no_wait);
     }
 
-    if (server->error_code < 0)
+    pthread_sigmask(SIG_SETMASK, &old_set, NULL);
+    errno = err;
+
+    return ret;
+}
+#endif
+
+/* Writes part of a file backed segment, returns the number of bytes written or -1. */
+static ssize_t http_send_file(cfrds_socket sockfd, const cfrds_http_segment *seg, size_t offset)
+{
+#ifdef __linux__
+    size_t size = seg->size - offset;
+    if (size > CFRDS_HTTP_SENDFILE_MAX)
+        size = CFRDS_HTTP_SENDFILE_MAX;
+
+    ssize_t ret = http_sendfile(sockfd, seg, offset, size);
+    if (ret > 0)
+        return ret;
+
+    if (ret == 0)
     {
-        cfrds_server_set_error(server, CFRDS_STATUS_RESPONSE_ERROR, response_data);
-        return CFRDS_STATUS_RESPONSE_ERROR;
+        errno = EIO;
+        return -1;
     }
 
+    /* EINVAL/ENOSYS: the descriptor can not be used with sendfile, copy through user space */
+    if ((errno != EINVAL)&&(errno != ENOSYS))
+        return -1;
+#endif
+
+    return http_send_file_copy(sockfd, seg, offset);
+}
+
+/* Writes all segments, waiting for a full send buffer to drain until `deadline`.
+ * `sent`, if not NULL, counts the bytes written, also when the write fails. */
+static cfrds_status http_send_all(cfrds_server *server, cfrds_socket sockfd, const cfrds_http_segment *segs, size_t cnt, uint64_t deadline, size_t *sent)
+{
+    size_t c = 0;
+    size_t offset = 0;
+
+    if (sent)
+        *sent = 0;
+
+    while (c < cnt)
+    {
+        ssize_t sock_written;
+
+        if (offset >= segs[c].size)
+        {
+            offset -= segs[c].size;
+            c++;
+            continue;
+        }
+
+        if (segs[c].data == NULL)
+        {
+            trace_net_start("sendfile");
+            sock_written = http_send_file(sockfd, &segs[c], offset);
+            trace_net_end();
+        }
+        else
+        {
+            /* gather the memory segments up to the next file backed one */
+            size_t run = c + 1;
+            while ((run < cnt)&&((segs[run].data != NULL)||(segs[run].size == 0)))
+                run++;
+
+            trace_net_start("send");
+            sock_written = cfrds_http_send_segments(sockfd, &segs[c], run - c, offset);
+            trace_net_end();
+        }
+
+        if (sock_written < 0)
+        {
+            int err = GET_SOCKET_ERRNO();
+            if (IS_SOCKET_EINTR(err))
+                continue;
+
+            if (IS_SOCKET_EWOULDBLOCK(err))
+            {
+                int ready = http_wait(sockfd, POLLOUT, deadline);
+                if (ready > 0)
+                    continue;
+
+                if (ready == 0) {
+                    cfrds_server_error_ctx(server)->_errno = SOCKET_ETIMEDOUT;
+                    cfrds_server_set_error(server, CFRDS_STATUS_WRITING_TO_SOCKET_FAILED, "request write timed out (overall deadline exceeded)");
+                    return CFRDS_STATUS_WRITING_TO_SOCKET_FAILED;
+                }
+
+                err = GET_SOCKET_ERRNO();
+            }
+
+            cfrds_server_error_ctx(server)->_errno = err;
+            cfrds_server_set_error(server, CFRDS_STATUS_WRITING_TO_SOCKET_FAILED, "failed to write to socket...");
+            return CFRDS_STATUS_WRITING_TO_SOCKET_FAILED;
+        }
+        offset += (size_t)sock_written;
+        if (sent)
+            *sent += (size_t)sock_written;
+    }
+    return CFRDS_STATUS_OK;
+}
+
+static bool http_token_equals(const char *str, size_t len, const char *token)
+{
+    size_t token_len = strlen(token);
+
+    if (len != token_len)
+        return false;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        char ch = str[i];
+        if ((ch >= 'A')&&(ch <= 'Z'))
+            ch = (char)(ch - 'A' + 'a');
+        if (ch != token[i])
+            return false;
+    }
+
+    return true;
+}
+
+static bool http_header_has_token(const char *value, size_t value_size, const char *token)
+{
+    const char *end = value + value_size;
+
+    while (value < end)
+    {
+        const char *item_end = memchr(value, ',', (size_t)(end - value));
+        if (item_end == NULL)
+            item_end = end;
+
+        const char *item = value;
+        const char *tail = item_end;
+        while ((item < tail)&&((*item == ' ')||(*item == '\t')))
+            item++;
+        while ((tail > item)&&((tail[-1] == ' ')||(tail[-1] == '\t')))
+            tail--;
+
+        if (http_token_equals(item, (size_t)(tail - item), token))
+            return true;
+
+        value = item_end + 1;
+    }
+
+    return false;
+}
+
+static bool http_header_find(const char *headers, size_t headers_size, const char *name, const char **value, size_t *value_size)
+{
+    size_t name_len = strlen(name);
+    const char *end = headers + headers_size;
+
+    /* skip the status line */
+    const char *line = memchr(headers, '\n', headers_size);
+    if (line == NULL)
+        return false;
+    line++;
+
+    while (line < end)
+    {
+        const char *eol = memchr(line, '\n', (size_t)(end - line));
+        if (eol == NULL)
+            eol = end;
+
+        size_t line_len = (size_t)(eol - line);
+        if ((line_len > 0)&&(line[line_len - 1] == '\r'))
+            line_len--;
+
+        if ((line_len > name_len)&&(line[name_len] == ':')&&(http_token_equals(line, name_len, name)))
+        {
+            const char *v = line + name_len + 1;
+            const char *v_end = line + line_len;
+
+            while ((v < v_end)&&((*v == ' ')||(*v == '\t')))
+                v++;
+            while ((v_end > v)&&((v_end[-1] == ' ')||(v_end[-1] == '\t')))
+                v_end--;
+
+            *value = v;
+            *value_size = (size_t)(v_end - v);
+
+            return true;
+        }
+
+        line = eol + 1;
+    }
+
+    return false;
+}
+
+static cfrds_status http_parser_fail(cfrds_http_parser *parser, cfrds_status status, const char *error)
+{
+    parser->status = status;
+    parser->error = error;
+
+    return status;
+}
+
+static cfrds_status http_parser_parse_headers(cfrds_http_parser *parser)
+{
+    const char *headers = cfrds_buffer_data(parser->headers);
+    size_t headers_size = cfrds_buffer_data_size(parser->headers);
+    const char *value = NULL;
+    size_t value_size = 0;
+
+    if ((headers_size < 12)||(memcmp(headers, "HTTP/1.", 7) != 0)||((headers[7] != '0')&&(headers[7] != '1'))||(headers[8] != ' ')||
+        (headers[9] < '0')||(headers[9] > '9')||(headers[10] < '0')||(headers[10] > '9')||(headers[11] < '0')||(headers[11] > '9'))
+        return http_parser_fail(parser, CFRDS_STATUS_RESPONSE_ERROR, "Invalid server response...");
+
+    parser->status_code = ((headers[9] - '0') * 100) + ((headers[10] - '0') * 10) + (headers[11] - '0');
+
+    /* HTTP/1.1 connections persist by default, HTTP/1.0 ones only when asked to */
+    parser->keep_alive = (headers[7] == '1');
+
+    if (http_header_find(headers, headers_size, "connection", &value, &value_size))
+    {
+        if (http_header_has_token(value, value_size, "close"))
+            parser->keep_alive = false;
+        else if (http_header_has_token(value, value_size, "keep-alive"))
+            parser->keep_alive = true;
+    }
+
+    parser->chunked = false;
+    if (http_header_find(headers, headers_size, "transfer-encoding", &value, &value_size))
+        parser->chunked = http_header_has_token(value, value_size, "chunked");
+
+    parser->encoding = CFRDS_HTTP_ENCODING_IDENTITY;
+    if ((http_header_find(headers, headers_size, "content-encoding", &value, &value_size))&&(value_size > 0)&&
+        (!http_token_equals(value, value_size, "identity")))
+    {
+#ifdef CFRDS_HAVE_ZLIB
+        if ((http_token_equals(value, value_size, "gzip"))||(http_token_equals(value, value_size, "x-gzip")))
+            parser->encoding = CFRDS_HTTP_ENCODING_GZIP;
+        else if (http_token_equals(value, value_size, "deflate"))
+            parser->encoding = CFRDS_HTTP_ENCODING_DEFLATE;
+        else
+#endif
+            return http_parser_fail(parser, CFRDS_STATUS_RESPONSE_ERROR, "unsupported Content-Encoding");
+    }
+
+    parser->content_length = -1;
+    if ((!parser->chunked)&&(http_header_find(headers, headers_size, "content-length", &value, &value_size)))
+    {
+        int64_t content_length = 0;
+
+        if (value_size == 0)
+            return http_parser_fail(parser, CFRDS_STATUS_RESPONSE_ERROR, "invalid Content-Length header");
+
+        for (size_t i = 0; i < value_size; i++)
+        {
+            if ((value[i] < '0')||(value[i] > '9'))
+                return http_parser_fail(parser, CFRDS_STATUS_RESPONSE_ERROR, "invalid Content-Length header");
+
+            if (content_length > (INT64_MAX - 9) / 10)
+                return http_parser_fail(parser, CFRDS_STATUS_RESPONSE_TOO_LARGE, "response exceeded maximum size");
+
+            content_length = (content_length * 10) + (value[i] - '0');
+            if ((uint64_t)content_length > parser->max_body_size)
+                return http_parser_fail(parser, CFRDS_STATUS_RESPONSE_TOO_LARGE, "response exceeded maximum size");
+        }
+
+        parser->content_length = content_length;
+    }
+
+    return CFRDS_STATUS_OK;
+}
+
+static cfrds_status http_parser_headers_complete(cfrds_http_parser *parser)
+{
+    cfrds_status status = http_parser_parse_headers(parser);
+    if (status != CFRDS_STATUS_OK)
+        return status;
+
+    if ((parser->status_code >= 100)&&(parser->status_code < 200))
+    {
+        /* interim response (e.g. 100 Continue), the real one follows */
+        cfrds_buffer_slice(parser->headers, 0, 0);
+        parser->header_match = 0;
+        return CFRDS_STATUS_OK;
+    }
+
+    if ((parser->status_code == 204)||(parser->status_code == 304))
+        parser->state = CFRDS_HTTP_STATE_DONE;
+    else if (parser->chunked)
+        parser->state = CFRDS_HTTP_STATE_CHUNK_SIZE;
+    else if (parser->content_length == 0)
+        parser->state = CFRDS_HTTP_STATE_DONE;
+    else if (parser->content_length > 0)
+    {
+        parser->remaining = (uint64_t)parser->content_length;
+        parser->state = CFRDS_HTTP_STATE_BODY_LENGTH;
+    }
+    else
+    {
+        parser->keep_alive = false;
+        parser->state = CFRDS_HTTP_STATE_BODY_EOF;
+    }
+
+    return CFRDS_STATUS_OK;
+}
+
+static cfrds_status http_parser_emit(cfrds_http_parser *parser, const char *data, size_t size)
+{
+    parser->body_size += size;
+    if (parser->body_size > parser->max_body_size)
+        return http_parser_fail(parser, CFRDS_STATUS_RESPONSE_TOO_LARGE, "response exceeded maximum size");
+
+    parser->delivered += size;
+    cfrds_status status = parser->on_body(parser->ctx, data, size);
+    if (status != CFRDS_STATUS_OK)
+        return http_parser_fail(parser, status, NULL);
+
+    return CFRDS_STATUS_OK;
+}
+
+#ifdef CFRDS_HAVE_ZLIB
+static cfrds_status http_parser_inflate_init(cfrds_http_parser *parser)
+{
+    const uint8_t *head = parser->inflate_head;
+    int window_bits = -MAX_WBITS;
+
+    /* "deflate" is meant to be zlib wrapped, but some servers send a raw deflate stream */
+    if ((head[0] == 0x1f)&&(head[1] == 0x8b))
+        window_bits = MAX_WBITS + 16;
+    else if (((head[0] & 0x0f) == Z_DEFLATED)&&(((head[0] << 8) | head[1]) % 31 == 0))
+        window_bits = MAX_WBITS;
+
+    z_stream *zs = calloc(1, sizeof(z_stream));
+    if (zs == NULL)
+        return http_parser_fail(parser, CFRDS_STATUS_MEMORY_ERROR, "failed to allocate inflate stream");
+
+    if (inflateInit2(zs, window_bits) != Z_OK)
+    {
+        free(zs);
+        return http_parser_fail(parser, CFRDS_STATUS_MEMORY_ERROR, "inflateInit2() failed");
+    }
+
+    parser->inflater = zs;
+
+    return CFRDS_STATUS_OK;
+}
+
+static cfrds_status http_parser_inflate_bytes(cfrds_http_parser *parser, const uint8_t *data, size_t size)
+{
+    z_stream *zs = parser->inflater;
+    uint8_t out[16384];
+
+    while ((size > 0)&&(!parser->inflate_end))
+    {
+        uInt piece = (size > (1U << 30)) ? (1U << 30) : (uInt)size;
+
+        zs->next_in = (Bytef *)data;
+        zs->avail_in = piece;
+
+        do {
+            zs->next_out = out;
+            zs->avail_out = sizeof(out);
+
+            int res = inflate(zs, Z_NO_FLUSH);
+            if (res == Z_STREAM_END)
+                parser->inflate_end = true;
+            else if ((res != Z_OK)&&(res != Z_BUF_ERROR))
+                return http_parser_fail(parser, CFRDS_STATUS_RESPONSE_ERROR, "failed to decompress response body");
+
+            size_t produced = sizeof(out) - zs->avail_out;
+            if (produced > 0)
+            {
+                cfrds_status status = http_parser_emit(parser, (const char *)out, produced);
+                if (status != CFRDS_STATUS_OK)
+                    return status;
+            }
+            else if (res == Z_BUF_ERROR)
+            {
+                break;
+            }
+        } while ((!parser->inflate_end)&&((zs->avail_in > 0)||(zs->avail_out == 0)));
+
+        /* bytes after the end of the compressed stream are ignored */
+        data += piece;
+        size -= piece;
+    }
+
+    return CFRDS_STATUS_OK;
+}
+
+static cfrds_status http_parser_inflate(cfrds_http_parser *parser, const char *data, size_t size)
+{
+    if (parser->inflater == NULL)
+    {
+        while ((size > 0)&&(parser->inflate_head_len < sizeof(parser->inflate_head)))
+        {
+            parser->inflate_head[parser->inflate_head_len++] = (uint8_t)*data++;
+            size--;
+        }
+
+        if (parser->inflate_head_len < sizeof(parser->inflate_head))
+            return CFRDS_STATUS_OK;
+
+        cfrds_status status = http_parser_inflate_init(parser);
+        if (status != CFRDS_STATUS_OK)
+            return status;
+
+        status = http_parser_inflate_bytes(parser, parser->inflate_head, sizeof(parser->inflate_head));
+        if (status != CFRDS_STATUS_OK)
+            return status;
+    }
+
+    return http_parser_inflate_bytes(parser, (const uint8_t *)data, size);
+}
+#endif
+
+static bool http_parser_delivers_body(const cfrds_http_parser *parser)
+{
+    /* error bodies are consumed to keep the connection framed, but never handed out */
+    return (parser->on_body != NULL)&&(parser->status_code >= 200)&&(parser->status_code <= 299);
+}
+
+static cfrds_status http_parser_deliver(cfrds_http_parser *parser, const char *data, size_t size)
+{
+    if (!http_parser_delivers_body(parser))
+    {
+        /* undelivered error bodies keep the default limit */
+        parser->body_size += size;
+        if (parser->body_size > CFRDS_MAX_RESPONSE_SIZE)
+            return http_parser_fail(parser, CFRDS_STATUS_RESPONSE_TOO_LARGE, "response exceeded maximum size");
+
+        return CFRDS_STATUS_OK;
+    }
+
+#ifdef CFRDS_HAVE_ZLIB
+    if (parser->encoding != CFRDS_HTTP_ENCODING_IDENTITY)
+        return http_parser_inflate(parser, data, size);
+#endif
+
+    return http_parser_emit(parser, data, size);
+}
+
+static cfrds_status http_parser_body_done(cfrds_http_parser *parser)
+{
+    parser->state = CFRDS_HTTP_STATE_DONE;
+
+    if ((parser->encoding != CFRDS_HTTP_ENCODING_IDENTITY)&&(http_parser_delivers_body(parser))&&
+        (parser->inflate_head_len > 0)&&(!parser->inflate_end))
+        return http_parser_fail(parser, CFRDS_STATUS_RESPONSE_ERROR, "truncated compressed response body");
+
+    return CFRDS_STATUS_OK;
+}
+
+static int http_hex_digit(char ch)
+{
+    if ((ch >= '0')&&(ch <= '9'))
+        return ch - '0';
+    if ((ch >= 'a')&&(ch <= 'f'))
+        return ch - 'a' + 10;
+    if ((ch >= 'A')&&(ch <= 'F'))
+        return ch - 'A' + 10;
+
+    return -1;
+}
+
+bool cfrds_http_parser_init(cfrds_http_parser *parser, cfrds_http_body_fn on_body, void *ctx)
+{
+    if (parser == NULL)
+        return false;
+
+    explicit_bzero(parser, sizeof(cfrds_http_parser));
+
+    parser->state = CFRDS_HTTP_STATE_HEADERS;
+    parser->content_length = -1;
+    parser->max_body_size = CFRDS_MAX_RESPONSE_SIZE;
+    parser->status = CFRDS_STATUS_OK;
+    parser->on_body = on_body;
+    parser->ctx = ctx;
+
+    return cfrds_buffer_create(&parser->headers);
+}
+
+void cfrds_http_parser_cleanup(cfrds_http_parser *parser)
+{
+    if (parser == NULL)
+        return;
+
+    cfrds_buffer_free(parser->headers);
+    parser->headers = NULL;
+
+#ifdef CFRDS_HAVE_ZLIB
+    if (parser->inflater)
+    {
+        inflateEnd((z_stream *)parser->inflater);
+        free(parser->inflater);
+        parser->inflater = NULL;
+    }
+#endif
+}
+
+cfrds_status cfrds_http_parser_feed(cfrds_http_parser *parser, const char *data, size_t size, size_t *consumed)
+{
+    size_t pos = 0;
+
+    if ((parser == NULL)||((data == NULL)&&(size > 0)))
+        return CFRDS_STATUS_PARAM_IS_NULL;
+
+    if (parser->status != CFRDS_STATUS_OK)
+        return parser->status;
+
+    while ((pos < size)&&(parser->state != CFRDS_HTTP_STATE_DONE))
+    {
+        switch (parser->state)
+        {
+        case CFRDS_HTTP_STATE_HEADERS:
+        {
+            static const char header_end[] = "\r\n\r\n";
+            size_t start = pos;
+            bool complete = false;
+
+            while (pos < size)
+            {
+                char ch = data[pos++];
+                if (ch == header_end[parser->header_match])
+                    parser->header_match++;
+                else
+                    parser->header_match = (ch == '\r') ? 1 : 0;
+
+                if (parser->header_match == 4)
+                {
+                    complete = true;
+                    break;
+                }
+            }
+
+            if (!cfrds_buffer_append_bytes(parser->headers, data + start, pos - start))
+                return http_parser_fail(parser, CFRDS_STATUS_MEMORY_ERROR, "buffer append failed reading response header");
+
+            if (cfrds_buffer_data_size(parser->headers) > CFRDS_MAX_HEADER_SIZE)
+                return http_parser_fail(parser, CFRDS_STATUS_RESPONSE_ERROR, "response header too large");
+
+            if (complete)
+            {
+                cfrds_status status = http_parser_headers_complete(parser);
+                if (status != CFRDS_STATUS_OK)
+                    return status;
+            }
+            break;
+        }
+        case CFRDS_HTTP_STATE_BODY_LENGTH:
+        case CFRDS_HTTP_STATE_CHUNK_DATA:
+        {
+            size_t chunk = size - pos;
+            if (chunk > parser->remaining)
+                chunk = (size_t)parser->remaining;
+
+            cfrds_status status = http_parser_deliver(parser, data + pos, chunk);
+            if (status != CFRDS_STATUS_OK)
+                return status;
+
+            pos += chunk;
+            parser->remaining -= chunk;
+
+            if (parser->remaining == 0)
+            {
+                if (parser->state == CFRDS_HTTP_STATE_BODY_LENGTH)
+                {
+                    status = http_parser_body_done(parser);
+                    if (status != CFRDS_STATUS_OK)
+                        return status;
+                }
+                else
+                {
+                    parser->state = CFRDS_HTTP_STATE_CHUNK_DATA_END;
+                }
+            }
+            break;
+        }
+        case CFRDS_HTTP_STATE_BODY_EOF:
+        {
+            cfrds_status status = http_parser_deliver(parser, data + pos, size - pos);
+            if (status != CFRDS_STATUS_OK)
+                return status;
+
+            pos = size;
+            break;
+        }
+        case CFRDS_HTTP_STATE_CHUNK_SIZE:
+        {
+            char ch = data[pos++];
+            int digit = http_hex_digit(ch);
+
+            if (ch == '\n')
+            {
+                if (!parser->chunk_digits)
+                    return http_parser_fail(parser, CFRDS_STATUS_RESPONSE_ERROR, "invalid chunk size");
+
+                parser->chunk_digits = false;
+                parser->chunk_ext = false;
+                parser->line_len = 0;
+                parser->state = (parser->remaining == 0) ? CFRDS_HTTP_STATE_TRAILER : CFRDS_HTTP_STATE_CHUNK_DATA;
+            }
+            else if ((ch == '\r')||(parser->chunk_ext))
+            {
+                /* chunk extensions are ignored */
+            }
+            else if ((ch == ';')||(ch == ' ')||(ch == '\t'))
+            {
+                parser->chunk_ext = true;
+            }
+            else if (digit >= 0)
+            {
+                if (parser->remaining > (UINT64_MAX >> 4))
+                    return http_parser_fail(parser, CFRDS_STATUS_RESPONSE_TOO_LARGE, "response exceeded maximum size");
+
+                parser->remaining = (parser->remaining * 16) + (uint64_t)digit;
+                parser->chunk_digits = true;
+                if (parser->remaining > parser->max_body_size)
+                    return http_parser_fail(parser, CFRDS_STATUS_RESPONSE_TOO_LARGE, "response exceeded maximum size");
+            }
+            else
+            {
+                return http_parser_fail(parser, CFRDS_STATUS_RESPONSE_ERROR, "invalid chunk size");
+            }
+            break;
+        }
+        case CFRDS_HTTP_STATE_CHUNK_DATA_END:
+        {
+            char ch = data[pos++];
+
+            if (ch == '\n')
+                parser->state = CFRDS_HTTP_STATE_CHUNK_SIZE;
+            else if (ch != '\r')
+                return http_parser_fail(parser, CFRDS_STATUS_RESPONSE_ERROR, "missing chunk terminator");
+            break;
+        }
+        case CFRDS_HTTP_STATE_TRAILER:
+        {
+            char ch = data[pos++];
+
+            if (ch == '\n')
+            {
+                if (parser->line_len == 0)
+                {
+                    cfrds_status status = http_parser_body_done(parser);
+                    if (status != CFRDS_STATUS_OK)
+                        return status;
+                }
+                parser->line_len = 0;
+            }
+            else if (ch != '\r')
+            {
+                parser->line_len++;
+            }
+            break;
+        }
+        case CFRDS_HTTP_STATE_DONE:
+            break;
+        }
+    }
+
+    if (consumed)
+        *consumed = pos;
+
+    return CFRDS_STATUS_OK;
+}
+
+cfrds_status cfrds_http_parser_finish(cfrds_http_parser *parser)
+{
+    if (parser == NULL)
+        return CFRDS_STATUS_PARAM_IS_NULL;
+
+    if (parser->status != CFRDS_STATUS_OK)
+        return parser->status;
+
+    switch (parser->state)
+    {
+    case CFRDS_HTTP_STATE_DONE:
+        return CFRDS_STATUS_OK;
+    case CFRDS_HTTP_STATE_BODY_EOF:
+        return http_parser_body_done(parser);
+    case CFRDS_HTTP_STATE_HEADERS:
+        if (cfrds_buffer_data_size(parser->headers) == 0)
+            return http_parser_fail(parser, CFRDS_STATUS_RESPONSE_ERROR, "Invalid server response...");
+        return http_parser_fail(parser, CFRDS_STATUS_HTTP_RESPONSE_NOT_FOUND, NULL);
+    default:
+        return http_parser_fail(parser, CFRDS_STATUS_READING_FROM_SOCKET_FAILED, "connection closed before end of response body");
+    }
+}
+
+uint64_t cfrds_http_parser_direct_window(const cfrds_http_parser *parser)
+{
+    if ((parser == NULL)||(parser->status != CFRDS_STATUS_OK))
+        return 0;
+
+    if ((parser->encoding != CFRDS_HTTP_ENCODING_IDENTITY)||(!http_parser_delivers_body(parser)))
+        return 0;
+
+    switch (parser->state)
+    {
+    case CFRDS_HTTP_STATE_BODY_LENGTH:
+    case CFRDS_HTTP_STATE_CHUNK_DATA:
+        return parser->remaining;
+    case CFRDS_HTTP_STATE_BODY_EOF:
+        return UINT64_MAX;
+    default:
+        return 0;
+    }
+}
+
+cfrds_status cfrds_http_parser_direct_commit(cfrds_http_parser *parser, size_t size)
+{
+    if (parser == NULL)
+        return CFRDS_STATUS_PARAM_IS_NULL;
+
+    if (parser->status != CFRDS_STATUS_OK)
+        return parser->status;
+
+    if (size > cfrds_http_parser_direct_window(parser))
+        return http_parser_fail(parser, CFRDS_STATUS_INVALID_INPUT_PARAMETER, "body bytes committed past the body window");
+
+    parser->body_size += size;
+    parser->delivered += size;
+    if (parser->body_size > parser->max_body_size)
+        return http_parser_fail(parser, CFRDS_STATUS_RESPONSE_TOO_LARGE, "response exceeded maximum size");
+
+    if (parser->state == CFRDS_HTTP_STATE_BODY_EOF)
+        return CFRDS_STATUS_OK;
+
+    parser->remaining -= size;
+    if (parser->remaining > 0)
+        return CFRDS_STATUS_OK;
+
+    if (parser->state == CFRDS_HTTP_STATE_CHUNK_DATA)
+    {
+        parser->state = CFRDS_HTTP_STATE_CHUNK_DATA_END;
+        return CFRDS_STATUS_OK;
+    }
+
+    return http_parser_body_done(parser);
+}
+
+/*
+ * Reads the response into the parser. When `body` is the buffer the body callback appends to,
+ * identity encoded body data is received straight into its spare capacity (pre-sized from
+ * Content-Length) instead of going through the bounce buffer, with reads that grow while the
+ * socket keeps filling them. The first byte has to arrive within the server first-byte timeout,
+ * the whole response by `deadline`. `first_byte_at`, if not NULL, gets the time the first byte was read.
+ */
+static cfrds_status http_receive_response(cfrds_server *server, cfrds_socket sockfd, cfrds_http_parser *parser, cfrds_buffer *body, uint64_t deadline, size_t *received, uint64_t *first_byte_at, bool *reusable)
+{
+    uint64_t first_byte = cfrds_http_deadline(server->first_byte_timeout_ms, deadline);
+    char recv_buf[CFRDS_HTTP_RECV_SIZE];
+    size_t read_size = CFRDS_HTTP_RECV_SIZE;
+    bool presized = false;
+    cfrds_status status;
+
+    *received = 0;
+    *reusable = false;
+
+    while (1)
+    {
+        if (cfrds_http_now_ms() >= ((*received == 0) ? first_byte : deadline)) {
+            cfrds_server_error_ctx(server)->_errno = SOCKET_ETIMEDOUT;
+            cfrds_server_set_error(server, CFRDS_STATUS_READING_FROM_SOCKET_FAILED, ((*received == 0)&&(first_byte < deadline)) ?
+                                   "response read timed out (first byte deadline exceeded)" :
+                                   "response read timed out (overall deadline exceeded)");
+            return CFRDS_STATUS_READING_FROM_SOCKET_FAILED;
+        }
+
+        uint64_t window = (body) ? cfrds_http_parser_direct_window(parser) : 0;
+        char *dst = recv_buf;
+        size_t want = sizeof(recv_buf);
+
+        if (window > 0)
+        {
+            if ((!presized)&&(parser->state == CFRDS_HTTP_STATE_BODY_LENGTH)) {
+                /* the size is known, allocate it once instead of growing while reading (best effort) */
+                cfrds_buffer_reserve_above_size(body, (size_t)parser->remaining);
+                presized = true;
+            }
+
+            want = (window < read_size) ? (size_t)window : read_size;
+            dst = cfrds_buffer_spare(body, want);
+            if (dst == NULL) {
+                cfrds_server_set_error(server, CFRDS_STATUS_MEMORY_ERROR, "buffer reserve failed reading response body");
+                return CFRDS_STATUS_MEMORY_ERROR;
+            }
+        }
+
+        trace_net_start("recv");
+        ssize_t nread = recv(sockfd, dst, want, 0);
+        trace_net_end();
+        if (nread < 0) {
+            int err = GET_SOCKET_ERRNO();
+            if (IS_SOCKET_EINTR(err))
+                continue;
+
+            if (IS_SOCKET_EWOULDBLOCK(err))
+            {
+                /* a timeout is reported at the top of the loop */
+                if (http_wait(sockfd, POLLIN, (*received == 0) ? first_byte : deadline) >= 0)
+                    continue;
+
+                err = GET_SOCKET_ERRNO();
+            }
+
+            cfrds_server_error_ctx(server)->_errno = err;
+            cfrds_server_set_error(server, CFRDS_STATUS_READING_FROM_SOCKET_FAILED, "failed to read from socket...");
+            return CFRDS_STATUS_READING_FROM_SOCKET_FAILED;
+        }
+
+        if (nread == 0) {
+            status = cfrds_http_parser_finish(parser);
+            break;
+        }
+
+        if ((*received == 0)&&(first_byte_at))
+            *first_byte_at = cfrds_http_now_ms();
+        *received += (size_t)nread;
+
+        if (dst != recv_buf)
+        {
+            cfrds_buffer_commit(body, (size_t)nread);
+
+            status = cfrds_http_parser_direct_commit(parser, (size_t)nread);
+            if (status != CFRDS_STATUS_OK)
+                break;
+
+            /* a full read means more data is queued, fetch it with fewer calls */
+            if (((size_t)nread == read_size)&&(read_size < CFRDS_HTTP_RECV_MAX_SIZE))
+                read_size *= 2;
+
+            if (parser->state == CFRDS_HTTP_STATE_DONE) {
+                *reusable = parser->keep_alive;
+                break;
+            }
+
+            continue;
+        }
+
+        size_t consumed = 0;
+        status = cfrds_http_parser_feed(parser, recv_buf, (size_t)nread, &consumed);
+        if (status != CFRDS_STATUS_OK)
+            break;
+
+        if (parser->state == CFRDS_HTTP_STATE_DONE) {
+            /* trailing bytes past the message make the connection unusable */
+            *reusable = (parser->keep_alive)&&(consumed == (size_t)nread);
+            break;
+        }
+    }
+
+    if ((status != CFRDS_STATUS_OK)&&(parser->error))
+        cfrds_server_set_error(server, status, parser->error);
+
+    return status;
+}
+
+static bool http_socket_is_alive(cfrds_socket sockfd)
+{
+#ifdef _WIN32
+    WSAPOLLFD pfd = { .fd = sockfd, .events = POLLRDNORM, .revents = 0 };
+    int res = WSAPoll(&pfd, 1, 0);
+#else
+    struct pollfd pfd = { .fd = sockfd, .events = POLLIN, .revents = 0 };
+    int res = poll(&pfd, 1, 0);
+#endif
+
+    /* An idle keep-alive socket has nothing to read: readiness means EOF, reset or stray bytes. */
+    return res == 0;
+}
+
+bool cfrds_http_pool_acquire(cfrds_server *server, cfrds_socket *out_sockfd)
+{
+    bool ret = false;
+
+    cfrds_server_lock(server);
+
+    struct cfrds_http_pool *pool = server->pool;
+    time_t now = time(NULL);
+
+    while ((pool)&&(pool->cnt > 0))
+    {
+        cfrds_http_idle_conn conn = pool->conns[--pool->cnt];
+
+        if ((now - conn.last_used <= (time_t)server->keepalive_idle_timeout)&&(http_socket_is_alive(conn.sockfd)))
+        {
+            *out_sockfd = conn.sockfd;
+            ret = true;
+            break;
+        }
+
+        cfrds_sock_cleanup(&conn.sockfd);
+    }
+
+    cfrds_server_unlock(server);
+
+    return ret;
+}
+
+void cfrds_http_pool_release(cfrds_server *server, cfrds_socket *sockfd)
+{
+    cfrds_server_lock(server);
+
+    struct cfrds_http_pool *pool = server->pool;
+
+    if ((pool == NULL)&&(server->keepalive_max_idle > 0))
+    {
+        pool = malloc(offsetof(struct cfrds_http_pool, conns) + sizeof(cfrds_http_idle_conn) * server->keepalive_max_idle);
+        if (pool)
+        {
+            pool->cnt = 0;
+            pool->max = server->keepalive_max_idle;
+            server->pool = pool;
+        }
+    }
+
+    if (pool == NULL)
+    {
+        cfrds_server_unlock(server);
+        cfrds_sock_cleanup(sockfd);
+        return;
+    }
+
+    if (pool->cnt >= pool->max)
+    {
+        /* drop the least recently used connection */
+        cfrds_sock_cleanup(&pool->conns[0].sockfd);
+        memmove(&pool->conns[0], &pool->conns[1], sizeof(cfrds_http_idle_conn) * (pool->cnt - 1));
+        pool->cnt--;
+    }
+
+    pool->conns[pool->cnt].sockfd = *sockfd;
+    pool->conns[pool->cnt].last_used = time(NULL);
+    pool->cnt++;
+
+    cfrds_server_unlock(server);
+
+    *sockfd = CFRDS_INVALID_SOCKET;
+}
+
+void cfrds_http_pool_free(cfrds_server *server)
+{
+    if (server == NULL)
+        return;
+
+    cfrds_server_lock(server);
+
+    struct cfrds_http_pool *pool = server->pool;
+    server->pool = NULL;
+
+    cfrds_server_unlock(server);
+
+    if (pool == NULL)
+        return;
+
+    for (size_t c = 0; c < pool->cnt; c++)
+        cfrds_sock_cleanup(&pool->conns[c].sockfd);
+
+    free(pool);
+}
+
+static size_t http_pool_idle(cfrds_server *server, bool *allocated)
+{
+    cfrds_server_lock(server);
+    size_t ret = (server->pool) ? server->pool->cnt : 0;
+    if (allocated)
+        *allocated = (server->pool != NULL);
+    cfrds_server_unlock(server);
+
+    return ret;
+}
+
+cfrds_status cfrds_http_pool_prewarm(cfrds_server *server, size_t count)
+{
+    if (count > server->keepalive_max_idle)
+        count = server->keepalive_max_idle;
+
+    while (http_pool_idle(server, NULL) < count)
+    {
+        bool allocated = false;
+        cfrds_socket sockfd = CFRDS_INVALID_SOCKET;
+
+        cfrds_status status = cfrds_http_connect(server, cfrds_http_deadline(server->connect_timeout_ms, UINT64_MAX), &sockfd);
+        if (status != CFRDS_STATUS_OK)
+            return status;
+
+        cfrds_http_pool_release(server, &sockfd);
+        http_pool_idle(server, &allocated);
+        if (!allocated) {
+            cfrds_server_set_error(server, CFRDS_STATUS_MEMORY_ERROR, "failed to allocate the connection pool");
+            return CFRDS_STATUS_MEMORY_ERROR;
+        }
+    }
+
+    return CFRDS_STATUS_OK;
+}
+
+/* Whether a failed attempt may succeed when repeated: transport errors, timeouts, nothing received and 5xx answers. */
+static bool http_retryable(cfrds_status status, int status_code, size_t received)
+{
+    switch (status)
+    {
+    case CFRDS_STATUS_CONNECTION_TO_SERVER_FAILED:
+    case CFRDS_STATUS_WRITING_TO_SOCKET_FAILED:
+    case CFRDS_STATUS_READING_FROM_SOCKET_FAILED:
+        return true;
+    case CFRDS_STATUS_RESPONSE_ERROR:
+        return received == 0;
+    case CFRDS_STATUS_OK:
+        return status_code >= 500;
+    default:
+        return false;
+    }
+}
+
+/* Delay before retry `retry` (1 based): uniformly random up to the capped exponential backoff (full jitter). */
+static unsigned int http_backoff_ms(cfrds_server *server, unsigned int retry)
+{
+    uint64_t cap = server->retry_backoff_base_ms;
+
+    for (unsigned int c = 1; (c < retry)&&(cap < server->retry_backoff_max_ms); c++)
+        cap *= 2;
+    if (cap > server->retry_backoff_max_ms)
+        cap = server->retry_backoff_max_ms;
+
+    /* xorshift64 */
+    cfrds_server_lock(server);
+    uint64_t x = server->jitter_state;
+    if (x == 0)
+        x = 0x9e3779b97f4a7c15ULL;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    server->jitter_state = x;
+    cfrds_server_unlock(server);
+
+    return (unsigned int)(x % (cap + 1));
+}
+
+static void http_sleep_ms(unsigned int ms)
+{
+#ifdef _WIN32
+    Sleep(ms);
+#else
+    poll(NULL, 0, (ms > INT_MAX) ? INT_MAX : (int)ms);
+#endif
+}
+
+static int http_compare_latency(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+/* Time to wait for the first response byte before hedging, 0 for no hedge. */
+static unsigned int http_hedge_delay(cfrds_server *server)
+{
+    const size_t max = sizeof(server->latency) / sizeof(server->latency[0]);
+    uint32_t sorted[sizeof(server->latency) / sizeof(server->latency[0])];
+
+    if (server->hedge_after_ms != CFRDS_HEDGE_AFTER_P95)
+        return server->hedge_after_ms;
+
+    cfrds_server_lock(server);
+    size_t cnt = (server->latency_cnt < max) ? server->latency_cnt : max;
+    memcpy(sorted, server->latency, cnt * sizeof(uint32_t));
+    cfrds_server_unlock(server);
+
+    if (cnt < CFRDS_HTTP_LATENCY_MIN_SAMPLES)
+        return 0;
+
+    qsort(sorted, cnt, sizeof(uint32_t), http_compare_latency);
+
+    /* nearest rank */
+    uint32_t p95 = sorted[((cnt * 95) + 99) / 100 - 1];
+
+    return p95 ? p95 : 1;
+}
+
+/* Records the time from the end of sending a request to its first response byte, the wait hedging bounds. */
+static void http_record_latency(cfrds_server *server, uint64_t elapsed)
+{
+    const size_t max = sizeof(server->latency) / sizeof(server->latency[0]);
+
+    cfrds_server_lock(server);
+    server->latency[server->latency_cnt++ % max] = (elapsed > UINT32_MAX) ? UINT32_MAX : (uint32_t)elapsed;
+    cfrds_server_unlock(server);
+}
+
+/*
+ * Waits for the first response byte of the request sent on `*sockfd`. When none arrived within
+ * `delay_ms`, the request is sent again on a new connection and whichever connection becomes
+ * readable first is kept in `*sockfd`. The hedge is best effort: if it can not be sent, the
+ * original request is read. Returns true when `*sockfd` was replaced.
+ */
+static bool http_hedge(cfrds_server *server, const cfrds_http_segment *segs, size_t cnt, unsigned int delay_ms, uint64_t deadline, cfrds_socket *sockfd)
+{
+    uint64_t first_byte = cfrds_http_deadline(server->first_byte_timeout_ms, deadline);
+    cfrds_sock_defer(hedged);
+
+    if (http_wait(*sockfd, POLLIN, cfrds_http_deadline(delay_ms, first_byte)) != 0)
+        return false;
+
+    if (cfrds_http_now_ms() >= first_byte)
+        return false;
+
+    if ((cfrds_http_connect(server, cfrds_http_deadline(server->connect_timeout_ms, first_byte), &hedged) != CFRDS_STATUS_OK)||
+        (http_send_all(server, hedged, segs, cnt, first_byte, NULL) != CFRDS_STATUS_OK))
+    {
+        cfrds_server_clear_error(server);
+        cfrds_server_error_ctx(server)->_errno = 0;
+        return false;
+    }
+
+    while (1)
+    {
+#ifdef _WIN32
+        WSAPOLLFD pfds[2] = {
+#else
+        struct pollfd pfds[2] = {
+#endif
+            { .fd = *sockfd, .events = POLLIN, .revents = 0 },
+            { .fd = hedged, .events = POLLIN, .revents = 0 },
+        };
+
+        int timeout = http_poll_timeout(first_byte, cfrds_http_now_ms());
+        if (timeout == 0)
+            return false;
+
+        trace_net_start("poll");
+#ifdef _WIN32
+        int res = WSAPoll(pfds, 2, timeout);
+#else
+        int res = poll(pfds, 2, timeout);
+#endif
+        trace_net_end();
+        if ((res < 0)&&(IS_SOCKET_EINTR(GET_SOCKET_ERRNO())))
+            continue;
+
+        if ((res <= 0)||(pfds[0].revents != 0)||(pfds[1].revents == 0))
+            return false;
+
+        /* the hedge answered first */
+        cfrds_sock_cleanup(sockfd);
+        *sockfd = hedged;
+        hedged = CFRDS_INVALID_SOCKET;
+
+        return true;
+    }
+}
+
+/*
+ * `direct`: the buffer `on_body` appends to, so the body can be received into it in place, or NULL.
+ * `idempotent`: the command may be repeated, so the server retry policy and hedging apply.
+ */
+static cfrds_status http_post(cfrds_server *server, const char *command, const cfrds_http_segment *body, size_t cnt, uint64_t max_body_size, cfrds_http_body_fn on_body, void *ctx, cfrds_buffer *direct, bool idempotent)
+{
+    cfrds_http_segment segs[CFRDS_HTTP_MAX_SEGMENTS];
+    cfrds_buffer_defer(send_buf);
+    cfrds_sock_defer(sockfd);
+    cfrds_http_parser parser;
+    size_t content_length = 0;
+    size_t received = 0;
+    bool reusable = false;
+    cfrds_status status;
+
+    if (cnt >= CFRDS_HTTP_MAX_SEGMENTS) {
+        cfrds_server_set_error(server, CFRDS_STATUS_INVALID_INPUT_PARAMETER, "too many request body segments");
+        return CFRDS_STATUS_INVALID_INPUT_PARAMETER;
+    }
+
+    if (!cfrds_buffer_create(&send_buf)) {
+        cfrds_server_set_error(server, CFRDS_STATUS_MEMORY_ERROR, "cfrds_buffer_create failed for send_buf");
+        return CFRDS_STATUS_MEMORY_ERROR;
+    }
+
+    for (size_t c = 0; c < cnt; c++)
+    {
+        content_length += body[c].size;
+        segs[c + 1] = body[c];
+    }
+
+    status = cfrds_http_build_header(server, command, content_length, send_buf);
+    if (status != CFRDS_STATUS_OK)
+        return status;
+
+    segs[0].data = cfrds_buffer_data(send_buf);
+    segs[0].size = cfrds_buffer_data_size(send_buf);
+
+    uint64_t deadline = cfrds_http_deadline(server->total_timeout_ms, UINT64_MAX);
+    unsigned int attempts = (idempotent) ? server->retry_max_attempts : 1;
+    unsigned int attempt = 1;
+    bool use_pool = true;
+
+    while (1)
+    {
+        uint64_t sent_at = 0;
+        uint64_t first_byte_at = 0;
+        bool reused = false;
+        int status_code = 0;
+        bool delivered = false;
+        size_t sent = 0;
+
+        received = 0;
+        reusable = false;
+
+        if ((server->keepalive)&&(use_pool))
+            reused = cfrds_http_pool_acquire(server, &sockfd);
+
+        status = CFRDS_STATUS_OK;
+        if (!reused)
+            status = cfrds_http_connect(server, cfrds_http_deadline(server->connect_timeout_ms, deadline), &sockfd);
+
+        if (status == CFRDS_STATUS_OK)
+        {
+            if (!cfrds_http_parser_init(&parser, on_body, ctx)) {
+                cfrds_server_set_error(server, CFRDS_STATUS_MEMORY_ERROR, "cfrds_buffer_create failed for response header");
+                return CFRDS_STATUS_MEMORY_ERROR;
+            }
+            parser.max_body_size = max_body_size;
+
+            cfrds_server_error_ctx(server)->_errno = 0;
+            status = http_send_all(server, sockfd, segs, cnt + 1, deadline, &sent);
+            sent_at = cfrds_http_now_ms();
+            if ((status == CFRDS_STATUS_OK)&&(idempotent))
+            {
+                unsigned int delay = http_hedge_delay(server);
+                if ((delay > 0)&&(http_hedge(server, segs, cnt + 1, delay, deadline, &sockfd)))
+                    reused = false;
+            }
+            if (status == CFRDS_STATUS_OK)
+                status = http_receive_response(server, sockfd, &parser, direct, deadline, &received, &first_byte_at, &reusable);
+
+            status_code = parser.status_code;
+            delivered = (parser.delivered > 0);
+            cfrds_http_parser_cleanup(&parser);
+        }
+
+        /* A pooled socket closed by the peer yields nothing at all: retry once on a fresh connection,
+         * unless the server may already have run a command that must not be repeated. */
+        if ((reused)&&(received == 0)&&((idempotent)||(sent == 0))&&(cfrds_server_error_ctx(server)->_errno != SOCKET_ETIMEDOUT)&&
+            ((status == CFRDS_STATUS_RESPONSE_ERROR)||(status == CFRDS_STATUS_WRITING_TO_SOCKET_FAILED)||(status == CFRDS_STATUS_READING_FROM_SOCKET_FAILED)))
+        {
+            cfrds_sock_cleanup(&sockfd);
+            cfrds_server_clear_error(server);
+            use_pool = false;
+            continue;
+        }
+
+        if ((status == CFRDS_STATUS_OK)&&(server->keepalive)&&(reusable))
+            cfrds_http_pool_release(server, &sockfd);
+
+        if ((status == CFRDS_STATUS_OK)&&(status_code == 200))
+        {
+            if (idempotent)
+                http_record_latency(server, first_byte_at - sent_at);
+
+            return CFRDS_STATUS_OK;
+        }
+
+        /* a streamed body already handed to the caller can not be taken back */
+        if ((attempt < attempts)&&(http_retryable(status, status_code, received))&&((direct)||(!delivered)))
+        {
+            unsigned int delay = http_backoff_ms(server, attempt);
+
+            if (cfrds_http_now_ms() + delay < deadline)
+            {
+                cfrds_sock_cleanup(&sockfd);
+                cfrds_buffer_slice(direct, 0, 0);
+                http_sleep_ms(delay);
+                cfrds_server_clear_error(server);
+                attempt++;
+                continue;
+            }
+        }
+
+        break;
+    }
+
+    if (status != CFRDS_STATUS_OK)
+        return status;
+
+    cfrds_server_set_error(server, CFRDS_STATUS_RESPONSE_ERROR, "Invalid server response...");
+    return CFRDS_STATUS_RESPONSE_ERROR;
+}
+
+cfrds_status cfrds_http_post_stream(cfrds_server *server, const char *command, const cfrds_http_segment *body, size_t cnt, uint64_t max_body_size, cfrds_http_body_fn on_body, void *ctx, bool idempotent)
+{
+    return http_post(server, command, body, cnt, max_body_size, on_body, ctx, NULL, idempotent);
+}
+
+struct cfrds_http_stream {
+    cfrds_server *server;
+    cfrds_socket sockfd;
+    uint64_t deadline;
+    cfrds_http_parser parser;
+    bool parser_ready;
+    bool reusable;
+};
+
+/* Receives once into the stream parser, waiting until `deadline` for the data. */
+static cfrds_status http_stream_receive(cfrds_http_stream *stream, uint64_t deadline, size_t *received)
+{
+    cfrds_server *server = stream->server;
+    char recv_buf[CFRDS_HTTP_RECV_SIZE];
+    cfrds_status status;
+
+    while (1)
+    {
+        if (cfrds_http_now_ms() >= deadline) {
+            cfrds_server_error_ctx(server)->_errno = SOCKET_ETIMEDOUT;
+            cfrds_server_set_error(server, CFRDS_STATUS_READING_FROM_SOCKET_FAILED, "response read timed out");
+            return CFRDS_STATUS_READING_FROM_SOCKET_FAILED;
+        }
+
+        trace_net_start("recv");
+        ssize_t nread = recv(stream->sockfd, recv_buf, sizeof(recv_buf), 0);
+        trace_net_end();
+        if (nread < 0) {
+            int err = GET_SOCKET_ERRNO();
+            if (IS_SOCKET_EINTR(err))
+                continue;
+
+            if (IS_SOCKET_EWOULDBLOCK(err))
+            {
+                if (http_wait(stream->sockfd, POLLIN, deadline) >= 0)
+                    continue;
+
+                err = GET_SOCKET_ERRNO();
+            }
+
+            cfrds_server_error_ctx(server)->_errno = err;
+            cfrds_server_set_error(server, CFRDS_STATUS_READING_FROM_SOCKET_FAILED, "failed to read from socket...");
+            return CFRDS_STATUS_READING_FROM_SOCKET_FAILED;
+        }
+
+        if (nread == 0) {
+            status = cfrds_http_parser_finish(&stream->parser);
+            break;
+        }
+
+        *received += (size_t)nread;
+
+        size_t consumed = 0;
+        status = cfrds_http_parser_feed(&stream->parser, recv_buf, (size_t)nread, &consumed);
+        if ((status == CFRDS_STATUS_OK)&&(stream->parser.state == CFRDS_HTTP_STATE_DONE))
+            stream->reusable = (stream->parser.keep_alive)&&(consumed == (size_t)nread);
+        break;
+    }
+
+    if ((status != CFRDS_STATUS_OK)&&(stream->parser.error))
+        cfrds_server_set_error(server, status, stream->parser.error);
+
+    return status;
+}
+
+cfrds_status cfrds_http_stream_open(cfrds_server *server, const char *command, const cfrds_http_segment *body, size_t cnt, cfrds_http_body_fn on_body, void *ctx, cfrds_http_stream **out)
+{
+    cfrds_http_segment segs[CFRDS_HTTP_MAX_SEGMENTS];
+    cfrds_buffer_defer(send_buf);
+    size_t content_length = 0;
+    cfrds_status status;
+
+    if (cnt >= CFRDS_HTTP_MAX_SEGMENTS) {
+        cfrds_server_set_error(server, CFRDS_STATUS_INVALID_INPUT_PARAMETER, "too many request body segments");
+        return CFRDS_STATUS_INVALID_INPUT_PARAMETER;
+    }
+
+    if (!cfrds_buffer_create(&send_buf)) {
+        cfrds_server_set_error(server, CFRDS_STATUS_MEMORY_ERROR, "cfrds_buffer_create failed for send_buf");
+        return CFRDS_STATUS_MEMORY_ERROR;
+    }
+
+    for (size_t c = 0; c < cnt; c++)
+    {
+        content_length += body[c].size;
+        segs[c + 1] = body[c];
+    }
+
+    status = cfrds_http_build_header(server, command, content_length, send_buf);
+    if (status != CFRDS_STATUS_OK)
+        return status;
+
+    segs[0].data = cfrds_buffer_data(send_buf);
+    segs[0].size = cfrds_buffer_data_size(send_buf);
+
+    cfrds_http_stream *stream = malloc(sizeof(cfrds_http_stream));
+    if (stream == NULL) {
+        cfrds_server_set_error(server, CFRDS_STATUS_MEMORY_ERROR, "malloc failed for cfrds_http_stream");
+        return CFRDS_STATUS_MEMORY_ERROR;
+    }
+
+    explicit_bzero(stream, sizeof(cfrds_http_stream));
+    stream->server = server;
+    stream->sockfd = CFRDS_INVALID_SOCKET;
+    stream->deadline = cfrds_http_deadline(server->total_timeout_ms, UINT64_MAX);
+
+    uint64_t deadline = stream->deadline;
+    bool use_pool = true;
+
+    while (1)
+    {
+        bool reused = false;
+        size_t received = 0;
+        size_t sent = 0;
+
+        if ((server->keepalive)&&(use_pool))
+            reused = cfrds_http_pool_acquire(server, &stream->sockfd);
+
+        status = CFRDS_STATUS_OK;
+        if (!reused)
+            status = cfrds_http_connect(server, cfrds_http_deadline(server->connect_timeout_ms, deadline), &stream->sockfd);
+
+        if (status == CFRDS_STATUS_OK)
+        {
+            if (!cfrds_http_parser_init(&stream->parser, on_body, ctx)) {
+                cfrds_server_set_error(server, CFRDS_STATUS_MEMORY_ERROR, "cfrds_buffer_create failed for response header");
+                cfrds_http_stream_close(stream);
+                return CFRDS_STATUS_MEMORY_ERROR;
+            }
+            stream->parser_ready = true;
+            stream->parser.max_body_size = UINT64_MAX;
+
+            cfrds_server_error_ctx(server)->_errno = 0;
+            status = http_send_all(server, stream->sockfd, segs, cnt + 1, deadline, &sent);
+
+            uint64_t first_byte = cfrds_http_deadline(server->first_byte_timeout_ms, deadline);
+            while ((status == CFRDS_STATUS_OK)&&(stream->parser.state == CFRDS_HTTP_STATE_HEADERS))
+                status = http_stream_receive(stream, (received == 0) ? first_byte : deadline, &received);
+        }
+
+        /* A pooled socket closed by the peer yields nothing at all: retry once on a fresh connection,
+         * as long as no byte of the request reached it. */
+        if ((reused)&&(received == 0)&&(sent == 0)&&(cfrds_server_error_ctx(server)->_errno != SOCKET_ETIMEDOUT)&&
+            ((status == CFRDS_STATUS_RESPONSE_ERROR)||(status == CFRDS_STATUS_WRITING_TO_SOCKET_FAILED)||(status == CFRDS_STATUS_READING_FROM_SOCKET_FAILED)))
+        {
+            cfrds_sock_cleanup(&stream->sockfd);
+            cfrds_http_parser_cleanup(&stream->parser);
+            stream->parser_ready = false;
+            cfrds_server_clear_error(server);
+            use_pool = false;
+            continue;
+        }
+
+        break;
+    }
+
+    if ((status == CFRDS_STATUS_OK)&&(stream->parser.status_code != 200))
+    {
+        status = CFRDS_STATUS_RESPONSE_ERROR;
+        cfrds_server_set_error(server, status, "Invalid server response...");
+    }
+
+    if (status != CFRDS_STATUS_OK)
+    {
+        cfrds_http_stream_close(stream);
+        return status;
+    }
+
+    *out = stream;
+
+    return CFRDS_STATUS_OK;
+}
+
+cfrds_status cfrds_http_stream_read(cfrds_http_stream *stream)
+{
+    size_t received = 0;
+
+    if (stream->parser.state == CFRDS_HTTP_STATE_DONE)
+        return CFRDS_STATUS_OK;
+
+    return http_stream_receive(stream, stream->deadline, &received);
+}
+
+bool cfrds_http_stream_done(const cfrds_http_stream *stream)
+{
+    return stream->parser.state == CFRDS_HTTP_STATE_DONE;
+}
+
+void cfrds_http_stream_close(cfrds_http_stream *stream)
+{
+    if (stream == NULL)
+        return;
+
+    if ((stream->parser_ready)&&(stream->parser.state == CFRDS_HTTP_STATE_DONE)&&(stream->reusable)&&(stream->server->keepalive))
+        cfrds_http_pool_release(stream->server, &stream->sockfd);
+
+    cfrds_sock_cleanup(&stream->sockfd);
+
+    if (stream->parser_ready)
+        cfrds_http_parser_cleanup(&stream->parser);
+
+    free(stream);
+}
+
+static cfrds_status http_append_body(void *ctx, const char *data, size_t size)
+{
+    if (!cfrds_buffer_append_bytes((cfrds_buffer *)ctx, data, size))
+        return CFRDS_STATUS_MEMORY_ERROR;
+
+    return CFRDS_STATUS_OK;
+}
+
+cfrds_status cfrds_http_parse_rds_status(cfrds_server *server, cfrds_buffer *response)
+{
+    const char *response_data = cfrds_buffer_data(response);
+    size_t response_size = cfrds_buffer_data_size(response);
+    cfrds_error_ctx *ctx = cfrds_server_error_ctx(server);
+
+    if (!cfrds_buffer_parse_number(&response_data, &response_size, &ctx->error_code))
+    {
+        ctx->error_code = -1;
+        cfrds_server_set_error(server, CFRDS_STATUS_RESPONSE_ERROR, "cfrds_buffer_parse_number FAILED...");
+        return CFRDS_STATUS_RESPONSE_ERROR;
+    }
+
+    if (ctx->error_code < 0)
+    {
+        cfrds_server_set_error(server, CFRDS_STATUS_RESPONSE_ERROR, response_data);
+        return CFRDS_STATUS_RESPONSE_ERROR;
+    }
+
+    return CFRDS_STATUS_OK;
+}
+
+cfrds_status cfrds_http_post(cfrds_server *server, const char *command, cfrds_buffer *payload, cfrds_buffer **response)
+{
+    cfrds_http_segment body = {
+        .data = cfrds_buffer_data(payload),
+        .size = cfrds_buffer_data_size(payload),
+    };
+
+    return cfrds_http_post_segments(server, command, &body, 1, false, response);
+}
+
+cfrds_status cfrds_http_post_segments(cfrds_server *server, const char *command, const cfrds_http_segment *body, size_t cnt, bool idempotent, cfrds_buffer **response)
+{
+    cfrds_buffer_defer(tmp_response);
+    cfrds_status status;
+
+    if (!cfrds_buffer_create(&tmp_response)) {
+        cfrds_server_set_error(server, CFRDS_STATUS_MEMORY_ERROR, "cfrds_buffer_create failed for tmp_response");
+        return CFRDS_STATUS_MEMORY_ERROR;
+    }
+    cfrds_buffer_set_spill_threshold(tmp_response, server->spill_threshold);
+    cfrds_buffer_set_result_views(tmp_response, server->result_views);
+
+    status = http_post(server, command, body, cnt, server->max_response_size, http_append_body, tmp_response, tmp_response, idempotent);
+    if (status != CFRDS_STATUS_OK)
+        return status;
+
+    status = cfrds_http_parse_rds_status(server, tmp_response);
+    if (status != CFRDS_STATUS_OK)
+        return status;
+
     if (response)
     {
         *response = tmp_response; tmp_response = NULL;
@@ -332,7 +2144,7 @@ cfrds_status cfrds_http_post(cfrds_server *server, const char *command, cfrds_bu
 }
 
 #ifdef _WIN32
-static void cfrds_sock_cleanup(SOCKET* sock)
+void cfrds_sock_cleanup(cfrds_socket *sock)
 {
     if (sock)
     {
@@ -344,7 +2156,7 @@ static void cfrds_sock_cleanup(SOCKET* sock)
     }
 }
 #else
-static void cfrds_sock_cleanup(int* sock)
+void cfrds_sock_cleanup(cfrds_socket *sock)
 {
     if ((sock != NULL)&&(*sock != CFRDS_INVALID_SOCKET))
     {
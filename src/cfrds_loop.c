@@ -0,0 +1,1043 @@
+#include <cfrds.h>
+#include <internal/explicit_bzero.h>
+#include <internal/cfrds_int.h>
+#include <internal/cfrds_buffer.h>
+#include <internal/cfrds_http.h>
+#include <../tracing/tracing.h>
+
+#ifdef _WIN32
+#include <WinSock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <poll.h>
+#endif
+
+#ifdef __linux__
+#define CFRDS_LOOP_EPOLL
+#include <sys/epoll.h>
+#endif
+
+#ifdef CFRDS_HAVE_IO_URING
+#include <internal/cfrds_uring.h>
+#endif
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+
+#define CFRDS_LOOP_MAX_EVENTS 64
+#define CFRDS_LOOP_RECV_SIZE (16 * 1024)
+#define CFRDS_LOOP_URING_ENTRIES 256
+
+typedef enum {
+    CFRDS_LOOP_REQUEST_CONNECTING,
+    CFRDS_LOOP_REQUEST_SENDING,
+    CFRDS_LOOP_REQUEST_RECEIVING
+} cfrds_loop_request_state;
+
+typedef struct cfrds_loop_request {
+    struct cfrds_loop_request *prev;
+    struct cfrds_loop_request *next;
+    cfrds_server *server;
+    cfrds_loop_request_state state;
+    cfrds_socket sockfd;
+    bool watched;
+    bool reused;
+    bool idempotent;              ///< The command may be sent again after a stale pooled socket.
+    cfrds_http_addrs *addrs;
+    struct addrinfo *addr;
+    struct addrinfo *next_addr;
+    int sys_errno;
+    cfrds_buffer *send_buf;       ///< Request headers.
+    cfrds_buffer *payload;        ///< RDS body, sent after the headers without being copied.
+    size_t sent;
+    cfrds_http_parser parser;
+    cfrds_buffer *response;
+    size_t received;
+    uint64_t deadline;            ///< Total deadline, on the cfrds_http_now_ms() clock.
+    uint64_t connect_deadline;
+    uint64_t first_byte_deadline; ///< Set once the request is sent.
+    const char *error;
+    cfrds_sql_parser_fn parse;
+    cfrds_loop_done_fn done;
+    void *ctx;
+#ifdef CFRDS_HAVE_IO_URING
+    char *recv_buf;
+    struct msghdr msg;
+    struct iovec iov[2];
+    bool inflight;                ///< An io_uring operation referencing the request is queued.
+    bool zombie;                  ///< Completed while an operation was in flight, freed when it finishes.
+#endif
+} cfrds_loop_request;
+
+struct cfrds_loop {
+#ifdef CFRDS_HAVE_IO_URING
+    bool use_uring;
+    cfrds_uring ring;
+    struct __kernel_timespec ts;
+    size_t zombies;
+#endif
+#ifdef CFRDS_LOOP_EPOLL
+    int epfd;
+#else
+    struct pollfd *pfds;
+    cfrds_loop_request **pfd_requests;
+    size_t pfds_size;
+#endif
+    size_t pending;
+    cfrds_loop_request *head;
+    cfrds_loop_request *tail;
+};
+
+static cfrds_status loop_append_body(void *ctx, const char *data, size_t size)
+{
+    if (!cfrds_buffer_append_bytes((cfrds_buffer *)ctx, data, size))
+        return CFRDS_STATUS_MEMORY_ERROR;
+
+    return CFRDS_STATUS_OK;
+}
+
+static size_t loop_request_send_size(const cfrds_loop_request *req)
+{
+    return cfrds_buffer_data_size(req->send_buf) + cfrds_buffer_data_size(req->payload);
+}
+
+static void loop_request_segments(const cfrds_loop_request *req, cfrds_http_segment segs[2])
+{
+    segs[0].data = cfrds_buffer_data(req->send_buf);
+    segs[0].size = cfrds_buffer_data_size(req->send_buf);
+    segs[1].data = cfrds_buffer_data(req->payload);
+    segs[1].size = cfrds_buffer_data_size(req->payload);
+}
+
+static bool loop_watch(cfrds_loop *loop, cfrds_loop_request *req)
+{
+#ifdef CFRDS_LOOP_EPOLL
+    struct epoll_event ev;
+
+    explicit_bzero(&ev, sizeof(ev));
+    ev.events = (req->state == CFRDS_LOOP_REQUEST_RECEIVING) ? EPOLLIN : EPOLLOUT;
+    ev.data.ptr = req;
+
+    if (epoll_ctl(loop->epfd, req->watched ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, req->sockfd, &ev) != 0)
+    {
+        req->sys_errno = errno;
+        return false;
+    }
+#else
+    (void)loop;
+#endif
+
+    req->watched = true;
+
+    return true;
+}
+
+#ifdef CFRDS_HAVE_IO_URING
+static bool loop_uring_arm(cfrds_loop *loop, cfrds_loop_request *req)
+{
+    if ((req->state == CFRDS_LOOP_REQUEST_RECEIVING)&&(req->recv_buf == NULL))
+    {
+        req->recv_buf = malloc(CFRDS_LOOP_RECV_SIZE);
+        if (req->recv_buf == NULL)
+        {
+            req->sys_errno = ENOMEM;
+            return false;
+        }
+    }
+
+    struct io_uring_sqe *sqe = cfrds_uring_get_sqe(&loop->ring);
+    if (sqe == NULL)
+    {
+        req->sys_errno = EBUSY;
+        return false;
+    }
+
+    sqe->fd = req->sockfd;
+    sqe->user_data = (uintptr_t)req;
+
+    switch (req->state)
+    {
+    case CFRDS_LOOP_REQUEST_CONNECTING:
+        sqe->opcode = IORING_OP_CONNECT;
+        sqe->addr = (uintptr_t)req->addr->ai_addr;
+        sqe->off = req->addr->ai_addrlen;
+        break;
+    case CFRDS_LOOP_REQUEST_SENDING:
+    {
+        cfrds_http_segment segs[2];
+        size_t offset = req->sent;
+
+        loop_request_segments(req, segs);
+        explicit_bzero(&req->msg, sizeof(req->msg));
+        req->msg.msg_iov = req->iov;
+        for (size_t c = 0; c < 2; c++)
+        {
+            if (offset >= segs[c].size)
+            {
+                offset -= segs[c].size;
+                continue;
+            }
+
+            req->iov[req->msg.msg_iovlen].iov_base = (char *)segs[c].data + offset;
+            req->iov[req->msg.msg_iovlen].iov_len = segs[c].size - offset;
+            req->msg.msg_iovlen++;
+            offset = 0;
+        }
+
+        sqe->opcode = IORING_OP_SENDMSG;
+        sqe->addr = (uintptr_t)&req->msg;
+        sqe->len = 1;
+        sqe->msg_flags = CFRDS_SEND_FLAGS;
+        break;
+    }
+    case CFRDS_LOOP_REQUEST_RECEIVING:
+        sqe->opcode = IORING_OP_RECV;
+        sqe->addr = (uintptr_t)req->recv_buf;
+        sqe->len = CFRDS_LOOP_RECV_SIZE;
+        break;
+    }
+
+    req->inflight = true;
+
+    return true;
+}
+#endif
+
+/* Waits for the socket to become ready for the current state (io_uring: queues the operation itself). */
+static bool loop_arm(cfrds_loop *loop, cfrds_loop_request *req)
+{
+#ifdef CFRDS_HAVE_IO_URING
+    if (loop->use_uring)
+        return loop_uring_arm(loop, req);
+#endif
+
+    return loop_watch(loop, req);
+}
+
+static void loop_unwatch(cfrds_loop *loop, cfrds_loop_request *req)
+{
+#ifdef CFRDS_LOOP_EPOLL
+    if (req->watched)
+        epoll_ctl(loop->epfd, EPOLL_CTL_DEL, req->sockfd, NULL);
+#else
+    (void)loop;
+#endif
+
+    req->watched = false;
+}
+
+static void loop_request_close(cfrds_loop *loop, cfrds_loop_request *req)
+{
+    loop_unwatch(loop, req);
+    cfrds_sock_cleanup(&req->sockfd);
+}
+
+static cfrds_status loop_request_connect(cfrds_loop *loop, cfrds_loop_request *req)
+{
+    while (req->next_addr)
+    {
+        struct addrinfo *rp = req->next_addr;
+        req->next_addr = rp->ai_next;
+
+        trace_net_start("socket");
+        req->sockfd = socket(rp->ai_family, rp->ai_socktype, rp->ai_protocol);
+        trace_net_end();
+        if (req->sockfd == CFRDS_INVALID_SOCKET)
+        {
+            req->sys_errno = GET_SOCKET_ERRNO();
+            continue;
+        }
+
+        if (!cfrds_http_socket_set_blocking(req->sockfd, false))
+        {
+            req->sys_errno = GET_SOCKET_ERRNO();
+            cfrds_sock_cleanup(&req->sockfd);
+            continue;
+        }
+
+        req->addr = rp;
+
+#ifdef CFRDS_HAVE_IO_URING
+        if (loop->use_uring)
+        {
+            req->state = CFRDS_LOOP_REQUEST_CONNECTING;
+            if (!loop_arm(loop, req))
+            {
+                cfrds_sock_cleanup(&req->sockfd);
+                req->error = "failed to queue connect on the event loop";
+                return CFRDS_STATUS_SOCKET_CREATION_FAILED;
+            }
+
+            return CFRDS_STATUS_OK;
+        }
+#endif
+
+        trace_net_start("connect");
+        int res = connect(req->sockfd, rp->ai_addr, rp->ai_addrlen);
+        trace_net_end();
+        if (res == 0)
+        {
+            req->state = CFRDS_LOOP_REQUEST_SENDING;
+        }
+        else
+        {
+            int err = GET_SOCKET_ERRNO();
+            if (!IS_SOCKET_EINPROGRESS(err))
+            {
+                req->sys_errno = err;
+                cfrds_sock_cleanup(&req->sockfd);
+                continue;
+            }
+
+            req->state = CFRDS_LOOP_REQUEST_CONNECTING;
+        }
+
+        if (!loop_arm(loop, req))
+        {
+            cfrds_sock_cleanup(&req->sockfd);
+            req->error = "failed to register socket with the event loop";
+            return CFRDS_STATUS_SOCKET_CREATION_FAILED;
+        }
+
+        return CFRDS_STATUS_OK;
+    }
+
+    /* the host may have moved since it was cached, resolve it again next time */
+    cfrds_http_dns_flush(req->server);
+
+    req->error = "failed to establish connection to the server...";
+    return CFRDS_STATUS_CONNECTION_TO_SERVER_FAILED;
+}
+
+static cfrds_status loop_request_start(cfrds_loop *loop, cfrds_loop_request *req, bool use_pool)
+{
+    req->sent = 0;
+    req->received = 0;
+    req->reused = false;
+
+    cfrds_http_parser_cleanup(&req->parser);
+    if (!cfrds_http_parser_init(&req->parser, loop_append_body, req->response))
+    {
+        req->error = "cfrds_buffer_create failed for response header";
+        return CFRDS_STATUS_MEMORY_ERROR;
+    }
+    req->parser.max_body_size = req->server->max_response_size;
+
+    if ((use_pool)&&(req->server->keepalive)&&(cfrds_http_pool_acquire(req->server, &req->sockfd)))
+    {
+        req->reused = true;
+        req->state = CFRDS_LOOP_REQUEST_SENDING;
+
+        if (loop_arm(loop, req))
+            return CFRDS_STATUS_OK;
+
+        cfrds_sock_cleanup(&req->sockfd);
+        req->reused = false;
+    }
+
+    req->connect_deadline = cfrds_http_deadline(req->server->connect_timeout_ms, req->deadline);
+
+    /* blocks the loop on a DNS cache miss, see cfrds_loop_init */
+    if (req->addrs == NULL)
+    {
+        cfrds_status status = cfrds_http_resolve(req->server, &req->addrs, NULL);
+        if (status != CFRDS_STATUS_OK)
+        {
+            req->addrs = NULL;
+            req->error = (status == CFRDS_STATUS_MEMORY_ERROR) ? "failed to allocate resolved addresses" : "failed to resolve hostname...";
+            return status;
+        }
+    }
+
+    req->next_addr = req->addrs->list;
+
+    return loop_request_connect(loop, req);
+}
+
+static void loop_request_free(cfrds_loop *loop, cfrds_loop_request *req)
+{
+#ifdef CFRDS_HAVE_IO_URING
+    if (req->inflight)
+    {
+        /* the kernel still references the socket and buffers: cancel and free on its completion */
+        struct io_uring_sqe *sqe = cfrds_uring_get_sqe(&loop->ring);
+        if (sqe)
+        {
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->addr = (uintptr_t)req;
+        }
+        else
+        {
+            /* no room for the cancel even after flushing the SQ: shutting the socket down
+             * completes a pending connect, send or recv on it just as well */
+            shutdown(req->sockfd, SHUT_RDWR);
+        }
+
+        req->zombie = true;
+        loop->zombies++;
+        return;
+    }
+
+    free(req->recv_buf);
+#endif
+
+    loop_request_close(loop, req);
+    cfrds_http_parser_cleanup(&req->parser);
+    cfrds_buffer_free(req->send_buf);
+    cfrds_buffer_free(req->payload);
+    cfrds_buffer_free(req->response);
+    cfrds_http_addrs_release(req->addrs);
+    free(req);
+}
+
+static void loop_request_complete(cfrds_loop *loop, cfrds_loop_request *req, cfrds_status status, bool reusable)
+{
+    cfrds_server *server = req->server;
+    void *result = NULL;
+
+    if (req->prev)
+        req->prev->next = req->next;
+    else
+        loop->head = req->next;
+    if (req->next)
+        req->next->prev = req->prev;
+    else
+        loop->tail = req->prev;
+    loop->pending--;
+
+    /* The server error state describes the request being reported. */
+    cfrds_server_clear_error(server);
+    cfrds_server_error_ctx(server)->_errno = req->sys_errno;
+
+    if ((status != CFRDS_STATUS_OK)&&(req->error))
+        cfrds_server_set_error(server, status, req->error);
+
+    if ((status == CFRDS_STATUS_OK)&&(req->parser.status_code != 200))
+    {
+        status = CFRDS_STATUS_RESPONSE_ERROR;
+        cfrds_server_set_error(server, status, "Invalid server response...");
+    }
+
+    if ((status == CFRDS_STATUS_OK)&&(server->keepalive)&&(reusable))
+    {
+        loop_unwatch(loop, req);
+        cfrds_http_pool_release(server, &req->sockfd);
+    }
+
+    if (status == CFRDS_STATUS_OK)
+        status = cfrds_http_parse_rds_status(server, req->response);
+
+    if ((status == CFRDS_STATUS_OK)&&(req->parse))
+    {
+        result = req->parse(req->response);
+        if (result == NULL)
+        {
+            cfrds_server_error_ctx(server)->error_code = -1;
+            status = CFRDS_STATUS_RESPONSE_ERROR;
+        }
+    }
+
+    cfrds_loop_done_fn done = req->done;
+    void *ctx = req->ctx;
+
+    loop_request_free(loop, req);
+
+    done(server, status, result, ctx);
+}
+
+static void loop_request_fail(cfrds_loop *loop, cfrds_loop_request *req, cfrds_status status, const char *error)
+{
+    /* A pooled socket closed by the peer yields nothing at all: retry once on a fresh connection,
+     * unless the server may already have run a command that must not be repeated. */
+    if ((req->reused)&&(req->received == 0)&&((req->idempotent)||(req->sent == 0))&&
+        ((status == CFRDS_STATUS_RESPONSE_ERROR)||(status == CFRDS_STATUS_WRITING_TO_SOCKET_FAILED)||(status == CFRDS_STATUS_READING_FROM_SOCKET_FAILED)))
+    {
+        loop_request_close(loop, req);
+        req->sys_errno = 0;
+        req->error = NULL;
+
+        status = loop_request_start(loop, req, false);
+        if (status == CFRDS_STATUS_OK)
+            return;
+
+        error = req->error;
+    }
+
+    req->error = error;
+    loop_request_complete(loop, req, status, false);
+}
+
+static void loop_request_send(cfrds_loop *loop, cfrds_loop_request *req)
+{
+    cfrds_http_segment segs[2];
+    size_t size = loop_request_send_size(req);
+
+    loop_request_segments(req, segs);
+
+    while (req->sent < size)
+    {
+        trace_net_start("send");
+        ssize_t n = cfrds_http_send_segments(req->sockfd, segs, 2, req->sent);
+        trace_net_end();
+        if (n < 0)
+        {
+            int err = GET_SOCKET_ERRNO();
+            if (IS_SOCKET_EINTR(err))
+                continue;
+            if (IS_SOCKET_EWOULDBLOCK(err))
+                return;
+
+            req->sys_errno = err;
+            loop_request_fail(loop, req, CFRDS_STATUS_WRITING_TO_SOCKET_FAILED, "failed to write to socket...");
+            return;
+        }
+
+        req->sent += (size_t)n;
+    }
+
+    req->state = CFRDS_LOOP_REQUEST_RECEIVING;
+    req->first_byte_deadline = cfrds_http_deadline(req->server->first_byte_timeout_ms, req->deadline);
+    if (!loop_arm(loop, req))
+        loop_request_fail(loop, req, CFRDS_STATUS_SOCKET_CREATION_FAILED, "failed to register socket with the event loop");
+}
+
+static void loop_request_received(cfrds_loop *loop, cfrds_loop_request *req, const char *recv_buf, size_t nread)
+{
+    cfrds_status status;
+
+    if (nread == 0)
+    {
+        status = cfrds_http_parser_finish(&req->parser);
+        if (status != CFRDS_STATUS_OK)
+            loop_request_fail(loop, req, status, req->parser.error);
+        else
+            loop_request_complete(loop, req, status, false);
+        return;
+    }
+
+    req->received += nread;
+
+    size_t consumed = 0;
+    status = cfrds_http_parser_feed(&req->parser, recv_buf, nread, &consumed);
+    if (status != CFRDS_STATUS_OK)
+    {
+        loop_request_fail(loop, req, status, req->parser.error);
+        return;
+    }
+
+    if (req->parser.state == CFRDS_HTTP_STATE_DONE)
+    {
+        /* trailing bytes past the message make the connection unusable */
+        loop_request_complete(loop, req, status, (req->parser.keep_alive)&&(consumed == nread));
+        return;
+    }
+
+#ifdef CFRDS_HAVE_IO_URING
+    /* io_uring operations are one-shot, readiness watches stay armed */
+    if ((loop->use_uring)&&(!loop_arm(loop, req)))
+        loop_request_fail(loop, req, CFRDS_STATUS_SOCKET_CREATION_FAILED, "failed to queue operation on the event loop");
+#endif
+}
+
+static void loop_request_receive(cfrds_loop *loop, cfrds_loop_request *req)
+{
+    char recv_buf[CFRDS_LOOP_RECV_SIZE];
+
+    trace_net_start("recv");
+    ssize_t nread = recv(req->sockfd, recv_buf, sizeof(recv_buf), 0);
+    trace_net_end();
+    if (nread < 0)
+    {
+        int err = GET_SOCKET_ERRNO();
+        if ((IS_SOCKET_EINTR(err))||(IS_SOCKET_EWOULDBLOCK(err)))
+            return;
+
+        req->sys_errno = err;
+        loop_request_fail(loop, req, CFRDS_STATUS_READING_FROM_SOCKET_FAILED, "failed to read from socket...");
+        return;
+    }
+
+    loop_request_received(loop, req, recv_buf, (size_t)nread);
+}
+
+/* Handles the outcome of a connect attempt, returns true if the request can start sending. */
+static bool loop_request_connected(cfrds_loop *loop, cfrds_loop_request *req, int err)
+{
+    if (err != 0)
+    {
+        req->sys_errno = err;
+        loop_request_close(loop, req);
+
+        cfrds_status status = loop_request_connect(loop, req);
+        if (status != CFRDS_STATUS_OK)
+            loop_request_complete(loop, req, status, false);
+        return false;
+    }
+
+    req->state = CFRDS_LOOP_REQUEST_SENDING;
+
+    return true;
+}
+
+#ifdef CFRDS_HAVE_IO_URING
+static void loop_uring_completed(cfrds_loop *loop, cfrds_loop_request *req, int res)
+{
+    req->inflight = false;
+
+    if (req->zombie)
+    {
+        req->zombie = false;
+        loop->zombies--;
+        loop_request_free(loop, req);
+        return;
+    }
+
+    if ((res == -EINTR)||(res == -EAGAIN))
+    {
+        if (!loop_arm(loop, req))
+            loop_request_fail(loop, req, CFRDS_STATUS_SOCKET_CREATION_FAILED, "failed to queue operation on the event loop");
+        return;
+    }
+
+    switch (req->state)
+    {
+    case CFRDS_LOOP_REQUEST_CONNECTING:
+        if ((loop_request_connected(loop, req, (res < 0) ? -res : 0))&&(!loop_arm(loop, req)))
+            loop_request_fail(loop, req, CFRDS_STATUS_SOCKET_CREATION_FAILED, "failed to queue operation on the event loop");
+        break;
+    case CFRDS_LOOP_REQUEST_SENDING:
+        if (res < 0)
+        {
+            req->sys_errno = -res;
+            loop_request_fail(loop, req, CFRDS_STATUS_WRITING_TO_SOCKET_FAILED, "failed to write to socket...");
+            break;
+        }
+
+        req->sent += (size_t)res;
+        if (req->sent >= loop_request_send_size(req))
+        {
+            req->state = CFRDS_LOOP_REQUEST_RECEIVING;
+            req->first_byte_deadline = cfrds_http_deadline(req->server->first_byte_timeout_ms, req->deadline);
+        }
+
+        if (!loop_arm(loop, req))
+            loop_request_fail(loop, req, CFRDS_STATUS_SOCKET_CREATION_FAILED, "failed to queue operation on the event loop");
+        break;
+    case CFRDS_LOOP_REQUEST_RECEIVING:
+        if (res < 0)
+        {
+            req->sys_errno = -res;
+            loop_request_fail(loop, req, CFRDS_STATUS_READING_FROM_SOCKET_FAILED, "failed to read from socket...");
+            break;
+        }
+
+        loop_request_received(loop, req, req->recv_buf, (size_t)res);
+        break;
+    }
+}
+
+static void loop_uring_drain(cfrds_loop *loop)
+{
+    struct io_uring_cqe cqe;
+
+    /* user_data 0 marks timeouts and cancellations, which carry no request */
+    while (cfrds_uring_next_cqe(&loop->ring, &cqe))
+    {
+        if (cqe.user_data != 0)
+            loop_uring_completed(loop, (cfrds_loop_request *)(uintptr_t)cqe.user_data, cqe.res);
+    }
+}
+#endif
+
+static void loop_request_ready(cfrds_loop *loop, cfrds_loop_request *req)
+{
+    if (req->state == CFRDS_LOOP_REQUEST_CONNECTING)
+    {
+        int err = 0;
+        socklen_t len = sizeof(err);
+
+        if (getsockopt(req->sockfd, SOL_SOCKET, SO_ERROR, (char *)&err, &len) != 0)
+            err = GET_SOCKET_ERRNO();
+
+        if (!loop_request_connected(loop, req, err))
+            return;
+    }
+
+    if (req->state == CFRDS_LOOP_REQUEST_SENDING)
+        loop_request_send(loop, req);
+    else
+        loop_request_receive(loop, req);
+}
+
+/* Deadline of the phase the request is in. */
+static uint64_t loop_request_deadline(const cfrds_loop_request *req)
+{
+    if (req->state == CFRDS_LOOP_REQUEST_CONNECTING)
+        return req->connect_deadline;
+
+    if ((req->state == CFRDS_LOOP_REQUEST_RECEIVING)&&(req->received == 0))
+        return req->first_byte_deadline;
+
+    return req->deadline;
+}
+
+static void loop_expire(cfrds_loop *loop)
+{
+    uint64_t now = cfrds_http_now_ms();
+    cfrds_loop_request *req = loop->head;
+
+    while (req)
+    {
+        cfrds_loop_request *next = req->next;
+
+        if (now >= loop_request_deadline(req))
+        {
+            req->sys_errno = SOCKET_ETIMEDOUT;
+
+            if (req->state == CFRDS_LOOP_REQUEST_CONNECTING)
+            {
+                req->error = "failed to establish connection to the server...";
+                loop_request_complete(loop, req, CFRDS_STATUS_CONNECTION_TO_SERVER_FAILED, false);
+            }
+            else if ((req->state == CFRDS_LOOP_REQUEST_RECEIVING)&&(req->received == 0)&&(now < req->deadline))
+            {
+                req->error = "response read timed out (first byte deadline exceeded)";
+                loop_request_complete(loop, req, CFRDS_STATUS_READING_FROM_SOCKET_FAILED, false);
+            }
+            else
+            {
+                req->error = "response read timed out (overall deadline exceeded)";
+                loop_request_complete(loop, req, CFRDS_STATUS_READING_FROM_SOCKET_FAILED, false);
+            }
+        }
+
+        req = next;
+    }
+}
+
+static int loop_wait_timeout(cfrds_loop *loop, int timeout_ms)
+{
+    uint64_t now = cfrds_http_now_ms();
+
+    for (cfrds_loop_request *req = loop->head; req; req = req->next)
+    {
+        uint64_t deadline = loop_request_deadline(req);
+        uint64_t left = (deadline > now) ? deadline - now : 0;
+        int left_ms = (left > INT_MAX) ? INT_MAX : (int)left;
+
+        if ((timeout_ms < 0)||(left_ms < timeout_ms))
+            timeout_ms = left_ms;
+    }
+
+    return timeout_ms;
+}
+
+bool cfrds_loop_init(cfrds_loop **loop)
+{
+    if (loop == NULL)
+        return false;
+
+    cfrds_loop *ret = malloc(sizeof(cfrds_loop));
+    if (ret == NULL)
+        return false;
+
+    explicit_bzero(ret, sizeof(cfrds_loop));
+
+#ifdef CFRDS_HAVE_IO_URING
+    /* io_uring may be compiled in but unavailable at runtime (old kernel, seccomp, sysctl) */
+    ret->use_uring = cfrds_uring_init(&ret->ring, CFRDS_LOOP_URING_ENTRIES);
+    if (ret->use_uring)
+    {
+        ret->epfd = -1;
+        *loop = ret;
+        return true;
+    }
+#endif
+
+#ifdef CFRDS_LOOP_EPOLL
+    ret->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (ret->epfd < 0)
+    {
+        free(ret);
+        return false;
+    }
+#endif
+
+    *loop = ret;
+
+    return true;
+}
+
+void cfrds_loop_free(cfrds_loop *loop)
+{
+    if (loop == NULL)
+        return;
+
+    while (loop->head)
+    {
+        loop->head->error = "request cancelled";
+        loop_request_complete(loop, loop->head, CFRDS_STATUS_COMMAND_FAILED, false);
+    }
+
+#ifdef CFRDS_HAVE_IO_URING
+    if (loop->use_uring)
+    {
+        /* cancelled requests are released once the kernel is done with them */
+        while (loop->zombies > 0)
+        {
+            int res = cfrds_uring_submit(&loop->ring, 1);
+            if ((res < 0)&&(res != -EINTR)&&(res != -EBUSY))
+                break;
+
+            loop_uring_drain(loop);
+        }
+
+        cfrds_uring_cleanup(&loop->ring);
+    }
+#endif
+
+#ifdef CFRDS_LOOP_EPOLL
+    if (loop->epfd >= 0)
+        close(loop->epfd);
+#else
+    free(loop->pfds);
+    free(loop->pfd_requests);
+#endif
+
+    free(loop);
+}
+
+void cfrds_loop_cleanup(cfrds_loop **loop)
+{
+    if (loop)
+    {
+        cfrds_loop_free(*loop);
+        *loop = NULL;
+    }
+}
+
+const char *cfrds_loop_get_backend(const cfrds_loop *loop)
+{
+    if (loop == NULL)
+        return NULL;
+
+#ifdef CFRDS_HAVE_IO_URING
+    if (loop->use_uring)
+        return "io_uring";
+#endif
+
+#ifdef CFRDS_LOOP_EPOLL
+    return "epoll";
+#else
+    return "poll";
+#endif
+}
+
+size_t cfrds_loop_pending(const cfrds_loop *loop)
+{
+    if (loop == NULL)
+        return 0;
+
+    return loop->pending;
+}
+
+cfrds_status cfrds_loop_run_once(cfrds_loop *loop, int timeout_ms)
+{
+    if (loop == NULL)
+        return CFRDS_STATUS_PARAM_IS_NULL;
+
+    if (loop->pending == 0)
+        return CFRDS_STATUS_OK;
+
+    timeout_ms = loop_wait_timeout(loop, timeout_ms);
+
+#ifdef CFRDS_HAVE_IO_URING
+    if (loop->use_uring)
+    {
+        if (timeout_ms > 0)
+        {
+            /* completes after the timeout or as soon as any other operation completes */
+            struct io_uring_sqe *sqe = cfrds_uring_get_sqe(&loop->ring);
+            if (sqe == NULL)
+                return CFRDS_STATUS_COMMAND_FAILED;
+
+            loop->ts.tv_sec = timeout_ms / 1000;
+            loop->ts.tv_nsec = (long long)(timeout_ms % 1000) * 1000000;
+            sqe->opcode = IORING_OP_TIMEOUT;
+            sqe->addr = (uintptr_t)&loop->ts;
+            sqe->len = 1;
+            sqe->off = 1;
+        }
+
+        trace_net_start("io_uring_enter");
+        int res = cfrds_uring_submit(&loop->ring, (timeout_ms == 0) ? 0 : 1);
+        trace_net_end();
+        if ((res < 0)&&(res != -EINTR)&&(res != -ETIME))
+            return CFRDS_STATUS_COMMAND_FAILED;
+
+        loop_uring_drain(loop);
+        loop_expire(loop);
+
+        return CFRDS_STATUS_OK;
+    }
+#endif
+
+#ifdef CFRDS_LOOP_EPOLL
+    struct epoll_event events[CFRDS_LOOP_MAX_EVENTS];
+
+    trace_net_start("epoll_wait");
+    int n = epoll_wait(loop->epfd, events, CFRDS_LOOP_MAX_EVENTS, timeout_ms);
+    trace_net_end();
+    if ((n < 0)&&(errno != EINTR))
+        return CFRDS_STATUS_COMMAND_FAILED;
+
+    for (int c = 0; c < n; c++)
+        loop_request_ready(loop, events[c].data.ptr);
+#else
+    if (loop->pfds_size < loop->pending)
+    {
+        struct pollfd *pfds = realloc(loop->pfds, sizeof(struct pollfd) * loop->pending);
+        if (pfds == NULL)
+            return CFRDS_STATUS_MEMORY_ERROR;
+        loop->pfds = pfds;
+
+        cfrds_loop_request **requests = realloc(loop->pfd_requests, sizeof(cfrds_loop_request *) * loop->pending);
+        if (requests == NULL)
+            return CFRDS_STATUS_MEMORY_ERROR;
+        loop->pfd_requests = requests;
+
+        loop->pfds_size = loop->pending;
+    }
+
+    size_t cnt = 0;
+    for (cfrds_loop_request *req = loop->head; req; req = req->next)
+    {
+        loop->pfds[cnt].fd = req->sockfd;
+        loop->pfds[cnt].events = (req->state == CFRDS_LOOP_REQUEST_RECEIVING) ? POLLIN : POLLOUT;
+        loop->pfds[cnt].revents = 0;
+        loop->pfd_requests[cnt] = req;
+        cnt++;
+    }
+
+    trace_net_start("poll");
+#ifdef _WIN32
+    int n = WSAPoll(loop->pfds, (ULONG)cnt, timeout_ms);
+#else
+    int n = poll(loop->pfds, (nfds_t)cnt, timeout_ms);
+#endif
+    trace_net_end();
+    if ((n < 0)&&(!IS_SOCKET_EINTR(GET_SOCKET_ERRNO())))
+        return CFRDS_STATUS_COMMAND_FAILED;
+
+    /* requests submitted from callbacks are appended to the list and polled on the next round */
+    for (size_t c = 0; (n > 0)&&(c < cnt); c++)
+    {
+        if (loop->pfds[c].revents != 0)
+            loop_request_ready(loop, loop->pfd_requests[c]);
+    }
+#endif
+
+    loop_expire(loop);
+
+    return CFRDS_STATUS_OK;
+}
+
+cfrds_status cfrds_loop_run(cfrds_loop *loop)
+{
+    if (loop == NULL)
+        return CFRDS_STATUS_PARAM_IS_NULL;
+
+    while (loop->pending > 0)
+    {
+        cfrds_status status = cfrds_loop_run_once(loop, -1);
+        if (status != CFRDS_STATUS_OK)
+            return status;
+    }
+
+    return CFRDS_STATUS_OK;
+}
+
+cfrds_status cfrds_loop_submit(cfrds_loop *loop, cfrds_server *server, const char *command, const char *list[], bool idempotent, cfrds_sql_parser_fn parser, cfrds_loop_done_fn done, void *ctx)
+{
+    cfrds_buffer_defer(payload);
+    cfrds_status status;
+
+    if ((loop == NULL)||(command == NULL)||(list == NULL)||(done == NULL))
+        return CFRDS_STATUS_PARAM_IS_NULL;
+
+    if (server == NULL)
+        return CFRDS_STATUS_SERVER_IS_NULL;
+
+    cfrds_server_error_ctx(server)->_errno = 0;
+    cfrds_server_clear_error(server);
+
+    cfrds_loop_request *req = malloc(sizeof(cfrds_loop_request));
+    if (req == NULL)
+        return CFRDS_STATUS_MEMORY_ERROR;
+
+    explicit_bzero(req, sizeof(cfrds_loop_request));
+    req->server = server;
+    req->sockfd = CFRDS_INVALID_SOCKET;
+    req->idempotent = idempotent;
+    req->parse = parser;
+    req->done = done;
+    req->ctx = ctx;
+    req->deadline = cfrds_http_deadline(server->total_timeout_ms, UINT64_MAX);
+
+    status = cfrds_build_command_payload(server, list, &payload);
+    if (status == CFRDS_STATUS_OK)
+    {
+        if ((!cfrds_buffer_create(&req->send_buf))||(!cfrds_buffer_create(&req->response)))
+        {
+            cfrds_server_set_error(server, CFRDS_STATUS_MEMORY_ERROR, "cfrds_buffer_create failed for send_buf");
+            status = CFRDS_STATUS_MEMORY_ERROR;
+        }
+        else
+        {
+            cfrds_buffer_set_spill_threshold(req->response, server->spill_threshold);
+            cfrds_buffer_set_result_views(req->response, server->result_views);
+        }
+    }
+
+    if (status == CFRDS_STATUS_OK)
+    {
+        req->payload = payload; payload = NULL;
+        status = cfrds_http_build_header(server, command, cfrds_buffer_data_size(req->payload), req->send_buf);
+    }
+
+    if (status == CFRDS_STATUS_OK)
+    {
+        status = loop_request_start(loop, req, true);
+        if (status != CFRDS_STATUS_OK)
+        {
+            cfrds_server_error_ctx(server)->_errno = req->sys_errno;
+            if (req->error)
+                cfrds_server_set_error(server, status, req->error);
+        }
+    }
+
+    if (status != CFRDS_STATUS_OK)
+    {
+        loop_request_free(loop, req);
+        return status;
+    }
+
+    req->prev = loop->tail;
+    if (loop->tail)
+        loop->tail->next = req;
+    else
+        loop->head = req;
+    loop->tail = req;
+    loop->pending++;
+
+    return CFRDS_STATUS_OK;
+}
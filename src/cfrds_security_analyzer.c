@@ -222,26 +222,26 @@ cfrds_status cfrds_command_security_analyzer_result(cfrds_server *server, int co
 
         if (!cfrds_buffer_parse_number(&response_data, &response_size, &items))
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
         if (items != 1)
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
         if (!cfrds_buffer_parse_string(&response_data, &response_size, &json_str))
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
         struct json_object *json_obj = json_tokener_parse(json_str);
         if (json_obj == NULL)
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
 
@@ -10,6 +10,10 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#define CFRDS_KEEPALIVE_DEFAULT_MAX_IDLE 4
+#define CFRDS_KEEPALIVE_DEFAULT_IDLE_TIMEOUT_SEC 15
+#define CFRDS_DNS_CACHE_DEFAULT_TTL_SEC 30
+
 void cfrds_server_cleanup(cfrds_server **server)
 {
     if (server && *server) {
@@ -18,18 +22,217 @@ void cfrds_server_cleanup(cfrds_server **server)
     }
 }
 
+/* One thread-local key for the whole library, its value heads the list of the thread's contexts.
+ * error_lock guards the server lists and detaching, lookups only walk the thread's own list. */
+static cfrds_tls_key error_key;
+static bool error_key_ready;
+static uint64_t error_serial;
+#ifdef _WIN32
+static INIT_ONCE error_key_once = INIT_ONCE_STATIC_INIT;
+static SRWLOCK error_lock = SRWLOCK_INIT;
+#else
+static pthread_once_t error_key_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t error_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static void error_lock_acquire(void)
+{
+#ifdef _WIN32
+    AcquireSRWLockExclusive(&error_lock);
+#else
+    pthread_mutex_lock(&error_lock);
+#endif
+}
+
+static void error_lock_release(void)
+{
+#ifdef _WIN32
+    ReleaseSRWLockExclusive(&error_lock);
+#else
+    pthread_mutex_unlock(&error_lock);
+#endif
+}
+
+static cfrds_error_ctx *error_ctx_thread_list(void)
+{
+#ifdef _WIN32
+    return FlsGetValue(error_key);
+#else
+    return pthread_getspecific(error_key);
+#endif
+}
+
+static bool error_ctx_set_thread_list(cfrds_error_ctx *head)
+{
+#ifdef _WIN32
+    return FlsSetValue(error_key, head);
+#else
+    return pthread_setspecific(error_key, head) == 0;
+#endif
+}
+
+static void error_ctx_unlink(cfrds_server *server, cfrds_error_ctx *ctx)
+{
+    if (ctx->prev)
+        ctx->prev->next = ctx->next;
+    else
+        server->error_ctxs = ctx->next;
+
+    if (ctx->next)
+        ctx->next->prev = ctx->prev;
+}
+
+/* Frees the contexts of an exiting thread. */
+#ifdef _WIN32
+static void WINAPI error_ctx_thread_exit(void *ptr)
+#else
+static void error_ctx_thread_exit(void *ptr)
+#endif
+{
+    cfrds_error_ctx *ctx = ptr;
+
+    error_lock_acquire();
+    while (ctx)
+    {
+        cfrds_error_ctx *next = ctx->thread_next;
+
+        if (ctx->server)
+            error_ctx_unlink(ctx->server, ctx);
+        free(ctx->error);
+        free(ctx);
+
+        ctx = next;
+    }
+    error_lock_release();
+}
+
+#ifdef _WIN32
+static BOOL CALLBACK error_key_init(PINIT_ONCE once, PVOID param, PVOID *context)
+{
+    (void)once; (void)param; (void)context;
+
+    error_key = FlsAlloc(error_ctx_thread_exit);
+    error_key_ready = (error_key != FLS_OUT_OF_INDEXES);
+
+    return TRUE;
+}
+#else
+static void error_key_init(void)
+{
+    error_key_ready = (pthread_key_create(&error_key, error_ctx_thread_exit) == 0);
+}
+#endif
+
+static bool error_key_create(void)
+{
+#ifdef _WIN32
+    InitOnceExecuteOnce(&error_key_once, error_key_init, NULL, NULL);
+#else
+    pthread_once(&error_key_once, error_key_init);
+#endif
+
+    return error_key_ready;
+}
+
+static cfrds_error_ctx *error_ctx_find(const cfrds_server *server)
+{
+    for (cfrds_error_ctx *ctx = error_ctx_thread_list(); ctx; ctx = ctx->thread_next)
+    {
+        if (ctx->serial == server->serial)
+            return ctx;
+    }
+
+    return NULL;
+}
+
+cfrds_error_ctx *cfrds_server_error_ctx(const cfrds_server *server)
+{
+    static _Thread_local cfrds_error_ctx fallback = { ._errno = 0, .error_code = 1, };
+    cfrds_server *owner = (cfrds_server *)server;
+
+    cfrds_error_ctx *ret = error_ctx_find(server);
+    if (ret)
+        return ret;
+
+    ret = malloc(sizeof(cfrds_error_ctx));
+    if (ret == NULL)
+        return &fallback;
+
+    ret->_errno = 0;
+    ret->error_code = 1;
+    ret->error = NULL;
+    ret->serial = owner->serial;
+    ret->server = owner;
+    ret->prev = NULL;
+
+    ret->thread_next = error_ctx_thread_list();
+    if (!error_ctx_set_thread_list(ret))
+    {
+        free(ret);
+        return &fallback;
+    }
+
+    error_lock_acquire();
+
+    /* drop the contexts of servers freed by other threads meanwhile */
+    cfrds_error_ctx **link = &ret->thread_next;
+    while (*link)
+    {
+        cfrds_error_ctx *ctx = *link;
+
+        if (ctx->server)
+        {
+            link = &ctx->thread_next;
+            continue;
+        }
+
+        *link = ctx->thread_next;
+        free(ctx->error);
+        free(ctx);
+    }
+
+    ret->next = owner->error_ctxs;
+    if (ret->next)
+        ret->next->prev = ret;
+    owner->error_ctxs = ret;
+
+    error_lock_release();
+
+    return ret;
+}
+
+void cfrds_server_lock(const cfrds_server *server)
+{
+#ifdef _WIN32
+    AcquireSRWLockExclusive((PSRWLOCK)&server->lock);
+#else
+    pthread_mutex_lock((pthread_mutex_t *)&server->lock);
+#endif
+}
+
+void cfrds_server_unlock(const cfrds_server *server)
+{
+#ifdef _WIN32
+    ReleaseSRWLockExclusive((PSRWLOCK)&server->lock);
+#else
+    pthread_mutex_unlock((pthread_mutex_t *)&server->lock);
+#endif
+}
+
 void cfrds_server_clear_error(cfrds_server *server)
 {
     if (server == NULL)
         return;
 
-    server->_errno = 0;
-    server->error_code = 1;
+    cfrds_error_ctx *ctx = cfrds_server_error_ctx(server);
 
-    if (server->error)
+    ctx->_errno = 0;
+    ctx->error_code = 1;
+
+    if (ctx->error)
     {
-        free(server->error);
-        server->error = NULL;
+        free(ctx->error);
+        ctx->error = NULL;
     }
 }
 
@@ -75,6 +278,26 @@ bool cfrds_server_init(cfrds_server **server, const char *host, uint16_t port, c
 
     explicit_bzero(ret, sizeof(cfrds_server));
 
+    if (!error_key_create())
+    {
+        free(ret);
+        ret = NULL;
+        return false;
+    }
+
+    /* The lock comes first, cfrds_server_free relies on it from here on */
+#ifdef _WIN32
+    InitializeSRWLock(&ret->lock);
+#else
+    if (pthread_mutex_init(&ret->lock, NULL) != 0)
+    {
+        free(ret);
+        ret = NULL;
+        return false;
+    }
+#endif
+    ret->serial = __atomic_add_fetch(&error_serial, 1, __ATOMIC_RELAXED);
+
     ret->host = strdup(host);
     if (ret->host == NULL)
         return false;
@@ -97,9 +320,15 @@ bool cfrds_server_init(cfrds_server **server, const char *host, uint16_t port, c
             return false;
     }
 
-    ret->_errno = 0;
-    ret->error_code = 1;
-    ret->error = NULL;
+    ret->dns_ttl = CFRDS_DNS_CACHE_DEFAULT_TTL_SEC;
+    ret->connect_timeout_ms = CFRDS_HTTP_CONNECT_TIMEOUT_MS;
+    ret->first_byte_timeout_ms = CFRDS_HTTP_FIRST_BYTE_TIMEOUT_MS;
+    ret->total_timeout_ms = CFRDS_HTTP_TOTAL_TIMEOUT_MS;
+    ret->max_response_size = CFRDS_MAX_RESPONSE_SIZE;
+    ret->retry_max_attempts = 1;
+    ret->retry_backoff_base_ms = CFRDS_HTTP_RETRY_BACKOFF_BASE_MS;
+    ret->retry_backoff_max_ms = CFRDS_HTTP_RETRY_BACKOFF_MAX_MS;
+    ret->jitter_state = cfrds_http_now_ms() ^ (uint64_t)(uintptr_t)ret;
 
     *server = ret;
     ret = NULL;
@@ -112,7 +341,38 @@ void cfrds_server_free(cfrds_server *server)
     if (server == NULL)
         return;
 
-    cfrds_server_clear_error(server);
+    cfrds_http_pool_free(server);
+    cfrds_http_dns_flush(server);
+
+    /* the calling thread frees its own context, the other threads' are left to them */
+    error_lock_acquire();
+    for (cfrds_error_ctx *ctx = server->error_ctxs; ctx; ctx = ctx->next)
+        ctx->server = NULL;
+    server->error_ctxs = NULL;
+
+    cfrds_error_ctx *first = error_ctx_thread_list();
+    cfrds_error_ctx *head = first;
+    cfrds_error_ctx **link = &head;
+    while (*link)
+    {
+        cfrds_error_ctx *ctx = *link;
+
+        if (ctx->serial != server->serial)
+        {
+            link = &ctx->thread_next;
+            continue;
+        }
+
+        *link = ctx->thread_next;
+        free(ctx->error);
+        free(ctx);
+    }
+    if (head != first)
+        error_ctx_set_thread_list(head);
+    error_lock_release();
+#ifndef _WIN32
+    pthread_mutex_destroy(&server->lock);
+#endif
 
     free(server->host);
     free(server->username);
@@ -133,14 +393,16 @@ void cfrds_server_set_error(cfrds_server *server, int64_t error_code, const char
     if (server == NULL)
         return;
 
-    server->error_code = error_code;
+    cfrds_error_ctx *ctx = cfrds_server_error_ctx(server);
+
+    ctx->error_code = error_code;
 
-    free(server->error);
+    free(ctx->error);
 
     if (error)
-        server->error = strdup(error);
+        ctx->error = strdup(error);
     else
-        server->error = NULL;
+        ctx->error = NULL;
 }
 
 const char *cfrds_server_get_error(const cfrds_server *server)
@@ -148,7 +410,11 @@ const char *cfrds_server_get_error(const cfrds_server *server)
     if (server == NULL)
         return NULL;
 
-    return server->error;
+    cfrds_error_ctx *ctx = error_ctx_find(server);
+    if (ctx == NULL)
+        return NULL;
+
+    return ctx->error;
 }
 
 const char *cfrds_server_get_host(const cfrds_server *server)
@@ -183,18 +449,123 @@ const char *cfrds_server_get_password(const cfrds_server *server)
     return server->orig_password;
 }
 
-cfrds_status cfrds_send_command(cfrds_server *server, cfrds_buffer **response, const char *command, const char *list[])
+bool cfrds_server_set_keepalive(cfrds_server *server, bool enabled, size_t max_idle, unsigned int idle_timeout_sec)
 {
-    cfrds_status ret = CFRDS_STATUS_OK;
+    if (server == NULL)
+        return false;
 
-    cfrds_buffer_defer(post);
-    size_t total_cnt = 0;
-    size_t list_cnt = 0;
+    cfrds_http_pool_free(server);
+
+    server->keepalive = enabled;
+    server->keepalive_max_idle = max_idle ? max_idle : CFRDS_KEEPALIVE_DEFAULT_MAX_IDLE;
+    server->keepalive_idle_timeout = idle_timeout_sec ? idle_timeout_sec : CFRDS_KEEPALIVE_DEFAULT_IDLE_TIMEOUT_SEC;
+
+    return true;
+}
+
+bool cfrds_server_set_dns_cache(cfrds_server *server, unsigned int ttl_sec)
+{
+    if (server == NULL)
+        return false;
+
+    cfrds_http_dns_flush(server);
+
+    server->dns_ttl = ttl_sec;
+
+    return true;
+}
+
+bool cfrds_server_set_happy_eyeballs(cfrds_server *server, bool enabled)
+{
+    if (server == NULL)
+        return false;
+
+    server->happy_eyeballs = enabled;
+
+    return true;
+}
+
+bool cfrds_server_set_timeouts(cfrds_server *server, unsigned int connect_ms, unsigned int first_byte_ms, unsigned int total_ms)
+{
+    if (server == NULL)
+        return false;
+
+    server->connect_timeout_ms = connect_ms ? connect_ms : CFRDS_HTTP_CONNECT_TIMEOUT_MS;
+    server->first_byte_timeout_ms = first_byte_ms ? first_byte_ms : CFRDS_HTTP_FIRST_BYTE_TIMEOUT_MS;
+    server->total_timeout_ms = total_ms ? total_ms : CFRDS_HTTP_TOTAL_TIMEOUT_MS;
+
+    return true;
+}
+
+bool cfrds_server_set_response_limits(cfrds_server *server, uint64_t max_size, size_t spill_threshold)
+{
+    if (server == NULL)
+        return false;
+
+    server->max_response_size = max_size ? max_size : CFRDS_MAX_RESPONSE_SIZE;
+    server->spill_threshold = spill_threshold;
+
+    return true;
+}
+
+bool cfrds_server_set_result_views(cfrds_server *server, bool enabled)
+{
+    if (server == NULL)
+        return false;
+
+    server->result_views = enabled;
+
+    return true;
+}
+
+bool cfrds_server_set_retry_policy(cfrds_server *server, unsigned int max_attempts, unsigned int backoff_base_ms, unsigned int backoff_max_ms, unsigned int hedge_after_ms)
+{
+    if (server == NULL)
+        return false;
+
+    server->retry_max_attempts = max_attempts ? max_attempts : 1;
+    server->retry_backoff_base_ms = backoff_base_ms ? backoff_base_ms : CFRDS_HTTP_RETRY_BACKOFF_BASE_MS;
+    server->retry_backoff_max_ms = backoff_max_ms ? backoff_max_ms : CFRDS_HTTP_RETRY_BACKOFF_MAX_MS;
+    server->hedge_after_ms = hedge_after_ms;
 
+    return true;
+}
+
+cfrds_status cfrds_server_prewarm(cfrds_server *server, size_t count)
+{
     if (server == NULL)
         return CFRDS_STATUS_SERVER_IS_NULL;
 
-    server->_errno = 0;
+    cfrds_server_clear_error(server);
+
+    if (!server->keepalive) {
+        cfrds_server_set_error(server, CFRDS_STATUS_INVALID_INPUT_PARAMETER, "keep-alive is disabled, there is no pool to prewarm");
+        return CFRDS_STATUS_INVALID_INPUT_PARAMETER;
+    }
+
+    return cfrds_http_pool_prewarm(server, count);
+}
+
+bool cfrds_server_set_compression(cfrds_server *server, bool enabled)
+{
+    if (server == NULL)
+        return false;
+
+#ifndef CFRDS_HAVE_ZLIB
+    if (enabled)
+        return false;
+#endif
+
+    server->compression = enabled;
+
+    return true;
+}
+
+cfrds_status cfrds_build_command_payload(cfrds_server *server, const char *list[], cfrds_buffer **payload)
+{
+    cfrds_buffer_defer(post);
+    size_t total_cnt = 0;
+    size_t list_cnt = 0;
 
     for(size_t c = 0; c < 1024; c++)
     {
@@ -213,8 +584,6 @@ cfrds_status cfrds_send_command(cfrds_server *server, cfrds_buffer **response, c
     if (server->username) total_cnt++;
     if (server->password) total_cnt++;
 
-    cfrds_server_clear_error(server);
-
     if (!cfrds_buffer_create(&post))
         return CFRDS_STATUS_MEMORY_ERROR;
 
@@ -233,7 +602,39 @@ cfrds_status cfrds_send_command(cfrds_server *server, cfrds_buffer **response, c
     if (server->password && !cfrds_buffer_append_rds_string(post, server->password))
         return CFRDS_STATUS_MEMORY_ERROR;
 
-    ret = cfrds_http_post(server, command, post, response);
+    *payload = post; post = NULL;
+
+    return CFRDS_STATUS_OK;
+}
+
+static cfrds_status send_command(cfrds_server *server, cfrds_buffer **response, const char *command, const char *list[], bool idempotent)
+{
+    cfrds_status ret = CFRDS_STATUS_OK;
+
+    cfrds_buffer_defer(post);
+
+    if (server == NULL)
+        return CFRDS_STATUS_SERVER_IS_NULL;
+
+    cfrds_server_clear_error(server);
+
+    ret = cfrds_build_command_payload(server, list, &post);
+    if (ret != CFRDS_STATUS_OK)
+        return ret;
+
+    const cfrds_http_segment body = { .data = cfrds_buffer_data(post), .size = cfrds_buffer_data_size(post) };
+
+    ret = cfrds_http_post_segments(server, command, &body, 1, idempotent, response);
 
     return ret;
 }
+
+cfrds_status cfrds_send_command(cfrds_server *server, cfrds_buffer **response, const char *command, const char *list[])
+{
+    return send_command(server, response, command, list, false);
+}
+
+cfrds_status cfrds_send_idempotent_command(cfrds_server *server, cfrds_buffer **response, const char *command, const char *list[])
+{
+    return send_command(server, response, command, list, true);
+}
@@ -1,3 +1,4 @@
+#include <internal/explicit_bzero.h>
 #include <internal/cfrds_buffer.h>
 #include <internal/cfrds_http.h>
 #include <internal/cfrds_int.h>
@@ -5,18 +6,24 @@
 
 #include <stdlib.h>
 #include <stddef.h>
+#include <string.h>
+#include <stdint.h>
 
 cfrds_status cfrds_execute_sql_cmd(cfrds_server *server, const char *params[], cfrds_sql_parser_fn parser, void **out_result)
 {
     cfrds_buffer_defer(response);
 
-    cfrds_status ret = cfrds_send_command(server, &response, "DBFUNCS", params);
+    /* metadata lookups are read-only, statements (also when only describing them) run user SQL */
+    bool idempotent = (strcmp(params[1], "SQLSTMNT") != 0)&&(strcmp(params[1], "SQLMETADATA") != 0);
+
+    cfrds_status ret = idempotent ? cfrds_send_idempotent_command(server, &response, "DBFUNCS", params) :
+                                    cfrds_send_command(server, &response, "DBFUNCS", params);
     if (ret == CFRDS_STATUS_OK)
     {
         void *res = parser(response);
         if (res == NULL)
         {
-            server->error_code = -1;
+            cfrds_server_error_ctx(server)->error_code = -1;
             return CFRDS_STATUS_RESPONSE_ERROR;
         }
         *out_result = res;
@@ -112,3 +119,558 @@ cfrds_status cfrds_command_sql_dbdescription(cfrds_server *server, const char *c
 
     return cfrds_execute_sql_cmd(server, (const char *[]){ connection_name, "DBDESCRIPTION", NULL }, (cfrds_sql_parser_fn)cfrds_buffer_to_sql_dbdescription, (void **)description);
 }
+
+typedef enum {
+    CFRDS_SQL_CURSOR_COUNT,
+    CFRDS_SQL_CURSOR_HEADER,
+    CFRDS_SQL_CURSOR_ROWS,
+    CFRDS_SQL_CURSOR_END,
+    CFRDS_SQL_CURSOR_SERVER_ERROR
+} cfrds_sql_cursor_state;
+
+/* Incremental parser of a SQLSTMNT response: `<rows + 1>:<len>:<header><len>:<row>...` */
+struct cfrds_sql_cursor {
+    cfrds_server *server;
+    cfrds_http_stream *stream;
+    cfrds_sql_cursor_state state;
+    cfrds_buffer *pending;        ///< Received body bytes, parsed up to `offset`, or the server error message.
+    size_t offset;
+    bool body_done;
+    uint64_t max_row_size;
+    int64_t rows;
+    int64_t rows_left;
+    size_t columns;
+    cfrds_buffer *header;         ///< Header row, split in place into `names`.
+    cfrds_str_view *names;
+    cfrds_buffer *row;            ///< Current row, split in place into `values`.
+    cfrds_str_view *values;
+    const char *error;
+};
+
+/* Returns 1 when a number was parsed, 0 if it is not complete yet, -1 if it is malformed. */
+static int cfrds_sql_cursor_number(const char **data, size_t *remaining, int64_t *out)
+{
+    if ((*remaining == 0)||(memchr(*data, ':', *remaining) == NULL))
+        return (*remaining < 24) ? 0 : -1;
+
+    return cfrds_buffer_parse_number(data, remaining, out) ? 1 : -1;
+}
+
+static cfrds_status cfrds_sql_cursor_feed(void *ctx, const char *data, size_t size)
+{
+    cfrds_sql_cursor *cursor = ctx;
+
+    switch (cursor->state)
+    {
+    case CFRDS_SQL_CURSOR_END:
+        break;
+    case CFRDS_SQL_CURSOR_SERVER_ERROR:
+        /* keep the beginning of the error message */
+        if (cfrds_buffer_data_size(cursor->pending) + size > CFRDS_MAX_HEADER_SIZE)
+            size = CFRDS_MAX_HEADER_SIZE - cfrds_buffer_data_size(cursor->pending);
+
+        if (!cfrds_buffer_append_bytes(cursor->pending, data, size))
+            return CFRDS_STATUS_MEMORY_ERROR;
+        break;
+    default:
+        /* drop the parsed rows before growing, so only the unparsed tail is ever kept */
+        if (cursor->offset > 0)
+        {
+            cfrds_buffer_slice(cursor->pending, cursor->offset, cfrds_buffer_data_size(cursor->pending) - cursor->offset);
+            cursor->offset = 0;
+        }
+
+        if (!cfrds_buffer_append_bytes(cursor->pending, data, size))
+            return CFRDS_STATUS_MEMORY_ERROR;
+        break;
+    }
+
+    return CFRDS_STATUS_OK;
+}
+
+/* Takes the next length-prefixed string off `pending` into `dest`, `*need_more` if it is not complete yet. */
+static cfrds_status cfrds_sql_cursor_take(cfrds_sql_cursor *cursor, cfrds_buffer *dest, bool *need_more)
+{
+    const char *data = cfrds_buffer_data(cursor->pending) + cursor->offset;
+    size_t remaining = cfrds_buffer_data_size(cursor->pending) - cursor->offset;
+    int64_t len = 0;
+
+    int res = cfrds_sql_cursor_number(&data, &remaining, &len);
+    if (res == 0)
+    {
+        *need_more = true;
+        return CFRDS_STATUS_OK;
+    }
+
+    if ((res < 0)||(len < 0))
+    {
+        cursor->error = "invalid sql statement response";
+        return CFRDS_STATUS_RESPONSE_ERROR;
+    }
+
+    if ((uint64_t)len > cursor->max_row_size)
+    {
+        cursor->error = "sql statement row exceeds the response size limit";
+        return CFRDS_STATUS_RESPONSE_TOO_LARGE;
+    }
+
+    if ((size_t)len > remaining)
+    {
+        *need_more = true;
+        return CFRDS_STATUS_OK;
+    }
+
+    if ((!cfrds_buffer_slice(dest, 0, 0))||(!cfrds_buffer_append_bytes(dest, data, (size_t)len)))
+        return CFRDS_STATUS_MEMORY_ERROR;
+
+    cursor->offset = (size_t)(data - cfrds_buffer_data(cursor->pending)) + (size_t)len;
+
+    return CFRDS_STATUS_OK;
+}
+
+/* Parses the next item of the response, `*need_more` if the received data does not hold it yet. */
+static cfrds_status cfrds_sql_cursor_advance(cfrds_sql_cursor *cursor, bool *need_more)
+{
+    cfrds_status status = CFRDS_STATUS_OK;
+
+    *need_more = false;
+
+    switch (cursor->state)
+    {
+    case CFRDS_SQL_CURSOR_COUNT:
+    {
+        const char *data = cfrds_buffer_data(cursor->pending);
+        size_t remaining = cfrds_buffer_data_size(cursor->pending);
+        int64_t cnt = 0;
+
+        int res = cfrds_sql_cursor_number(&data, &remaining, &cnt);
+        if (res == 0)
+        {
+            *need_more = true;
+            break;
+        }
+
+        if ((res > 0)&&(cnt < 0))
+        {
+            cursor->state = CFRDS_SQL_CURSOR_SERVER_ERROR;
+            break;
+        }
+
+        if ((res < 0)||(cnt == 0))
+        {
+            cursor->error = "invalid sql statement response";
+            return CFRDS_STATUS_RESPONSE_ERROR;
+        }
+
+        cursor->rows = cnt - 1;
+        cursor->rows_left = cnt - 1;
+        cursor->offset = (size_t)(data - cfrds_buffer_data(cursor->pending));
+        cursor->state = CFRDS_SQL_CURSOR_HEADER;
+        break;
+    }
+    case CFRDS_SQL_CURSOR_HEADER:
+    {
+        size_t cols = 0;
+
+        status = cfrds_sql_cursor_take(cursor, cursor->header, need_more);
+        if ((status != CFRDS_STATUS_OK)||(*need_more))
+            break;
+
+        char *row = cfrds_buffer_data(cursor->header);
+        size_t row_size = cfrds_buffer_data_size(cursor->header);
+
+        if ((!cfrds_buffer_split_row(row, row_size, NULL, SIZE_MAX, &cols))||(cols < 1))
+        {
+            cursor->error = "invalid sql statement header";
+            return CFRDS_STATUS_RESPONSE_ERROR;
+        }
+
+        cursor->names = malloc(sizeof(cfrds_str_view) * cols);
+        cursor->values = malloc(sizeof(cfrds_str_view) * cols);
+        if ((cursor->names == NULL)||(cursor->values == NULL))
+            return CFRDS_STATUS_MEMORY_ERROR;
+
+        cfrds_buffer_split_row(row, row_size, cursor->names, cols, &cols);
+
+        cursor->columns = cols;
+        cursor->state = CFRDS_SQL_CURSOR_ROWS;
+        break;
+    }
+    case CFRDS_SQL_CURSOR_ROWS:
+    {
+        size_t cols = 0;
+
+        if (cursor->rows_left == 0)
+        {
+            cursor->state = CFRDS_SQL_CURSOR_END;
+            break;
+        }
+
+        status = cfrds_sql_cursor_take(cursor, cursor->row, need_more);
+        if ((status != CFRDS_STATUS_OK)||(*need_more))
+            break;
+
+        if ((!cfrds_buffer_split_row(cfrds_buffer_data(cursor->row), cfrds_buffer_data_size(cursor->row), cursor->values, cursor->columns, &cols))||
+            (cols != cursor->columns))
+        {
+            cursor->error = "sql statement row does not match the header";
+            return CFRDS_STATUS_RESPONSE_ERROR;
+        }
+
+        cursor->rows_left--;
+        break;
+    }
+    case CFRDS_SQL_CURSOR_END:
+    case CFRDS_SQL_CURSOR_SERVER_ERROR:
+        break;
+    }
+
+    return status;
+}
+
+/* Advances once, receiving more of the response for as long as the parser needs it. */
+static cfrds_status cfrds_sql_cursor_step(cfrds_sql_cursor *cursor)
+{
+    while (1)
+    {
+        bool need_more = false;
+
+        cfrds_status status = cfrds_sql_cursor_advance(cursor, &need_more);
+        if (status != CFRDS_STATUS_OK)
+        {
+            if (cursor->error)
+            {
+                cfrds_server_error_ctx(cursor->server)->error_code = -1;
+                cfrds_server_set_error(cursor->server, status, cursor->error);
+            }
+            return status;
+        }
+
+        if (!need_more)
+            return CFRDS_STATUS_OK;
+
+        if (cursor->body_done)
+        {
+            cfrds_server_error_ctx(cursor->server)->error_code = -1;
+            cfrds_server_set_error(cursor->server, CFRDS_STATUS_RESPONSE_ERROR, "sql statement response is truncated");
+            return CFRDS_STATUS_RESPONSE_ERROR;
+        }
+
+        status = cfrds_http_stream_read(cursor->stream);
+        if (status != CFRDS_STATUS_OK)
+            return status;
+
+        cursor->body_done = cfrds_http_stream_done(cursor->stream);
+    }
+}
+
+/* Reads the rest of the response, so the connection can go back to the pool. */
+static cfrds_status cfrds_sql_cursor_drain(cfrds_sql_cursor *cursor)
+{
+    while (!cursor->body_done)
+    {
+        cfrds_status status = cfrds_http_stream_read(cursor->stream);
+        if (status != CFRDS_STATUS_OK)
+            return status;
+
+        cursor->body_done = cfrds_http_stream_done(cursor->stream);
+    }
+
+    return CFRDS_STATUS_OK;
+}
+
+static cfrds_sql_cursor *cfrds_sql_cursor_create(cfrds_server *server)
+{
+    cfrds_sql_cursor *cursor = malloc(sizeof(cfrds_sql_cursor));
+    if (cursor == NULL)
+        return NULL;
+
+    explicit_bzero(cursor, sizeof(cfrds_sql_cursor));
+    cursor->server = server;
+    cursor->state = CFRDS_SQL_CURSOR_COUNT;
+    cursor->max_row_size = server ? server->max_response_size : CFRDS_MAX_RESPONSE_SIZE;
+
+    if ((!cfrds_buffer_create(&cursor->pending))||(!cfrds_buffer_create(&cursor->header))||(!cfrds_buffer_create(&cursor->row)))
+    {
+        cfrds_sql_cursor_close(cursor);
+        return NULL;
+    }
+
+    return cursor;
+}
+
+cfrds_status cfrds_sql_cursor_open(cfrds_server *server, const char *connection_name, const char *sql, cfrds_sql_cursor **cursor)
+{
+    cfrds_buffer_defer(post);
+    cfrds_sql_cursor_defer(tmp);
+    cfrds_status ret;
+
+    if ((server == NULL)||(connection_name == NULL)||(sql == NULL)||(cursor == NULL))
+        return CFRDS_STATUS_PARAM_IS_NULL;
+
+    cfrds_server_clear_error(server);
+
+    ret = cfrds_build_command_payload(server, (const char *[]){ connection_name, "SQLSTMNT", sql, NULL }, &post);
+    if (ret != CFRDS_STATUS_OK)
+        return ret;
+
+    tmp = cfrds_sql_cursor_create(server);
+    if (tmp == NULL)
+        return CFRDS_STATUS_MEMORY_ERROR;
+
+    const cfrds_http_segment body = { .data = cfrds_buffer_data(post), .size = cfrds_buffer_data_size(post) };
+
+    /* statements run user SQL, so a failed request is never sent again */
+    ret = cfrds_http_stream_open(server, "DBFUNCS", &body, 1, cfrds_sql_cursor_feed, tmp, &tmp->stream);
+    if (ret != CFRDS_STATUS_OK)
+        return ret;
+
+    tmp->body_done = cfrds_http_stream_done(tmp->stream);
+
+    while ((tmp->state == CFRDS_SQL_CURSOR_COUNT)||(tmp->state == CFRDS_SQL_CURSOR_HEADER))
+    {
+        ret = cfrds_sql_cursor_step(tmp);
+        if (ret != CFRDS_STATUS_OK)
+            return ret;
+    }
+
+    if (tmp->state == CFRDS_SQL_CURSOR_SERVER_ERROR)
+    {
+        ret = cfrds_sql_cursor_drain(tmp);
+        if (ret != CFRDS_STATUS_OK)
+            return ret;
+
+        return cfrds_http_parse_rds_status(server, tmp->pending);
+    }
+
+    cfrds_server_error_ctx(server)->error_code = tmp->rows + 1;
+
+    *cursor = tmp; tmp = NULL;
+
+    return CFRDS_STATUS_OK;
+}
+
+cfrds_status cfrds_sql_cursor_next_row(cfrds_sql_cursor *cursor, bool *row)
+{
+    if ((cursor == NULL)||(row == NULL))
+        return CFRDS_STATUS_PARAM_IS_NULL;
+
+    *row = false;
+
+    if (cursor->state == CFRDS_SQL_CURSOR_END)
+        return CFRDS_STATUS_OK;
+
+    cfrds_status ret = cfrds_sql_cursor_step(cursor);
+    if (ret != CFRDS_STATUS_OK)
+        return ret;
+
+    if (cursor->state == CFRDS_SQL_CURSOR_END)
+        return cfrds_sql_cursor_drain(cursor);
+
+    *row = true;
+
+    return CFRDS_STATUS_OK;
+}
+
+size_t cfrds_sql_cursor_columns(const cfrds_sql_cursor *cursor)
+{
+    if (cursor == NULL)
+        return 0;
+
+    return cursor->columns;
+}
+
+size_t cfrds_sql_cursor_rows(const cfrds_sql_cursor *cursor)
+{
+    if (cursor == NULL)
+        return 0;
+
+    return (size_t)cursor->rows;
+}
+
+const char *cfrds_sql_cursor_column_name(const cfrds_sql_cursor *cursor, size_t column)
+{
+    if ((cursor == NULL)||(column >= cursor->columns))
+        return NULL;
+
+    return cursor->names[column].str;
+}
+
+const char *cfrds_sql_cursor_value(const cfrds_sql_cursor *cursor, size_t column)
+{
+    if ((cursor == NULL)||(column >= cursor->columns)||(cursor->rows_left == cursor->rows))
+        return NULL;
+
+    return cursor->values[column].str;
+}
+
+size_t cfrds_sql_cursor_value_len(const cfrds_sql_cursor *cursor, size_t column)
+{
+    if ((cursor == NULL)||(column >= cursor->columns)||(cursor->rows_left == cursor->rows))
+        return 0;
+
+    return cursor->values[column].len;
+}
+
+void cfrds_sql_cursor_close(cfrds_sql_cursor *cursor)
+{
+    if (cursor == NULL)
+        return;
+
+    cfrds_http_stream_close(cursor->stream);
+    cfrds_buffer_free(cursor->pending);
+    cfrds_buffer_free(cursor->header);
+    cfrds_buffer_free(cursor->row);
+    free(cursor->names);
+    free(cursor->values);
+    free(cursor);
+}
+
+void cfrds_sql_cursor_cleanup(cfrds_sql_cursor **cursor)
+{
+    if (cursor)
+    {
+        cfrds_sql_cursor_close(*cursor);
+        *cursor = NULL;
+    }
+}
+
+cfrds_status cfrds_loop_submit_sql_dsninfo(cfrds_loop *loop, cfrds_server *server, cfrds_loop_done_fn done, void *ctx)
+{
+    return cfrds_loop_submit(loop, server, "DBFUNCS", (const char *[]){ "", "DSNINFO", NULL }, true, (cfrds_sql_parser_fn)cfrds_buffer_to_sql_dsninfo, done, ctx);
+}
+
+cfrds_status cfrds_loop_submit_sql_tableinfo(cfrds_loop *loop, cfrds_server *server, const char *connection_name, cfrds_loop_done_fn done, void *ctx)
+{
+    if (connection_name == NULL)
+        return CFRDS_STATUS_PARAM_IS_NULL;
+
+    return cfrds_loop_submit(loop, server, "DBFUNCS", (const char *[]){ connection_name, "TABLEINFO", NULL }, true, (cfrds_sql_parser_fn)cfrds_buffer_to_sql_tableinfo, done, ctx);
+}
+
+cfrds_status cfrds_loop_submit_sql_columninfo(cfrds_loop *loop, cfrds_server *server, const char *connection_name, const char *table_name, cfrds_loop_done_fn done, void *ctx)
+{
+    return cfrds_loop_submit(loop, server, "DBFUNCS", (const char *[]){ connection_name, "COLUMNINFO", table_name, NULL }, true, (cfrds_sql_parser_fn)cfrds_buffer_to_sql_columninfo, done, ctx);
+}
+
+cfrds_status cfrds_loop_submit_sql_primarykeys(cfrds_loop *loop, cfrds_server *server, const char *connection_name, const char *table_name, cfrds_loop_done_fn done, void *ctx)
+{
+    if (table_name == NULL)
+        return CFRDS_STATUS_PARAM_IS_NULL;
+
+    return cfrds_loop_submit(loop, server, "DBFUNCS", (const char *[]){ connection_name, "PRIMARYKEYS", table_name, NULL }, true, (cfrds_sql_parser_fn)cfrds_buffer_to_sql_primarykeys, done, ctx);
+}
+
+cfrds_status cfrds_loop_submit_sql_foreignkeys(cfrds_loop *loop, cfrds_server *server, const char *connection_name, const char *table_name, cfrds_loop_done_fn done, void *ctx)
+{
+    if (table_name == NULL)
+        return CFRDS_STATUS_PARAM_IS_NULL;
+
+    return cfrds_loop_submit(loop, server, "DBFUNCS", (const char *[]){ connection_name, "FOREIGNKEYS", table_name, NULL }, true, (cfrds_sql_parser_fn)cfrds_buffer_to_sql_foreignkeys, done, ctx);
+}
+
+cfrds_status cfrds_loop_submit_sql_importedkeys(cfrds_loop *loop, cfrds_server *server, const char *connection_name, const char *table_name, cfrds_loop_done_fn done, void *ctx)
+{
+    if (table_name == NULL)
+        return CFRDS_STATUS_PARAM_IS_NULL;
+
+    return cfrds_loop_submit(loop, server, "DBFUNCS", (const char *[]){ connection_name, "IMPORTEDKEYS", table_name, NULL }, true, (cfrds_sql_parser_fn)cfrds_buffer_to_sql_importedkeys, done, ctx);
+}
+
+cfrds_status cfrds_loop_submit_sql_exportedkeys(cfrds_loop *loop, cfrds_server *server, const char *connection_name, const char *table_name, cfrds_loop_done_fn done, void *ctx)
+{
+    if (table_name == NULL)
+        return CFRDS_STATUS_PARAM_IS_NULL;
+
+    return cfrds_loop_submit(loop, server, "DBFUNCS", (const char *[]){ connection_name, "EXPORTEDKEYS", table_name, NULL }, true, (cfrds_sql_parser_fn)cfrds_buffer_to_sql_exportedkeys, done, ctx);
+}
+
+cfrds_status cfrds_loop_submit_sql_sqlstmnt(cfrds_loop *loop, cfrds_server *server, const char *connection_name, const char *sql, cfrds_loop_done_fn done, void *ctx)
+{
+    return cfrds_loop_submit(loop, server, "DBFUNCS", (const char *[]){ connection_name, "SQLSTMNT", sql, NULL }, false, (cfrds_sql_parser_fn)cfrds_buffer_to_sql_sqlstmnt, done, ctx);
+}
+
+cfrds_status cfrds_loop_submit_sql_sqlmetadata(cfrds_loop *loop, cfrds_server *server, const char *connection_name, const char *sql, cfrds_loop_done_fn done, void *ctx)
+{
+    return cfrds_loop_submit(loop, server, "DBFUNCS", (const char *[]){ connection_name, "SQLMETADATA", sql, NULL }, false, (cfrds_sql_parser_fn)cfrds_buffer_to_sql_metadata, done, ctx);
+}
+
+cfrds_status cfrds_loop_submit_sql_getsupportedcommands(cfrds_loop *loop, cfrds_server *server, cfrds_loop_done_fn done, void *ctx)
+{
+    return cfrds_loop_submit(loop, server, "DBFUNCS", (const char *[]){ "", "SUPPORTEDCOMMANDS", NULL }, true, (cfrds_sql_parser_fn)cfrds_buffer_to_sql_supportedcommands, done, ctx);
+}
+
+cfrds_status cfrds_loop_submit_sql_dbdescription(cfrds_loop *loop, cfrds_server *server, const char *connection_name, cfrds_loop_done_fn done, void *ctx)
+{
+    return cfrds_loop_submit(loop, server, "DBFUNCS", (const char *[]){ connection_name, "DBDESCRIPTION", NULL }, true, (cfrds_sql_parser_fn)cfrds_buffer_to_sql_dbdescription, done, ctx);
+}
+
+cfrds_status cfrds_batch_add_sql_dsninfo(cfrds_batch *batch, cfrds_loop_done_fn done, void *ctx)
+{
+    return cfrds_batch_add(batch, "DBFUNCS", (const char *[]){ "", "DSNINFO", NULL }, true, (cfrds_sql_parser_fn)cfrds_buffer_to_sql_dsninfo, done, ctx);
+}
+
+cfrds_status cfrds_batch_add_sql_tableinfo(cfrds_batch *batch, const char *connection_name, cfrds_loop_done_fn done, void *ctx)
+{
+    if (connection_name == NULL)
+        return CFRDS_STATUS_PARAM_IS_NULL;
+
+    return cfrds_batch_add(batch, "DBFUNCS", (const char *[]){ connection_name, "TABLEINFO", NULL }, true, (cfrds_sql_parser_fn)cfrds_buffer_to_sql_tableinfo, done, ctx);
+}
+
+cfrds_status cfrds_batch_add_sql_columninfo(cfrds_batch *batch, const char *connection_name, const char *table_name, cfrds_loop_done_fn done, void *ctx)
+{
+    return cfrds_batch_add(batch, "DBFUNCS", (const char *[]){ connection_name, "COLUMNINFO", table_name, NULL }, true, (cfrds_sql_parser_fn)cfrds_buffer_to_sql_columninfo, done, ctx);
+}
+
+cfrds_status cfrds_batch_add_sql_primarykeys(cfrds_batch *batch, const char *connection_name, const char *table_name, cfrds_loop_done_fn done, void *ctx)
+{
+    if (table_name == NULL)
+        return CFRDS_STATUS_PARAM_IS_NULL;
+
+    return cfrds_batch_add(batch, "DBFUNCS", (const char *[]){ connection_name, "PRIMARYKEYS", table_name, NULL }, true, (cfrds_sql_parser_fn)cfrds_buffer_to_sql_primarykeys, done, ctx);
+}
+
+cfrds_status cfrds_batch_add_sql_foreignkeys(cfrds_batch *batch, const char *connection_name, const char *table_name, cfrds_loop_done_fn done, void *ctx)
+{
+    if (table_name == NULL)
+        return CFRDS_STATUS_PARAM_IS_NULL;
+
+    return cfrds_batch_add(batch, "DBFUNCS", (const char *[]){ connection_name, "FOREIGNKEYS", table_name, NULL }, true, (cfrds_sql_parser_fn)cfrds_buffer_to_sql_foreignkeys, done, ctx);
+}
+
+cfrds_status cfrds_batch_add_sql_importedkeys(cfrds_batch *batch, const char *connection_name, const char *table_name, cfrds_loop_done_fn done, void *ctx)
+{
+    if (table_name == NULL)
+        return CFRDS_STATUS_PARAM_IS_NULL;
+
+    return cfrds_batch_add(batch, "DBFUNCS", (const char *[]){ connection_name, "IMPORTEDKEYS", table_name, NULL }, true, (cfrds_sql_parser_fn)cfrds_buffer_to_sql_importedkeys, done, ctx);
+}
+
+cfrds_status cfrds_batch_add_sql_exportedkeys(cfrds_batch *batch, const char *connection_name, const char *table_name, cfrds_loop_done_fn done, void *ctx)
+{
+    if (table_name == NULL)
+        return CFRDS_STATUS_PARAM_IS_NULL;
+
+    return cfrds_batch_add(batch, "DBFUNCS", (const char *[]){ connection_name, "EXPORTEDKEYS", table_name, NULL }, true, (cfrds_sql_parser_fn)cfrds_buffer_to_sql_exportedkeys, done, ctx);
+}
+
+cfrds_status cfrds_batch_add_sql_sqlstmnt(cfrds_batch *batch, const char *connection_name, const char *sql, cfrds_loop_done_fn done, void *ctx)
+{
+    return cfrds_batch_add(batch, "DBFUNCS", (const char *[]){ connection_name, "SQLSTMNT", sql, NULL }, false, (cfrds_sql_parser_fn)cfrds_buffer_to_sql_sqlstmnt, done, ctx);
+}
+
+cfrds_status cfrds_batch_add_sql_sqlmetadata(cfrds_batch *batch, const char *connection_name, const char *sql, cfrds_loop_done_fn done, void *ctx)
+{
+    return cfrds_batch_add(batch, "DBFUNCS", (const char *[]){ connection_name, "SQLMETADATA", sql, NULL }, false, (cfrds_sql_parser_fn)cfrds_buffer_to_sql_metadata, done, ctx);
+}
+
+cfrds_status cfrds_batch_add_sql_getsupportedcommands(cfrds_batch *batch, cfrds_loop_done_fn done, void *ctx)
+{
+    return cfrds_batch_add(batch, "DBFUNCS", (const char *[]){ "", "SUPPORTEDCOMMANDS", NULL }, true, (cfrds_sql_parser_fn)cfrds_buffer_to_sql_supportedcommands, done, ctx);
+}
+
+cfrds_status cfrds_batch_add_sql_dbdescription(cfrds_batch *batch, const char *connection_name, cfrds_loop_done_fn done, void *ctx)
+{
+    return cfrds_batch_add(batch, "DBFUNCS", (const char *[]){ connection_name, "DBDESCRIPTION", NULL }, true, (cfrds_sql_parser_fn)cfrds_buffer_to_sql_dbdescription, done, ctx);
+}
@@ -0,0 +1,169 @@
+#include <internal/explicit_bzero.h>
+#include <internal/cfrds_uring.h>
+
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <string.h>
+#include <errno.h>
+
+#define CFRDS_URING_REQUIRED_FEATURES (IORING_FEAT_NODROP | IORING_FEAT_FAST_POLL)
+
+static int uring_setup(unsigned entries, struct io_uring_params *params)
+{
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+bool cfrds_uring_init(cfrds_uring *ring, unsigned entries)
+{
+    struct io_uring_params params;
+
+    explicit_bzero(ring, sizeof(cfrds_uring));
+    explicit_bzero(&params, sizeof(params));
+    ring->fd = -1;
+
+    int fd = uring_setup(entries, &params);
+    if (fd < 0)
+        return false;
+
+    ring->fd = fd;
+
+    if ((params.features & CFRDS_URING_REQUIRED_FEATURES) != CFRDS_URING_REQUIRED_FEATURES)
+    {
+        cfrds_uring_cleanup(ring);
+        return false;
+    }
+
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if (ring->cq_ring_size > ring->sq_ring_size)
+            ring->sq_ring_size = ring->cq_ring_size;
+        ring->cq_ring_size = ring->sq_ring_size;
+    }
+
+    ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ring == MAP_FAILED)
+    {
+        ring->sq_ring = NULL;
+        cfrds_uring_cleanup(ring);
+        return false;
+    }
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        ring->cq_ring = ring->sq_ring;
+    }
+    else
+    {
+        ring->cq_ring = mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (ring->cq_ring == MAP_FAILED)
+        {
+            ring->cq_ring = NULL;
+            cfrds_uring_cleanup(ring);
+            return false;
+        }
+    }
+
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED)
+    {
+        ring->sqes = NULL;
+        cfrds_uring_cleanup(ring);
+        return false;
+    }
+
+    char *sq = ring->sq_ring;
+    char *cq = ring->cq_ring;
+
+    ring->sq_head = (unsigned *)(sq + params.sq_off.head);
+    ring->sq_tail = (unsigned *)(sq + params.sq_off.tail);
+    ring->sq_array = (unsigned *)(sq + params.sq_off.array);
+    ring->sq_mask = *(unsigned *)(sq + params.sq_off.ring_mask);
+    ring->sq_entries = *(unsigned *)(sq + params.sq_off.ring_entries);
+    ring->sq_local_tail = *ring->sq_tail;
+
+    ring->cq_head = (unsigned *)(cq + params.cq_off.head);
+    ring->cq_tail = (unsigned *)(cq + params.cq_off.tail);
+    ring->cq_mask = *(unsigned *)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+
+    return true;
+}
+
+void cfrds_uring_cleanup(cfrds_uring *ring)
+{
+    if (ring->sqes)
+        munmap(ring->sqes, ring->sqes_size);
+    if ((ring->cq_ring)&&(ring->cq_ring != ring->sq_ring))
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    if (ring->sq_ring)
+        munmap(ring->sq_ring, ring->sq_ring_size);
+    if (ring->fd >= 0)
+        close(ring->fd);
+
+    explicit_bzero(ring, sizeof(cfrds_uring));
+    ring->fd = -1;
+}
+
+struct io_uring_sqe *cfrds_uring_get_sqe(cfrds_uring *ring)
+{
+    unsigned head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+
+    if (ring->sq_local_tail - head >= ring->sq_entries)
+    {
+        if (cfrds_uring_submit(ring, 0) != 0)
+            return NULL;
+
+        head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+        if (ring->sq_local_tail - head >= ring->sq_entries)
+            return NULL;
+    }
+
+    unsigned index = ring->sq_local_tail & ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    ring->sq_array[index] = index;
+    ring->sq_local_tail++;
+
+    return sqe;
+}
+
+int cfrds_uring_submit(cfrds_uring *ring, unsigned wait_nr)
+{
+    /* publish the queued entries, the kernel reads them on io_uring_enter() */
+    unsigned to_submit = ring->sq_local_tail - *ring->sq_tail;
+    __atomic_store_n(ring->sq_tail, ring->sq_local_tail, __ATOMIC_RELEASE);
+
+    if ((to_submit == 0)&&(wait_nr == 0))
+        return 0;
+
+    int res = uring_enter(ring->fd, to_submit, wait_nr, (wait_nr > 0) ? IORING_ENTER_GETEVENTS : 0);
+    if (res < 0)
+        return -errno;
+
+    return 0;
+}
+
+bool cfrds_uring_next_cqe(cfrds_uring *ring, struct io_uring_cqe *cqe)
+{
+    unsigned head = *ring->cq_head;
+
+    if (head == __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE))
+        return false;
+
+    *cqe = ring->cqes[head & ring->cq_mask];
+    __atomic_store_n(ring->cq_head, head + 1, __ATOMIC_RELEASE);
+
+    return true;
+}
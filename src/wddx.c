@@ -5,20 +5,48 @@
 #include <libxml/tree.h>
 
 #include <string.h>
+#include <strings.h>
 #include <stdlib.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <ctype.h>
 #include <math.h>
 #include <limits.h>
 
 
 #define WDDX_MAX_ARRAY_LENGTH 10000
+#define WDDX_MAX_DEPTH 256
+
+/* Structs with at least this many keys get a hash index, smaller ones are scanned. */
+#define WDDX_STRUCT_INDEX_MIN 16
+
+/* First arena chunk of a packet built with wddx_put_*(), parsed packets size it by the XML. */
+#define WDDX_ARENA_CAPACITY 1024
+
+/* The nodes of a parsed packet take up to about twice the length of its XML. */
+#define WDDX_ARENA_CAPACITY_FOR(xml_len) (((xml_len) < SIZE_MAX / 4) ? (xml_len) * 2 : (xml_len))
 
 #define xmlDoc_defer(var) xmlDoc* var __attribute__((cleanup(xmlDoc_cleanup))) = NULL
 
+typedef struct {
+    uint32_t hash;
+    uint32_t pos;         ///< Position of the key in `items` plus one, 0 for an empty slot.
+} wddx_index_slot;
+
+/* Open addressing index of a struct's keys, linear probing, at most half full. */
+typedef struct {
+    uint32_t mask;
+    uint32_t used;
+    wddx_index_slot slots[];
+} wddx_struct_index;
+
 struct WDDX_NODE {
     int type;
     int cnt;
+    union {
+        wddx_struct_index *index; ///< Struct key index, NULL for arrays and small structs.
+        size_t capacity;          ///< Bytes available for the value of a scalar node.
+    };
     union {
         bool boolean;
         double number;
@@ -32,13 +60,73 @@ typedef struct {
     struct WDDX_NODE *value;
 } WDDX_STRUCT_NODE;
 
+/*
+ * Lives in its own arena, together with every node, struct member, key and index of the
+ * packet. Nothing is freed on its own: outgrown items lists and values stay in the arena
+ * until wddx_cleanup() frees it whole. Both grow geometrically, so the outgrown copies add
+ * up to less than the final size: items lists double (see wddx_node_room()), and a value
+ * replaced by wddx_put_*() is overwritten in place when the new one fits, otherwise its
+ * replacement gets at least twice the room.
+ */
 struct WDDX {
     struct WDDX_NODE *header;
     struct WDDX_NODE *data;
-    xmlBufferPtr str;
+    cfrds_buffer *str;
+    cfrds_arena *arena;
 };
 
-static void wddx_node_free(struct WDDX_NODE *value);
+/* Item slots of an array or struct of `cnt` items: the next power of two, so appends double it. */
+static size_t wddx_node_room(size_t cnt)
+{
+    size_t room = 1;
+
+    while (room < cnt)
+        room *= 2;
+
+    return room;
+}
+
+/* Zeroed node of `type` with `payload` bytes for its value, items or string.
+ * Arrays and structs get wddx_node_room() slots for the items `payload` holds. */
+static struct WDDX_NODE *wddx_node_alloc(cfrds_arena *arena, int type, size_t payload)
+{
+    if ((type == WDDX_ARRAY)||(type == WDDX_STRUCT))
+    {
+        size_t room = wddx_node_room(payload / sizeof(void *));
+        if (room > SIZE_MAX / sizeof(void *))
+            return NULL;
+        payload = room * sizeof(void *);
+    }
+
+    size_t size = offsetof(struct WDDX_NODE, items) + payload;
+
+    if (size < sizeof(struct WDDX_NODE))
+        size = sizeof(struct WDDX_NODE);
+
+    struct WDDX_NODE *ret = cfrds_arena_alloc(arena, size);
+    if (ret)
+    {
+        ret->type = type;
+        if ((type != WDDX_ARRAY)&&(type != WDDX_STRUCT))
+            ret->capacity = size - offsetof(struct WDDX_NODE, items);
+    }
+
+    return ret;
+}
+
+/* Copy of the array or struct `node` with room for `cnt` items, the ones past node->cnt zeroed. */
+static struct WDDX_NODE *wddx_node_grow(cfrds_arena *arena, const struct WDDX_NODE *node, size_t cnt)
+{
+    struct WDDX_NODE *ret = wddx_node_alloc(arena, node->type, cnt * sizeof(void *));
+    if (ret == NULL)
+        return NULL;
+
+    ret->cnt = node->cnt;
+    ret->index = node->index;
+    memcpy(ret->items, node->items, (size_t)node->cnt * sizeof(void *));
+
+    return ret;
+}
 
 static void xmlDoc_cleanup(xmlDoc **value)
 {
@@ -72,22 +160,147 @@ static bool is_string_numeric(const char *str)
     return true;
 }
 
-static struct WDDX_NODE *wddx_recursively_put(struct WDDX_NODE *node, const char *path, const char *value, enum wddx_type type)
+/* FNV-1a, struct keys are short. */
+static uint32_t wddx_key_hash(const char *key, size_t len)
+{
+    uint32_t hash = 2166136261u;
+
+    for (size_t c = 0; c < len; c++)
+    {
+        hash ^= (unsigned char)key[c];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+/* Adds the key at `pos` unless the index has it already, the first of duplicate keys wins like in a scan. */
+static void wddx_struct_index_insert(wddx_struct_index *index, const struct WDDX_NODE *node, int pos)
+{
+    const WDDX_STRUCT_NODE *item = node->items[pos];
+    if ((item == NULL)||(item->name == NULL))
+        return;
+
+    uint32_t hash = wddx_key_hash(item->name, strlen(item->name));
+
+    for (uint32_t slot = hash & index->mask; ; slot = (slot + 1) & index->mask)
+    {
+        wddx_index_slot *entry = &index->slots[slot];
+
+        if (entry->pos == 0)
+        {
+            entry->hash = hash;
+            entry->pos = (uint32_t)pos + 1;
+            index->used++;
+            return;
+        }
+
+        if (entry->hash == hash)
+        {
+            const WDDX_STRUCT_NODE *other = node->items[entry->pos - 1];
+            if (strcmp(other->name, item->name) == 0)
+                return;
+        }
+    }
+}
+
+/* (Re)builds the index of `node` for at least `cnt` keys. Without memory the struct stays unindexed. */
+static void wddx_struct_index_build(cfrds_arena *arena, struct WDDX_NODE *node, int cnt)
+{
+    size_t capacity = 32;
+
+    while (capacity < (size_t)cnt * 2)
+        capacity *= 2;
+
+    node->index = NULL;
+
+    wddx_struct_index *index = cfrds_arena_alloc(arena, offsetof(wddx_struct_index, slots) + capacity * sizeof(wddx_index_slot));
+    if (index == NULL)
+        return;
+
+    index->mask = (uint32_t)capacity - 1;
+
+    for (int c = 0; c < node->cnt; c++)
+        wddx_struct_index_insert(index, node, c);
+
+    node->index = index;
+}
+
+/* Called once the struct `node` is complete, or after a key was appended to it. */
+static void wddx_struct_index_update(cfrds_arena *arena, struct WDDX_NODE *node)
+{
+    if (node->cnt < WDDX_STRUCT_INDEX_MIN)
+        return;
+
+    if (node->index == NULL)
+        wddx_struct_index_build(arena, node, node->cnt);
+    else if ((node->index->used + 1) * 2 > node->index->mask + 1)
+        wddx_struct_index_build(arena, node, node->cnt * 2);
+    else
+        wddx_struct_index_insert(node->index, node, node->cnt - 1);
+}
+
+/* Finds the member `key` of the struct `node`, through its index when it has one. `hash` is the key's wddx_key_hash. */
+static WDDX_STRUCT_NODE *wddx_struct_find_hashed(const struct WDDX_NODE *node, const char *key, uint32_t hash)
+{
+    if (node->index)
+    {
+        const wddx_struct_index *index = node->index;
+
+        for (uint32_t slot = hash & index->mask; index->slots[slot].pos; slot = (slot + 1) & index->mask)
+        {
+            if (index->slots[slot].hash != hash)
+                continue;
+
+            WDDX_STRUCT_NODE *item = node->items[index->slots[slot].pos - 1];
+            if (strcmp(item->name, key) == 0)
+                return item;
+        }
+
+        return NULL;
+    }
+
+    for (int c = 0; c < node->cnt; c++)
+    {
+        WDDX_STRUCT_NODE *item = node->items[c];
+        if ((item != NULL)&&(item->name != NULL)&&(strcmp(item->name, key) == 0))
+            return item;
+    }
+
+    return NULL;
+}
+
+static WDDX_STRUCT_NODE *wddx_struct_find(const struct WDDX_NODE *node, const char *key)
+{
+    return wddx_struct_find_hashed(node, key, node->index ? wddx_key_hash(key, strlen(key)) : 0);
+}
+
+static struct WDDX_NODE *wddx_recursively_put(cfrds_arena *arena, struct WDDX_NODE *node, const char *path, const char *value, enum wddx_type type)
 {
     size_t path_len = strlen(path);
-    size_t newsize = 0;
-    bool created_node = false;
 
     if (path_len == 0)
     {
-        struct WDDX_NODE *new_node = NULL;
         size_t value_len = strlen(value);
+        size_t payload = value_len + 1;
+
+        if ((node)&&(node->type != WDDX_ARRAY)&&(node->type != WDDX_STRUCT))
+        {
+            if (node->capacity >= payload)
+            {
+                node->type = type;
+                memcpy(node->string, value, payload);
+                return node;
+            }
+
+            /* the outgrown value stays in the arena, leave room for the next ones */
+            if (payload < node->capacity * 2)
+                payload = node->capacity * 2;
+        }
 
-        size_t size = offsetof(struct WDDX_NODE, string) + value_len + 1;
-        new_node = malloc(size);
+        struct WDDX_NODE *new_node = wddx_node_alloc(arena, type, payload);
         if (new_node == NULL) return NULL;
 
-        new_node->type = type;
         memcpy(new_node->string, value, value_len + 1);
 
         return new_node;
@@ -114,155 +327,114 @@ static struct WDDX_NODE *wddx_recursively_put(struct WDDX_NODE *node, const char
 
         if (node == NULL)
         {
-            newsize = offsetof(struct WDDX_NODE, items) + (sizeof(void *) * (size_t)idx);
-            node = malloc(newsize);
+            node = wddx_node_alloc(arena, WDDX_ARRAY, sizeof(void *) * (size_t)idx);
             if (node == NULL)
-            {
                 return NULL;
-            }
-            created_node = true;
-            explicit_bzero(node, newsize);
-            node->type = WDDX_ARRAY;
             node->cnt = idx;
         }
 
-        switch (node->type)
-        {
-        case WDDX_NULL:
-        case WDDX_BOOLEAN:
-        case WDDX_NUMBER:
-        case WDDX_STRING:
-        case WDDX_STRUCT:
-            if (created_node) wddx_node_free(node);
+        if (node->type != WDDX_ARRAY)
             return NULL;
-        case WDDX_ARRAY:
+
+        if(node->cnt < idx)
         {
-            if(node->cnt < idx)
+            if ((size_t)idx > wddx_node_room((size_t)node->cnt))
             {
-                newsize = offsetof(struct WDDX_NODE, items) + (sizeof(void *) * (size_t)idx);
-                struct WDDX_NODE *pre_realloc_node = node;
-                node = realloc(node, newsize);
-                if (node == NULL) {
-                    if (created_node) wddx_node_free(pre_realloc_node);
+                node = wddx_node_grow(arena, node, (size_t)idx);
+                if (node == NULL)
                     return NULL;
-                }
-                size_t oldsize = offsetof(struct WDDX_NODE, items) + (sizeof(void *) * (size_t)node->cnt);
-                explicit_bzero((char *)node + oldsize, newsize - oldsize);
-                node->cnt = idx;
             }
-
-            struct WDDX_NODE *new_child = wddx_recursively_put(node->items[idx - 1], path, value, type);
-            if (new_child == NULL && node->items[idx - 1] != NULL) {
-                if (created_node) {
-                    node->items[idx - 1] = NULL;
-                    wddx_node_free(node);
-                }
-                return NULL;
+            else
+            {
+                memset(&node->items[node->cnt], 0, (size_t)(idx - node->cnt) * sizeof(void *));
             }
-            node->items[idx - 1] = new_child;
-            return node;
+            node->cnt = idx;
         }
-        default:
-            if (created_node) wddx_node_free(node);
+
+        struct WDDX_NODE *new_child = wddx_recursively_put(arena, node->items[idx - 1], path, value, type);
+        if (new_child == NULL && node->items[idx - 1] != NULL)
             return NULL;
-        }
+
+        node->items[idx - 1] = new_child;
+        return node;
     }
     else
     {
         if (node == NULL)
         {
-            newsize = sizeof(struct WDDX_NODE);
-            node = malloc(newsize);
+            node = wddx_node_alloc(arena, WDDX_STRUCT, 0);
             if (node == NULL)
                 return NULL;
-            explicit_bzero(node, newsize);
-            node->type = WDDX_STRUCT;
-            node->cnt = 0;
-            created_node = true;
         }
 
-        switch (node->type)
-        {
-        case WDDX_NULL:
-        case WDDX_BOOLEAN:
-        case WDDX_NUMBER:
-        case WDDX_STRING:
-        case WDDX_ARRAY:
-            if (created_node) wddx_node_free(node);
+        if (node->type != WDDX_STRUCT)
             return NULL;
-        case WDDX_STRUCT:
-        {
-            for(int c = 0; c < node->cnt; c++)
-            {
-                WDDX_STRUCT_NODE *child = node->items[c];
-                if (child == NULL || child->name == NULL) continue;
-                if (strcmp(child->name, newkey) == 0)
-                {
-                    struct WDDX_NODE *new_val = wddx_recursively_put(child->value, path, value, type);
-                    if (new_val == NULL && child->value != NULL)
-                    {
-                        if (created_node) wddx_node_free(node);
-                        return NULL;
-                    }
-                    child->value = new_val;
-                    return node;
-                }
-            }
 
-            newsize = offsetof(struct WDDX_NODE, items) + (sizeof(WDDX_STRUCT_NODE *) * (size_t)(node->cnt + 1));
-            struct WDDX_NODE *pre_realloc_node = node;
-            node = realloc(node, newsize);
-            if (node == NULL) {
-                if (created_node) wddx_node_free(pre_realloc_node);
-                return NULL;
-            }
-            node->items[node->cnt] = malloc(sizeof(WDDX_STRUCT_NODE));
-            if (node->items[node->cnt] == NULL) {
-                if (created_node) wddx_node_free(node);
-                return NULL;
-            }
-            char *tstr = strdup(newkey);
-            if (tstr == NULL) {
-                free(node->items[node->cnt]);
-                if (created_node) wddx_node_free(node);
-                return NULL;
-            }
-            struct WDDX_NODE *new_val = wddx_recursively_put(NULL, path, value, type);
-            if (new_val == NULL) {
-                free(tstr);
-                free(node->items[node->cnt]);
-                if (created_node) wddx_node_free(node);
+        WDDX_STRUCT_NODE *child = wddx_struct_find(node, newkey);
+        if (child)
+        {
+            struct WDDX_NODE *new_val = wddx_recursively_put(arena, child->value, path, value, type);
+            if (new_val == NULL && child->value != NULL)
                 return NULL;
-            }
-            WDDX_STRUCT_NODE *sitem = node->items[node->cnt];
-            sitem->name = tstr;
-            sitem->value = new_val;
-            node->cnt++;
+
+            child->value = new_val;
             return node;
         }
-        default:
-            if (created_node) wddx_node_free(node);
+
+        WDDX_STRUCT_NODE *sitem = cfrds_arena_alloc(arena, sizeof(WDDX_STRUCT_NODE));
+        if (sitem == NULL)
+            return NULL;
+
+        sitem->name = cfrds_arena_strndup(arena, newkey, seg_len);
+        if (sitem->name == NULL)
+            return NULL;
+
+        sitem->value = wddx_recursively_put(arena, NULL, path, value, type);
+        if (sitem->value == NULL)
             return NULL;
+
+        if ((size_t)node->cnt + 1 > wddx_node_room((size_t)node->cnt))
+        {
+            node = wddx_node_grow(arena, node, (size_t)node->cnt + 1);
+            if (node == NULL)
+                return NULL;
         }
+
+        node->items[node->cnt++] = sitem;
+        wddx_struct_index_update(arena, node);
+        return node;
     }
 }
 
-WDDX *wddx_create(void)
+/* A packet whose arena starts with room for `capacity` bytes of nodes. */
+static WDDX *wddx_create_sized(size_t capacity)
 {
-    struct WDDX *ret = malloc(sizeof(struct WDDX));
-    if (ret)
+    cfrds_arena *arena = cfrds_arena_create(sizeof(struct WDDX) + capacity);
+    if (arena == NULL)
+        return NULL;
+
+    struct WDDX *ret = cfrds_arena_alloc(arena, sizeof(struct WDDX));
+    if (ret == NULL)
     {
-        explicit_bzero(ret, sizeof(struct WDDX));
+        cfrds_arena_free(arena);
+        return NULL;
     }
 
+    ret->arena = arena;
+
     return ret;
 }
 
+WDDX *wddx_create(void)
+{
+    return wddx_create_sized(WDDX_ARENA_CAPACITY);
+}
+
 static bool wddx_put(WDDX *dest, const char *path, const char *value, enum wddx_type type)
 {
     if (dest == NULL) return false;
 
-    struct WDDX_NODE *new_data = wddx_recursively_put(dest->data, path, value, type);
+    struct WDDX_NODE *new_data = wddx_recursively_put(dest->arena, dest->data, path, value, type);
     if (new_data == NULL && dest->data != NULL) {
         return false;
     }
@@ -354,14 +526,9 @@ static void wddx_to_xml_node(xmlNode *xml_node, const struct WDDX_NODE *node)
     }
 }
 
-const char *wddx_to_xml(WDDX *src)
+/* The serializer before wddx_to_buffer, kept as the reference output. The caller frees the buffer. */
+static __attribute__((unused)) xmlBufferPtr wddx_to_xml_libxml2(const WDDX *src)
 {
-    if (src->str)
-    {
-        xmlBufferFree(src->str);
-        src->str = NULL;
-    }
-
     xmlDocPtr doc = xmlNewDoc(NULL);
     xmlNodePtr root_node = xmlNewNode(NULL, BAD_CAST "wddxPacket");
     xmlNewProp(root_node, BAD_CAST "version", BAD_CAST "1.0");
@@ -373,19 +540,148 @@ const char *wddx_to_xml(WDDX *src)
     xmlNode *dataNode = xmlNewChild(root_node, NULL, BAD_CAST "data", NULL);
     wddx_to_xml_node(dataNode, src->data);
 
-    src->str = xmlBufferCreate();
+    xmlBufferPtr ret = xmlBufferCreate();
 
-    xmlNodeDump(src->str, doc, root_node, 0, 0);
+    xmlNodeDump(ret, doc, root_node, 0, 0);
 
     xmlFreeDoc(doc);
 
-    return (const char *)xmlBufferContent(src->str);
+    return ret;
+}
+
+/* Writes `>` after an open tag, and after its children turns an element that got none into `<name .../>`. */
+static bool wddx_close_element(cfrds_buffer *out, size_t content_start, const char *name)
+{
+    size_t size = cfrds_buffer_data_size(out);
+
+    if (size == content_start)
+    {
+        return (cfrds_buffer_slice(out, 0, size - 1))&&(cfrds_buffer_append(out, "/>"));
+    }
+
+    return (cfrds_buffer_append(out, "</"))&&(cfrds_buffer_append(out, name))&&(cfrds_buffer_append(out, ">"));
+}
+
+/* Writes the element for `node` in the layout wddx_to_xml_node gives it; NULL nodes are left out. */
+static bool wddx_node_to_buffer(cfrds_buffer *out, const struct WDDX_NODE *node)
+{
+    const char *name = NULL;
+    char number_str[20];
+
+    if (node == NULL)
+        return true;
+
+    switch(node->type)
+    {
+    case WDDX_NULL:
+        return cfrds_buffer_append(out, "<null/>");
+    case WDDX_BOOLEAN:
+        return (cfrds_buffer_append(out, "<boolean value=\""))&&
+               (cfrds_buffer_append_xml_escaped(out, node->string, true))&&
+               (cfrds_buffer_append(out, "\"/>"));
+    case WDDX_NUMBER:
+    case WDDX_STRING:
+        name = (node->type == WDDX_NUMBER) ? "number" : "string";
+        if ((!cfrds_buffer_append(out, "<"))||(!cfrds_buffer_append(out, name))||(!cfrds_buffer_append(out, ">")))
+            return false;
+        break;
+    case WDDX_ARRAY:
+        name = "array";
+        snprintf(number_str, sizeof(number_str), "%d", node->cnt);
+        if ((!cfrds_buffer_append(out, "<array length=\""))||(!cfrds_buffer_append(out, number_str))||(!cfrds_buffer_append(out, "\">")))
+            return false;
+        break;
+    case WDDX_STRUCT:
+        name = "struct";
+        if (!cfrds_buffer_append(out, "<struct type=\"java.util.HashMap\">"))
+            return false;
+        break;
+    default:
+        return true;
+    }
+
+    size_t content_start = cfrds_buffer_data_size(out);
+
+    if ((node->type == WDDX_NUMBER)||(node->type == WDDX_STRING))
+    {
+        if (!cfrds_buffer_append_xml_escaped(out, node->string, false))
+            return false;
+    }
+    else if (node->type == WDDX_ARRAY)
+    {
+        for(int c = 0; c < node->cnt; c++)
+        {
+            if (!wddx_node_to_buffer(out, node->items[c]))
+                return false;
+        }
+    }
+    else
+    {
+        for(int c = 0; c < node->cnt; c++)
+        {
+            const WDDX_STRUCT_NODE *var = node->items[c];
+            if (var == NULL || var->name == NULL) continue;
+
+            if ((!cfrds_buffer_append(out, "<var name=\""))||(!cfrds_buffer_append_xml_escaped(out, var->name, true))||
+                (!cfrds_buffer_append(out, "\">")))
+                return false;
+
+            size_t var_start = cfrds_buffer_data_size(out);
+
+            if ((!wddx_node_to_buffer(out, var->value))||(!wddx_close_element(out, var_start, "var")))
+                return false;
+        }
+    }
+
+    return wddx_close_element(out, content_start, name);
+}
+
+bool wddx_to_buffer(const WDDX *src, cfrds_buffer *out)
+{
+    size_t content_start = 0;
+
+    if ((src == NULL)||(out == NULL))
+        return false;
+
+    if (!cfrds_buffer_append(out, "<wddxPacket version=\"1.0\"><header>"))
+        return false;
+
+    content_start = cfrds_buffer_data_size(out);
+    if ((!wddx_node_to_buffer(out, src->header))||(!wddx_close_element(out, content_start, "header")))
+        return false;
+
+    if (!cfrds_buffer_append(out, "<data>"))
+        return false;
+
+    content_start = cfrds_buffer_data_size(out);
+    if ((!wddx_node_to_buffer(out, src->data))||(!wddx_close_element(out, content_start, "data")))
+        return false;
+
+    return cfrds_buffer_append(out, "</wddxPacket>");
+}
+
+const char *wddx_to_xml(WDDX *src)
+{
+    if (src == NULL)
+        return NULL;
+
+    if ((src->str == NULL)&&(!cfrds_buffer_create(&src->str)))
+        return NULL;
+
+    cfrds_buffer_slice(src->str, 0, 0);
+
+    if (!wddx_to_buffer(src, src->str))
+        return NULL;
+
+    /* terminates the data */
+    cfrds_buffer_slice(src->str, 0, cfrds_buffer_data_size(src->str));
+
+    return cfrds_buffer_data(src->str);
 }
 
-static struct WDDX_NODE *wddx_from_xml_element(xmlNodePtr xml_node)
+static struct WDDX_NODE *wddx_from_xml_element(cfrds_arena *arena, xmlNodePtr xml_node)
 {
     struct WDDX_NODE *ret = NULL;
-    size_t malloc_size = 0;
 
     if (xml_node == NULL) return NULL;
     if (xml_node->type != XML_ELEMENT_NODE) return NULL;
@@ -395,30 +691,20 @@ static struct WDDX_NODE *wddx_from_xml_element(xmlNodePtr xml_node)
 
     if (strcmp(name, "null") == 0)
     {
-        malloc_size = sizeof(struct WDDX_NODE);
-        ret = malloc(malloc_size);
+        ret = wddx_node_alloc(arena, WDDX_NULL, 0);
         if (ret == NULL) return NULL;
-
-        explicit_bzero(ret, malloc_size);
-
-        ret->type = WDDX_NULL;
     }
     else if (strcmp(name, "boolean") == 0)
     {
         xmlChar *valueStr = xmlGetProp(xml_node, BAD_CAST "value");
         if (valueStr == NULL) return NULL;
 
-        malloc_size = sizeof(struct WDDX_NODE);
-        ret = malloc(malloc_size);
+        ret = wddx_node_alloc(arena, WDDX_BOOLEAN, 0);
         if (ret == NULL) {
             xmlFree(valueStr);
             return NULL;
         }
 
-        explicit_bzero(ret, malloc_size);
-
-        ret->type = WDDX_BOOLEAN;
-
         if (strcmp((const char *)valueStr, "false") == 0)
             ret->boolean = false;
         else
@@ -431,209 +717,1384 @@ static struct WDDX_NODE *wddx_from_xml_element(xmlNodePtr xml_node)
         if (xml_node->children == NULL) return NULL;
         if (xml_node->children->content == NULL) return NULL;
 
-        malloc_size = sizeof(struct WDDX_NODE);
-        ret = malloc(malloc_size);
+        char *endptr = NULL;
+        const char *num_str = (const char *)xml_node->children->content;
+        double number = strtod(num_str, &endptr);
+        if (endptr == num_str || *endptr != '\0')
+            return NULL;
+
+        ret = wddx_node_alloc(arena, WDDX_NUMBER, 0);
+        if (ret == NULL) return NULL;
+
+        ret->number = number;
+    }
+    else if (strcmp(name, "string") == 0)
+    {
+        size_t str_size = 0;
+        if ((xml_node->children != NULL)&&(xml_node->children->content != NULL))
+            str_size = strlen((const char *)xml_node->children->content);
+
+        ret = wddx_node_alloc(arena, WDDX_STRING, str_size + 1);
         if (ret == NULL) return NULL;
 
-        explicit_bzero(ret, malloc_size);
+        if (str_size > 0)
+            memcpy(ret->string, xml_node->children->content, str_size);
+    }
+    else if (strcmp(name, "array") == 0)
+    {
+        xmlChar *lengthStr = xmlGetProp(xml_node, BAD_CAST "length");
+        if (lengthStr == NULL) return NULL;
+
+        long parsed_len = strtol((char *)lengthStr, NULL, 10);
+        xmlFree(lengthStr); lengthStr = NULL;
+        if (parsed_len <= 0 || parsed_len > WDDX_MAX_ARRAY_LENGTH) return NULL;
+        int length = (int)parsed_len;
+
+        ret = wddx_node_alloc(arena, WDDX_ARRAY, (size_t)length * sizeof(void *));
+        if (ret == NULL) return NULL;
+
+        int idx = 0;
+        for(xmlNodePtr child_node = xml_node->children; child_node && idx < length; child_node = child_node->next)
+        {
+            if (child_node->type != XML_ELEMENT_NODE) continue;
+
+            ret->items[idx++] = wddx_from_xml_element(arena, child_node);
+            ret->cnt = idx;
+        }
+    }
+    else if (strcmp(name, "struct") == 0)
+    {
+        int length = 0;
+
+        for(xmlNodePtr child_node = xml_node->children; child_node; child_node = child_node->next)
+        {
+            if (child_node->type != XML_ELEMENT_NODE) continue;
+
+            if (strcmp((const char *)child_node->name, "var") != 0) continue;
+
+            length++;
+        }
+
+        ret = wddx_node_alloc(arena, WDDX_STRUCT, (size_t)length * sizeof(void *));
+        if (ret == NULL) return NULL;
+
+        int idx = 0;
+        for(xmlNodePtr child_node = xml_node->children; child_node && idx < length; child_node = child_node->next)
+        {
+            if (child_node->type != XML_ELEMENT_NODE) continue;
+
+            if (child_node->children == NULL)
+                return NULL;
+
+            xmlChar *key = xmlGetProp(child_node, BAD_CAST "name");
+            if (key == NULL)
+                return NULL;
+
+            WDDX_STRUCT_NODE *item = cfrds_arena_alloc(arena, sizeof(WDDX_STRUCT_NODE));
+            if (item)
+                item->name = cfrds_arena_strndup(arena, (const char *)key, strlen((const char *)key));
+            xmlFree(key); key = NULL;
+            if ((item == NULL)||(item->name == NULL))
+                return NULL;
+
+            item->value = wddx_from_xml_element(arena, child_node->children);
+
+            ret->items[idx++] = item;
+            ret->cnt = idx;
+        }
+
+        wddx_struct_index_update(arena, ret);
+    }
+
+    return ret;
+}
+
+static void silentErrorHandler(void *ctx, const char *msg, ...) {
+    (void)ctx;
+    (void)msg;
+    // Do nothing - silencing output
+}
+
+/* Builds the packet through a libxml2 DOM, for the documents the reader leaves to libxml2. */
+static WDDX *wddx_from_xml_dom(const char *xml)
+{
+    xmlDoc_defer(doc);
+    size_t xml_len = 0;
+
+    if (xml == NULL) return NULL;
+
+    xml_len = strlen(xml);
+
+    if (xml_len == 0) return NULL;
+
+    xmlSetGenericErrorFunc(NULL, silentErrorHandler);
+
+    if (xml_len > INT_MAX)
+        return NULL;
+
+    doc = xmlParseMemory(xml, (int)xml_len);
+
+    xmlNodePtr rootEl = xmlDocGetRootElement(doc);
+    if (rootEl == NULL) return NULL;
+
+    while(rootEl->type == XML_TEXT_NODE)
+    {
+        if (rootEl->next == NULL) return NULL;
+        rootEl = rootEl->next;
+    }
+
+    if (rootEl->type != XML_ELEMENT_NODE) return NULL;
+
+    if (strcmp((const char *)rootEl->name, "wddxPacket") != 0) return NULL;
+
+    xmlNodePtr headerEl = rootEl->children;
+    if (headerEl == NULL) return NULL;
+
+    while(headerEl->type == XML_TEXT_NODE)
+    {
+        if (headerEl->next == NULL) return NULL;
+        headerEl = headerEl->next;
+    }
+
+    if (headerEl->type != XML_ELEMENT_NODE) return NULL;
+    if (strcmp((const char *)headerEl->name, "header") != 0) return NULL;
+
+    xmlNodePtr dataEl = headerEl->next;
+    if (dataEl == NULL) return NULL;
+
+    while(dataEl->type == XML_TEXT_NODE)
+    {
+        if (dataEl->next == NULL) return NULL;
+        dataEl = dataEl->next;
+    }
+
+    if (dataEl->type != XML_ELEMENT_NODE) return NULL;
+    if (strcmp((const char *)dataEl->name, "data") != 0) return NULL;
+
+    struct WDDX *ret = wddx_create_sized(WDDX_ARENA_CAPACITY_FOR(xml_len));
+    if (ret == NULL) return NULL;
+
+    if (headerEl->children) ret->header = wddx_from_xml_element(ret->arena, headerEl->children);
+    if (dataEl->children) ret->data   = wddx_from_xml_element(ret->arena, dataEl->children);
+
+    return ret;
+}
+
+
+typedef enum {
+    WDDX_READ_OK,
+    WDDX_READ_FAILED,     ///< Not well-formed, libxml2 rejects it as well.
+    WDDX_READ_UNSUPPORTED ///< XML left to libxml2: a DTD, another encoding or an unusual declaration.
+} wddx_read_status;
+
+typedef enum {
+    WDDX_CHILD_ERROR,
+    WDDX_CHILD_END,       ///< End tag of the parent, consumed.
+    WDDX_CHILD_ELEMENT,   ///< Start of a child element, not consumed.
+    WDDX_CHILD_TEXT,      ///< Character data, consumed.
+    WDDX_CHILD_MARKUP     ///< Comment, processing instruction or CDATA section, consumed.
+} wddx_child;
+
+typedef enum {
+    WDDX_ATTR_NONE,
+    WDDX_ATTR_BY_ELEMENT, ///< The attribute the WDDX element needs (`value`, `length`).
+    WDDX_ATTR_NAME        ///< The `name` of a struct member.
+} wddx_attr;
+
+/* Single pass WDDX reader: checks the XML is well-formed and builds WDDX_NODEs as it goes. */
+typedef struct {
+    const char *cur;
+    const char *end;
+    int depth;
+    bool failed;
+    cfrds_buffer *text;   ///< Decoded character data or attribute value, when it has references or CRs.
+    cfrds_arena *arena;   ///< Arena of the packet being built.
+} wddx_reader;
+
+typedef struct {
+    const char *name;
+    size_t name_len;
+    const char *value;    ///< Value of the wanted attribute, NULL if the tag has none.
+    size_t value_len;
+    bool empty;           ///< `<name/>`, no children and no end tag.
+} wddx_tag;
+
+static struct WDDX_NODE *wddx_read_element(wddx_reader *r, bool build);
+
+static bool wddx_is_space(char ch)
+{
+    return (ch == ' ')||(ch == '\t')||(ch == '\n')||(ch == '\r');
+}
+
+static bool wddx_is_name_start(unsigned char ch)
+{
+    return ((ch >= 'a')&&(ch <= 'z'))||((ch >= 'A')&&(ch <= 'Z'))||(ch == '_')||(ch == ':')||(ch >= 0x80);
+}
+
+static bool wddx_is_name_char(unsigned char ch)
+{
+    return (wddx_is_name_start(ch))||((ch >= '0')&&(ch <= '9'))||(ch == '.')||(ch == '-');
+}
+
+static bool wddx_is_xml_char(uint32_t cp)
+{
+    return (cp == 0x9)||(cp == 0xA)||(cp == 0xD)||((cp >= 0x20)&&(cp <= 0xD7FF))||
+           ((cp >= 0xE000)&&(cp <= 0xFFFD))||((cp >= 0x10000)&&(cp <= 0x10FFFF));
+}
+
+/* Bytes that can be copied from character data as they are. */
+static bool wddx_is_plain_text(unsigned char ch)
+{
+    return ((ch >= 0x20)&&(ch < 0x80)&&(ch != '<')&&(ch != '&')&&(ch != '>'))||(ch == '\n')||(ch == '\t');
+}
+
+static bool wddx_view_equals(const char *view, size_t len, const char *word)
+{
+    return (strlen(word) == len)&&(memcmp(view, word, len) == 0);
+}
+
+static bool wddx_reader_starts(const wddx_reader *r, const char *prefix)
+{
+    size_t len = strlen(prefix);
+
+    return ((size_t)(r->end - r->cur) >= len)&&(memcmp(r->cur, prefix, len) == 0);
+}
+
+static void wddx_reader_skip_spaces(wddx_reader *r)
+{
+    while ((r->cur < r->end)&&(wddx_is_space(*r->cur)))
+        r->cur++;
+}
+
+/* Length of the valid UTF-8 encoded XML character at `str`, 0 if there is none. */
+static size_t wddx_utf8_len(const char *str, const char *end)
+{
+    static const uint32_t min_cp[5] = { 0, 0, 0x80, 0x800, 0x10000 };
+    const unsigned char *s = (const unsigned char *)str;
+    size_t len = 0;
+    uint32_t cp = 0;
+
+    if (s[0] < 0x80)
+        return wddx_is_xml_char(s[0]) ? 1 : 0;
+
+    if ((s[0] & 0xE0) == 0xC0) {
+        len = 2; cp = s[0] & 0x1F;
+    } else if ((s[0] & 0xF0) == 0xE0) {
+        len = 3; cp = s[0] & 0x0F;
+    } else if ((s[0] & 0xF8) == 0xF0) {
+        len = 4; cp = s[0] & 0x07;
+    } else {
+        return 0;
+    }
+
+    if ((size_t)(end - str) < len)
+        return 0;
+
+    for (size_t i = 1; i < len; i++)
+    {
+        if ((s[i] & 0xC0) != 0x80)
+            return 0;
+        cp = (cp << 6) | (s[i] & 0x3F);
+    }
+
+    if ((cp < min_cp[len])||(!wddx_is_xml_char(cp)))
+        return 0;
+
+    return len;
+}
+
+static bool wddx_append_utf8(cfrds_buffer *out, uint32_t cp)
+{
+    char buf[4];
+    size_t len = 0;
+
+    if (cp < 0x80) {
+        buf[len++] = (char)cp;
+    } else if (cp < 0x800) {
+        buf[len++] = (char)(0xC0 | (cp >> 6));
+        buf[len++] = (char)(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        buf[len++] = (char)(0xE0 | (cp >> 12));
+        buf[len++] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        buf[len++] = (char)(0x80 | (cp & 0x3F));
+    } else {
+        buf[len++] = (char)(0xF0 | (cp >> 18));
+        buf[len++] = (char)(0x80 | ((cp >> 12) & 0x3F));
+        buf[len++] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        buf[len++] = (char)(0x80 | (cp & 0x3F));
+    }
+
+    return cfrds_buffer_append_bytes(out, buf, len);
+}
+
+/* Reads a character or predefined entity reference at '&', appending its text to `out` unless NULL. */
+static bool wddx_read_reference(wddx_reader *r, cfrds_buffer *out)
+{
+    static const struct {
+        const char *name;
+        char ch;
+    } entities[] = { { "lt", '<' }, { "gt", '>' }, { "amp", '&' }, { "apos", '\'' }, { "quot", '"' } };
+
+    const char *start = ++r->cur;
+    const char *semicolon = NULL;
+
+    for (const char *p = start; (p < r->end)&&(p - start <= 12); p++)
+    {
+        if (*p == ';') {
+            semicolon = p;
+            break;
+        }
+    }
+
+    if ((semicolon == NULL)||(semicolon == start))
+        return false;
+
+    r->cur = semicolon + 1;
+
+    if (*start == '#')
+    {
+        const char *digits = start + 1;
+        int base = 10;
+        uint32_t cp = 0;
+
+        if ((digits < semicolon)&&(*digits == 'x')) {
+            base = 16;
+            digits++;
+        }
+
+        if (digits == semicolon)
+            return false;
+
+        for (const char *p = digits; p < semicolon; p++)
+        {
+            int digit;
+
+            if ((*p >= '0')&&(*p <= '9'))
+                digit = *p - '0';
+            else if ((base == 16)&&(*p >= 'a')&&(*p <= 'f'))
+                digit = *p - 'a' + 10;
+            else if ((base == 16)&&(*p >= 'A')&&(*p <= 'F'))
+                digit = *p - 'A' + 10;
+            else
+                return false;
+
+            cp = cp * (uint32_t)base + (uint32_t)digit;
+            if (cp > 0x10FFFF)
+                return false;
+        }
+
+        if (!wddx_is_xml_char(cp))
+            return false;
+
+        return (out == NULL)||(wddx_append_utf8(out, cp));
+    }
+
+    for (size_t c = 0; c < sizeof(entities) / sizeof(entities[0]); c++)
+    {
+        if (wddx_view_equals(start, (size_t)(semicolon - start), entities[c].name))
+            return (out == NULL)||(cfrds_buffer_append_bytes(out, &entities[c].ch, 1));
+    }
+
+    /* no DTD, so no other entity can be declared */
+    return false;
+}
+
+/*
+ * Reads character data up to the next '<'. With `keep`, `*data` gets the text the way libxml2
+ * reports it: references decoded and line ends normalized to "\n". Plain text is returned in
+ * place, anything else is decoded into `r->text`.
+ */
+static bool wddx_read_text(wddx_reader *r, bool keep, const char **data, size_t *len)
+{
+    const char *start = r->cur;
+    const char *seg = r->cur;
+    bool plain = true;
+
+    while (1)
+    {
+        while ((r->cur < r->end)&&(wddx_is_plain_text((unsigned char)*r->cur)))
+            r->cur++;
+
+        if ((r->cur == r->end)||(*r->cur == '<'))
+            break;
+
+        char ch = *r->cur;
+
+        if ((ch == '&')||(ch == '\r'))
+        {
+            if (keep)
+            {
+                if (plain)
+                    cfrds_buffer_slice(r->text, 0, 0);
+                if (!cfrds_buffer_append_bytes(r->text, seg, (size_t)(r->cur - seg)))
+                    return false;
+            }
+            plain = false;
+
+            if (ch == '&')
+            {
+                if (!wddx_read_reference(r, keep ? r->text : NULL))
+                    return false;
+            }
+            else
+            {
+                r->cur++;
+                if ((r->cur < r->end)&&(*r->cur == '\n'))
+                    r->cur++;
+                if ((keep)&&(!cfrds_buffer_append_bytes(r->text, "\n", 1)))
+                    return false;
+            }
+
+            seg = r->cur;
+            continue;
+        }
+
+        if (ch == '>')
+        {
+            /* "]]>" is not allowed in character data */
+            if ((r->cur - start >= 2)&&(r->cur[-1] == ']')&&(r->cur[-2] == ']'))
+                return false;
+            r->cur++;
+            continue;
+        }
+
+        size_t n = wddx_utf8_len(r->cur, r->end);
+        if (n == 0)
+            return false;
+        r->cur += n;
+    }
+
+    if (!keep)
+        return true;
+
+    if (plain)
+    {
+        *data = start;
+        *len = (size_t)(r->cur - start);
+        return true;
+    }
+
+    if (!cfrds_buffer_append_bytes(r->text, seg, (size_t)(r->cur - seg)))
+        return false;
+
+    *data = cfrds_buffer_data(r->text);
+    *len = cfrds_buffer_data_size(r->text);
+
+    return true;
+}
+
+/* Reads the raw text up to `terminator`, for comments, processing instructions and CDATA sections. */
+static bool wddx_read_until(wddx_reader *r, const char *terminator, bool keep, const char **data, size_t *len)
+{
+    size_t term_len = strlen(terminator);
+    const char *start = r->cur;
+    bool has_cr = false;
+
+    while (1)
+    {
+        if ((size_t)(r->end - r->cur) < term_len)
+            return false;
+
+        if (memcmp(r->cur, terminator, term_len) == 0)
+            break;
+
+        if (*r->cur == '\r')
+            has_cr = true;
+
+        size_t n = wddx_utf8_len(r->cur, r->end);
+        if (n == 0)
+            return false;
+        r->cur += n;
+    }
+
+    const char *stop = r->cur;
+    r->cur += term_len;
+
+    if (!keep)
+        return true;
+
+    if (!has_cr)
+    {
+        *data = start;
+        *len = (size_t)(stop - start);
+        return true;
+    }
+
+    cfrds_buffer_slice(r->text, 0, 0);
+    for (const char *p = start; p < stop; p++)
+    {
+        if (*p == '\r')
+        {
+            if ((p + 1 < stop)&&(p[1] == '\n'))
+                continue;
+            if (!cfrds_buffer_append_bytes(r->text, "\n", 1))
+                return false;
+        }
+        else if (!cfrds_buffer_append_bytes(r->text, p, 1))
+        {
+            return false;
+        }
+    }
+
+    *data = cfrds_buffer_data(r->text);
+    *len = cfrds_buffer_data_size(r->text);
+
+    return true;
+}
+
+static bool wddx_read_name(wddx_reader *r, const char **name, size_t *len)
+{
+    const char *start = r->cur;
+
+    if ((r->cur >= r->end)||(!wddx_is_name_start((unsigned char)*r->cur)))
+        return false;
+
+    while ((r->cur < r->end)&&(wddx_is_name_char((unsigned char)*r->cur)))
+    {
+        if ((unsigned char)*r->cur >= 0x80)
+        {
+            size_t n = wddx_utf8_len(r->cur, r->end);
+            if (n == 0)
+                return false;
+            r->cur += n;
+        }
+        else
+        {
+            r->cur++;
+        }
+    }
+
+    *name = start;
+    *len = (size_t)(r->cur - start);
+
+    return true;
+}
+
+/* Reads a comment at "<!--", the body of one must not contain "--". */
+static bool wddx_read_comment(wddx_reader *r, bool keep, const char **data, size_t *len)
+{
+    const char *body = NULL;
+    size_t body_len = 0;
+
+    r->cur += 4;
+    if (!wddx_read_until(r, "--", true, &body, &body_len))
+        return false;
+
+    if ((r->cur >= r->end)||(*r->cur != '>'))
+        return false;
+    r->cur++;
+
+    if (keep)
+    {
+        *data = body;
+        *len = body_len;
+    }
+
+    return true;
+}
+
+/* Reads a processing instruction at "<?", its data is the text after the target. */
+static bool wddx_read_pi(wddx_reader *r, bool keep, const char **data, size_t *len)
+{
+    const char *target = NULL;
+    size_t target_len = 0;
+
+    r->cur += 2;
+    if (!wddx_read_name(r, &target, &target_len))
+        return false;
+
+    /* the XML declaration is only allowed at the very start */
+    if ((target_len == 3)&&(tolower((unsigned char)target[0]) == 'x')&&(tolower((unsigned char)target[1]) == 'm')&&(tolower((unsigned char)target[2]) == 'l'))
+        return false;
+
+    if ((r->cur < r->end)&&(!wddx_is_space(*r->cur))&&(!wddx_reader_starts(r, "?>")))
+        return false;
+
+    wddx_reader_skip_spaces(r);
+
+    return wddx_read_until(r, "?>", keep, data, len);
+}
+
+/* Reads an attribute value at its opening quote, normalizing whitespace like libxml2 does without a DTD. */
+static bool wddx_read_attr_value(wddx_reader *r, bool keep, const char **data, size_t *len)
+{
+    if ((r->cur >= r->end)||((*r->cur != '"')&&(*r->cur != '\'')))
+        return false;
+
+    char quote = *r->cur++;
+    const char *start = r->cur;
+    const char *seg = r->cur;
+    bool plain = true;
+
+    while (1)
+    {
+        if (r->cur >= r->end)
+            return false;
+
+        char ch = *r->cur;
+
+        if (ch == quote)
+            break;
+
+        if (ch == '<')
+            return false;
+
+        if ((ch == '&')||(ch == '\r')||(ch == '\n')||(ch == '\t'))
+        {
+            if (keep)
+            {
+                if (plain)
+                    cfrds_buffer_slice(r->text, 0, 0);
+                if (!cfrds_buffer_append_bytes(r->text, seg, (size_t)(r->cur - seg)))
+                    return false;
+            }
+            plain = false;
+
+            if (ch == '&')
+            {
+                if (!wddx_read_reference(r, keep ? r->text : NULL))
+                    return false;
+            }
+            else
+            {
+                r->cur++;
+                if ((ch == '\r')&&(r->cur < r->end)&&(*r->cur == '\n'))
+                    r->cur++;
+                if ((keep)&&(!cfrds_buffer_append_bytes(r->text, " ", 1)))
+                    return false;
+            }
+
+            seg = r->cur;
+            continue;
+        }
+
+        size_t n = wddx_utf8_len(r->cur, r->end);
+        if (n == 0)
+            return false;
+        r->cur += n;
+    }
+
+    const char *stop = r->cur++;
+
+    if (!keep)
+        return true;
+
+    if (plain)
+    {
+        *data = start;
+        *len = (size_t)(stop - start);
+        return true;
+    }
+
+    if (!cfrds_buffer_append_bytes(r->text, seg, (size_t)(stop - seg)))
+        return false;
+
+    *data = cfrds_buffer_data(r->text);
+    *len = cfrds_buffer_data_size(r->text);
+
+    return true;
+}
+
+/* Attributes compared for duplicates, WDDX elements have at most two. */
+#define WDDX_MAX_CHECKED_ATTRS 16
+
+/* Reads a start tag at '<', keeping the value of the attribute `want` asks for. */
+static bool wddx_read_start_tag(wddx_reader *r, wddx_attr want, wddx_tag *tag)
+{
+    struct {
+        const char *name;
+        size_t len;
+    } seen[WDDX_MAX_CHECKED_ATTRS];
+    size_t seen_cnt = 0;
+    const char *wanted = NULL;
+
+    explicit_bzero(tag, sizeof(wddx_tag));
+
+    r->cur++;
+    if (!wddx_read_name(r, &tag->name, &tag->name_len))
+        return false;
+
+    if (want == WDDX_ATTR_NAME)
+        wanted = "name";
+    else if ((want == WDDX_ATTR_BY_ELEMENT)&&(wddx_view_equals(tag->name, tag->name_len, "boolean")))
+        wanted = "value";
+    else if ((want == WDDX_ATTR_BY_ELEMENT)&&(wddx_view_equals(tag->name, tag->name_len, "array")))
+        wanted = "length";
+
+    while (1)
+    {
+        const char *attr = NULL;
+        size_t attr_len = 0;
+        bool spaced = (r->cur < r->end)&&(wddx_is_space(*r->cur));
+
+        wddx_reader_skip_spaces(r);
+
+        if (r->cur >= r->end)
+            return false;
+
+        if (*r->cur == '>')
+        {
+            r->cur++;
+            return true;
+        }
+
+        if (wddx_reader_starts(r, "/>"))
+        {
+            r->cur += 2;
+            tag->empty = true;
+            return true;
+        }
+
+        if ((!spaced)||(!wddx_read_name(r, &attr, &attr_len)))
+            return false;
+
+        for (size_t c = 0; c < seen_cnt; c++)
+        {
+            if ((seen[c].len == attr_len)&&(memcmp(seen[c].name, attr, attr_len) == 0))
+                return false;
+        }
+
+        if (seen_cnt < WDDX_MAX_CHECKED_ATTRS)
+        {
+            seen[seen_cnt].name = attr;
+            seen[seen_cnt].len = attr_len;
+            seen_cnt++;
+        }
+
+        wddx_reader_skip_spaces(r);
+        if ((r->cur >= r->end)||(*r->cur != '='))
+            return false;
+        r->cur++;
+        wddx_reader_skip_spaces(r);
+
+        bool keep = (wanted)&&(wddx_view_equals(attr, attr_len, wanted));
+        if (!wddx_read_attr_value(r, keep, &tag->value, &tag->value_len))
+            return false;
+    }
+}
+
+/* Reads the end tag at "</", which must close `tag`. */
+static bool wddx_read_end_tag(wddx_reader *r, const wddx_tag *tag)
+{
+    const char *name = NULL;
+    size_t name_len = 0;
+
+    r->cur += 2;
+    if ((!wddx_read_name(r, &name, &name_len))||(name_len != tag->name_len)||(memcmp(name, tag->name, name_len) != 0))
+        return false;
+
+    wddx_reader_skip_spaces(r);
+    if ((r->cur >= r->end)||(*r->cur != '>'))
+        return false;
+    r->cur++;
+
+    return true;
+}
+
+/*
+ * Reads the next child of the element `tag`, see `wddx_child`. With `keep`, `*data` gets the
+ * content of a text, comment, processing instruction or CDATA child.
+ */
+static wddx_child wddx_read_child(wddx_reader *r, const wddx_tag *tag, bool keep, const char **data, size_t *len)
+{
+    bool ok = false;
+    wddx_child ret = WDDX_CHILD_MARKUP;
+
+    if (r->cur >= r->end) {
+        ok = false;
+    } else if (*r->cur != '<') {
+        ok = wddx_read_text(r, keep, data, len);
+        ret = WDDX_CHILD_TEXT;
+    } else if (wddx_reader_starts(r, "</")) {
+        ok = wddx_read_end_tag(r, tag);
+        ret = WDDX_CHILD_END;
+    } else if (wddx_reader_starts(r, "<!--")) {
+        ok = wddx_read_comment(r, keep, data, len);
+    } else if (wddx_reader_starts(r, "<![CDATA[")) {
+        r->cur += 9;
+        ok = wddx_read_until(r, "]]>", keep, data, len);
+    } else if (wddx_reader_starts(r, "<?")) {
+        ok = wddx_read_pi(r, keep, data, len);
+    } else if ((r->cur + 1 < r->end)&&(wddx_is_name_start((unsigned char)r->cur[1]))) {
+        ok = true;
+        ret = WDDX_CHILD_ELEMENT;
+    }
+
+    if (!ok)
+    {
+        r->failed = true;
+        return WDDX_CHILD_ERROR;
+    }
+
+    return ret;
+}
+
+/* Skips the remaining children of `tag`, checking they are well-formed. */
+static void wddx_skip_children(wddx_reader *r, const wddx_tag *tag)
+{
+    while (!r->failed)
+    {
+        wddx_child child = wddx_read_child(r, tag, false, NULL, NULL);
+
+        if (child == WDDX_CHILD_END)
+            break;
+
+        if (child == WDDX_CHILD_ELEMENT)
+            wddx_read_element(r, false);
+    }
+}
+
+/*
+ * Reads the children of `tag` whose value is its first child, like `<var>`, `<header>` and
+ * `<data>` do. `*value` is that child if it is an element; the other children are skipped.
+ */
+static void wddx_read_first_child(wddx_reader *r, const wddx_tag *tag, struct WDDX_NODE **value, bool *has_children)
+{
+    *value = NULL;
+    *has_children = false;
+
+    if (tag->empty)
+        return;
+
+    wddx_child child = wddx_read_child(r, tag, false, NULL, NULL);
+    if ((child == WDDX_CHILD_ERROR)||(child == WDDX_CHILD_END))
+        return;
+
+    *has_children = true;
+
+    if (child == WDDX_CHILD_ELEMENT)
+        *value = wddx_read_element(r, true);
+
+    wddx_skip_children(r, tag);
+}
+
+/* Parses an array `length` the way strtol does, saturating instead of overflowing. */
+static long wddx_parse_length(const char *str, size_t len)
+{
+    const char *end = str + len;
+    long ret = 0;
+    bool negative = false;
+
+    while ((str < end)&&(isspace((unsigned char)*str)))
+        str++;
+
+    if ((str < end)&&((*str == '-')||(*str == '+')))
+        negative = (*str++ == '-');
+
+    while ((str < end)&&(*str >= '0')&&(*str <= '9'))
+    {
+        if (ret <= (LONG_MAX - 9) / 10)
+            ret = ret * 10 + (*str - '0');
+        else
+            ret = LONG_MAX;
+        str++;
+    }
+
+    return negative ? -ret : ret;
+}
+
+/* The first `length` element children are the items; the others are only checked. */
+static struct WDDX_NODE *wddx_read_array(wddx_reader *r, const wddx_tag *tag)
+{
+    struct WDDX_NODE *ret = NULL;
+    long length = 0;
+
+    if (tag->value)
+        length = wddx_parse_length(tag->value, tag->value_len);
+
+    if ((length > 0)&&(length <= WDDX_MAX_ARRAY_LENGTH))
+        ret = wddx_node_alloc(r->arena, WDDX_ARRAY, (size_t)length * sizeof(void *));
+
+    if (tag->empty)
+        return ret;
+
+    while (!r->failed)
+    {
+        wddx_child child = wddx_read_child(r, tag, false, NULL, NULL);
+
+        if (child == WDDX_CHILD_END)
+            return ret;
+
+        if (child == WDDX_CHILD_ELEMENT)
+        {
+            if ((ret)&&(ret->cnt < length))
+                ret->items[ret->cnt++] = wddx_read_element(r, true);
+            else
+                wddx_read_element(r, false);
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Every element child of a struct is a member, and the first (number of `<var>` children) of
+ * them are kept, as the DOM walk did. A kept member without a name or without children makes
+ * the whole struct NULL.
+ */
+static struct WDDX_NODE *wddx_read_struct(wddx_reader *r, const wddx_tag *tag)
+{
+    size_t capacity = 4;
+    int vars = 0;
+    int invalid = -1;
+    bool oom = false;
+
+    struct WDDX_NODE *ret = wddx_node_alloc(r->arena, WDDX_STRUCT, capacity * sizeof(void *));
+
+    if (tag->empty)
+        return ret;
+
+    while (!r->failed)
+    {
+        wddx_child child = wddx_read_child(r, tag, false, NULL, NULL);
+
+        if (child == WDDX_CHILD_END)
+            break;
+
+        if (child != WDDX_CHILD_ELEMENT)
+            continue;
+
+        wddx_tag var;
+        struct WDDX_NODE *value = NULL;
+        bool has_children = false;
+        WDDX_STRUCT_NODE *item = NULL;
+
+        if (++r->depth > WDDX_MAX_DEPTH)
+        {
+            r->failed = true;
+            break;
+        }
+
+        if (!wddx_read_start_tag(r, WDDX_ATTR_NAME, &var))
+        {
+            r->failed = true;
+            break;
+        }
+
+        if (wddx_view_equals(var.name, var.name_len, "var"))
+            vars++;
+
+        if ((ret)&&(!oom))
+        {
+            /* `var.value` may point into r->text, so the key is copied before reading on */
+            item = cfrds_arena_alloc(r->arena, sizeof(WDDX_STRUCT_NODE));
+            if ((item)&&(var.value))
+                item->name = cfrds_arena_strndup(r->arena, var.value, var.value_len);
+
+            if ((item == NULL)||((var.value)&&(item->name == NULL)))
+                oom = true;
+        }
+
+        wddx_read_first_child(r, &var, &value, &has_children);
+        r->depth--;
+
+        if ((oom)||(ret == NULL))
+            continue;
+
+        if (((var.value == NULL)||(!has_children))&&(invalid < 0))
+            invalid = ret->cnt;
+
+        if ((size_t)ret->cnt == capacity)
+        {
+            /* the outgrown items stay in the arena */
+            struct WDDX_NODE *grown = wddx_node_grow(r->arena, ret, capacity * 2);
+            if (grown == NULL)
+            {
+                oom = true;
+                continue;
+            }
+            ret = grown;
+            capacity *= 2;
+        }
+
+        item->value = value;
+        ret->items[ret->cnt++] = item;
+    }
+
+    if ((r->failed)||(oom)||(ret == NULL)||((invalid >= 0)&&(invalid < vars)))
+        return NULL;
+
+    if (ret->cnt > vars)
+        ret->cnt = vars;
+
+    wddx_struct_index_update(r->arena, ret);
+
+    return ret;
+}
+
+/*
+ * `<number>` and `<string>` take their value from the content of their first child: text,
+ * CDATA, comment or processing instruction. A number without one is NULL, a string is empty.
+ */
+static struct WDDX_NODE *wddx_read_scalar(wddx_reader *r, const wddx_tag *tag, enum wddx_type type)
+{
+    struct WDDX_NODE *ret = NULL;
+    const char *content = NULL;
+    size_t content_len = 0;
+    wddx_child child = WDDX_CHILD_END;
+
+    if (!tag->empty)
+        child = wddx_read_child(r, tag, true, &content, &content_len);
+
+    if (child == WDDX_CHILD_ERROR)
+        return NULL;
+
+    if (child == WDDX_CHILD_ELEMENT)
+        wddx_read_element(r, false);
+
+    if ((child != WDDX_CHILD_TEXT)&&(child != WDDX_CHILD_MARKUP))
+        content = NULL;
+
+    /* `content` may point into r->text, so the node is built before reading on */
+    if (type == WDDX_STRING)
+    {
+        size_t str_size = content ? content_len : 0;
+
+        ret = wddx_node_alloc(r->arena, WDDX_STRING, str_size + 1);
+        if ((ret)&&(str_size > 0))
+            memcpy(ret->string, content, str_size);
+    }
+    else if (content)
+    {
+        char num_buf[64];
+        char *num_str = num_buf;
+
+        if (content_len >= sizeof(num_buf))
+            num_str = malloc(content_len + 1);
+
+        if (num_str)
+        {
+            char *endptr = NULL;
+
+            memcpy(num_str, content, content_len);
+            num_str[content_len] = '\0';
+
+            double number = strtod(num_str, &endptr);
+            if ((endptr != num_str)&&(*endptr == '\0'))
+            {
+                ret = wddx_node_alloc(r->arena, WDDX_NUMBER, 0);
+                if (ret)
+                    ret->number = number;
+            }
+
+            if (num_str != num_buf)
+                free(num_str);
+        }
+    }
+
+    if (child != WDDX_CHILD_END)
+        wddx_skip_children(r, tag);
+
+    if (r->failed)
+        return NULL;
+
+    return ret;
+}
+
+/*
+ * Reads an element at '<' with its whole subtree. Without `build` the subtree is only checked,
+ * and so are elements that are no WDDX type. Sets `r->failed` if the XML is not well-formed.
+ */
+static struct WDDX_NODE *wddx_read_element(wddx_reader *r, bool build)
+{
+    struct WDDX_NODE *ret = NULL;
+    wddx_tag tag;
+
+    if (++r->depth > WDDX_MAX_DEPTH)
+    {
+        r->failed = true;
+        return NULL;
+    }
+
+    if (!wddx_read_start_tag(r, build ? WDDX_ATTR_BY_ELEMENT : WDDX_ATTR_NONE, &tag))
+    {
+        r->failed = true;
+        return NULL;
+    }
+
+    if (!build)
+    {
+        if (!tag.empty)
+            wddx_skip_children(r, &tag);
+    }
+    else if (wddx_view_equals(tag.name, tag.name_len, "null"))
+    {
+        ret = wddx_node_alloc(r->arena, WDDX_NULL, 0);
+        if (!tag.empty)
+            wddx_skip_children(r, &tag);
+    }
+    else if (wddx_view_equals(tag.name, tag.name_len, "boolean"))
+    {
+        if (tag.value)
+        {
+            ret = wddx_node_alloc(r->arena, WDDX_BOOLEAN, 0);
+            if (ret)
+                ret->boolean = !wddx_view_equals(tag.value, tag.value_len, "false");
+        }
+        if (!tag.empty)
+            wddx_skip_children(r, &tag);
+    }
+    else if (wddx_view_equals(tag.name, tag.name_len, "number"))
+    {
+        ret = wddx_read_scalar(r, &tag, WDDX_NUMBER);
+    }
+    else if (wddx_view_equals(tag.name, tag.name_len, "string"))
+    {
+        ret = wddx_read_scalar(r, &tag, WDDX_STRING);
+    }
+    else if (wddx_view_equals(tag.name, tag.name_len, "array"))
+    {
+        ret = wddx_read_array(r, &tag);
+    }
+    else if (wddx_view_equals(tag.name, tag.name_len, "struct"))
+    {
+        ret = wddx_read_struct(r, &tag);
+    }
+    else if (!tag.empty)
+    {
+        wddx_skip_children(r, &tag);
+    }
+
+    r->depth--;
+
+    if (r->failed)
+        return NULL;
+
+    return ret;
+}
+
+/* Skips whitespace, comments and processing instructions outside the root element. */
+static bool wddx_read_misc(wddx_reader *r)
+{
+    while (1)
+    {
+        wddx_reader_skip_spaces(r);
+
+        if (wddx_reader_starts(r, "<!--")) {
+            if (!wddx_read_comment(r, false, NULL, NULL))
+                return false;
+        } else if (wddx_reader_starts(r, "<?")) {
+            if (!wddx_read_pi(r, false, NULL, NULL))
+                return false;
+        } else {
+            return true;
+        }
+    }
+}
+
+/* Reads ` name="value"` of the XML declaration, `name` being optional. */
+static bool wddx_read_pseudo_attr(wddx_reader *r, const char *name, bool *present, const char **value, size_t *len)
+{
+    wddx_reader peek = *r;
+    size_t name_len = strlen(name);
 
-        ret->type = WDDX_NUMBER;
+    *present = false;
 
-        char *endptr = NULL;
-        const char *num_str = (const char *)xml_node->children->content;
-        ret->number = strtod(num_str, &endptr);
-        if (endptr == num_str || *endptr != '\0')
-        {
-            free(ret);
-            return NULL;
-        }
-    }
-    else if (strcmp(name, "string") == 0)
-    {
-        size_t str_size = 0;
-        if ((xml_node->children != NULL)&&(xml_node->children->content != NULL))
-            str_size = strlen((const char *)xml_node->children->content);
+    if ((peek.cur >= peek.end)||(!wddx_is_space(*peek.cur)))
+        return true;
 
-        malloc_size = offsetof(struct WDDX_NODE, string) + str_size + 1;
-        ret = malloc(malloc_size);
-        if (ret == NULL) return NULL;
+    wddx_reader_skip_spaces(&peek);
+    if (!wddx_reader_starts(&peek, name))
+        return true;
 
-        explicit_bzero(ret, malloc_size);
+    peek.cur += name_len;
+    wddx_reader_skip_spaces(&peek);
+    if ((peek.cur >= peek.end)||(*peek.cur != '='))
+        return false;
+    peek.cur++;
+    wddx_reader_skip_spaces(&peek);
 
-        ret->type = WDDX_STRING;
+    if ((peek.cur >= peek.end)||((*peek.cur != '"')&&(*peek.cur != '\'')))
+        return false;
 
-        if (str_size > 0) {
-            strncpy(ret->string, (const char *)xml_node->children->content, str_size);
-            ret->string[str_size] = '\0';
-        }
-    }
-    else if (strcmp(name, "array") == 0)
-    {
-        xmlChar *lengthStr = xmlGetProp(xml_node, BAD_CAST "length");
-        if (lengthStr == NULL) return NULL;
+    const char *start = peek.cur + 1;
+    const char *stop = memchr(start, *peek.cur, (size_t)(peek.end - start));
+    if (stop == NULL)
+        return false;
 
-        long parsed_len = strtol((char *)lengthStr, NULL, 10);
-        xmlFree(lengthStr); lengthStr = NULL;
-        if (parsed_len <= 0 || parsed_len > WDDX_MAX_ARRAY_LENGTH) return NULL;
-        int length = (int)parsed_len;
+    *present = true;
+    *value = start;
+    *len = (size_t)(stop - start);
+    r->cur = stop + 1;
 
-        malloc_size = offsetof(struct WDDX_NODE, items) + (size_t)length * sizeof(void *);
-        ret = malloc(malloc_size);
-        if (ret == NULL) return NULL;
+    return true;
+}
 
-        explicit_bzero(ret, malloc_size);
+/*
+ * Reads the XML declaration at "<?xml ". Only a plain UTF-8 one is handled here; libxml2 gets
+ * other encodings, and tells what is wrong with a declaration the reader does not expect.
+ */
+static wddx_read_status wddx_read_declaration(wddx_reader *r)
+{
+    const char *value = NULL;
+    size_t len = 0;
+    bool present = false;
 
-        ret->type = WDDX_ARRAY;
-        ret->cnt = 0;
+    r->cur += 5;
 
-        int idx = 0;
-        for(xmlNodePtr child_node = xml_node->children; child_node && idx < length; child_node = child_node->next)
-        {
-            if (child_node->type != XML_ELEMENT_NODE) continue;
+    if ((!wddx_read_pseudo_attr(r, "version", &present, &value, &len))||(!present)||
+        (len < 3)||(value[0] != '1')||(value[1] != '.'))
+        return WDDX_READ_UNSUPPORTED;
 
-            ret->items[idx++] = wddx_from_xml_element(child_node);
-            ret->cnt = idx;
-        }
-    }
-    else if (strcmp(name, "struct") == 0)
+    for (size_t c = 2; c < len; c++)
     {
-        int length = 0;
-
-        for(xmlNodePtr child_node = xml_node->children; child_node; child_node = child_node->next)
-        {
-            if (child_node->type != XML_ELEMENT_NODE) continue;
+        if ((value[c] < '0')||(value[c] > '9'))
+            return WDDX_READ_UNSUPPORTED;
+    }
 
-            if (strcmp((const char *)child_node->name, "var") != 0) continue;
+    if (!wddx_read_pseudo_attr(r, "encoding", &present, &value, &len))
+        return WDDX_READ_UNSUPPORTED;
 
-            length++;
-        }
+    if ((present)&&((len != 5)||(strncasecmp(value, "utf-8", 5) != 0)))
+        return WDDX_READ_UNSUPPORTED;
 
-        malloc_size = offsetof(struct WDDX_NODE, items) + (size_t)length * sizeof(void *);
-        ret = malloc(malloc_size);
-        if (ret == NULL) return NULL;
+    if (!wddx_read_pseudo_attr(r, "standalone", &present, &value, &len))
+        return WDDX_READ_UNSUPPORTED;
 
-        explicit_bzero(ret, malloc_size);
+    if ((present)&&(!wddx_view_equals(value, len, "yes"))&&(!wddx_view_equals(value, len, "no")))
+        return WDDX_READ_UNSUPPORTED;
 
-        ret->type = WDDX_STRUCT;
-        ret->cnt = 0;
+    wddx_reader_skip_spaces(r);
+    if (!wddx_reader_starts(r, "?>"))
+        return WDDX_READ_UNSUPPORTED;
 
-        int idx = 0;
-        for(xmlNodePtr child_node = xml_node->children; child_node && idx < length; child_node = child_node->next)
-        {
-            if (child_node->type != XML_ELEMENT_NODE) continue;
+    r->cur += 2;
 
-            if (child_node->children == NULL)
-            {
-                wddx_node_free(ret);
-                return NULL;
-            }
+    return WDDX_READ_OK;
+}
 
-            xmlChar *key = xmlGetProp(child_node, BAD_CAST "name");
-            if (key == NULL)
-            {
-                wddx_node_free(ret);
-                return NULL;
-            }
+/* Reads the next child of `<wddxPacket>` other than text, NULL if it is not the element `name`. */
+static bool wddx_read_packet_child(wddx_reader *r, const wddx_tag *packet, const char *name, wddx_tag *tag)
+{
+    wddx_child child;
 
-            malloc_size = sizeof(WDDX_STRUCT_NODE);
-            WDDX_STRUCT_NODE *item = malloc(malloc_size);
-            if (item == NULL)
-            {
-                xmlFree(key);
-                wddx_node_free(ret);
-                return NULL;
-            }
+    do {
+        child = wddx_read_child(r, packet, false, NULL, NULL);
+    } while (child == WDDX_CHILD_TEXT);
 
-            explicit_bzero(item, malloc_size);
+    if (child != WDDX_CHILD_ELEMENT)
+    {
+        /* anything else still has to be well-formed */
+        if ((child != WDDX_CHILD_END)&&(child != WDDX_CHILD_ERROR))
+            wddx_skip_children(r, packet);
+        return false;
+    }
 
-            item->name = strdup((char *)key);
-            xmlFree(key); key = NULL;
-            if (item->name == NULL)
-            {
-                free(item);
-                wddx_node_free(ret);
-                return NULL;
-            }
-            item->value = wddx_from_xml_element(child_node->children);
+    if (++r->depth > WDDX_MAX_DEPTH)
+    {
+        r->failed = true;
+        return false;
+    }
 
-            ret->items[idx++] = item;
-            ret->cnt = idx;
-        }
+    if (!wddx_read_start_tag(r, WDDX_ATTR_NONE, tag))
+    {
+        r->failed = true;
+        return false;
     }
 
-    return ret;
-}
+    if (!wddx_view_equals(tag->name, tag->name_len, name))
+    {
+        if (!tag->empty)
+            wddx_skip_children(r, tag);
+        r->depth--;
+        wddx_skip_children(r, packet);
+        return false;
+    }
 
-static void silentErrorHandler(void *ctx, const char *msg, ...) {
-    (void)ctx;
-    (void)msg;
-    // Do nothing - silencing output
+    return true;
 }
 
-WDDX *wddx_from_xml(const char *xml)
+static wddx_read_status wddx_read_packet(wddx_reader *r, WDDX *ret, bool *is_wddx)
 {
-    xmlDoc_defer(doc);
-    size_t xml_len = 0;
+    wddx_tag packet;
+    wddx_tag tag;
+    bool has_children = false;
 
-    if (xml == NULL) return NULL;
+    *is_wddx = false;
 
-    xml_len = strlen(xml);
+    if (wddx_reader_starts(r, "\xEF\xBB\xBF"))
+        r->cur += 3;
 
-    if (xml_len == 0) return NULL;
+    if ((wddx_reader_starts(r, "<?xml"))&&(r->cur + 5 < r->end)&&(wddx_is_space(r->cur[5])))
+    {
+        wddx_read_status status = wddx_read_declaration(r);
+        if (status != WDDX_READ_OK)
+            return status;
+    }
 
-    xmlSetGenericErrorFunc(NULL, silentErrorHandler);
+    if (!wddx_read_misc(r))
+        return WDDX_READ_FAILED;
 
-    if (xml_len > INT_MAX)
-        return NULL;
+    if (wddx_reader_starts(r, "<!DOCTYPE"))
+        return WDDX_READ_UNSUPPORTED;
 
-    doc = xmlParseMemory(xml, (int)xml_len);
+    if ((r->cur + 1 >= r->end)||(*r->cur != '<')||(!wddx_is_name_start((unsigned char)r->cur[1])))
+        return WDDX_READ_FAILED;
 
-    xmlNodePtr rootEl = xmlDocGetRootElement(doc);
-    if (rootEl == NULL) return NULL;
+    r->depth++;
+    if (!wddx_read_start_tag(r, WDDX_ATTR_NONE, &packet))
+        return WDDX_READ_FAILED;
 
-    while(rootEl->type == XML_TEXT_NODE)
+    bool is_packet = wddx_view_equals(packet.name, packet.name_len, "wddxPacket");
+
+    if ((!is_packet)||(packet.empty))
     {
-        if (rootEl->next == NULL) return NULL;
-        rootEl = rootEl->next;
+        if (!packet.empty)
+            wddx_skip_children(r, &packet);
     }
+    else if (wddx_read_packet_child(r, &packet, "header", &tag))
+    {
+        wddx_read_first_child(r, &tag, &ret->header, &has_children);
+        r->depth--;
 
-    if (rootEl->type != XML_ELEMENT_NODE) return NULL;
+        if ((!r->failed)&&(wddx_read_packet_child(r, &packet, "data", &tag)))
+        {
+            wddx_read_first_child(r, &tag, &ret->data, &has_children);
+            r->depth--;
+            *is_wddx = true;
+            wddx_skip_children(r, &packet);
+        }
+    }
 
-    if (strcmp((const char *)rootEl->name, "wddxPacket") != 0) return NULL;
+    if (r->failed)
+        return WDDX_READ_FAILED;
 
-    xmlNodePtr headerEl = rootEl->children;
-    if (headerEl == NULL) return NULL;
+    if (!wddx_read_misc(r))
+        return WDDX_READ_FAILED;
 
-    while(headerEl->type == XML_TEXT_NODE)
-    {
-        if (headerEl->next == NULL) return NULL;
-        headerEl = headerEl->next;
-    }
+    return (r->cur == r->end) ? WDDX_READ_OK : WDDX_READ_FAILED;
+}
 
-    if (headerEl->type != XML_ELEMENT_NODE) return NULL;
-    if (strcmp((const char *)headerEl->name, "header") != 0) return NULL;
+WDDX *wddx_from_xml(const char *xml)
+{
+    cfrds_buffer_defer(text);
+    bool is_wddx = false;
 
-    xmlNodePtr dataEl = headerEl->next;
-    if (dataEl == NULL) return NULL;
+    if ((xml == NULL)||(*xml == '\0'))
+        return NULL;
 
-    while(dataEl->type == XML_TEXT_NODE)
-    {
-        if (dataEl->next == NULL) return NULL;
-        dataEl = dataEl->next;
-    }
+    if (!cfrds_buffer_create(&text))
+        return NULL;
 
-    if (dataEl->type != XML_ELEMENT_NODE) return NULL;
-    if (strcmp((const char *)dataEl->name, "data") != 0) return NULL;
+    size_t xml_len = strlen(xml);
 
-    struct WDDX *ret = wddx_create();
-    if (ret == NULL) return NULL;
+    WDDX *ret = wddx_create_sized(WDDX_ARENA_CAPACITY_FOR(xml_len));
+    if (ret == NULL)
+        return NULL;
 
-    if (headerEl->children) ret->header = wddx_from_xml_element(headerEl->children);
-    if (dataEl->children) ret->data   = wddx_from_xml_element(dataEl->children);
+    wddx_reader r = { xml, xml + xml_len, 0, false, text, ret->arena };
 
-    return ret;
-}
+    wddx_read_status status = wddx_read_packet(&r, ret, &is_wddx);
+    if ((status == WDDX_READ_OK)&&(is_wddx))
+        return ret;
+
+    wddx_cleanup(&ret);
 
+    if (status == WDDX_READ_UNSUPPORTED)
+        return wddx_from_xml_dom(xml);
+
+    return NULL;
+}
 
 static const struct WDDX_NODE *wddx_recursively_get(const struct WDDX_NODE *node, const char *path)
 {
@@ -658,15 +2119,9 @@ static const struct WDDX_NODE *wddx_recursively_get(const struct WDDX_NODE *node
     else
     {
         if (node->type != WDDX_STRUCT) return NULL;
-        for (int c = 0; c < node->cnt; c++)
-        {
-            const WDDX_STRUCT_NODE *item = node->items[c];
-            if (item != NULL && item->name != NULL && strcmp(item->name, seg) == 0)
-            {
-                target = item->value;
-                break;
-            }
-        }
+        const WDDX_STRUCT_NODE *item = wddx_struct_find(node, seg);
+        if (item != NULL)
+            target = item->value;
     }
 
     if (target == NULL || next == NULL)
@@ -862,6 +2317,156 @@ const WDDX_NODE *wddx_get_var(const void *src_ptr, const char *path)
     return wddx_recursively_get(src->data, path);
 }
 
+typedef struct {
+    const char *key;      ///< Struct key, NULL for an array index.
+    uint32_t hash;
+    long index;
+} wddx_path_segment;
+
+struct wddx_path {
+    size_t cnt;
+    wddx_path_segment segments[];
+};
+
+wddx_path *wddx_path_compile(const char *path)
+{
+    size_t cnt = 0;
+    size_t path_len = path ? strlen(path) : 0;
+
+    /* same segments as wddx_recursively_get: a trailing comma adds none, an empty one in between is the key "" */
+    for (const char *p = path; (p)&&(*p); )
+    {
+        const char *next = strchr(p, ',');
+        cnt++;
+        if (next == NULL)
+            break;
+        p = next + 1;
+    }
+
+    size_t malloc_size = offsetof(struct wddx_path, segments) + cnt * sizeof(wddx_path_segment) + path_len + 1;
+    struct wddx_path *ret = malloc(malloc_size);
+    if (ret == NULL)
+        return NULL;
+
+    explicit_bzero(ret, malloc_size);
+
+    char *keys = (char *)&ret->segments[cnt];
+    if (path_len > 0)
+        memcpy(keys, path, path_len);
+
+    for (char *seg = keys; ret->cnt < cnt; )
+    {
+        char *next = strchr(seg, ',');
+        if (next)
+            *next = '\0';
+
+        wddx_path_segment *segment = &ret->segments[ret->cnt++];
+        if (is_string_numeric(seg))
+        {
+            segment->index = strtol(seg, NULL, 10);
+        }
+        else
+        {
+            segment->key = seg;
+            segment->hash = wddx_key_hash(seg, strlen(seg));
+        }
+
+        if (next == NULL)
+            break;
+        seg = next + 1;
+    }
+
+    return ret;
+}
+
+void wddx_path_free(wddx_path *path)
+{
+    free(path);
+}
+
+void wddx_path_cleanup(wddx_path **path)
+{
+    if (path)
+    {
+        wddx_path_free(*path);
+        *path = NULL;
+    }
+}
+
+const wddx_path *wddx_path_static(wddx_path **slot, const char *path)
+{
+    wddx_path *ret = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+    if (ret)
+        return ret;
+
+    wddx_path *compiled = wddx_path_compile(path);
+    if (compiled == NULL)
+        return NULL;
+
+    /* another thread may have won the race, its path is used */
+    if (!__atomic_compare_exchange_n(slot, &ret, compiled, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+    {
+        wddx_path_free(compiled);
+        return ret;
+    }
+
+    return compiled;
+}
+
+const WDDX_NODE *wddx_get_var_compiled(const void *src_ptr, const wddx_path *path)
+{
+    const struct WDDX *src = src_ptr;
+    if ((src == NULL)||(path == NULL))
+        return NULL;
+
+    const struct WDDX_NODE *node = src->data;
+
+    for (size_t c = 0; (c < path->cnt)&&(node != NULL); c++)
+    {
+        const wddx_path_segment *segment = &path->segments[c];
+
+        if (segment->key == NULL)
+        {
+            if ((node->type != WDDX_ARRAY)||(segment->index >= node->cnt))
+                return NULL;
+            node = node->items[segment->index];
+        }
+        else
+        {
+            if (node->type != WDDX_STRUCT)
+                return NULL;
+            const WDDX_STRUCT_NODE *item = wddx_struct_find_hashed(node, segment->key, segment->hash);
+            node = item ? item->value : NULL;
+        }
+    }
+
+    return node;
+}
+
+const char *wddx_get_string_compiled(const void *src, const wddx_path *path)
+{
+    const struct WDDX_NODE *node = wddx_get_var_compiled(src, path);
+
+    if ((node == NULL)||(node->type != WDDX_STRING))
+        return NULL;
+
+    return node->string;
+}
+
+double wddx_get_number_compiled(const void *src, const wddx_path *path, bool *ok)
+{
+    const struct WDDX_NODE *node = wddx_get_var_compiled(src, path);
+
+    if ((node == NULL)||(node->type != WDDX_NUMBER))
+    {
+        if (ok) *ok = false;
+        return 0.;
+    }
+
+    if (ok) *ok = true;
+    return node->number;
+}
+
 static void wddx_node_recursively(xmlNodePtr xml, const struct WDDX_NODE *wddx)
 {
     xmlNodePtr new_node = NULL;
@@ -953,65 +2558,16 @@ static __attribute__((unused)) char *wddx_node_to_xml(const WDDX_NODE *node)
     return ret;
 }
 
-static void wddx_node_free(struct WDDX_NODE *value)
-{
-    if (value == NULL) return;
-
-    switch(value->type)
-    {
-    case WDDX_ARRAY:
-        for(int c = 0;c < value->cnt; c++)
-        {
-            struct WDDX_NODE *child = value->items[c];
-            wddx_node_free(child);
-            child = NULL;
-        }
-
-        break;
-    case WDDX_STRUCT:
-        for(int c = 0;c < value->cnt; c++)
-        {
-            WDDX_STRUCT_NODE *child = value->items[c];
-            if (child == NULL) continue;
-            free(child->name);
-            wddx_node_free(child->value);
-            child->name = NULL;
-            child->value = NULL;
-            free(child);
-            child = NULL;
-        }
-        break;
-    default:
-        break;
-    }
-
-    free(value);
-}
-
 void wddx_cleanup(void *value_ptr)
 {
     if (value_ptr && *(struct WDDX **)value_ptr)
     {
         struct WDDX **v = value_ptr;
-        if ((*v)->header)
-        {
-            wddx_node_free((*v)->header);
-            (*v)->header = NULL;
-        }
-
-        if ((*v)->data)
-        {
-            wddx_node_free((*v)->data);
-            (*v)->data = NULL;
-        }
 
-        if ((*v)->str)
-        {
-            xmlBufferFree((*v)->str);
-            (*v)->str = NULL;
-        }
+        cfrds_buffer_free((*v)->str);
 
-        free(*v);
+        /* the packet itself lives in its arena */
+        cfrds_arena_free((*v)->arena);
         *v = NULL;
     }
 }
@@ -0,0 +1,548 @@
+/*
+ * test_batch.c — Unit tests for the pipelined request batches in cfrds_batch.c.
+ *
+ * A minimal HTTP server on an ephemeral loopback port runs in a thread, because
+ * cfrds_batch_execute() blocks until every response has arrived. It can hold its
+ * answers until a number of requests has arrived on a connection, which only
+ * completes when the client really pipelines them, and it can close connections
+ * after a number of responses to exercise the retry path.
+ */
+
+#include <cfrds.h>
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+/* ── Minimal assert helper ─────────────────────────────────────────────── */
+
+#define PASS 0
+#define FAIL 1
+
+static int _failures = 0;
+
+#define CHECK(expr) \
+    do { \
+        if (!(expr)) { \
+            fprintf(stderr, "FAIL  %s:%d  %s\n", __func__, __LINE__, #expr); \
+            return FAIL; \
+        } \
+    } while (0)
+
+#define RUN(fn) \
+    do { \
+        int _r = fn(); \
+        if (_r == PASS) { \
+            printf("PASS  %s\n", #fn); \
+        } else { \
+            printf("FAIL  %s\n", #fn); \
+            _failures++; \
+        } \
+    } while (0)
+
+/* ── Loopback test server ──────────────────────────────────────────────── */
+
+#define TEST_MAX_CONNS 16
+#define TEST_MAX_QUEUE 256
+
+typedef struct {
+    int fd;
+    char data[64 * 1024];
+    size_t len;
+    unsigned long queue[TEST_MAX_QUEUE]; ///< File numbers of the requests received and not answered yet.
+    size_t queued;
+    size_t answered;
+    int idle;                            ///< Poll rounds spent waiting for `wait_for` requests.
+} test_conn;
+
+typedef struct {
+    int listener;
+    uint16_t port;
+    size_t wait_for;                     ///< Requests a connection must carry before any of them is answered.
+    size_t close_after;                  ///< Responses per connection before it is closed, 0 for never.
+    test_conn conns[TEST_MAX_CONNS];
+    size_t accepted;
+    size_t held;                         ///< Connections that had `wait_for` requests in before the first answer.
+    atomic_bool stop;
+    pthread_t thread;
+} test_server;
+
+static void test_conn_answer(test_server *srv, test_conn *conn)
+{
+    for (size_t c = 0; (c < conn->queued)&&(conn->fd >= 0); c++)
+    {
+        char body[128];
+        char response[256];
+        char data[32];
+        bool last = (srv->close_after)&&(conn->answered + 1 == srv->close_after);
+
+        if (conn->queue[c] == 0)
+        {
+            snprintf(body, sizeof(body), "-1:missing");
+        }
+        else
+        {
+            snprintf(data, sizeof(data), "file%lu", conn->queue[c]);
+            snprintf(body, sizeof(body), "3:%zu:%s19:2024-01-01 10:00:004:rw-r", strlen(data), data);
+        }
+
+        snprintf(response, sizeof(response), "HTTP/1.1 200 OK\r\nContent-Length: %zu\r\n%s\r\n%s",
+                 strlen(body), last ? "Connection: close\r\n" : "", body);
+        send(conn->fd, response, strlen(response), MSG_NOSIGNAL);
+        conn->answered++;
+
+        if (last)
+        {
+            close(conn->fd);
+            conn->fd = -1;
+        }
+    }
+
+    conn->queued = 0;
+}
+
+/* Moves every complete request in the connection buffer to its queue. */
+static void test_conn_parse(test_conn *conn)
+{
+    while (conn->queued < TEST_MAX_QUEUE)
+    {
+        conn->data[conn->len] = '\0';
+
+        const char *body = strstr(conn->data, "\r\n\r\n");
+        const char *length = strstr(conn->data, "Content-length: ");
+        if ((body == NULL)||(length == NULL))
+            return;
+
+        size_t end = (size_t)(body + 4 - conn->data) + strtoul(length + 16, NULL, 10);
+        if (conn->len < end)
+            return;
+
+        char saved = conn->data[end];
+        conn->data[end] = '\0';
+        const char *path = strstr(body, "/f");
+        conn->queue[conn->queued++] = path ? strtoul(path + 2, NULL, 10) : 0;
+        conn->data[end] = saved;
+
+        memmove(conn->data, conn->data + end, conn->len - end);
+        conn->len -= end;
+    }
+}
+
+static void *test_server_run(void *arg)
+{
+    test_server *srv = arg;
+
+    while (!atomic_load(&srv->stop))
+    {
+        struct pollfd pfds[TEST_MAX_CONNS + 1];
+        size_t cnt = 0;
+
+        pfds[cnt].fd = srv->listener;
+        pfds[cnt++].events = POLLIN;
+        for (size_t c = 0; c < srv->accepted; c++)
+        {
+            pfds[cnt].fd = srv->conns[c].fd;
+            pfds[cnt++].events = POLLIN;
+        }
+
+        if (poll(pfds, cnt, 10) < 0)
+            break;
+
+        int fd;
+        while ((srv->accepted < TEST_MAX_CONNS)&&((fd = accept(srv->listener, NULL, NULL)) >= 0))
+        {
+            test_conn *conn = &srv->conns[srv->accepted++];
+
+            memset(conn, 0, sizeof(*conn));
+            conn->fd = fd;
+        }
+
+        for (size_t c = 0; c < srv->accepted; c++)
+        {
+            test_conn *conn = &srv->conns[c];
+
+            if (conn->fd < 0)
+                continue;
+
+            ssize_t n = recv(conn->fd, conn->data + conn->len, sizeof(conn->data) - conn->len - 1, MSG_DONTWAIT);
+            if (n == 0)
+            {
+                close(conn->fd);
+                conn->fd = -1;
+                continue;
+            }
+
+            if (n > 0)
+            {
+                conn->len += (size_t)n;
+                test_conn_parse(conn);
+            }
+
+            if (conn->queued == 0)
+                continue;
+
+            /* hold the first answers until enough requests arrived, or give up after about a second */
+            if ((conn->answered == 0)&&(conn->queued < srv->wait_for)&&(conn->idle++ < 100))
+                continue;
+
+            if ((conn->answered == 0)&&(conn->queued >= srv->wait_for))
+                srv->held++;
+
+            test_conn_answer(srv, conn);
+        }
+    }
+
+    return NULL;
+}
+
+static bool test_server_start(test_server *srv, size_t wait_for, size_t close_after)
+{
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+
+    memset(srv, 0, sizeof(*srv));
+    srv->wait_for = wait_for;
+    srv->close_after = close_after;
+    atomic_init(&srv->stop, false);
+
+    srv->listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (srv->listener < 0)
+        return false;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+
+    if ((bind(srv->listener, (struct sockaddr *)&addr, sizeof(addr)) != 0)||
+        (listen(srv->listener, TEST_MAX_CONNS) != 0)||
+        (getsockname(srv->listener, (struct sockaddr *)&addr, &len) != 0)||
+        (fcntl(srv->listener, F_SETFL, O_NONBLOCK) != 0)||
+        (pthread_create(&srv->thread, NULL, test_server_run, srv) != 0))
+    {
+        close(srv->listener);
+        return false;
+    }
+
+    srv->port = ntohs(addr.sin_port);
+
+    return true;
+}
+
+static void test_server_stop(test_server *srv)
+{
+    atomic_store(&srv->stop, true);
+    pthread_join(srv->thread, NULL);
+
+    for (size_t c = 0; c < srv->accepted; c++)
+    {
+        if (srv->conns[c].fd >= 0)
+            close(srv->conns[c].fd);
+    }
+
+    close(srv->listener);
+}
+
+/* ── Helpers ───────────────────────────────────────────────────────────── */
+
+typedef struct {
+    int calls;
+    int ok;
+    int order;                           ///< File number of the last response, to check ordering.
+    bool in_order;
+    cfrds_status status;
+    char error[64];
+} test_result;
+
+typedef struct {
+    test_result *res;
+    int number;
+} test_request;
+
+static void on_file(cfrds_server *server, cfrds_status status, void *result, void *ctx)
+{
+    test_request *req = ctx;
+    test_result *res = req->res;
+    const char *error = cfrds_server_get_error(server);
+    char expected[32];
+
+    res->calls++;
+    res->status = status;
+    snprintf(res->error, sizeof(res->error), "%s", error ? error : "");
+    snprintf(expected, sizeof(expected), "file%d", req->number);
+
+    if ((status == CFRDS_STATUS_OK)&&(result)&&
+        (cfrds_file_content_get_size(result) == strlen(expected))&&
+        (memcmp(cfrds_file_content_get_data(result), expected, strlen(expected)) == 0))
+        res->ok++;
+
+    if (req->number < res->order)
+        res->in_order = false;
+    res->order = req->number;
+
+    cfrds_file_content_free(result);
+}
+
+static bool add_files(cfrds_batch *batch, test_request *reqs, test_result *res, int first, int cnt)
+{
+    for (int c = 0; c < cnt; c++)
+    {
+        char path[32];
+
+        reqs[c].res = res;
+        reqs[c].number = first + c;
+        snprintf(path, sizeof(path), "/f%d", first + c);
+
+        if (cfrds_batch_add_file_read(batch, path, on_file, &reqs[c]) != CFRDS_STATUS_OK)
+            return false;
+    }
+
+    return true;
+}
+
+/* ── Tests ─────────────────────────────────────────────────────────────── */
+
+static int test_requires_keepalive(void)
+{
+    cfrds_batch *batch = NULL;
+
+    cfrds_server_defer(server);
+    CHECK(cfrds_server_init(&server, "127.0.0.1", 80, "admin", "secret"));
+
+    CHECK(cfrds_batch_begin(NULL, 0, &batch) == CFRDS_STATUS_SERVER_IS_NULL);
+    CHECK(cfrds_batch_begin(server, 0, NULL) == CFRDS_STATUS_PARAM_IS_NULL);
+    CHECK(cfrds_batch_begin(server, 0, &batch) == CFRDS_STATUS_INVALID_INPUT_PARAMETER);
+    CHECK(batch == NULL);
+    CHECK(cfrds_server_get_error(server) != NULL);
+
+    CHECK(cfrds_batch_execute(NULL) == CFRDS_STATUS_PARAM_IS_NULL);
+    CHECK(cfrds_batch_count(NULL) == 0);
+
+    return PASS;
+}
+
+static int test_pipelined_in_order(void)
+{
+    test_server srv;
+    test_request reqs[50];
+    test_result res = { .in_order = true, };
+
+    /* the server answers nothing until all 50 requests are in */
+    CHECK(test_server_start(&srv, 50, 0));
+
+    cfrds_server_defer(server);
+    CHECK(cfrds_server_init(&server, "127.0.0.1", srv.port, "admin", "secret"));
+    CHECK(cfrds_server_set_keepalive(server, true, 0, 0));
+
+    cfrds_batch_defer(batch);
+    CHECK(cfrds_batch_begin(server, 1, &batch) == CFRDS_STATUS_OK);
+    CHECK(add_files(batch, reqs, &res, 1, 50));
+    CHECK(cfrds_batch_count(batch) == 50);
+
+    CHECK(cfrds_batch_execute(batch) == CFRDS_STATUS_OK);
+    CHECK(cfrds_batch_count(batch) == 0);
+    CHECK(res.calls == 50);
+    CHECK(res.ok == 50);
+    CHECK(res.in_order);
+
+    /* the connection went back to the pool and serves the next batch */
+    res.order = 0;
+    srv.wait_for = 0;
+    CHECK(add_files(batch, reqs, &res, 1, 5));
+    CHECK(cfrds_batch_execute(batch) == CFRDS_STATUS_OK);
+    CHECK(res.ok == 55);
+
+    test_server_stop(&srv);
+    CHECK(srv.accepted == 1);
+    CHECK(srv.held == 1);
+
+    return PASS;
+}
+
+static int test_several_connections(void)
+{
+    test_server srv;
+    test_request reqs[40];
+    test_result res = { .in_order = true, };
+
+    /* round robin over 4 connections puts 10 requests on each */
+    CHECK(test_server_start(&srv, 10, 0));
+
+    cfrds_server_defer(server);
+    CHECK(cfrds_server_init(&server, "127.0.0.1", srv.port, "admin", "secret"));
+    CHECK(cfrds_server_set_keepalive(server, true, 4, 0));
+
+    cfrds_batch_defer(batch);
+    CHECK(cfrds_batch_begin(server, 0, &batch) == CFRDS_STATUS_OK);
+    CHECK(add_files(batch, reqs, &res, 1, 40));
+
+    CHECK(cfrds_batch_execute(batch) == CFRDS_STATUS_OK);
+    CHECK(res.calls == 40);
+    CHECK(res.ok == 40);
+
+    test_server_stop(&srv);
+    CHECK(srv.accepted == 4);
+    CHECK(srv.held == 4);
+
+    return PASS;
+}
+
+static int test_connection_close_retry(void)
+{
+    test_server srv;
+    test_request reqs[10];
+    test_result res = { .in_order = true, };
+
+    /* every connection is closed after 3 responses, the rest is sent again */
+    CHECK(test_server_start(&srv, 0, 3));
+
+    cfrds_server_defer(server);
+    CHECK(cfrds_server_init(&server, "127.0.0.1", srv.port, "admin", "secret"));
+    CHECK(cfrds_server_set_keepalive(server, true, 0, 0));
+
+    cfrds_batch_defer(batch);
+    CHECK(cfrds_batch_begin(server, 1, &batch) == CFRDS_STATUS_OK);
+    CHECK(add_files(batch, reqs, &res, 1, 10));
+
+    cfrds_status status = cfrds_batch_execute(batch);
+    CHECK(res.calls == 10);
+
+    /* three connections answer 9 requests, the last one fails after its third attempt */
+    CHECK(res.ok == 9);
+    CHECK(res.in_order);
+    CHECK(status == CFRDS_STATUS_READING_FROM_SOCKET_FAILED);
+    CHECK(res.status == CFRDS_STATUS_READING_FROM_SOCKET_FAILED);
+
+    test_server_stop(&srv);
+    CHECK(srv.accepted == 3);
+
+    return PASS;
+}
+
+static void on_sql(cfrds_server *server, cfrds_status status, void *result, void *ctx)
+{
+    test_result *res = ctx;
+
+    (void)server;
+
+    res->calls++;
+    res->status = status;
+
+    cfrds_sql_resultset_free(result);
+}
+
+static int test_non_idempotent_not_retried(void)
+{
+    test_server srv;
+    test_request reqs[2];
+    test_result res = { .in_order = true, };
+    test_result sql = { 0 };
+
+    /* the connection is closed after the first response, the statement behind it is not sent again */
+    CHECK(test_server_start(&srv, 3, 1));
+
+    cfrds_server_defer(server);
+    CHECK(cfrds_server_init(&server, "127.0.0.1", srv.port, "admin", "secret"));
+    CHECK(cfrds_server_set_keepalive(server, true, 0, 0));
+
+    cfrds_batch_defer(batch);
+    CHECK(cfrds_batch_begin(server, 1, &batch) == CFRDS_STATUS_OK);
+    CHECK(add_files(batch, reqs, &res, 1, 1));
+    CHECK(cfrds_batch_add_sql_sqlstmnt(batch, "dsn", "DELETE FROM t", on_sql, &sql) == CFRDS_STATUS_OK);
+    CHECK(add_files(batch, reqs + 1, &res, 2, 1));
+
+    CHECK(cfrds_batch_execute(batch) != CFRDS_STATUS_OK);
+    CHECK(sql.calls == 1);
+    CHECK(sql.status != CFRDS_STATUS_OK);
+    CHECK(res.calls == 2);
+    CHECK(res.ok == 2);
+
+    test_server_stop(&srv);
+
+    /* only the file read went out again, on a second connection */
+    CHECK(srv.accepted == 2);
+    CHECK(srv.conns[1].answered == 1);
+
+    return PASS;
+}
+
+static int test_rds_error(void)
+{
+    test_server srv;
+    test_request reqs[3];
+    test_result res = { .in_order = true, };
+
+    CHECK(test_server_start(&srv, 0, 0));
+
+    cfrds_server_defer(server);
+    CHECK(cfrds_server_init(&server, "127.0.0.1", srv.port, "admin", "secret"));
+    CHECK(cfrds_server_set_keepalive(server, true, 0, 0));
+
+    cfrds_batch_defer(batch);
+    CHECK(cfrds_batch_begin(server, 1, &batch) == CFRDS_STATUS_OK);
+
+    /* file number 0 is answered with an RDS error, the requests after it are not affected */
+    CHECK(add_files(batch, reqs, &res, 0, 3));
+
+    CHECK(cfrds_batch_execute(batch) == CFRDS_STATUS_RESPONSE_ERROR);
+    CHECK(res.calls == 3);
+    CHECK(res.ok == 2);
+    CHECK(res.status == CFRDS_STATUS_OK);
+
+    test_server_stop(&srv);
+
+    return PASS;
+}
+
+static int test_connection_refused(void)
+{
+    test_server srv;
+    test_request reqs[3];
+    test_result res = { .in_order = true, };
+
+    /* grab a free port, then stop listening on it */
+    CHECK(test_server_start(&srv, 0, 0));
+    uint16_t port = srv.port;
+    test_server_stop(&srv);
+
+    cfrds_server_defer(server);
+    CHECK(cfrds_server_init(&server, "127.0.0.1", port, "admin", "secret"));
+    CHECK(cfrds_server_set_keepalive(server, true, 0, 0));
+
+    cfrds_batch_defer(batch);
+    CHECK(cfrds_batch_begin(server, 0, &batch) == CFRDS_STATUS_OK);
+    CHECK(add_files(batch, reqs, &res, 1, 3));
+
+    CHECK(cfrds_batch_execute(batch) != CFRDS_STATUS_OK);
+    CHECK(res.calls == 3);
+    CHECK(res.ok == 0);
+    CHECK(res.error[0] != '\0');
+
+    return PASS;
+}
+
+/* ── main ──────────────────────────────────────────────────────────────── */
+
+int main(void)
+{
+    RUN(test_requires_keepalive);
+    RUN(test_pipelined_in_order);
+    RUN(test_several_connections);
+    RUN(test_connection_close_retry);
+    RUN(test_non_idempotent_not_retried);
+    RUN(test_rds_error);
+    RUN(test_connection_refused);
+
+    printf("\n%d test(s) failed.\n", _failures);
+    return _failures ? 1 : 0;
+}
@@ -492,6 +492,106 @@ static int test_large_append(void)
     return PASS;
 }
 
+/* ── Tests: slice ──────────────────────────────────────────────────────── */
+
+static int test_slice(void)
+{
+    cfrds_buffer *buf = NULL;
+    CHECK(cfrds_buffer_create(&buf));
+    CHECK(cfrds_buffer_append(buf, "HTTP/1.1 200 OK\r\n\r\n3:abcXYZ"));
+
+    CHECK(cfrds_buffer_slice(buf, 19, 100) == false);
+    CHECK(cfrds_buffer_slice(buf, 100, 0) == false);
+    CHECK(cfrds_buffer_slice(buf, 19, 5));
+    CHECK(cfrds_buffer_data_size(buf) == 5);
+    CHECK(strcmp(cfrds_buffer_data(buf), "3:abc") == 0);
+
+    CHECK(cfrds_buffer_slice(buf, 5, 0));
+    CHECK(cfrds_buffer_data_size(buf) == 0);
+    CHECK(cfrds_buffer_data(buf)[0] == '\0');
+
+    CHECK(cfrds_buffer_slice(NULL, 0, 0) == false);
+
+    cfrds_buffer_free(buf);
+    return PASS;
+}
+
+/* ── Tests: spare / commit ─────────────────────────────────────────────── */
+
+static int test_spare_commit(void)
+{
+    cfrds_buffer *buf = NULL;
+    CHECK(cfrds_buffer_create(&buf));
+    CHECK(cfrds_buffer_append(buf, "1:"));
+
+    char *spare = cfrds_buffer_spare(buf, 100000);
+    CHECK(spare != NULL);
+    CHECK(spare == cfrds_buffer_data(buf) + 2);
+    CHECK(cfrds_buffer_data_size(buf) == 2);
+
+    memset(spare, 'x', 100000);
+    CHECK(cfrds_buffer_commit(buf, 3));
+    CHECK(cfrds_buffer_data_size(buf) == 5);
+    CHECK(strcmp(cfrds_buffer_data(buf), "1:xxx") == 0);
+
+    /* only reserved capacity can be committed */
+    CHECK(cfrds_buffer_commit(buf, SIZE_MAX) == false);
+    CHECK(cfrds_buffer_data_size(buf) == 5);
+
+    CHECK(cfrds_buffer_spare(NULL, 1) == NULL);
+    CHECK(cfrds_buffer_commit(NULL, 0) == false);
+
+    cfrds_buffer_free(buf);
+    return PASS;
+}
+
+/* ── Tests: spill to a mapped file ─────────────────────────────────────── */
+
+static int test_spill(void)
+{
+    cfrds_buffer *buf = NULL;
+    char chunk[1000];
+    CHECK(cfrds_buffer_create(&buf));
+    CHECK(cfrds_buffer_set_spill_threshold(buf, 4096));
+    CHECK(cfrds_buffer_set_spill_threshold(NULL, 4096) == false);
+
+    for (size_t i = 0; i < sizeof(chunk); i++)
+        chunk[i] = (char)('a' + (i % 26));
+
+    CHECK(cfrds_buffer_append_bytes(buf, chunk, sizeof(chunk)));
+    CHECK(!cfrds_buffer_spilled(buf));
+
+    /* the data moves to the file once it outgrows the threshold and keeps growing there */
+    for (int c = 1; c < 300; c++)
+        CHECK(cfrds_buffer_append_bytes(buf, chunk, sizeof(chunk)));
+    CHECK(cfrds_buffer_spilled(buf));
+    CHECK(cfrds_buffer_data_size(buf) == 300 * sizeof(chunk));
+    for (int c = 0; c < 300; c++)
+        CHECK(memcmp(cfrds_buffer_data(buf) + (c * sizeof(chunk)), chunk, sizeof(chunk)) == 0);
+    CHECK(cfrds_buffer_data(buf)[300 * sizeof(chunk)] == '\0');
+
+    char *spare = cfrds_buffer_spare(buf, 1000000);
+    CHECK(spare == cfrds_buffer_data(buf) + (300 * sizeof(chunk)));
+    memset(spare, 'x', 1000000);
+    CHECK(cfrds_buffer_commit(buf, 2));
+    CHECK(strcmp(cfrds_buffer_data(buf) + (300 * sizeof(chunk)), "xx") == 0);
+
+    CHECK(cfrds_buffer_slice(buf, 1, 3));
+    CHECK(strcmp(cfrds_buffer_data(buf), "bcd") == 0);
+    CHECK(cfrds_buffer_spilled(buf));
+
+    cfrds_buffer_free(buf);
+
+    /* a threshold of 0 keeps the data on the heap */
+    CHECK(cfrds_buffer_create(&buf));
+    CHECK(cfrds_buffer_reserve_above_size(buf, 1000000));
+    CHECK(!cfrds_buffer_spilled(buf));
+    CHECK(!cfrds_buffer_spilled(NULL));
+
+    cfrds_buffer_free(buf);
+    return PASS;
+}
+
 /* ── Tests: null-sentinel beyond data ──────────────────────────────────── */
 
 static int test_null_sentinel(void)
@@ -527,10 +627,10 @@ static int test_sql_key_parsers(void)
         struct cfrds_sql_primarykeys *pk = cfrds_buffer_to_sql_primarykeys(buf);
         CHECK(pk != NULL);
         CHECK(pk->cnt == 1);
-        CHECK(strcmp(pk->items[0].tableCatalog, "a") == 0);
-        CHECK(strcmp(pk->items[0].tableOwner, "b") == 0);
-        CHECK(strcmp(pk->items[0].tableName, "c") == 0);
-        CHECK(strcmp(pk->items[0].colName, "d") == 0);
+        CHECK(strcmp(pk->items[0].tableCatalog.str, "a") == 0);
+        CHECK(strcmp(pk->items[0].tableOwner.str, "b") == 0);
+        CHECK(strcmp(pk->items[0].tableName.str, "c") == 0);
+        CHECK(strcmp(pk->items[0].colName.str, "d") == 0);
         CHECK(pk->items[0].keySequence == 2);
         cfrds_sql_primarykeys_free(pk);
         cfrds_buffer_free(buf);
@@ -555,14 +655,14 @@ static int test_sql_key_parsers(void)
         struct cfrds_sql_foreignkeys *fk = cfrds_buffer_to_sql_foreignkeys(buf);
         CHECK(fk != NULL);
         CHECK(fk->cnt == 1);
-        CHECK(strcmp(fk->items[0].pkTableCatalog, "a") == 0);
-        CHECK(strcmp(fk->items[0].pkTableOwner, "b") == 0);
-        CHECK(strcmp(fk->items[0].pkTableName, "c") == 0);
-        CHECK(strcmp(fk->items[0].pkColName, "d") == 0);
-        CHECK(strcmp(fk->items[0].fkTableCatalog, "e") == 0);
-        CHECK(strcmp(fk->items[0].fkTableOwner, "f") == 0);
-        CHECK(strcmp(fk->items[0].fkTableName, "g") == 0);
-        CHECK(strcmp(fk->items[0].fkColName, "h") == 0);
+        CHECK(strcmp(fk->items[0].pkTableCatalog.str, "a") == 0);
+        CHECK(strcmp(fk->items[0].pkTableOwner.str, "b") == 0);
+        CHECK(strcmp(fk->items[0].pkTableName.str, "c") == 0);
+        CHECK(strcmp(fk->items[0].pkColName.str, "d") == 0);
+        CHECK(strcmp(fk->items[0].fkTableCatalog.str, "e") == 0);
+        CHECK(strcmp(fk->items[0].fkTableOwner.str, "f") == 0);
+        CHECK(strcmp(fk->items[0].fkTableName.str, "g") == 0);
+        CHECK(strcmp(fk->items[0].fkColName.str, "h") == 0);
         CHECK(fk->items[0].keySequence == 1);
         CHECK(fk->items[0].updateRule == 2);
         CHECK(fk->items[0].deleteRule == 3);
@@ -589,7 +689,7 @@ static int test_sql_key_parsers(void)
         struct cfrds_sql_importedkeys *ik = cfrds_buffer_to_sql_importedkeys(buf);
         CHECK(ik != NULL);
         CHECK(ik->cnt == 1);
-        CHECK(strcmp(ik->items[0].pkTableCatalog, "a") == 0);
+        CHECK(strcmp(ik->items[0].pkTableCatalog.str, "a") == 0);
         CHECK(ik->items[0].keySequence == 1);
         CHECK(ik->items[0].updateRule == 2);
         CHECK(ik->items[0].deleteRule == 3);
@@ -616,7 +716,7 @@ static int test_sql_key_parsers(void)
         struct cfrds_sql_exportedkeys *ek = cfrds_buffer_to_sql_exportedkeys(buf);
         CHECK(ek != NULL);
         CHECK(ek->cnt == 1);
-        CHECK(strcmp(ek->items[0].pkTableCatalog, "a") == 0);
+        CHECK(strcmp(ek->items[0].pkTableCatalog.str, "a") == 0);
         CHECK(ek->items[0].keySequence == 1);
         CHECK(ek->items[0].updateRule == 2);
         CHECK(ek->items[0].deleteRule == 3);
@@ -636,10 +736,10 @@ static int test_buffer_to_file_content(void)
         CHECK(cfrds_buffer_append(buf, "3:5:hello19:2026-07-22 05:00:009:read-only") == true);
         cfrds_file_content *fc = cfrds_buffer_to_file_content(buf);
         CHECK(fc != NULL);
-        CHECK(fc->size == 5);
-        CHECK(memcmp(fc->data, "hello", 5) == 0);
-        CHECK(strcmp(fc->modified, "2026-07-22 05:00:00") == 0);
-        CHECK(strcmp(fc->permission, "read-only") == 0);
+        CHECK(fc->data.len == 5);
+        CHECK(memcmp(fc->data.str, "hello", 5) == 0);
+        CHECK(strcmp(fc->modified.str, "2026-07-22 05:00:00") == 0);
+        CHECK(strcmp(fc->permission.str, "read-only") == 0);
         cfrds_file_content_free(fc);
         cfrds_buffer_free(buf);
     }
@@ -712,6 +812,277 @@ static int test_append_escaped(void)
     return PASS;
 }
 
+static int test_append_xml_escaped(void)
+{
+    static const struct {
+        const char *in;
+        bool attribute;
+        const char *out;
+    } cases[] = {
+        { "", false, "" },
+        { "plain text", false, "plain text" },
+        { "a<b>&c\r\n\t\"'", false, "a&lt;b&gt;&amp;c&#13;\n\t\"'" },
+        { "a<b>&c\r\n\t\"'", true, "a&lt;b&gt;&amp;c&#13;&#10;&#9;&quot;'" },
+        /* specials just before, at and after the 16 byte blocks */
+        { "0123456789abcde<", false, "0123456789abcde&lt;" },
+        { "0123456789abcdef<", false, "0123456789abcdef&lt;" },
+        { "0123456789abcdef0123456789abcdef&", false, "0123456789abcdef0123456789abcdef&amp;" },
+        { "caf\xC3\xA9 \xE2\x82\xAC", false, "caf\xC3\xA9 \xE2\x82\xAC" },
+        { "caf\xC3\xA9 \xE2\x82\xAC \xF0\x9F\x98\x80", true, "caf&#xE9; &#x20AC; &#x1F600;" },
+        /* not UTF-8: the byte is referenced, a last byte is kept */
+        { "\x80x\xEF\xBF\xBE.\xC3", true, "&#x80;x&#xEF;&#xBF;&#xBE;.\xC3" },
+    };
+
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++)
+    {
+        cfrds_buffer *buf = NULL;
+        CHECK(cfrds_buffer_create(&buf));
+
+        CHECK(cfrds_buffer_append_xml_escaped(buf, cases[c].in, cases[c].attribute));
+        size_t size = cfrds_buffer_data_size(buf);
+        bool same = (size == strlen(cases[c].out))&&((size == 0)||(memcmp(cfrds_buffer_data(buf), cases[c].out, size) == 0));
+
+        cfrds_buffer_free(buf);
+        CHECK(same);
+    }
+
+    CHECK(!cfrds_buffer_append_xml_escaped(NULL, "x", false));
+
+    return PASS;
+}
+
+/* ── Tests: arena ──────────────────────────────────────────────────────── */
+
+static int test_arena(void)
+{
+    cfrds_arena *arena = cfrds_arena_create(16);
+    CHECK(arena != NULL);
+
+    char *small = cfrds_arena_strndup(arena, "abc,def", 3);
+    CHECK(small != NULL);
+    CHECK(strcmp(small, "abc") == 0);
+
+    /* allocations stay aligned after odd-sized strings */
+    uint64_t *num = cfrds_arena_alloc(arena, sizeof(uint64_t));
+    CHECK(num != NULL);
+    CHECK(((uintptr_t)num % _Alignof(max_align_t)) == 0);
+    CHECK(*num == 0);
+
+    /* growing past the first chunk keeps earlier allocations valid */
+    char *big = cfrds_arena_alloc(arena, 100000);
+    CHECK(big != NULL);
+    memset(big, 'x', 100000);
+    CHECK(arena->chunk->next != NULL);
+    CHECK(strcmp(small, "abc") == 0);
+
+    CHECK(cfrds_arena_alloc(NULL, 1) == NULL);
+    CHECK(cfrds_arena_strndup(NULL, "a", 1) == NULL);
+    CHECK(cfrds_arena_strndup(arena, "a", SIZE_MAX) == NULL);
+
+    cfrds_arena_free(arena);
+    cfrds_arena_free(NULL);
+    return PASS;
+}
+
+static int test_sql_sqlstmnt_arena(void)
+{
+    cfrds_buffer *buf = NULL;
+    CHECK(cfrds_buffer_create(&buf) == true);
+    CHECK(cfrds_buffer_append(buf, "3:11:\"id\",\"name\"7:1,\"a,b\"4:2,cd") == true);
+
+    cfrds_sql_resultset *rs = cfrds_buffer_to_sql_sqlstmnt(buf);
+    CHECK(rs != NULL);
+    CHECK(rs->columns == 2);
+    CHECK(rs->rows == 2);
+    CHECK(strcmp(rs->values[0].str, "id") == 0);
+    CHECK(strcmp(rs->values[1].str, "name") == 0);
+    CHECK(strcmp(rs->values[3].str, "a,b") == 0);
+    CHECK(strcmp(rs->values[5].str, "cd") == 0);
+
+    /* the whole result fits the first chunk, sized from the response */
+    CHECK(rs->arena->chunk->next == NULL);
+
+    /* cells point into a copy, the response itself is left as it was */
+    CHECK(strcmp(cfrds_buffer_data(buf), "3:11:\"id\",\"name\"7:1,\"a,b\"4:2,cd") == 0);
+
+    cfrds_sql_resultset_free(rs);
+    cfrds_buffer_free(buf);
+    return PASS;
+}
+
+static int test_sql_sqlstmnt_wide(void)
+{
+    /* more columns than the parser keeps header views for */
+    for (int views = 0; views <= 1; views++)
+    {
+        char header[1024] = "";
+        char row[1024] = "";
+        char response[2112];
+
+        for (int c = 0; c < 100; c++)
+        {
+            char field[16];
+            snprintf(field, sizeof(field), "%s\"c%d\"", c ? "," : "", c);
+            strcat(header, field);
+            snprintf(field, sizeof(field), "%s%d", c ? "," : "", c);
+            strcat(row, field);
+        }
+        snprintf(response, sizeof(response), "2:%zu:%s%zu:%s", strlen(header), header, strlen(row), row);
+
+        cfrds_buffer *buf = NULL;
+        CHECK(cfrds_buffer_create(&buf) == true);
+        CHECK(cfrds_buffer_set_result_views(buf, views) == true);
+        CHECK(cfrds_buffer_append(buf, response) == true);
+
+        cfrds_sql_resultset *rs = cfrds_buffer_to_sql_sqlstmnt(buf);
+        CHECK(rs != NULL);
+        CHECK(rs->columns == 100);
+        CHECK(rs->rows == 1);
+        CHECK(strcmp(rs->values[0].str, "c0") == 0);
+        CHECK(strcmp(rs->values[63].str, "c63") == 0);
+        CHECK(strcmp(rs->values[64].str, "c64") == 0);
+        CHECK(rs->values[99].len == 3);
+        CHECK(strcmp(rs->values[99].str, "c99") == 0);
+        CHECK(strcmp(rs->values[100].str, "0") == 0);
+        CHECK(strcmp(rs->values[199].str, "99") == 0);
+        CHECK(rs->arena->chunk->next == NULL);
+
+        cfrds_sql_resultset_free(rs);
+        cfrds_buffer_free(buf);
+    }
+
+    /* a short row fails the whole result */
+    {
+        cfrds_buffer *buf = NULL;
+        CHECK(cfrds_buffer_create(&buf) == true);
+        CHECK(cfrds_buffer_append(buf, "2:7:\"a\",\"b\"1:1") == true);
+        CHECK(cfrds_buffer_to_sql_sqlstmnt(buf) == NULL);
+        cfrds_buffer_free(buf);
+    }
+
+    return PASS;
+}
+
+static int test_sql_resultset_columnar(void)
+{
+    cfrds_buffer *buf = NULL;
+    CHECK(cfrds_buffer_create(&buf) == true);
+    CHECK(cfrds_buffer_append(buf, "4:"
+        "28:\"id\",\"price\",\"active\",\"name\""
+        "12:1,2.5,1,\"ab\""
+        "11:,x,false,\"\""
+        "37:9223372036854775807,-1e3,\"NULL\",\"c,d\"") == true);
+    cfrds_sql_resultset *rs = cfrds_buffer_to_sql_sqlstmnt(buf);
+    CHECK(rs != NULL);
+    CHECK(rs->column_data == NULL);
+
+    CHECK(cfrds_buffer_slice(buf, 0, 0) == true);
+    CHECK(cfrds_buffer_append(buf, "4:"
+        "14:\"id\",\"INT\",\"4\""
+        "25:\"price\",\"MONEY\",\"DECIMAL\""
+        "19:\"active\",\"BIT\",\"-7\""
+        "21:\"name\",\"VARCHAR\",\"12\"") == true);
+    cfrds_sql_metadata *md = cfrds_buffer_to_sql_metadata(buf);
+    CHECK(md != NULL);
+
+    CHECK(cfrds_sql_resultset_make_columnar(rs, md) == true);
+    const cfrds_sql_column *col = rs->column_data;
+    CHECK(col != NULL);
+
+    CHECK(col[0].type == CFRDS_SQL_COLUMN_INT64);
+    CHECK(((int64_t *)col[0].values)[0] == 1);
+    CHECK(((int64_t *)col[0].values)[2] == INT64_MAX);
+    CHECK(!CFRDS_SQL_IS_NULL(col[0].nulls, 0));
+    CHECK(CFRDS_SQL_IS_NULL(col[0].nulls, 1));
+    CHECK(!CFRDS_SQL_IS_NULL(col[0].nulls, 2));
+
+    CHECK(col[1].type == CFRDS_SQL_COLUMN_DOUBLE);
+    CHECK(((double *)col[1].values)[0] == 2.5);
+    CHECK(((double *)col[1].values)[2] == -1000.0);
+    CHECK(CFRDS_SQL_IS_NULL(col[1].nulls, 1));
+
+    CHECK(col[2].type == CFRDS_SQL_COLUMN_BOOL);
+    CHECK(((bool *)col[2].values)[0] == true);
+    CHECK(((bool *)col[2].values)[1] == false);
+    CHECK(!CFRDS_SQL_IS_NULL(col[2].nulls, 1));
+    CHECK(CFRDS_SQL_IS_NULL(col[2].nulls, 2));
+
+    /* text: one heap per column, row r spans offsets[r]..offsets[r + 1] */
+    CHECK(col[3].type == CFRDS_SQL_COLUMN_TEXT);
+    CHECK(col[3].nulls == NULL);
+    CHECK(col[3].values == NULL);
+    CHECK(col[3].offsets[0] == 0);
+    CHECK(col[3].offsets[1] == 2);
+    CHECK(col[3].offsets[2] == 2);
+    CHECK(col[3].offsets[3] == 5);
+    CHECK(memcmp(col[3].heap, "abc,d", 5) == 0);
+    CHECK(memcmp(col[0].heap + col[0].offsets[2], "9223372036854775807", 19) == 0);
+
+    /* row-major values stay as they were */
+    CHECK(strcmp(rs->values[4 * 3 + 3].str, "c,d") == 0);
+
+    /* without metadata every column is text */
+    CHECK(cfrds_sql_resultset_make_columnar(rs, NULL) == true);
+    CHECK(rs->column_data[0].type == CFRDS_SQL_COLUMN_TEXT);
+    CHECK(rs->column_data[0].nulls == NULL);
+
+    CHECK(cfrds_sql_resultset_make_columnar(NULL, md) == false);
+    md->cnt = 3;
+    CHECK(cfrds_sql_resultset_make_columnar(rs, md) == false);
+
+    cfrds_sql_metadata_free(md);
+    cfrds_sql_resultset_free(rs);
+    cfrds_buffer_free(buf);
+    return PASS;
+}
+
+static int test_result_views(void)
+{
+    cfrds_buffer *buf = NULL;
+    CHECK(cfrds_buffer_create(&buf) == true);
+    CHECK(cfrds_buffer_set_result_views(buf, true) == true);
+    CHECK(cfrds_buffer_append(buf, "3:11:\"id\",\"name\"7:1,\"a,b\"4:2,cd") == true);
+    const char *response = cfrds_buffer_data(buf);
+
+    cfrds_sql_resultset *rs = cfrds_buffer_to_sql_sqlstmnt(buf);
+    CHECK(rs != NULL);
+    CHECK(rs->columns == 2);
+    CHECK(rs->rows == 2);
+    CHECK(strcmp(rs->values[0].str, "id") == 0);
+    CHECK(rs->values[0].len == 2);
+    CHECK(strcmp(rs->values[3].str, "a,b") == 0);
+    CHECK(rs->values[3].len == 3);
+    CHECK(strcmp(rs->values[4].str, "2") == 0);
+    CHECK(strcmp(rs->values[5].str, "cd") == 0);
+    CHECK(rs->values[5].len == 2);
+
+    /* strings point into the response, which now belongs to the result */
+    CHECK(rs->values[5].str == response + strlen("3:11:\"id\",\"name\"7:1,\"a,b\"4:2,"));
+    CHECK(cfrds_buffer_data_size(buf) == 0);
+    cfrds_sql_resultset_free(rs);
+
+    /* the emptied buffer takes the next response */
+    CHECK(cfrds_buffer_append(buf, "3:5:hello19:2026-07-22 05:00:009:read-only") == true);
+    cfrds_file_content *fc = cfrds_buffer_to_file_content(buf);
+    CHECK(fc != NULL);
+    CHECK(fc->data.len == 5);
+    CHECK(strcmp(fc->data.str, "hello") == 0);
+    CHECK(strcmp(fc->modified.str, "2026-07-22 05:00:00") == 0);
+    CHECK(fc->permission.len == 9);
+    CHECK(strcmp(fc->permission.str, "read-only") == 0);
+    cfrds_file_content_free(fc);
+
+    /* a failed parse keeps the response with the buffer */
+    CHECK(cfrds_buffer_append(buf, "3:5:hello") == true);
+    CHECK(cfrds_buffer_to_file_content(buf) == NULL);
+    CHECK(cfrds_buffer_data_size(buf) == 9);
+
+    CHECK(cfrds_buffer_set_result_views(NULL, true) == false);
+
+    cfrds_buffer_free(buf);
+    return PASS;
+}
+
 /* ── main ──────────────────────────────────────────────────────────────── */
 
 int main(void)
@@ -748,6 +1119,7 @@ int main(void)
 
     /* RDS helpers */
     RUN(test_append_escaped);
+    RUN(test_append_xml_escaped);
     RUN(test_append_rds_count);
     RUN(test_append_rds_string);
     RUN(test_append_rds_string_empty);
@@ -773,11 +1145,19 @@ int main(void)
     /* growth / sentinel / graphing */
     RUN(test_large_append);
     RUN(test_null_sentinel);
+    RUN(test_slice);
+    RUN(test_spare_commit);
+    RUN(test_spill);
     RUN(test_command_graphing_null_guards);
     RUN(test_sql_key_parsers);
     RUN(test_buffer_to_file_content);
     RUN(test_sql_sqlstmnt_cnt_zero);
     RUN(test_overflow_checks);
+    RUN(test_arena);
+    RUN(test_sql_sqlstmnt_arena);
+    RUN(test_sql_sqlstmnt_wide);
+    RUN(test_sql_resultset_columnar);
+    RUN(test_result_views);
 
 
     printf("\n%d test(s) failed.\n", _failures);
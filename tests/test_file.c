@@ -0,0 +1,254 @@
+/*
+ * test_file.c — Unit tests for the incremental FILEIO READ response parser in cfrds_file.c.
+ *
+ * Response bodies are embedded as string literals and fed to the parser either
+ * in one piece or one byte at a time, the way the HTTP layer delivers them.
+ * No network access is required.
+ */
+
+#include "../src/cfrds_file.c"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+/* ── Minimal assert helper ─────────────────────────────────────────────── */
+
+#define PASS 0
+#define FAIL 1
+
+static int _failures = 0;
+
+#define CHECK(expr) \
+    do { \
+        if (!(expr)) { \
+            fprintf(stderr, "FAIL  %s:%d  %s\n", __func__, __LINE__, #expr); \
+            return FAIL; \
+        } \
+    } while (0)
+
+#define RUN(fn) \
+    do { \
+        int _r = fn(); \
+        if (_r == PASS) { \
+            printf("PASS  %s\n", #fn); \
+        } else { \
+            printf("FAIL  %s\n", #fn); \
+            _failures++; \
+        } \
+    } while (0)
+
+/* ── Helpers ───────────────────────────────────────────────────────────── */
+
+static cfrds_status collect_data(void *ctx, const void *data, size_t size)
+{
+    if (!cfrds_buffer_append_bytes((cfrds_buffer *)ctx, data, size))
+        return CFRDS_STATUS_MEMORY_ERROR;
+
+    return CFRDS_STATUS_OK;
+}
+
+static cfrds_status abort_data(void *ctx, const void *data, size_t size)
+{
+    (void)ctx; (void)data; (void)size;
+
+    return CFRDS_STATUS_COMMAND_FAILED;
+}
+
+/* Feeds `response` in pieces of `step` bytes. */
+static cfrds_status feed_in_steps(cfrds_file_reader *reader, const char *response, size_t step)
+{
+    size_t len = strlen(response);
+
+    for (size_t pos = 0; pos < len; pos += step)
+    {
+        size_t piece = (len - pos < step) ? len - pos : step;
+
+        cfrds_status status = cfrds_file_reader_feed(reader, response + pos, piece);
+        if (status != CFRDS_STATUS_OK)
+            return status;
+    }
+
+    return CFRDS_STATUS_OK;
+}
+
+static void reader_init(cfrds_file_reader *reader, cfrds_buffer *head, cfrds_file_read_fn on_data, void *ctx)
+{
+    explicit_bzero(reader, sizeof(cfrds_file_reader));
+    reader->state = CFRDS_FILE_READER_HEAD;
+    reader->head = head;
+    reader->on_data = on_data;
+    reader->ctx = ctx;
+}
+
+/* ── Tests ─────────────────────────────────────────────────────────────── */
+
+static int test_file_contents(void)
+{
+    static const char response[] = "3:11:hello world19:2024-01-01 10:00:004:rw-r";
+
+    for (size_t step = 1; step <= sizeof(response); step++)
+    {
+        cfrds_buffer_defer(head);
+        cfrds_buffer_defer(data);
+        cfrds_file_reader reader;
+
+        CHECK(cfrds_buffer_create(&head));
+        CHECK(cfrds_buffer_create(&data));
+        reader_init(&reader, head, collect_data, data);
+
+        CHECK(feed_in_steps(&reader, response, step) == CFRDS_STATUS_OK);
+        CHECK(reader.state == CFRDS_FILE_READER_TAIL);
+        CHECK(reader.size == 11);
+        CHECK(cfrds_buffer_data_size(data) == 11);
+        CHECK(memcmp(cfrds_buffer_data(data), "hello world", 11) == 0);
+    }
+
+    return PASS;
+}
+
+/* The length prefix split over two pieces, the second one a full 64 KB read with file data. */
+static int test_split_prefix(void)
+{
+    enum { FILE_SIZE = 70000 };
+    static const char tail[] = "19:2024-01-01 10:00:004:rw-r";
+    char prefix[16];
+    cfrds_buffer_defer(head);
+    cfrds_buffer_defer(data);
+    cfrds_buffer_defer(response);
+    cfrds_file_reader reader;
+
+    CHECK(cfrds_buffer_create(&head));
+    CHECK(cfrds_buffer_create(&data));
+    CHECK(cfrds_buffer_create(&response));
+
+    snprintf(prefix, sizeof(prefix), "3:%d:", FILE_SIZE);
+    CHECK(cfrds_buffer_append(response, prefix));
+    for (int c = 0; c < FILE_SIZE; c++)
+        CHECK(cfrds_buffer_append_bytes(response, (const char[]){ (char)('a' + c % 26) }, 1));
+    CHECK(cfrds_buffer_append(response, tail));
+
+    const char *body = cfrds_buffer_data(response);
+    size_t body_size = cfrds_buffer_data_size(response);
+
+    reader_init(&reader, head, collect_data, data);
+    CHECK(cfrds_file_reader_feed(&reader, body, 3) == CFRDS_STATUS_OK);
+    CHECK(cfrds_file_reader_feed(&reader, body + 3, 65536) == CFRDS_STATUS_OK);
+    CHECK(cfrds_file_reader_feed(&reader, body + 3 + 65536, body_size - 3 - 65536) == CFRDS_STATUS_OK);
+
+    CHECK(reader.state == CFRDS_FILE_READER_TAIL);
+    CHECK(reader.size == FILE_SIZE);
+    CHECK(cfrds_buffer_data_size(data) == FILE_SIZE);
+    CHECK(memcmp(cfrds_buffer_data(data), body + strlen(prefix), FILE_SIZE) == 0);
+
+    return PASS;
+}
+
+static int test_empty_file(void)
+{
+    cfrds_buffer_defer(head);
+    cfrds_buffer_defer(data);
+    cfrds_file_reader reader;
+
+    CHECK(cfrds_buffer_create(&head));
+    CHECK(cfrds_buffer_create(&data));
+    reader_init(&reader, head, collect_data, data);
+
+    CHECK(feed_in_steps(&reader, "3:0:0:0:", 1) == CFRDS_STATUS_OK);
+    CHECK(reader.state == CFRDS_FILE_READER_TAIL);
+    CHECK(reader.size == 0);
+    CHECK(cfrds_buffer_data_size(data) == 0);
+
+    return PASS;
+}
+
+static int test_truncated(void)
+{
+    cfrds_buffer_defer(head);
+    cfrds_buffer_defer(data);
+    cfrds_file_reader reader;
+
+    CHECK(cfrds_buffer_create(&head));
+    CHECK(cfrds_buffer_create(&data));
+    reader_init(&reader, head, collect_data, data);
+
+    /* the caller reports anything that did not reach the tail */
+    CHECK(feed_in_steps(&reader, "3:11:hello", 4) == CFRDS_STATUS_OK);
+    CHECK(reader.state == CFRDS_FILE_READER_DATA);
+    CHECK(reader.remaining == 6);
+
+    return PASS;
+}
+
+static int test_server_error(void)
+{
+    cfrds_buffer_defer(head);
+    cfrds_buffer_defer(data);
+    cfrds_file_reader reader;
+
+    CHECK(cfrds_buffer_create(&head));
+    CHECK(cfrds_buffer_create(&data));
+    reader_init(&reader, head, collect_data, data);
+
+    CHECK(feed_in_steps(&reader, "-1:The system cannot find the file specified", 3) == CFRDS_STATUS_OK);
+    CHECK(reader.state == CFRDS_FILE_READER_SERVER_ERROR);
+    CHECK(cfrds_buffer_data_size(data) == 0);
+
+    cfrds_buffer_append_bytes(head, "", 1);
+    CHECK(strcmp(cfrds_buffer_data(head), "-1:The system cannot find the file specified") == 0);
+
+    return PASS;
+}
+
+static int test_malformed(void)
+{
+    static const char *responses[] = {
+        "2:5:hello",
+        "3:-5:hello",
+        "3:x:hello",
+    };
+
+    for (size_t c = 0; c < sizeof(responses) / sizeof(responses[0]); c++)
+    {
+        cfrds_buffer_defer(head);
+        cfrds_file_reader reader;
+
+        CHECK(cfrds_buffer_create(&head));
+        reader_init(&reader, head, abort_data, NULL);
+
+        CHECK(feed_in_steps(&reader, responses[c], 1) == CFRDS_STATUS_RESPONSE_ERROR);
+        CHECK(reader.error != NULL);
+    }
+
+    return PASS;
+}
+
+static int test_callback_abort(void)
+{
+    cfrds_buffer_defer(head);
+    cfrds_file_reader reader;
+
+    CHECK(cfrds_buffer_create(&head));
+    reader_init(&reader, head, abort_data, NULL);
+
+    CHECK(feed_in_steps(&reader, "3:5:hello0:0:", 64) == CFRDS_STATUS_COMMAND_FAILED);
+    CHECK(reader.error != NULL);
+
+    return PASS;
+}
+
+/* ── main ──────────────────────────────────────────────────────────────── */
+
+int main(void)
+{
+    RUN(test_file_contents);
+    RUN(test_split_prefix);
+    RUN(test_empty_file);
+    RUN(test_truncated);
+    RUN(test_server_error);
+    RUN(test_malformed);
+    RUN(test_callback_abort);
+
+    printf("\n%d test(s) failed.\n", _failures);
+    return _failures ? 1 : 0;
+}
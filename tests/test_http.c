@@ -0,0 +1,1071 @@
+/*
+ * test_http.c — Unit tests for the incremental HTTP response parser in cfrds_http.c.
+ *
+ * Responses are embedded as string literals and fed to the parser either in
+ * one piece or one byte at a time, the way a slow socket would deliver them.
+ * Request framing is checked over a local socket pair.
+ * No network access is required.
+ */
+
+#include "../src/cfrds_buffer.c"
+#include "../src/cfrds_http.c"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#endif
+
+#ifdef CFRDS_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+/* ── Minimal assert helper ─────────────────────────────────────────────── */
+
+#define PASS 0
+#define FAIL 1
+
+static int _failures = 0;
+
+#define CHECK(expr) \
+    do { \
+        if (!(expr)) { \
+            fprintf(stderr, "FAIL  %s:%d  %s\n", __func__, __LINE__, #expr); \
+            return FAIL; \
+        } \
+    } while (0)
+
+#define RUN(fn) \
+    do { \
+        int _r = fn(); \
+        if (_r == PASS) { \
+            printf("PASS  %s\n", #fn); \
+        } else { \
+            printf("FAIL  %s\n", #fn); \
+            _failures++; \
+        } \
+    } while (0)
+
+/* ── Helpers ───────────────────────────────────────────────────────────── */
+
+static cfrds_status collect_body(void *ctx, const char *data, size_t size)
+{
+    if (!cfrds_buffer_append_bytes((cfrds_buffer *)ctx, data, size))
+        return CFRDS_STATUS_MEMORY_ERROR;
+
+    return CFRDS_STATUS_OK;
+}
+
+/* Feeds `response` in pieces of `step` bytes, returns total bytes consumed. */
+static cfrds_status feed_in_steps(cfrds_http_parser *parser, const char *response, size_t step, size_t *total)
+{
+    size_t len = strlen(response);
+    size_t pos = 0;
+
+    while ((pos < len)&&(parser->state != CFRDS_HTTP_STATE_DONE))
+    {
+        size_t piece = (len - pos < step) ? len - pos : step;
+        size_t consumed = 0;
+
+        cfrds_status status = cfrds_http_parser_feed(parser, response + pos, piece, &consumed);
+        if (status != CFRDS_STATUS_OK)
+            return status;
+
+        pos += consumed;
+    }
+
+    *total = pos;
+
+    return CFRDS_STATUS_OK;
+}
+
+/* ── Tests ─────────────────────────────────────────────────────────────── */
+
+static int test_content_length(void)
+{
+    static const char response[] =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/html\r\n"
+        "content-length:  9 \r\n"
+        "\r\n"
+        "1:5:/opt/"
+        "HTTP/1.1 200 OK\r\n";
+
+    static const size_t steps[] = { 1, 7, SIZE_MAX };
+
+    for (size_t i = 0; i < sizeof(steps) / sizeof(steps[0]); i++)
+    {
+        size_t step = steps[i];
+
+        cfrds_buffer *body = NULL;
+        cfrds_http_parser parser;
+        size_t consumed = 0;
+
+        CHECK(cfrds_buffer_create(&body));
+        CHECK(cfrds_http_parser_init(&parser, collect_body, body));
+        CHECK(feed_in_steps(&parser, response, step, &consumed) == CFRDS_STATUS_OK);
+        CHECK(parser.state == CFRDS_HTTP_STATE_DONE);
+        CHECK(parser.status_code == 200);
+        CHECK(parser.keep_alive);
+        CHECK(parser.content_length == 9);
+        CHECK(consumed == strlen(response) - strlen("HTTP/1.1 200 OK\r\n"));
+        CHECK(cfrds_buffer_data_size(body) == 9);
+        CHECK(memcmp(cfrds_buffer_data(body), "1:5:/opt/", 9) == 0);
+
+        cfrds_http_parser_cleanup(&parser);
+        cfrds_buffer_free(body);
+    }
+
+    return PASS;
+}
+
+static int test_chunked(void)
+{
+    static const char response[] =
+        "HTTP/1.1 200 OK\r\n"
+        "Transfer-Encoding: gzip, Chunked\r\n"
+        "Content-Length: 1000\r\n"
+        "\r\n"
+        "4;name=value\r\n"
+        "1:5:\r\n"
+        "5\r\n"
+        "/opt/\r\n"
+        "0\r\n"
+        "X-Trailer: yes\r\n"
+        "\r\n";
+
+    static const size_t steps[] = { 1, 7, SIZE_MAX };
+
+    for (size_t i = 0; i < sizeof(steps) / sizeof(steps[0]); i++)
+    {
+        size_t step = steps[i];
+
+        cfrds_buffer *body = NULL;
+        cfrds_http_parser parser;
+        size_t consumed = 0;
+
+        CHECK(cfrds_buffer_create(&body));
+        CHECK(cfrds_http_parser_init(&parser, collect_body, body));
+        CHECK(feed_in_steps(&parser, response, step, &consumed) == CFRDS_STATUS_OK);
+        CHECK(parser.state == CFRDS_HTTP_STATE_DONE);
+        CHECK(parser.chunked);
+        CHECK(parser.content_length == -1);
+        CHECK(consumed == strlen(response));
+        CHECK(cfrds_buffer_data_size(body) == 9);
+        CHECK(memcmp(cfrds_buffer_data(body), "1:5:/opt/", 9) == 0);
+
+        cfrds_http_parser_cleanup(&parser);
+        cfrds_buffer_free(body);
+    }
+
+    return PASS;
+}
+
+static int test_chunked_invalid_size(void)
+{
+    cfrds_http_parser parser;
+    size_t consumed = 0;
+
+    CHECK(cfrds_http_parser_init(&parser, NULL, NULL));
+    CHECK(feed_in_steps(&parser, "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n", 3, &consumed) == CFRDS_STATUS_RESPONSE_ERROR);
+    CHECK(parser.error != NULL);
+    /* errors are sticky */
+    CHECK(cfrds_http_parser_feed(&parser, "0\r\n\r\n", 5, &consumed) == CFRDS_STATUS_RESPONSE_ERROR);
+    cfrds_http_parser_cleanup(&parser);
+
+    return PASS;
+}
+
+static int test_read_until_eof(void)
+{
+    cfrds_buffer *body = NULL;
+    cfrds_http_parser parser;
+    size_t consumed = 0;
+
+    CHECK(cfrds_buffer_create(&body));
+    CHECK(cfrds_http_parser_init(&parser, collect_body, body));
+    CHECK(feed_in_steps(&parser, "HTTP/1.0 200 OK\r\nConnection: keep-alive\r\n\r\n0:", 7, &consumed) == CFRDS_STATUS_OK);
+    CHECK(parser.state == CFRDS_HTTP_STATE_BODY_EOF);
+    CHECK(parser.keep_alive == false);
+    CHECK(cfrds_http_parser_finish(&parser) == CFRDS_STATUS_OK);
+    CHECK(parser.state == CFRDS_HTTP_STATE_DONE);
+    CHECK(strcmp(cfrds_buffer_data(body), "0:") == 0);
+
+    cfrds_http_parser_cleanup(&parser);
+    cfrds_buffer_free(body);
+
+    return PASS;
+}
+
+static int test_connection_flags(void)
+{
+    cfrds_http_parser parser;
+    size_t consumed = 0;
+
+    CHECK(cfrds_http_parser_init(&parser, NULL, NULL));
+    CHECK(feed_in_steps(&parser, "HTTP/1.0 200 OK\r\nConnection: Keep-Alive\r\nContent-Length: 0\r\n\r\n", 64, &consumed) == CFRDS_STATUS_OK);
+    CHECK(parser.state == CFRDS_HTTP_STATE_DONE);
+    CHECK(parser.keep_alive);
+    cfrds_http_parser_cleanup(&parser);
+
+    CHECK(cfrds_http_parser_init(&parser, NULL, NULL));
+    CHECK(feed_in_steps(&parser, "HTTP/1.1 200 OK\r\nConnection: close\r\nContent-Length: 0\r\n\r\n", 64, &consumed) == CFRDS_STATUS_OK);
+    CHECK(parser.state == CFRDS_HTTP_STATE_DONE);
+    CHECK(parser.keep_alive == false);
+    cfrds_http_parser_cleanup(&parser);
+
+    return PASS;
+}
+
+static int test_interim_response(void)
+{
+    cfrds_buffer *body = NULL;
+    cfrds_http_parser parser;
+    size_t consumed = 0;
+
+    CHECK(cfrds_buffer_create(&body));
+    CHECK(cfrds_http_parser_init(&parser, collect_body, body));
+    CHECK(feed_in_steps(&parser, "HTTP/1.1 100 Continue\r\n\r\nHTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\n0:", 5, &consumed) == CFRDS_STATUS_OK);
+    CHECK(parser.state == CFRDS_HTTP_STATE_DONE);
+    CHECK(parser.status_code == 200);
+    CHECK(strcmp(cfrds_buffer_data(body), "0:") == 0);
+
+    cfrds_http_parser_cleanup(&parser);
+    cfrds_buffer_free(body);
+
+    return PASS;
+}
+
+static int test_error_status_body_not_delivered(void)
+{
+    cfrds_buffer *body = NULL;
+    cfrds_http_parser parser;
+    size_t consumed = 0;
+
+    CHECK(cfrds_buffer_create(&body));
+    CHECK(cfrds_http_parser_init(&parser, collect_body, body));
+    CHECK(feed_in_steps(&parser, "HTTP/1.1 404 Not Found\r\nContent-Length: 9\r\n\r\nnot found", 64, &consumed) == CFRDS_STATUS_OK);
+    CHECK(parser.state == CFRDS_HTTP_STATE_DONE);
+    CHECK(parser.status_code == 404);
+    CHECK(cfrds_buffer_data_size(body) == 0);
+
+    cfrds_http_parser_cleanup(&parser);
+    cfrds_buffer_free(body);
+
+    return PASS;
+}
+
+static int test_malformed_responses(void)
+{
+    cfrds_http_parser parser;
+    size_t consumed = 0;
+
+    CHECK(cfrds_http_parser_init(&parser, NULL, NULL));
+    CHECK(feed_in_steps(&parser, "ICY 200 OK\r\n\r\n", 64, &consumed) == CFRDS_STATUS_RESPONSE_ERROR);
+    cfrds_http_parser_cleanup(&parser);
+
+    CHECK(cfrds_http_parser_init(&parser, NULL, NULL));
+    CHECK(feed_in_steps(&parser, "HTTP/1.1 200 OK\r\nContent-Length: 12x\r\n\r\n", 64, &consumed) == CFRDS_STATUS_RESPONSE_ERROR);
+    cfrds_http_parser_cleanup(&parser);
+
+    CHECK(cfrds_http_parser_init(&parser, NULL, NULL));
+    CHECK(feed_in_steps(&parser, "HTTP/1.1 200 OK\r\nContent-Length: 999999999999\r\n\r\n", 64, &consumed) == CFRDS_STATUS_RESPONSE_TOO_LARGE);
+    cfrds_http_parser_cleanup(&parser);
+
+    CHECK(cfrds_http_parser_init(&parser, NULL, NULL));
+    CHECK(cfrds_http_parser_finish(&parser) == CFRDS_STATUS_RESPONSE_ERROR);
+    cfrds_http_parser_cleanup(&parser);
+
+    CHECK(cfrds_http_parser_init(&parser, NULL, NULL));
+    CHECK(feed_in_steps(&parser, "HTTP/1.1 200 OK\r\nContent-Le", 64, &consumed) == CFRDS_STATUS_OK);
+    CHECK(cfrds_http_parser_finish(&parser) == CFRDS_STATUS_HTTP_RESPONSE_NOT_FOUND);
+    cfrds_http_parser_cleanup(&parser);
+
+    CHECK(cfrds_http_parser_init(&parser, NULL, NULL));
+    CHECK(feed_in_steps(&parser, "HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\n0:", 64, &consumed) == CFRDS_STATUS_OK);
+    CHECK(cfrds_http_parser_finish(&parser) == CFRDS_STATUS_READING_FROM_SOCKET_FAILED);
+    cfrds_http_parser_cleanup(&parser);
+
+    return PASS;
+}
+
+static int test_unsupported_encoding(void)
+{
+    cfrds_http_parser parser;
+    size_t consumed = 0;
+
+    CHECK(cfrds_http_parser_init(&parser, NULL, NULL));
+    CHECK(feed_in_steps(&parser, "HTTP/1.1 200 OK\r\nContent-Encoding: br\r\nContent-Length: 2\r\n\r\n0:", 64, &consumed) == CFRDS_STATUS_RESPONSE_ERROR);
+    cfrds_http_parser_cleanup(&parser);
+
+    return PASS;
+}
+
+#ifdef CFRDS_HAVE_ZLIB
+/* Builds "HTTP/1.1 200 OK" with `body` compressed using the given zlib window bits. */
+static cfrds_buffer *build_compressed_response(const char *encoding, int window_bits, const char *body, size_t body_size)
+{
+    cfrds_buffer *ret = NULL;
+    uint8_t compressed[4096];
+    char header[256];
+    z_stream zs;
+
+    memset(&zs, 0, sizeof(zs));
+    if (deflateInit2(&zs, Z_BEST_COMPRESSION, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return NULL;
+
+    zs.next_in = (Bytef *)body;
+    zs.avail_in = (uInt)body_size;
+    zs.next_out = compressed;
+    zs.avail_out = sizeof(compressed);
+    int res = deflate(&zs, Z_FINISH);
+    size_t compressed_size = sizeof(compressed) - zs.avail_out;
+    deflateEnd(&zs);
+    if (res != Z_STREAM_END)
+        return NULL;
+
+    snprintf(header, sizeof(header), "HTTP/1.1 200 OK\r\nContent-Encoding: %s\r\nContent-Length: %zu\r\n\r\n", encoding, compressed_size);
+
+    if ((!cfrds_buffer_create(&ret))||
+        (!cfrds_buffer_append(ret, header))||
+        (!cfrds_buffer_append_bytes(ret, compressed, compressed_size)))
+    {
+        cfrds_buffer_free(ret);
+        return NULL;
+    }
+
+    return ret;
+}
+
+static int test_compressed_bodies(void)
+{
+    static const struct {
+        const char *encoding;
+        int window_bits;
+    } variants[] = {
+        { "gzip", MAX_WBITS + 16 },
+        { "deflate", MAX_WBITS },
+        { "deflate", -MAX_WBITS },  /* raw deflate, as sent by some servers */
+    };
+    char body[3000];
+
+    for (size_t i = 0; i < sizeof(body); i++)
+        body[i] = "STR:12:/opt/coldfusion"[i % 22];
+
+    for (size_t v = 0; v < sizeof(variants) / sizeof(variants[0]); v++)
+    {
+        cfrds_buffer *response = build_compressed_response(variants[v].encoding, variants[v].window_bits, body, sizeof(body));
+        CHECK(response != NULL);
+
+        for (size_t step = 1; step <= 4096; step *= 64)
+        {
+            const char *data = cfrds_buffer_data(response);
+            size_t size = cfrds_buffer_data_size(response);
+            cfrds_buffer *decoded = NULL;
+            cfrds_http_parser parser;
+
+            CHECK(cfrds_buffer_create(&decoded));
+            CHECK(cfrds_http_parser_init(&parser, collect_body, decoded));
+
+            for (size_t pos = 0; pos < size; pos += step)
+            {
+                size_t piece = (size - pos < step) ? size - pos : step;
+                CHECK(cfrds_http_parser_feed(&parser, data + pos, piece, NULL) == CFRDS_STATUS_OK);
+            }
+
+            CHECK(parser.state == CFRDS_HTTP_STATE_DONE);
+            CHECK(parser.body_size == sizeof(body));
+            CHECK(cfrds_buffer_data_size(decoded) == sizeof(body));
+            CHECK(memcmp(cfrds_buffer_data(decoded), body, sizeof(body)) == 0);
+
+            cfrds_http_parser_cleanup(&parser);
+            cfrds_buffer_free(decoded);
+        }
+
+        cfrds_buffer_free(response);
+    }
+
+    return PASS;
+}
+
+static int test_compressed_truncated(void)
+{
+    static const char body[] = "1:STR:5:/opt/";
+    cfrds_buffer *decoded = NULL;
+    cfrds_http_parser parser;
+
+    cfrds_buffer *response = build_compressed_response("gzip", MAX_WBITS + 16, body, sizeof(body) - 1);
+    CHECK(response != NULL);
+
+    /* feed everything but the gzip trailer, then report end of input */
+    const char *data = cfrds_buffer_data(response);
+    const char *compressed = strstr(data, "\r\n\r\n") + 4;
+    size_t compressed_size = cfrds_buffer_data_size(response) - (size_t)(compressed - data);
+    static const char header[] = "HTTP/1.1 200 OK\r\nContent-Encoding: gzip\r\nConnection: close\r\n\r\n";
+
+    CHECK(cfrds_buffer_create(&decoded));
+    CHECK(cfrds_http_parser_init(&parser, collect_body, decoded));
+    CHECK(cfrds_http_parser_feed(&parser, header, strlen(header), NULL) == CFRDS_STATUS_OK);
+    CHECK(cfrds_http_parser_feed(&parser, compressed, compressed_size - 8, NULL) == CFRDS_STATUS_OK);
+    CHECK(cfrds_http_parser_finish(&parser) == CFRDS_STATUS_RESPONSE_ERROR);
+
+    cfrds_http_parser_cleanup(&parser);
+    cfrds_buffer_free(decoded);
+    cfrds_buffer_free(response);
+
+    return PASS;
+}
+#endif
+
+/* ── Requests ──────────────────────────────────────────────────────────── */
+
+static int test_build_header(void)
+{
+    cfrds_server_defer(server);
+    cfrds_buffer_defer(header);
+
+    CHECK(cfrds_server_init(&server, "example.com", 8500, "admin", "secret"));
+    CHECK(cfrds_buffer_create(&header));
+    CHECK(cfrds_http_build_header(server, "FILEIO", 1234, header) == CFRDS_STATUS_OK);
+
+    cfrds_buffer_append_char(header, '\0');
+    const char *str = cfrds_buffer_data(header);
+    const char *start = "POST /CFIDE/main/ide.cfm?CFSRV=IDE&ACTION=FILEIO HTTP/1.1\r\nHost: example.com:8500\r\n";
+    CHECK(strncmp(str, start, strlen(start)) == 0);
+    CHECK(strstr(str, "\r\nContent-length: 1234\r\n\r\n") != NULL);
+
+    /* the body is not part of the header block */
+    const char *end = strstr(str, "\r\n\r\n");
+    CHECK(end[4] == '\0');
+
+    return PASS;
+}
+
+#ifndef _WIN32
+static int test_send_segments(void)
+{
+    int fds[2];
+    char out[64] = {0, };
+    const cfrds_http_segment segs[] = {
+        { .data = "head|", .size = 5, .fd = -1 },
+        { .data = "", .size = 0, .fd = -1 },
+        { .data = "data|", .size = 5, .fd = -1 },
+        { .data = "tail", .size = 4, .fd = -1 },
+    };
+
+    CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+    /* whole chain in one call */
+    CHECK(cfrds_http_send_segments(fds[0], segs, 4, 0) == 14);
+    CHECK(recv(fds[1], out, sizeof(out), 0) == 14);
+    CHECK(memcmp(out, "head|data|tail", 14) == 0);
+
+    /* resume in the middle of a segment, as after a partial write */
+    CHECK(cfrds_http_send_segments(fds[0], segs, 4, 7) == 7);
+    CHECK(recv(fds[1], out, sizeof(out), 0) == 7);
+    CHECK(memcmp(out, "ta|tail", 7) == 0);
+
+    /* nothing left */
+    CHECK(cfrds_http_send_segments(fds[0], segs, 4, 14) == 0);
+
+    close(fds[0]);
+    close(fds[1]);
+
+    return PASS;
+}
+
+static int test_send_file_segment(void)
+{
+    int fds[2];
+    char out[64] = {0, };
+    char path[] = "/tmp/test_http_XXXXXX";
+
+    cfrds_server_defer(server);
+    CHECK(cfrds_server_init(&server, "127.0.0.1", 80, "admin", "secret"));
+
+    int fd = mkstemp(path);
+    CHECK(fd >= 0);
+    unlink(path);
+    CHECK(write(fd, "0123456789", 10) == 10);
+
+    CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+    /* memory, part of the file, memory */
+    const cfrds_http_segment segs[] = {
+        { .data = "STR:4:", .size = 6 },
+        { .data = NULL, .size = 4, .fd = fd, .file_offset = 3 },
+        { .data = "|end", .size = 4 },
+    };
+
+    size_t sent = 0;
+    CHECK(http_send_all(server, fds[0], segs, 3, UINT64_MAX, &sent) == CFRDS_STATUS_OK);
+    CHECK(sent == 14);
+    CHECK(recv(fds[1], out, sizeof(out), 0) == 14);
+    CHECK(memcmp(out, "STR:4:3456|end", 14) == 0);
+
+    /* file shorter than the announced length */
+    const cfrds_http_segment short_segs[] = {
+        { .data = NULL, .size = 20, .fd = fd, .file_offset = 0 },
+    };
+
+    CHECK(http_send_all(server, fds[0], short_segs, 1, UINT64_MAX, &sent) == CFRDS_STATUS_WRITING_TO_SOCKET_FAILED);
+    CHECK(sent == 10);
+
+    close(fds[0]);
+    close(fds[1]);
+    close(fd);
+
+    return PASS;
+}
+
+/* Body data past the headers is received into the response buffer, framing still goes through the parser. */
+static int test_receive_direct(void)
+{
+    static const char *responses[] = {
+        "HTTP/1.1 200 OK\r\nContent-Length: 100000\r\n\r\n",
+        "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n186a0\r\n",
+        "HTTP/1.0 200 OK\r\n\r\n",
+    };
+    static const char *trailers[] = { "", "\r\n0\r\n\r\n", "" };
+
+    char *payload = malloc(100000);
+    CHECK(payload != NULL);
+    for (size_t i = 0; i < 100000; i++)
+        payload[i] = (char)('a' + (i % 26));
+
+    for (size_t c = 0; c < sizeof(responses) / sizeof(responses[0]); c++)
+    {
+        int fds[2];
+        size_t received = 0;
+        bool reusable = false;
+        cfrds_http_parser parser;
+
+        cfrds_server_defer(server);
+        cfrds_buffer_defer(body);
+        CHECK(cfrds_server_init(&server, "127.0.0.1", 80, "admin", "secret"));
+        CHECK(cfrds_buffer_create(&body));
+        CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+        /* the kernel buffers the whole response, the connection close ends the last one */
+        int sndbuf = 1024 * 1024;
+        setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+        const cfrds_http_segment segs[] = {
+            { .data = responses[c], .size = strlen(responses[c]) },
+            { .data = payload, .size = 100000 },
+            { .data = trailers[c], .size = strlen(trailers[c]) },
+        };
+        CHECK(http_send_all(server, fds[0], segs, 3, UINT64_MAX, NULL) == CFRDS_STATUS_OK);
+        if (c == 2)
+            shutdown(fds[0], SHUT_WR);
+
+        CHECK(cfrds_http_parser_init(&parser, collect_body, body));
+        CHECK(http_receive_response(server, fds[1], &parser, body, UINT64_MAX, &received, NULL, &reusable) == CFRDS_STATUS_OK);
+        CHECK(parser.state == CFRDS_HTTP_STATE_DONE);
+        CHECK(parser.body_size == 100000);
+        CHECK(reusable == (c != 2));
+        CHECK(cfrds_buffer_data_size(body) == 100000);
+        CHECK(memcmp(cfrds_buffer_data(body), payload, 100000) == 0);
+        CHECK(cfrds_buffer_data(body)[100000] == '\0');
+
+        cfrds_http_parser_cleanup(&parser);
+        close(fds[0]);
+        close(fds[1]);
+    }
+
+    free(payload);
+
+    return PASS;
+}
+
+static int test_direct_window(void)
+{
+    cfrds_http_parser parser;
+    size_t consumed = 0;
+
+    CHECK(cfrds_http_parser_init(&parser, collect_body, NULL));
+    CHECK(cfrds_http_parser_direct_window(&parser) == 0);
+
+    CHECK(feed_in_steps(&parser, "HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\n", SIZE_MAX, &consumed) == CFRDS_STATUS_OK);
+    CHECK(cfrds_http_parser_direct_window(&parser) == 10);
+    CHECK(cfrds_http_parser_direct_commit(&parser, 4) == CFRDS_STATUS_OK);
+    CHECK(cfrds_http_parser_direct_window(&parser) == 6);
+    CHECK(cfrds_http_parser_direct_commit(&parser, 7) == CFRDS_STATUS_INVALID_INPUT_PARAMETER);
+    cfrds_http_parser_cleanup(&parser);
+
+    /* error bodies are never handed out */
+    CHECK(cfrds_http_parser_init(&parser, collect_body, NULL));
+    CHECK(feed_in_steps(&parser, "HTTP/1.1 500 Error\r\nContent-Length: 10\r\n\r\n", SIZE_MAX, &consumed) == CFRDS_STATUS_OK);
+    CHECK(cfrds_http_parser_direct_window(&parser) == 0);
+    cfrds_http_parser_cleanup(&parser);
+
+    /* the size limit still applies */
+    CHECK(cfrds_http_parser_init(&parser, collect_body, NULL));
+    parser.max_body_size = 8;
+    CHECK(feed_in_steps(&parser, "HTTP/1.0 200 OK\r\n\r\n", SIZE_MAX, &consumed) == CFRDS_STATUS_OK);
+    CHECK(cfrds_http_parser_direct_window(&parser) == UINT64_MAX);
+    CHECK(cfrds_http_parser_direct_commit(&parser, 8) == CFRDS_STATUS_OK);
+    CHECK(cfrds_http_parser_direct_commit(&parser, 1) == CFRDS_STATUS_RESPONSE_TOO_LARGE);
+    cfrds_http_parser_cleanup(&parser);
+
+    return PASS;
+}
+
+/* Listening IPv4 loopback socket on an ephemeral port. */
+static int test_response_limits(void)
+{
+    char *payload = malloc(150000);
+    CHECK(payload != NULL);
+    for (size_t i = 0; i < 150000; i++)
+        payload[i] = (char)('a' + (i % 26));
+
+    cfrds_server_defer(server);
+    CHECK(cfrds_server_init(&server, "127.0.0.1", 80, "admin", "secret"));
+    CHECK(server->max_response_size == CFRDS_MAX_RESPONSE_SIZE);
+    CHECK(server->spill_threshold == 0);
+    CHECK(!cfrds_server_set_response_limits(NULL, 0, 0));
+    CHECK(cfrds_server_set_response_limits(server, 1000000, 32768));
+    CHECK(server->max_response_size == 1000000);
+    CHECK(server->spill_threshold == 32768);
+
+    /* received in place into a spilled buffer, then refused past the limit */
+    for (int c = 0; c < 2; c++)
+    {
+        int fds[2];
+        size_t received = 0;
+        bool reusable = false;
+        cfrds_http_parser parser;
+
+        cfrds_buffer_defer(body);
+        CHECK(cfrds_buffer_create(&body));
+        CHECK(cfrds_buffer_set_spill_threshold(body, server->spill_threshold));
+        CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+        int sndbuf = 1024 * 1024;
+        setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+        const char *head = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n249f0\r\n";
+        const cfrds_http_segment segs[] = {
+            { .data = head, .size = strlen(head) },
+            { .data = payload, .size = 150000 },
+            { .data = "\r\n0\r\n\r\n", .size = 7 },
+        };
+        CHECK(http_send_all(server, fds[0], segs, 3, UINT64_MAX, NULL) == CFRDS_STATUS_OK);
+
+        CHECK(cfrds_http_parser_init(&parser, collect_body, body));
+        parser.max_body_size = (c == 0) ? server->max_response_size : 100000;
+        cfrds_status status = http_receive_response(server, fds[1], &parser, body, UINT64_MAX, &received, NULL, &reusable);
+        cfrds_http_parser_cleanup(&parser);
+        close(fds[0]);
+        close(fds[1]);
+
+        if (c == 0)
+        {
+            CHECK(status == CFRDS_STATUS_OK);
+            CHECK(cfrds_buffer_spilled(body));
+            CHECK(cfrds_buffer_data_size(body) == 150000);
+            CHECK(memcmp(cfrds_buffer_data(body), payload, 150000) == 0);
+            CHECK(cfrds_buffer_data(body)[150000] == '\0');
+        }
+        else
+        {
+            CHECK(status == CFRDS_STATUS_RESPONSE_TOO_LARGE);
+            CHECK(cfrds_buffer_data_size(body) <= 100000);
+        }
+    }
+
+    free(payload);
+
+    return PASS;
+}
+
+static int listen_loopback(uint16_t *port)
+{
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    socklen_t len = sizeof(addr);
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+
+    if ((bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)||(listen(fd, 16) != 0)||
+        (getsockname(fd, (struct sockaddr *)&addr, &len) != 0))
+    {
+        close(fd);
+        return -1;
+    }
+
+    *port = ntohs(addr.sin_port);
+
+    return fd;
+}
+
+static int test_dns_cache(void)
+{
+    cfrds_http_addrs *first = NULL;
+    cfrds_http_addrs *second = NULL;
+    bool cached = true;
+
+    cfrds_server_defer(server);
+    CHECK(cfrds_server_init(&server, "127.0.0.1", 80, "admin", "secret"));
+
+    CHECK(cfrds_http_resolve(server, &first, &cached) == CFRDS_STATUS_OK);
+    CHECK(cached == false);
+    CHECK(cfrds_http_resolve(server, &second, &cached) == CFRDS_STATUS_OK);
+    CHECK(cached == true);
+    CHECK(first == second);
+    CHECK(first->refs == 3);
+
+    /* a flushed entry stays valid for its holders */
+    cfrds_http_dns_flush(server);
+    CHECK(server->addrs == NULL);
+    CHECK(first->list->ai_family == AF_INET);
+    cfrds_http_addrs_release(first);
+    cfrds_http_addrs_release(second);
+
+    /* expired */
+    CHECK(cfrds_http_resolve(server, &first, NULL) == CFRDS_STATUS_OK);
+    server->addrs->resolved_at -= 30;
+    CHECK(cfrds_http_resolve(server, &second, &cached) == CFRDS_STATUS_OK);
+    CHECK(cached == false);
+    CHECK(first != second);
+    cfrds_http_addrs_release(first);
+    cfrds_http_addrs_release(second);
+
+    /* disabled */
+    CHECK(cfrds_server_set_dns_cache(server, 0));
+    CHECK(cfrds_http_resolve(server, &first, &cached) == CFRDS_STATUS_OK);
+    CHECK(cached == false);
+    CHECK(server->addrs == NULL);
+    cfrds_http_addrs_release(first);
+
+    return PASS;
+}
+
+static int test_happy_eyeballs(void)
+{
+    uint16_t port = 0;
+    int saved_errno = 0;
+    int listener = listen_loopback(&port);
+    CHECK(listener >= 0);
+
+    /* no listener on the IPv6 loopback port: that attempt fails and the IPv4 one wins */
+    struct sockaddr_in6 addr6 = { .sin6_family = AF_INET6, .sin6_addr = IN6ADDR_LOOPBACK_INIT, .sin6_port = htons(1) };
+    struct sockaddr_in addr4 = { .sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK), .sin_port = htons(port) };
+    struct addrinfo v4b = { .ai_family = AF_INET, .ai_socktype = SOCK_STREAM, .ai_addr = (struct sockaddr *)&addr4, .ai_addrlen = sizeof(addr4) };
+    struct addrinfo v4a = v4b;
+    struct addrinfo v6 = { .ai_family = AF_INET6, .ai_socktype = SOCK_STREAM, .ai_addr = (struct sockaddr *)&addr6, .ai_addrlen = sizeof(addr6) };
+
+    /* resolver order v6, v6, v4, v4 is tried as v6, v4, v6, v4 */
+    struct addrinfo v6b = v6;
+    v6.ai_next = &v6b;
+    v6b.ai_next = &v4a;
+    v4a.ai_next = &v4b;
+
+    const struct addrinfo *order[4];
+    CHECK(http_interleave_addrs(&v6, order, 4) == 4);
+    CHECK((order[0] == &v6)&&(order[1] == &v4a)&&(order[2] == &v6b)&&(order[3] == &v4b));
+    CHECK(http_interleave_addrs(&v6, order, 3) == 3);
+
+    cfrds_socket sockfd = http_connect_addrs(&v6, true, cfrds_http_now_ms() + 5000, &saved_errno);
+    CHECK(sockfd != CFRDS_INVALID_SOCKET);
+
+    struct sockaddr_storage peer;
+    socklen_t len = sizeof(peer);
+    CHECK(getpeername(sockfd, (struct sockaddr *)&peer, &len) == 0);
+    CHECK(peer.ss_family == AF_INET);
+    CHECK((fcntl(sockfd, F_GETFL, 0) & O_NONBLOCK) != 0);
+    cfrds_sock_cleanup(&sockfd);
+
+    /* sequentially the IPv6 addresses fail first */
+    sockfd = http_connect_addrs(&v6, false, cfrds_http_now_ms() + 5000, &saved_errno);
+    CHECK(sockfd != CFRDS_INVALID_SOCKET);
+    cfrds_sock_cleanup(&sockfd);
+
+    /* deadline already passed */
+    saved_errno = 0;
+    CHECK(http_connect_addrs(&v4a, false, cfrds_http_now_ms(), &saved_errno) == CFRDS_INVALID_SOCKET);
+    CHECK(saved_errno == ETIMEDOUT);
+
+    /* nothing listening at all */
+    v4a.ai_next = NULL;
+    addr4.sin_port = htons(1);
+    CHECK(http_connect_addrs(&v4a, true, cfrds_http_now_ms() + 5000, &saved_errno) == CFRDS_INVALID_SOCKET);
+    CHECK(saved_errno == ECONNREFUSED);
+
+    close(listener);
+
+    return PASS;
+}
+
+static int test_prewarm(void)
+{
+    uint16_t port = 0;
+    int listener = listen_loopback(&port);
+    CHECK(listener >= 0);
+
+    cfrds_server_defer(server);
+    CHECK(cfrds_server_init(&server, "127.0.0.1", port, "admin", "secret"));
+
+    CHECK(cfrds_server_prewarm(server, 2) == CFRDS_STATUS_INVALID_INPUT_PARAMETER);
+
+    CHECK(cfrds_server_set_keepalive(server, true, 3, 0));
+    CHECK(cfrds_server_prewarm(server, 2) == CFRDS_STATUS_OK);
+    CHECK(server->pool->cnt == 2);
+
+    /* limited by the pool size */
+    CHECK(cfrds_server_prewarm(server, 10) == CFRDS_STATUS_OK);
+    CHECK(server->pool->cnt == 3);
+
+    cfrds_socket sockfd = CFRDS_INVALID_SOCKET;
+    CHECK(cfrds_http_pool_acquire(server, &sockfd));
+    cfrds_sock_cleanup(&sockfd);
+
+    close(listener);
+
+    return PASS;
+}
+
+/* Posts to a server that accepts the connection (in the kernel backlog) but never answers. */
+static int test_timeouts(void)
+{
+    uint16_t port = 0;
+    int listener = listen_loopback(&port);
+    CHECK(listener >= 0);
+
+    cfrds_server_defer(server);
+    cfrds_buffer_defer(payload);
+    CHECK(cfrds_server_init(&server, "127.0.0.1", port, "admin", "secret"));
+    CHECK(cfrds_buffer_create(&payload));
+    CHECK(cfrds_buffer_append(payload, "1:3:abc"));
+
+    CHECK(!cfrds_server_set_timeouts(NULL, 0, 0, 0));
+    CHECK(cfrds_server_set_timeouts(server, 0, 0, 0));
+    CHECK(server->connect_timeout_ms == CFRDS_HTTP_CONNECT_TIMEOUT_MS);
+    CHECK(server->first_byte_timeout_ms == CFRDS_HTTP_FIRST_BYTE_TIMEOUT_MS);
+    CHECK(server->total_timeout_ms == CFRDS_HTTP_TOTAL_TIMEOUT_MS);
+
+    /* first byte */
+    CHECK(cfrds_server_set_timeouts(server, 0, 100, 0));
+    uint64_t start = cfrds_http_now_ms();
+    CHECK(cfrds_http_post(server, "FILEIO", payload, NULL) == CFRDS_STATUS_READING_FROM_SOCKET_FAILED);
+    uint64_t elapsed = cfrds_http_now_ms() - start;
+    CHECK((elapsed >= 100)&&(elapsed < 2000));
+    CHECK(strstr(cfrds_server_get_error(server), "first byte") != NULL);
+    CHECK(cfrds_server_error_ctx(server)->_errno == ETIMEDOUT);
+
+    /* the total deadline caps the first byte one */
+    CHECK(cfrds_server_set_timeouts(server, 0, 0, 150));
+    start = cfrds_http_now_ms();
+    CHECK(cfrds_http_post(server, "FILEIO", payload, NULL) == CFRDS_STATUS_READING_FROM_SOCKET_FAILED);
+    elapsed = cfrds_http_now_ms() - start;
+    CHECK((elapsed >= 150)&&(elapsed < 2000));
+    CHECK(strstr(cfrds_server_get_error(server), "overall") != NULL);
+
+    /* a timed out pooled connection is not retried */
+    CHECK(cfrds_server_set_keepalive(server, true, 1, 0));
+    CHECK(cfrds_server_prewarm(server, 1) == CFRDS_STATUS_OK);
+    CHECK(cfrds_server_set_timeouts(server, 0, 100, 0));
+    start = cfrds_http_now_ms();
+    CHECK(cfrds_http_post(server, "FILEIO", payload, NULL) == CFRDS_STATUS_READING_FROM_SOCKET_FAILED);
+    elapsed = cfrds_http_now_ms() - start;
+    CHECK((elapsed >= 100)&&(elapsed < 200));
+
+    close(listener);
+
+    return PASS;
+}
+
+/* Forks a peer that accepts one connection and closes it as soon as a request arrives. */
+static pid_t close_after_request(int listener)
+{
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        char buf[4096];
+        int fd = accept(listener, NULL, NULL);
+
+        if ((fd >= 0)&&(recv(fd, buf, sizeof(buf), 0) > 0))
+            close(fd);
+        _exit(0);
+    }
+
+    return pid;
+}
+
+/* A pooled connection dropped after the request was written is only replayed for idempotent commands. */
+static int test_stale_pooled_replay(void)
+{
+    uint16_t port = 0;
+    int listener = listen_loopback(&port);
+    CHECK(listener >= 0);
+
+    cfrds_server_defer(server);
+    CHECK(cfrds_server_init(&server, "127.0.0.1", port, "admin", "secret"));
+    CHECK(cfrds_server_set_keepalive(server, true, 1, 0));
+    CHECK(cfrds_server_set_timeouts(server, 0, 100, 0));
+
+    const cfrds_http_segment body[] = {
+        { .data = "1:3:abc", .size = 7, .fd = -1 },
+    };
+    struct pollfd pfd = { .fd = listener, .events = POLLIN };
+
+    CHECK(cfrds_server_prewarm(server, 1) == CFRDS_STATUS_OK);
+    pid_t pid = close_after_request(listener);
+    CHECK(pid > 0);
+    CHECK(cfrds_http_post_segments(server, "DBFUNCS", body, 1, false, NULL) != CFRDS_STATUS_OK);
+    CHECK(waitpid(pid, NULL, 0) == pid);
+    CHECK(poll(&pfd, 1, 0) == 0);
+
+    CHECK(cfrds_server_prewarm(server, 1) == CFRDS_STATUS_OK);
+    pid = close_after_request(listener);
+    CHECK(pid > 0);
+    CHECK(cfrds_http_post_segments(server, "DBFUNCS", body, 1, true, NULL) != CFRDS_STATUS_OK);
+    CHECK(waitpid(pid, NULL, 0) == pid);
+    CHECK(poll(&pfd, 1, 0) == 1);
+
+    close(listener);
+
+    return PASS;
+}
+
+/* Forks a peer that answers one request per connection with `responses` in turn, pausing `pause_ms` after the headers. */
+static pid_t serve_responses(int listener, const char *const responses[], size_t cnt, unsigned int pause_ms)
+{
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        /* do not outlive a failed test waiting for a connection that never comes */
+        alarm(5);
+        for (size_t c = 0; c < cnt; c++)
+        {
+            char buf[4096];
+            int fd = accept(listener, NULL, NULL);
+
+            if ((fd < 0)||(recv(fd, buf, sizeof(buf), 0) <= 0))
+                _exit(1);
+
+            const char *body = strstr(responses[c], "\r\n\r\n") + 4;
+            send(fd, responses[c], (size_t)(body - responses[c]), MSG_NOSIGNAL);
+            if (pause_ms)
+                usleep(pause_ms * 1000);
+            send(fd, body, strlen(body), MSG_NOSIGNAL);
+            close(fd);
+        }
+        _exit(0);
+    }
+
+    return pid;
+}
+
+/* Hedging waits for the first byte, so only the time up to it is sampled, not the whole response. */
+static int test_latency_first_byte(void)
+{
+    static const char *const responses[] = {
+        "HTTP/1.1 200 OK\r\nContent-Length: 7\r\n\r\n1:3:abc",
+    };
+    uint16_t port = 0;
+    int listener = listen_loopback(&port);
+    CHECK(listener >= 0);
+
+    cfrds_server_defer(server);
+    cfrds_buffer_defer(response);
+    CHECK(cfrds_server_init(&server, "127.0.0.1", port, "admin", "secret"));
+
+    const cfrds_http_segment body[] = {
+        { .data = "1:3:abc", .size = 7, .fd = -1 },
+    };
+
+    pid_t pid = serve_responses(listener, responses, 1, 300);
+    CHECK(pid > 0);
+    CHECK(cfrds_http_post_segments(server, "FILEIO", body, 1, true, &response) == CFRDS_STATUS_OK);
+    CHECK(waitpid(pid, NULL, 0) == pid);
+    CHECK(cfrds_buffer_data_size(response) == 7);
+    CHECK(server->latency_cnt == 1);
+    CHECK(server->latency[0] < 300);
+
+    close(listener);
+
+    return PASS;
+}
+
+/* An error body is consumed without reaching `on_body`, so a streamed request is still retried after it. */
+static int test_stream_retry_after_error_body(void)
+{
+    static const char *const responses[] = {
+        "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 4\r\n\r\nbusy",
+        "HTTP/1.1 200 OK\r\nContent-Length: 7\r\n\r\n1:3:abc",
+    };
+    uint16_t port = 0;
+    int listener = listen_loopback(&port);
+    CHECK(listener >= 0);
+
+    cfrds_server_defer(server);
+    cfrds_buffer_defer(response);
+    CHECK(cfrds_server_init(&server, "127.0.0.1", port, "admin", "secret"));
+    CHECK(cfrds_server_set_retry_policy(server, 2, 1, 1, 0));
+    CHECK(cfrds_buffer_create(&response));
+
+    const cfrds_http_segment body[] = {
+        { .data = "1:3:abc", .size = 7, .fd = -1 },
+    };
+
+    pid_t pid = serve_responses(listener, responses, 2, 0);
+    CHECK(pid > 0);
+    CHECK(cfrds_http_post_stream(server, "FILEIO", body, 1, UINT64_MAX, collect_body, response, true) == CFRDS_STATUS_OK);
+    CHECK(waitpid(pid, NULL, 0) == pid);
+    CHECK(cfrds_buffer_data_size(response) == 7);
+    CHECK(memcmp(cfrds_buffer_data(response), "1:3:abc", 7) == 0);
+
+    close(listener);
+
+    return PASS;
+}
+#endif
+
+/* ── main ──────────────────────────────────────────────────────────────── */
+
+int main(void)
+{
+    /* framing */
+    RUN(test_content_length);
+    RUN(test_chunked);
+    RUN(test_chunked_invalid_size);
+    RUN(test_read_until_eof);
+
+    /* headers */
+    RUN(test_connection_flags);
+    RUN(test_interim_response);
+    RUN(test_error_status_body_not_delivered);
+    RUN(test_malformed_responses);
+
+    /* content encoding */
+    RUN(test_unsupported_encoding);
+#ifdef CFRDS_HAVE_ZLIB
+    RUN(test_compressed_bodies);
+    RUN(test_compressed_truncated);
+#endif
+
+    /* requests */
+    RUN(test_build_header);
+#ifndef _WIN32
+    RUN(test_send_segments);
+    RUN(test_send_file_segment);
+    RUN(test_receive_direct);
+    RUN(test_direct_window);
+    RUN(test_response_limits);
+
+    /* connections */
+    RUN(test_dns_cache);
+    RUN(test_happy_eyeballs);
+    RUN(test_prewarm);
+    RUN(test_timeouts);
+    RUN(test_stale_pooled_replay);
+    RUN(test_latency_first_byte);
+    RUN(test_stream_retry_after_error_body);
+#endif
+
+    printf("\n%d test(s) failed.\n", _failures);
+    return _failures ? 1 : 0;
+}
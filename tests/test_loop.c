@@ -0,0 +1,425 @@
+/*
+ * test_loop.c — Unit tests for the asynchronous request engine in cfrds_loop.c.
+ *
+ * A minimal HTTP server listening on an ephemeral loopback port is driven from
+ * the same thread, between calls to cfrds_loop_run_once(), so the tests need
+ * no external server and stay deterministic.
+ */
+
+#include "../src/cfrds_loop.c"
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+/* ── Minimal assert helper ─────────────────────────────────────────────── */
+
+#define PASS 0
+#define FAIL 1
+
+static int _failures = 0;
+
+#define CHECK(expr) \
+    do { \
+        if (!(expr)) { \
+            fprintf(stderr, "FAIL  %s:%d  %s\n", __func__, __LINE__, #expr); \
+            return FAIL; \
+        } \
+    } while (0)
+
+#define RUN(fn) \
+    do { \
+        int _r = fn(); \
+        if (_r == PASS) { \
+            printf("PASS  %s\n", #fn); \
+        } else { \
+            printf("FAIL  %s\n", #fn); \
+            _failures++; \
+        } \
+    } while (0)
+
+/* ── Loopback test server ──────────────────────────────────────────────── */
+
+#define TEST_MAX_CONNS 64
+
+typedef struct {
+    int listener;
+    uint16_t port;
+    int conns[TEST_MAX_CONNS];
+    char requests[TEST_MAX_CONNS][2048];
+    size_t request_len[TEST_MAX_CONNS];
+    size_t accepted;
+    const char *response;
+    bool keep_open;
+} test_server;
+
+static bool test_server_start(test_server *srv, const char *response, bool keep_open)
+{
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+
+    memset(srv, 0, sizeof(*srv));
+    for (size_t c = 0; c < TEST_MAX_CONNS; c++)
+        srv->conns[c] = -1;
+    srv->response = response;
+    srv->keep_open = keep_open;
+
+    srv->listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (srv->listener < 0)
+        return false;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+
+    if ((bind(srv->listener, (struct sockaddr *)&addr, sizeof(addr)) != 0)||
+        (listen(srv->listener, TEST_MAX_CONNS) != 0)||
+        (getsockname(srv->listener, (struct sockaddr *)&addr, &len) != 0)||
+        (fcntl(srv->listener, F_SETFL, O_NONBLOCK) != 0))
+    {
+        close(srv->listener);
+        return false;
+    }
+
+    srv->port = ntohs(addr.sin_port);
+
+    return true;
+}
+
+static void test_server_stop(test_server *srv)
+{
+    for (size_t c = 0; c < TEST_MAX_CONNS; c++)
+    {
+        if (srv->conns[c] >= 0)
+            close(srv->conns[c]);
+    }
+
+    close(srv->listener);
+}
+
+/* Accepts new connections and answers every complete request. */
+static void test_server_step(test_server *srv)
+{
+    int fd;
+
+    while ((srv->accepted < TEST_MAX_CONNS)&&((fd = accept(srv->listener, NULL, NULL)) >= 0))
+    {
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+        srv->conns[srv->accepted++] = fd;
+    }
+
+    for (size_t c = 0; c < srv->accepted; c++)
+    {
+        if (srv->conns[c] < 0)
+            continue;
+
+        char *req = srv->requests[c];
+        ssize_t n = recv(srv->conns[c], req + srv->request_len[c], sizeof(srv->requests[c]) - srv->request_len[c] - 1, 0);
+        if (n <= 0)
+            continue;
+
+        srv->request_len[c] += (size_t)n;
+        req[srv->request_len[c]] = '\0';
+
+        const char *body = strstr(req, "\r\n\r\n");
+        const char *length = strstr(req, "Content-length: ");
+        if ((body == NULL)||(length == NULL))
+            continue;
+
+        if ((size_t)(req + srv->request_len[c] - body - 4) < strtoul(length + 16, NULL, 10))
+            continue;
+
+        send(srv->conns[c], srv->response, strlen(srv->response), MSG_NOSIGNAL);
+        srv->request_len[c] = 0;
+
+        if (!srv->keep_open)
+        {
+            close(srv->conns[c]);
+            srv->conns[c] = -1;
+        }
+    }
+}
+
+static bool drive(cfrds_loop *loop, test_server *srv)
+{
+    for (int c = 0; (c < 1000)&&(cfrds_loop_pending(loop) > 0); c++)
+    {
+        if (cfrds_loop_run_once(loop, 5) != CFRDS_STATUS_OK)
+            return false;
+
+        if (srv)
+            test_server_step(srv);
+    }
+
+    return cfrds_loop_pending(loop) == 0;
+}
+
+typedef struct {
+    int calls;
+    int ok;
+    cfrds_status status;
+    char error[64];
+} test_result;
+
+static void on_root_dir(cfrds_server *server, cfrds_status status, void *result, void *ctx)
+{
+    test_result *res = ctx;
+    const char *error = cfrds_server_get_error(server);
+
+    res->calls++;
+    res->status = status;
+    if ((status == CFRDS_STATUS_OK)&&(result)&&(strcmp(result, "/opt/") == 0))
+        res->ok++;
+    snprintf(res->error, sizeof(res->error), "%s", error ? error : "");
+
+    free(result);
+}
+
+static const char ROOT_DIR_RESPONSE[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Length: 9\r\n"
+    "\r\n"
+    "1:5:/opt/";
+
+/* ── Tests ─────────────────────────────────────────────────────────────── */
+
+static int test_concurrent_requests(void)
+{
+    test_server srv;
+    cfrds_server *servers[3] = {NULL, };
+    test_result res = {0, };
+
+    CHECK(test_server_start(&srv, ROOT_DIR_RESPONSE, false));
+
+    cfrds_loop_defer(loop);
+    CHECK(cfrds_loop_init(&loop));
+
+    for (int s = 0; s < 3; s++)
+    {
+        CHECK(cfrds_server_init(&servers[s], "127.0.0.1", srv.port, "admin", "secret"));
+
+        for (int c = 0; c < 5; c++)
+            CHECK(cfrds_loop_submit_file_get_root_dir(loop, servers[s], on_root_dir, &res) == CFRDS_STATUS_OK);
+    }
+
+    CHECK(cfrds_loop_pending(loop) == 15);
+    CHECK(drive(loop, &srv));
+    CHECK(res.calls == 15);
+    CHECK(res.ok == 15);
+    CHECK(srv.accepted == 15);
+
+    for (int s = 0; s < 3; s++)
+        cfrds_server_free(servers[s]);
+    test_server_stop(&srv);
+
+    return PASS;
+}
+
+static int test_keepalive_reuse(void)
+{
+    test_server srv;
+    test_result res = {0, };
+
+    CHECK(test_server_start(&srv, ROOT_DIR_RESPONSE, true));
+
+    cfrds_server_defer(server);
+    CHECK(cfrds_server_init(&server, "127.0.0.1", srv.port, "admin", "secret"));
+    CHECK(cfrds_server_set_keepalive(server, true, 0, 0));
+
+    cfrds_loop_defer(loop);
+    CHECK(cfrds_loop_init(&loop));
+
+    for (int c = 0; c < 3; c++)
+    {
+        CHECK(cfrds_loop_submit_file_get_root_dir(loop, server, on_root_dir, &res) == CFRDS_STATUS_OK);
+        CHECK(drive(loop, &srv));
+    }
+
+    CHECK(res.ok == 3);
+    CHECK(srv.accepted == 1);
+
+    cfrds_loop_cleanup(&loop);
+    cfrds_server_cleanup(&server);
+    test_server_stop(&srv);
+
+    return PASS;
+}
+
+static int test_rds_error(void)
+{
+    test_server srv;
+    test_result res = {0, };
+
+    CHECK(test_server_start(&srv, "HTTP/1.1 200 OK\r\nContent-Length: 7\r\n\r\n-1:boom", false));
+
+    cfrds_server_defer(server);
+    CHECK(cfrds_server_init(&server, "127.0.0.1", srv.port, "admin", "secret"));
+
+    cfrds_loop_defer(loop);
+    CHECK(cfrds_loop_init(&loop));
+
+    CHECK(cfrds_loop_submit_file_get_root_dir(loop, server, on_root_dir, &res) == CFRDS_STATUS_OK);
+    CHECK(drive(loop, &srv));
+    CHECK(res.calls == 1);
+    CHECK(res.status == CFRDS_STATUS_RESPONSE_ERROR);
+    CHECK(strcmp(res.error, "boom") == 0);
+
+    cfrds_loop_cleanup(&loop);
+    cfrds_server_cleanup(&server);
+    test_server_stop(&srv);
+
+    return PASS;
+}
+
+static int test_connection_refused(void)
+{
+    test_server srv;
+    test_result res = {0, };
+
+    /* grab a free port, then stop listening on it */
+    CHECK(test_server_start(&srv, ROOT_DIR_RESPONSE, false));
+    uint16_t port = srv.port;
+    test_server_stop(&srv);
+
+    cfrds_server_defer(server);
+    CHECK(cfrds_server_init(&server, "127.0.0.1", port, "admin", "secret"));
+
+    cfrds_loop_defer(loop);
+    CHECK(cfrds_loop_init(&loop));
+
+    cfrds_status status = cfrds_loop_submit_file_get_root_dir(loop, server, on_root_dir, &res);
+    if (status == CFRDS_STATUS_OK)
+    {
+        CHECK(drive(loop, NULL));
+        CHECK(res.calls == 1);
+        status = res.status;
+    }
+    else
+    {
+        CHECK(res.calls == 0);
+    }
+
+    CHECK(status == CFRDS_STATUS_CONNECTION_TO_SERVER_FAILED);
+
+    cfrds_loop_cleanup(&loop);
+    cfrds_server_cleanup(&server);
+
+    return PASS;
+}
+
+static int test_free_cancels_pending(void)
+{
+    test_server srv;
+    test_result res = {0, };
+
+    CHECK(test_server_start(&srv, ROOT_DIR_RESPONSE, false));
+
+    cfrds_server_defer(server);
+    CHECK(cfrds_server_init(&server, "127.0.0.1", srv.port, "admin", "secret"));
+
+    cfrds_loop *loop = NULL;
+    CHECK(cfrds_loop_init(&loop));
+
+    CHECK(cfrds_loop_submit_file_get_root_dir(loop, server, on_root_dir, &res) == CFRDS_STATUS_OK);
+    CHECK(cfrds_loop_submit_file_get_root_dir(loop, server, on_root_dir, &res) == CFRDS_STATUS_OK);
+
+    cfrds_loop_free(loop);
+    CHECK(res.calls == 2);
+    CHECK(res.status == CFRDS_STATUS_COMMAND_FAILED);
+
+    cfrds_server_cleanup(&server);
+    test_server_stop(&srv);
+
+    return PASS;
+}
+
+static int test_free_stalled_request(void)
+{
+    test_server srv;
+    test_result res = {0, };
+
+    /* the server accepts the connection but never answers */
+    CHECK(test_server_start(&srv, ROOT_DIR_RESPONSE, true));
+
+    cfrds_server_defer(server);
+    CHECK(cfrds_server_init(&server, "127.0.0.1", srv.port, "admin", "secret"));
+
+    cfrds_loop *loop = NULL;
+    CHECK(cfrds_loop_init(&loop));
+
+    CHECK(cfrds_loop_submit_file_get_root_dir(loop, server, on_root_dir, &res) == CFRDS_STATUS_OK);
+    for (int c = 0; (c < 1000)&&(loop->head->state != CFRDS_LOOP_REQUEST_RECEIVING); c++)
+        CHECK(cfrds_loop_run_once(loop, 5) == CFRDS_STATUS_OK);
+    CHECK(loop->head->state == CFRDS_LOOP_REQUEST_RECEIVING);
+
+#ifdef CFRDS_HAVE_IO_URING
+    /* leave no room in the SQ for the cancel of the pending recv */
+    if (loop->use_uring)
+        loop->ring.sq_entries = 0;
+#endif
+
+    cfrds_loop_free(loop);
+    CHECK(res.calls == 1);
+    CHECK(res.status == CFRDS_STATUS_COMMAND_FAILED);
+
+    cfrds_server_cleanup(&server);
+    test_server_stop(&srv);
+
+    return PASS;
+}
+
+static int test_backend(void)
+{
+    cfrds_loop_defer(loop);
+    CHECK(cfrds_loop_init(&loop));
+
+    const char *backend = cfrds_loop_get_backend(loop);
+    CHECK(backend != NULL);
+    CHECK((strcmp(backend, "io_uring") == 0)||(strcmp(backend, "epoll") == 0)||(strcmp(backend, "poll") == 0));
+    CHECK(cfrds_loop_get_backend(NULL) == NULL);
+
+    printf("INFO  loop backend: %s\n", backend);
+
+    return PASS;
+}
+
+static int test_invalid_params(void)
+{
+    cfrds_server_defer(server);
+    CHECK(cfrds_server_init(&server, "127.0.0.1", 80, "admin", "secret"));
+
+    cfrds_loop_defer(loop);
+    CHECK(cfrds_loop_init(&loop));
+
+    CHECK(cfrds_loop_submit_file_get_root_dir(NULL, server, on_root_dir, NULL) == CFRDS_STATUS_PARAM_IS_NULL);
+    CHECK(cfrds_loop_submit_file_get_root_dir(loop, server, NULL, NULL) == CFRDS_STATUS_PARAM_IS_NULL);
+    CHECK(cfrds_loop_submit_browse_dir(loop, server, NULL, on_root_dir, NULL) == CFRDS_STATUS_PARAM_IS_NULL);
+    CHECK(cfrds_loop_pending(loop) == 0);
+    CHECK(cfrds_loop_run(loop) == CFRDS_STATUS_OK);
+    CHECK(cfrds_loop_run(NULL) == CFRDS_STATUS_PARAM_IS_NULL);
+
+    return PASS;
+}
+
+int main(void)
+{
+    RUN(test_concurrent_requests);
+    RUN(test_keepalive_reuse);
+    RUN(test_rds_error);
+    RUN(test_connection_refused);
+    RUN(test_free_cancels_pending);
+    RUN(test_free_stalled_request);
+    RUN(test_invalid_params);
+    RUN(test_backend);
+
+    printf("\n%d test(s) failed.\n", _failures);
+    return _failures ? 1 : 0;
+}
@@ -0,0 +1,414 @@
+/*
+ * test_retry.c — Unit tests for the retry policy and request hedging of idempotent commands.
+ *
+ * A minimal HTTP server on an ephemeral loopback port runs in a thread, because
+ * the commands block until they are answered. Each accepted connection follows
+ * one step of a script: answer, stall without answering, close without
+ * answering, or answer with a 503, so every recovery path can be driven.
+ */
+
+#include <cfrds.h>
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+/* ── Minimal assert helper ─────────────────────────────────────────────── */
+
+#define PASS 0
+#define FAIL 1
+
+static int _failures = 0;
+
+#define CHECK(expr) \
+    do { \
+        if (!(expr)) { \
+            fprintf(stderr, "FAIL  %s:%d  %s\n", __func__, __LINE__, #expr); \
+            return FAIL; \
+        } \
+    } while (0)
+
+#define RUN(fn) \
+    do { \
+        int _r = fn(); \
+        if (_r == PASS) { \
+            printf("PASS  %s\n", #fn); \
+        } else { \
+            printf("FAIL  %s\n", #fn); \
+            _failures++; \
+        } \
+    } while (0)
+
+/* ── Loopback test server ──────────────────────────────────────────────── */
+
+#define TEST_MAX_CONNS 64
+
+typedef struct {
+    int fd;
+    char action;
+    char data[4096];
+    size_t len;
+    bool handled;
+} test_conn;
+
+typedef struct {
+    int listener;
+    uint16_t port;
+    const char *script;                  ///< Action of each accepted connection, 'a' past its end.
+    test_conn conns[TEST_MAX_CONNS];
+    atomic_size_t accepted;
+    atomic_bool stop;
+    pthread_t thread;
+} test_server;
+
+static void test_conn_handle(test_conn *conn)
+{
+    static const char body[] = "3:11:hello world19:2024-01-01 10:00:004:rw-r";
+    char response[256];
+
+    conn->data[conn->len] = '\0';
+
+    const char *end = strstr(conn->data, "\r\n\r\n");
+    const char *length = strstr(conn->data, "Content-length: ");
+    if ((end == NULL)||(length == NULL)||(conn->len < (size_t)(end + 4 - conn->data) + strtoul(length + 16, NULL, 10)))
+        return;
+
+    conn->handled = true;
+
+    switch (conn->action)
+    {
+    case 's':
+        return;
+    case '5':
+        snprintf(response, sizeof(response), "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+        break;
+    case 'a':
+        snprintf(response, sizeof(response), "HTTP/1.1 200 OK\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n%s", strlen(body), body);
+        break;
+    default:
+        response[0] = '\0';
+        break;
+    }
+
+    send(conn->fd, response, strlen(response), MSG_NOSIGNAL);
+    close(conn->fd);
+    conn->fd = -1;
+}
+
+static void *test_server_run(void *arg)
+{
+    test_server *srv = arg;
+
+    while (!atomic_load(&srv->stop))
+    {
+        struct pollfd pfds[TEST_MAX_CONNS + 1];
+        size_t accepted = atomic_load(&srv->accepted);
+        size_t cnt = 0;
+
+        pfds[cnt].fd = srv->listener;
+        pfds[cnt++].events = POLLIN;
+        for (size_t c = 0; c < accepted; c++)
+        {
+            pfds[cnt].fd = srv->conns[c].fd;
+            pfds[cnt++].events = POLLIN;
+        }
+
+        if (poll(pfds, cnt, 10) < 0)
+            break;
+
+        int fd;
+        while ((accepted < TEST_MAX_CONNS)&&((fd = accept(srv->listener, NULL, NULL)) >= 0))
+        {
+            test_conn *conn = &srv->conns[accepted];
+            size_t len = strlen(srv->script);
+
+            memset(conn, 0, sizeof(*conn));
+            conn->fd = fd;
+            conn->action = (accepted < len) ? srv->script[accepted] : 'a';
+            atomic_store(&srv->accepted, ++accepted);
+        }
+
+        for (size_t c = 0; c < accepted; c++)
+        {
+            test_conn *conn = &srv->conns[c];
+
+            if ((conn->fd < 0)||(conn->handled))
+                continue;
+
+            ssize_t n = recv(conn->fd, conn->data + conn->len, sizeof(conn->data) - conn->len - 1, MSG_DONTWAIT);
+            if (n == 0)
+            {
+                close(conn->fd);
+                conn->fd = -1;
+                continue;
+            }
+
+            if (n > 0)
+            {
+                conn->len += (size_t)n;
+                test_conn_handle(conn);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+static bool test_server_start(test_server *srv, const char *script)
+{
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+
+    memset(srv, 0, sizeof(*srv));
+    srv->script = script;
+    atomic_init(&srv->accepted, 0);
+    atomic_init(&srv->stop, false);
+
+    srv->listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (srv->listener < 0)
+        return false;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+
+    if ((bind(srv->listener, (struct sockaddr *)&addr, sizeof(addr)) != 0)||
+        (listen(srv->listener, TEST_MAX_CONNS) != 0)||
+        (getsockname(srv->listener, (struct sockaddr *)&addr, &len) != 0)||
+        (fcntl(srv->listener, F_SETFL, O_NONBLOCK) != 0)||
+        (pthread_create(&srv->thread, NULL, test_server_run, srv) != 0))
+    {
+        close(srv->listener);
+        return false;
+    }
+
+    srv->port = ntohs(addr.sin_port);
+
+    return true;
+}
+
+static void test_server_stop(test_server *srv)
+{
+    atomic_store(&srv->stop, true);
+    pthread_join(srv->thread, NULL);
+
+    for (size_t c = 0; c < atomic_load(&srv->accepted); c++)
+    {
+        if (srv->conns[c].fd >= 0)
+            close(srv->conns[c].fd);
+    }
+
+    close(srv->listener);
+}
+
+/* ── Helpers ───────────────────────────────────────────────────────────── */
+
+static uint64_t now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000) + ((uint64_t)ts.tv_nsec / 1000000);
+}
+
+/* Reads a file and checks its contents, returns the command status. */
+static cfrds_status read_file(cfrds_server *server)
+{
+    cfrds_file_content_defer(content);
+
+    cfrds_status status = cfrds_command_file_read(server, "/f1", &content);
+    if ((status == CFRDS_STATUS_OK)&&((content == NULL)||(strcmp(cfrds_file_content_get_data(content), "hello world") != 0)))
+        return CFRDS_STATUS_RESPONSE_ERROR;
+
+    return status;
+}
+
+/* ── Tests ─────────────────────────────────────────────────────────────── */
+
+static int test_policy_defaults(void)
+{
+    cfrds_server_defer(server);
+    test_server srv;
+
+    CHECK(test_server_start(&srv, "c"));
+    CHECK(cfrds_server_init(&server, "127.0.0.1", srv.port, "admin", "secret"));
+    CHECK(!cfrds_server_set_retry_policy(NULL, 3, 0, 0, 0));
+    CHECK(cfrds_server_set_retry_policy(server, 0, 0, 0, 0));
+
+    /* one attempt unless configured */
+    CHECK(read_file(server) != CFRDS_STATUS_OK);
+    CHECK(atomic_load(&srv.accepted) == 1);
+
+    test_server_stop(&srv);
+
+    return PASS;
+}
+
+static int test_retry_after_failures(void)
+{
+    static const struct {
+        const char *script;
+        unsigned int attempts;
+        bool ok;
+    } cases[] = {
+        { "ca", 2, true },
+        { "55a", 3, true },
+        { "55a", 2, false },
+        { "cc5a", 4, true },
+    };
+
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++)
+    {
+        cfrds_server_defer(server);
+        test_server srv;
+
+        CHECK(test_server_start(&srv, cases[c].script));
+        CHECK(cfrds_server_init(&server, "127.0.0.1", srv.port, "admin", "secret"));
+        CHECK(cfrds_server_set_retry_policy(server, cases[c].attempts, 5, 20, 0));
+
+        CHECK((read_file(server) == CFRDS_STATUS_OK) == cases[c].ok);
+        CHECK(atomic_load(&srv.accepted) == cases[c].attempts);
+
+        test_server_stop(&srv);
+    }
+
+    return PASS;
+}
+
+static int test_retry_after_timeout(void)
+{
+    cfrds_server_defer(server);
+    test_server srv;
+
+    CHECK(test_server_start(&srv, "sa"));
+    CHECK(cfrds_server_init(&server, "127.0.0.1", srv.port, "admin", "secret"));
+    CHECK(cfrds_server_set_timeouts(server, 0, 200, 0));
+    CHECK(cfrds_server_set_retry_policy(server, 2, 5, 20, 0));
+
+    uint64_t start = now_ms();
+    CHECK(read_file(server) == CFRDS_STATUS_OK);
+    CHECK(now_ms() - start >= 200);
+    CHECK(atomic_load(&srv.accepted) == 2);
+
+    test_server_stop(&srv);
+
+    return PASS;
+}
+
+static int test_not_idempotent(void)
+{
+    cfrds_server_defer(server);
+    test_server srv;
+
+    CHECK(test_server_start(&srv, "ca"));
+    CHECK(cfrds_server_init(&server, "127.0.0.1", srv.port, "admin", "secret"));
+    CHECK(cfrds_server_set_retry_policy(server, 3, 5, 20, 10));
+
+    /* a removal is sent exactly once */
+    CHECK(cfrds_command_file_remove_file(server, "/f1") != CFRDS_STATUS_OK);
+    CHECK(atomic_load(&srv.accepted) == 1);
+
+    test_server_stop(&srv);
+
+    return PASS;
+}
+
+static int test_backoff_within_deadline(void)
+{
+    cfrds_server_defer(server);
+    test_server srv;
+
+    CHECK(test_server_start(&srv, "cccccccccccccccccccccccccccccccc"));
+    CHECK(cfrds_server_init(&server, "127.0.0.1", srv.port, "admin", "secret"));
+    CHECK(cfrds_server_set_timeouts(server, 0, 0, 300));
+    CHECK(cfrds_server_set_retry_policy(server, 30, 50, 5000, 0));
+
+    /* retries stop at the total deadline instead of sleeping past it */
+    uint64_t start = now_ms();
+    CHECK(read_file(server) != CFRDS_STATUS_OK);
+    CHECK(now_ms() - start < 1000);
+    CHECK(atomic_load(&srv.accepted) < 30);
+
+    test_server_stop(&srv);
+
+    return PASS;
+}
+
+static int test_hedge(void)
+{
+    cfrds_server_defer(server);
+    test_server srv;
+
+    CHECK(test_server_start(&srv, "sa"));
+    CHECK(cfrds_server_init(&server, "127.0.0.1", srv.port, "admin", "secret"));
+    CHECK(cfrds_server_set_retry_policy(server, 1, 0, 0, 50));
+
+    /* the stalled request is outrun by its duplicate, long before the first byte timeout */
+    uint64_t start = now_ms();
+    CHECK(read_file(server) == CFRDS_STATUS_OK);
+    CHECK(now_ms() - start < 2000);
+    CHECK(atomic_load(&srv.accepted) == 2);
+
+    test_server_stop(&srv);
+
+    return PASS;
+}
+
+static int test_hedge_p95(void)
+{
+    char script[40];
+    cfrds_server_defer(server);
+    test_server srv;
+
+    /* 16 quick answers to measure, then a stall */
+    memset(script, 'a', sizeof(script));
+    script[16] = 's';
+    script[sizeof(script) - 1] = '\0';
+
+    CHECK(test_server_start(&srv, script));
+    CHECK(cfrds_server_init(&server, "127.0.0.1", srv.port, "admin", "secret"));
+    CHECK(cfrds_server_set_timeouts(server, 0, 5000, 0));
+    CHECK(cfrds_server_set_retry_policy(server, 1, 0, 0, CFRDS_HEDGE_AFTER_P95));
+
+    for (int c = 0; c < 16; c++)
+        CHECK(read_file(server) == CFRDS_STATUS_OK);
+    CHECK(atomic_load(&srv.accepted) == 16);
+
+    uint64_t start = now_ms();
+    CHECK(read_file(server) == CFRDS_STATUS_OK);
+    CHECK(now_ms() - start < 2000);
+    CHECK(atomic_load(&srv.accepted) == 18);
+
+    test_server_stop(&srv);
+
+    return PASS;
+}
+
+/* ── main ──────────────────────────────────────────────────────────────── */
+
+int main(void)
+{
+    RUN(test_policy_defaults);
+    RUN(test_retry_after_failures);
+    RUN(test_retry_after_timeout);
+    RUN(test_not_idempotent);
+    RUN(test_backoff_within_deadline);
+    RUN(test_hedge);
+    RUN(test_hedge_p95);
+
+    printf("\n%d test(s) failed.\n", _failures);
+    return _failures ? 1 : 0;
+}
@@ -0,0 +1,324 @@
+/*
+ * test_sql.c — Unit tests for the incremental SQLSTMNT cursor parser in cfrds_sql.c.
+ *
+ * Response bodies are built in memory and handed to the cursor either in one piece
+ * or a few bytes at a time, only when it asks for more, the way the HTTP stream
+ * delivers them. No network access is required.
+ */
+
+#include "../src/cfrds_sql.c"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+/* ── Minimal assert helper ─────────────────────────────────────────────── */
+
+#define PASS 0
+#define FAIL 1
+
+static int _failures = 0;
+
+#define CHECK(expr) \
+    do { \
+        if (!(expr)) { \
+            fprintf(stderr, "FAIL  %s:%d  %s\n", __func__, __LINE__, #expr); \
+            return FAIL; \
+        } \
+    } while (0)
+
+#define RUN(fn) \
+    do { \
+        int _r = fn(); \
+        if (_r == PASS) { \
+            printf("PASS  %s\n", #fn); \
+        } else { \
+            printf("FAIL  %s\n", #fn); \
+            _failures++; \
+        } \
+    } while (0)
+
+/* ── Helpers ───────────────────────────────────────────────────────────── */
+
+typedef struct {
+    const char *data;
+    size_t size;
+    size_t pos;
+    size_t step;
+} test_source;
+
+/* Same loop as cfrds_sql_cursor_step, receiving `step` bytes of the response whenever the parser needs more. */
+static cfrds_status source_advance(cfrds_sql_cursor *cursor, test_source *source)
+{
+    while (1)
+    {
+        bool need_more = false;
+
+        cfrds_status status = cfrds_sql_cursor_advance(cursor, &need_more);
+        if ((status != CFRDS_STATUS_OK)||(!need_more))
+            return status;
+
+        /* a body that ended before the parser did */
+        if (source->pos == source->size)
+            return CFRDS_STATUS_RESPONSE_ERROR;
+
+        size_t piece = (source->size - source->pos < source->step) ? source->size - source->pos : source->step;
+
+        status = cfrds_sql_cursor_feed(cursor, source->data + source->pos, piece);
+        if (status != CFRDS_STATUS_OK)
+            return status;
+
+        source->pos += piece;
+    }
+}
+
+/* Opens a cursor on `response` the way cfrds_sql_cursor_open does, up to the first row. */
+static cfrds_status source_open(cfrds_sql_cursor *cursor, test_source *source)
+{
+    while ((cursor->state == CFRDS_SQL_CURSOR_COUNT)||(cursor->state == CFRDS_SQL_CURSOR_HEADER))
+    {
+        cfrds_status status = source_advance(cursor, source);
+        if (status != CFRDS_STATUS_OK)
+            return status;
+    }
+
+    return CFRDS_STATUS_OK;
+}
+
+/* Moves to the next row like cfrds_sql_cursor_next_row, `*row` false after the last one. */
+static cfrds_status source_next_row(cfrds_sql_cursor *cursor, test_source *source, bool *row)
+{
+    cfrds_status status = source_advance(cursor, source);
+
+    *row = (status == CFRDS_STATUS_OK)&&(cursor->state == CFRDS_SQL_CURSOR_ROWS);
+
+    return status;
+}
+
+/* Appends one length-prefixed row to `response`. */
+static bool append_row(cfrds_buffer *response, const char *row)
+{
+    char prefix[32];
+
+    snprintf(prefix, sizeof(prefix), "%zu:", strlen(row));
+
+    return (cfrds_buffer_append(response, prefix))&&(cfrds_buffer_append(response, row));
+}
+
+/* ── Tests ─────────────────────────────────────────────────────────────── */
+
+static int test_cursor_rows(void)
+{
+    static const char response[] = "4:11:\"ID\",\"NAME\"7:\"1\",\"a\"11:\"2\",\"b,c d\"5:3,xyz";
+
+    for (size_t step = 1; step <= sizeof(response); step++)
+    {
+        cfrds_sql_cursor *cursor = cfrds_sql_cursor_create(NULL);
+        test_source source = { response, strlen(response), 0, step };
+        bool row = false;
+
+        CHECK(cursor != NULL);
+        CHECK(source_open(cursor, &source) == CFRDS_STATUS_OK);
+        CHECK(cfrds_sql_cursor_columns(cursor) == 2);
+        CHECK(cfrds_sql_cursor_rows(cursor) == 3);
+        CHECK(strcmp(cfrds_sql_cursor_column_name(cursor, 0), "ID") == 0);
+        CHECK(strcmp(cfrds_sql_cursor_column_name(cursor, 1), "NAME") == 0);
+        CHECK(cfrds_sql_cursor_column_name(cursor, 2) == NULL);
+        CHECK(cfrds_sql_cursor_value(cursor, 0) == NULL);
+
+        CHECK(source_next_row(cursor, &source, &row) == CFRDS_STATUS_OK);
+        CHECK(row);
+        CHECK(strcmp(cfrds_sql_cursor_value(cursor, 0), "1") == 0);
+        CHECK(strcmp(cfrds_sql_cursor_value(cursor, 1), "a") == 0);
+
+        CHECK(source_next_row(cursor, &source, &row) == CFRDS_STATUS_OK);
+        CHECK(row);
+        CHECK(strcmp(cfrds_sql_cursor_value(cursor, 1), "b,c d") == 0);
+        CHECK(cfrds_sql_cursor_value_len(cursor, 1) == 5);
+
+        CHECK(source_next_row(cursor, &source, &row) == CFRDS_STATUS_OK);
+        CHECK(row);
+        CHECK(strcmp(cfrds_sql_cursor_value(cursor, 0), "3") == 0);
+        CHECK(strcmp(cfrds_sql_cursor_value(cursor, 1), "xyz") == 0);
+        CHECK(cfrds_sql_cursor_value(cursor, 2) == NULL);
+
+        CHECK(source_next_row(cursor, &source, &row) == CFRDS_STATUS_OK);
+        CHECK(!row);
+        CHECK(cursor->state == CFRDS_SQL_CURSOR_END);
+
+        cfrds_sql_cursor_close(cursor);
+    }
+
+    return PASS;
+}
+
+static int test_cursor_no_rows(void)
+{
+    cfrds_sql_cursor_defer(cursor);
+    test_source source = { "1:4:\"ID\"", 8, 0, 64 };
+    bool row = true;
+
+    cursor = cfrds_sql_cursor_create(NULL);
+    CHECK(cursor != NULL);
+    CHECK(source_open(cursor, &source) == CFRDS_STATUS_OK);
+    CHECK(cfrds_sql_cursor_columns(cursor) == 1);
+    CHECK(cfrds_sql_cursor_rows(cursor) == 0);
+
+    CHECK(source_next_row(cursor, &source, &row) == CFRDS_STATUS_OK);
+    CHECK(!row);
+
+    return PASS;
+}
+
+/* Three times the rows cfrds_buffer_to_sql_sqlstmnt accepts, with only the unparsed tail kept. */
+static int test_cursor_many_rows(void)
+{
+    const size_t rows = 30000;
+    cfrds_sql_cursor_defer(cursor);
+    cfrds_buffer_defer(response);
+    char line[64];
+    size_t seen = 0;
+    bool row = false;
+
+    CHECK(cfrds_buffer_create(&response));
+    snprintf(line, sizeof(line), "%zu:", rows + 1);
+    CHECK(cfrds_buffer_append(response, line));
+    CHECK(append_row(response, "\"ID\",\"VALUE\""));
+    for (size_t r = 0; r < rows; r++)
+    {
+        snprintf(line, sizeof(line), "\"%zu\",\"value %zu\"", r, r);
+        CHECK(append_row(response, line));
+    }
+
+    cursor = cfrds_sql_cursor_create(NULL);
+    CHECK(cursor != NULL);
+
+    test_source source = { cfrds_buffer_data(response), cfrds_buffer_data_size(response), 0, 4096 };
+
+    CHECK(source_open(cursor, &source) == CFRDS_STATUS_OK);
+    CHECK(cfrds_sql_cursor_rows(cursor) == rows);
+
+    while (1)
+    {
+        CHECK(source_next_row(cursor, &source, &row) == CFRDS_STATUS_OK);
+        if (!row)
+            break;
+
+        snprintf(line, sizeof(line), "%zu", seen);
+        CHECK(strcmp(cfrds_sql_cursor_value(cursor, 0), line) == 0);
+        CHECK(cfrds_buffer_data_size(cursor->pending) <= 4096 + 64);
+        seen++;
+    }
+
+    CHECK(seen == rows);
+
+    return PASS;
+}
+
+static int test_cursor_truncated(void)
+{
+    static const char response[] = "3:4:\"ID\"3:\"1\"3:\"2";
+
+    for (size_t step = 1; step <= sizeof(response); step++)
+    {
+        cfrds_sql_cursor_defer(cursor);
+        test_source source = { response, strlen(response), 0, step };
+        bool row = false;
+
+        cursor = cfrds_sql_cursor_create(NULL);
+        CHECK(cursor != NULL);
+        CHECK(source_open(cursor, &source) == CFRDS_STATUS_OK);
+        CHECK(source_next_row(cursor, &source, &row) == CFRDS_STATUS_OK);
+        CHECK(row);
+        CHECK(source_next_row(cursor, &source, &row) == CFRDS_STATUS_RESPONSE_ERROR);
+        CHECK(!row);
+    }
+
+    return PASS;
+}
+
+static int test_cursor_server_error(void)
+{
+    static const char response[] = "-1:Table 'missing' doesn't exist";
+    cfrds_sql_cursor_defer(cursor);
+    test_source source = { response, strlen(response), 0, 3 };
+
+    cursor = cfrds_sql_cursor_create(NULL);
+    CHECK(cursor != NULL);
+    CHECK(source_open(cursor, &source) == CFRDS_STATUS_OK);
+    CHECK(cursor->state == CFRDS_SQL_CURSOR_SERVER_ERROR);
+
+    /* the rest of the body is kept for cfrds_http_parse_rds_status */
+    CHECK(cfrds_sql_cursor_feed(cursor, source.data + source.pos, source.size - source.pos) == CFRDS_STATUS_OK);
+    CHECK(cfrds_buffer_data_size(cursor->pending) == strlen(response));
+    CHECK(memcmp(cfrds_buffer_data(cursor->pending), response, strlen(response)) == 0);
+
+    return PASS;
+}
+
+static int test_cursor_malformed(void)
+{
+    static const char *responses[] = {
+        "0:",
+        "x:4:\"ID\"",
+        "2:-4:\"ID\"",
+        "2:0:",
+        "2:4:\"ID\"7:\"1\",\"2\"",
+        "3:8:\"ID\",\"N\"3:\"1\"",
+        "2:8:\"ID\",\"N3:\"1\"",
+    };
+
+    for (size_t c = 0; c < sizeof(responses) / sizeof(responses[0]); c++)
+    {
+        cfrds_sql_cursor_defer(cursor);
+        test_source source = { responses[c], strlen(responses[c]), 0, 1 };
+        cfrds_status status;
+        bool row = false;
+
+        cursor = cfrds_sql_cursor_create(NULL);
+        CHECK(cursor != NULL);
+
+        status = source_open(cursor, &source);
+        if (status == CFRDS_STATUS_OK)
+            status = source_next_row(cursor, &source, &row);
+
+        CHECK(status == CFRDS_STATUS_RESPONSE_ERROR);
+        CHECK(cursor->error != NULL);
+    }
+
+    return PASS;
+}
+
+static int test_cursor_row_too_large(void)
+{
+    static const char response[] = "2:4:\"ID\"40:\"0123456789012345678901234567890123456\"";
+    cfrds_sql_cursor_defer(cursor);
+    test_source source = { response, strlen(response), 0, 4 };
+    bool row = false;
+
+    cursor = cfrds_sql_cursor_create(NULL);
+    CHECK(cursor != NULL);
+    cursor->max_row_size = 16;
+
+    CHECK(source_open(cursor, &source) == CFRDS_STATUS_OK);
+    CHECK(source_next_row(cursor, &source, &row) == CFRDS_STATUS_RESPONSE_TOO_LARGE);
+    CHECK(cursor->error != NULL);
+
+    return PASS;
+}
+
+/* ── main ──────────────────────────────────────────────────────────────── */
+
+int main(void)
+{
+    RUN(test_cursor_rows);
+    RUN(test_cursor_no_rows);
+    RUN(test_cursor_many_rows);
+    RUN(test_cursor_truncated);
+    RUN(test_cursor_server_error);
+    RUN(test_cursor_malformed);
+    RUN(test_cursor_row_too_large);
+
+    printf("\n%d test(s) failed.\n", _failures);
+    return _failures ? 1 : 0;
+}
@@ -0,0 +1,459 @@
+/*
+ * test_threads.c — Unit tests for sharing one cfrds_server between threads.
+ *
+ * A keep-alive HTTP server on an ephemeral loopback port serves every
+ * connection from its own thread. Reads of "/ok" succeed, reads of any other
+ * path fail with an RDS error naming that path, so each worker can check that
+ * the error it reads back is its own and not one set by a concurrent call.
+ */
+
+#include <cfrds.h>
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+/* ── Minimal assert helper ─────────────────────────────────────────────── */
+
+#define PASS 0
+#define FAIL 1
+
+static int _failures = 0;
+
+#define CHECK(expr) \
+    do { \
+        if (!(expr)) { \
+            fprintf(stderr, "FAIL  %s:%d  %s\n", __func__, __LINE__, #expr); \
+            return FAIL; \
+        } \
+    } while (0)
+
+#define RUN(fn) \
+    do { \
+        int _r = fn(); \
+        if (_r == PASS) { \
+            printf("PASS  %s\n", #fn); \
+        } else { \
+            printf("FAIL  %s\n", #fn); \
+            _failures++; \
+        } \
+    } while (0)
+
+/* ── Loopback test server ──────────────────────────────────────────────── */
+
+typedef struct {
+    int listener;
+    uint16_t port;
+    atomic_size_t accepted;
+    atomic_size_t active;
+    atomic_bool stop;
+    pthread_t thread;
+} test_server;
+
+typedef struct {
+    test_server *srv;
+    int fd;
+} test_conn;
+
+/* Answers one complete request from `data`, returns its length or 0 if more data is needed. */
+static size_t test_conn_answer(int fd, const char *data, size_t len)
+{
+    static const char ok_body[] = "3:11:hello world19:2024-01-01 10:00:004:rw-r";
+    char body[256];
+    char response[512];
+
+    const char *end = strstr(data, "\r\n\r\n");
+    const char *length = strstr(data, "Content-length: ");
+    if ((end == NULL)||(length == NULL))
+        return 0;
+
+    size_t total = (size_t)(end + 4 - data) + strtoul(length + 16, NULL, 10);
+    if (len < total)
+        return 0;
+
+    /* the path is the first argument, "STR:<len>:<path>" */
+    const char *arg = strstr(end + 4, "STR:");
+    char *path = "";
+    size_t path_len = arg ? strtoul(arg + 4, &path, 10) : 0;
+    if (path_len > 0)
+        path++;
+
+    if ((path_len == 3)&&(strncmp(path, "/ok", 3) == 0))
+        snprintf(body, sizeof(body), "%s", ok_body);
+    else
+        snprintf(body, sizeof(body), "-1:no such file %.*s", (int)path_len, path);
+
+    snprintf(response, sizeof(response), "HTTP/1.1 200 OK\r\nContent-Length: %zu\r\n\r\n%s", strlen(body), body);
+    send(fd, response, strlen(response), MSG_NOSIGNAL);
+
+    return total;
+}
+
+static void *test_conn_run(void *arg)
+{
+    test_conn *conn = arg;
+    char data[4096];
+    size_t len = 0;
+
+    while (!atomic_load(&conn->srv->stop))
+    {
+        struct pollfd pfd = { .fd = conn->fd, .events = POLLIN };
+
+        if (poll(&pfd, 1, 10) <= 0)
+            continue;
+
+        ssize_t n = recv(conn->fd, data + len, sizeof(data) - len - 1, 0);
+        if (n <= 0)
+            break;
+
+        len += (size_t)n;
+        data[len] = '\0';
+
+        size_t used = test_conn_answer(conn->fd, data, len);
+        if (used > 0)
+        {
+            memmove(data, data + used, len - used);
+            len -= used;
+            data[len] = '\0';
+        }
+    }
+
+    close(conn->fd);
+    atomic_fetch_sub(&conn->srv->active, 1);
+    free(conn);
+
+    return NULL;
+}
+
+static void *test_server_run(void *arg)
+{
+    test_server *srv = arg;
+
+    while (!atomic_load(&srv->stop))
+    {
+        struct pollfd pfd = { .fd = srv->listener, .events = POLLIN };
+
+        if (poll(&pfd, 1, 10) <= 0)
+            continue;
+
+        int fd = accept(srv->listener, NULL, NULL);
+        if (fd < 0)
+            continue;
+
+        test_conn *conn = malloc(sizeof(test_conn));
+        pthread_t thread;
+
+        if (conn == NULL)
+        {
+            close(fd);
+            continue;
+        }
+
+        conn->srv = srv;
+        conn->fd = fd;
+        atomic_fetch_add(&srv->accepted, 1);
+        atomic_fetch_add(&srv->active, 1);
+
+        if (pthread_create(&thread, NULL, test_conn_run, conn) != 0)
+        {
+            atomic_fetch_sub(&srv->active, 1);
+            close(fd);
+            free(conn);
+            continue;
+        }
+
+        pthread_detach(thread);
+    }
+
+    return NULL;
+}
+
+static bool test_server_start(test_server *srv)
+{
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+
+    memset(srv, 0, sizeof(*srv));
+    atomic_init(&srv->accepted, 0);
+    atomic_init(&srv->active, 0);
+    atomic_init(&srv->stop, false);
+
+    srv->listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (srv->listener < 0)
+        return false;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+
+    if ((bind(srv->listener, (struct sockaddr *)&addr, sizeof(addr)) != 0)||
+        (listen(srv->listener, 128) != 0)||
+        (getsockname(srv->listener, (struct sockaddr *)&addr, &len) != 0)||
+        (fcntl(srv->listener, F_SETFL, O_NONBLOCK) != 0)||
+        (pthread_create(&srv->thread, NULL, test_server_run, srv) != 0))
+    {
+        close(srv->listener);
+        return false;
+    }
+
+    srv->port = ntohs(addr.sin_port);
+
+    return true;
+}
+
+static void test_server_stop(test_server *srv)
+{
+    atomic_store(&srv->stop, true);
+    pthread_join(srv->thread, NULL);
+
+    /* connection threads notice the stop flag within one poll interval */
+    while (atomic_load(&srv->active) > 0)
+        poll(NULL, 0, 5);
+
+    close(srv->listener);
+}
+
+/* ── Workers ───────────────────────────────────────────────────────────── */
+
+#define TEST_WORKERS 8
+#define TEST_ROUNDS 100
+
+typedef struct {
+    cfrds_server *server;
+    int id;
+    int failed_line;
+} test_worker;
+
+#define WORKER_CHECK(expr) \
+    do { \
+        if (!(expr)) { \
+            worker->failed_line = __LINE__; \
+            return NULL; \
+        } \
+    } while (0)
+
+static void *test_worker_run(void *arg)
+{
+    test_worker *worker = arg;
+    char path[64];
+    char expected[96];
+
+    for (int c = 0; c < TEST_ROUNDS; c++)
+    {
+        cfrds_file_content_defer(content);
+        cfrds_file_content_defer(missing);
+
+        WORKER_CHECK(cfrds_command_file_read(worker->server, "/ok", &content) == CFRDS_STATUS_OK);
+        WORKER_CHECK(strcmp(cfrds_file_content_get_data(content), "hello world") == 0);
+        WORKER_CHECK(cfrds_server_get_error(worker->server) == NULL);
+
+        snprintf(path, sizeof(path), "/missing-%d-%d", worker->id, c);
+        snprintf(expected, sizeof(expected), "no such file %s", path);
+
+        WORKER_CHECK(cfrds_command_file_read(worker->server, path, &missing) != CFRDS_STATUS_OK);
+        WORKER_CHECK(cfrds_server_get_error(worker->server) != NULL);
+        WORKER_CHECK(strcmp(cfrds_server_get_error(worker->server), expected) == 0);
+    }
+
+    return NULL;
+}
+
+static void *test_set_error_run(void *arg)
+{
+    cfrds_server *server = arg;
+
+    if (cfrds_server_get_error(server) != NULL)
+        return "inherited error";
+
+    /* keep-alive is off, so prewarming fails without any network traffic */
+    if ((cfrds_server_prewarm(server, 1) == CFRDS_STATUS_OK)||(cfrds_server_get_error(server) == NULL))
+        return "own error lost";
+
+    return NULL;
+}
+
+typedef struct {
+    cfrds_server *server;
+    atomic_bool ready;
+    atomic_bool release;
+} test_holder;
+
+/* Sets an error, then keeps the thread alive until released. */
+static void *test_hold_error_run(void *arg)
+{
+    test_holder *holder = arg;
+
+    cfrds_server_prewarm(holder->server, 1);
+    atomic_store(&holder->ready, true);
+
+    while (!atomic_load(&holder->release))
+        poll(NULL, 0, 1);
+
+    return NULL;
+}
+
+/* ── Tests ─────────────────────────────────────────────────────────────── */
+
+static int test_error_per_thread(void)
+{
+    cfrds_server_defer(server);
+    cfrds_file_content_defer(content);
+    test_server srv;
+    pthread_t thread;
+    void *result = NULL;
+
+    CHECK(test_server_start(&srv));
+    CHECK(cfrds_server_init(&server, "127.0.0.1", srv.port, "admin", "secret"));
+
+    CHECK(cfrds_command_file_read(server, "/missing-main", &content) != CFRDS_STATUS_OK);
+    CHECK(strcmp(cfrds_server_get_error(server), "no such file /missing-main") == 0);
+
+    /* a thread starts without an error and its own error stays invisible to others */
+    CHECK(pthread_create(&thread, NULL, test_set_error_run, server) == 0);
+    CHECK(pthread_join(thread, &result) == 0);
+    CHECK(result == NULL);
+    CHECK(strcmp(cfrds_server_get_error(server), "no such file /missing-main") == 0);
+
+    cfrds_server_clear_error(server);
+    CHECK(cfrds_server_get_error(server) == NULL);
+
+    cfrds_server_free(server);
+    server = NULL;
+    test_server_stop(&srv);
+
+    return PASS;
+}
+
+static int test_error_thread_lifetime(void)
+{
+    cfrds_server_defer(server);
+    pthread_t threads[4];
+    test_holder holders[4];
+
+    CHECK(cfrds_server_init(&server, "127.0.0.1", 80, "admin", "secret"));
+
+    /* two threads exit while the server lives, two only after it is freed */
+    for (int c = 0; c < 4; c++)
+    {
+        holders[c].server = server;
+        atomic_init(&holders[c].ready, false);
+        atomic_init(&holders[c].release, c < 2);
+        CHECK(pthread_create(&threads[c], NULL, test_hold_error_run, &holders[c]) == 0);
+    }
+
+    for (int c = 0; c < 4; c++)
+    {
+        while (!atomic_load(&holders[c].ready))
+            poll(NULL, 0, 1);
+    }
+    for (int c = 0; c < 2; c++)
+        CHECK(pthread_join(threads[c], NULL) == 0);
+
+    cfrds_server_free(server);
+    server = NULL;
+
+    for (int c = 2; c < 4; c++)
+    {
+        atomic_store(&holders[c].release, true);
+        CHECK(pthread_join(threads[c], NULL) == 0);
+    }
+
+    return PASS;
+}
+
+/* More servers than a process has thread-local keys, each keeping its own error. */
+static int test_many_servers(void)
+{
+    enum { COUNT = 2048 };
+    cfrds_server **servers = calloc(COUNT, sizeof(cfrds_server *));
+    cfrds_file_content_defer(content);
+    int created = 0;
+    bool ok = true;
+
+    CHECK(servers != NULL);
+
+    /* nothing listens on port 1: every read fails and leaves an error on its server */
+    for (; (created < COUNT)&&(ok); created++)
+    {
+        ok = cfrds_server_init(&servers[created], "127.0.0.1", 1, "admin", "secret");
+        if (ok)
+            ok = (cfrds_command_file_read(servers[created], "/x", &content) != CFRDS_STATUS_OK)&&(cfrds_server_get_error(servers[created]) != NULL);
+    }
+
+    if (ok)
+    {
+        cfrds_server_clear_error(servers[0]);
+        ok = (cfrds_server_get_error(servers[0]) == NULL)&&(cfrds_server_get_error(servers[COUNT - 1]) != NULL);
+    }
+
+    for (int c = 0; c < created; c++)
+        cfrds_server_free(servers[c]);
+    free(servers);
+
+    CHECK(ok);
+    CHECK(created == COUNT);
+
+    return PASS;
+}
+
+static int test_concurrent_commands(void)
+{
+    cfrds_server_defer(server);
+    test_server srv;
+    pthread_t threads[TEST_WORKERS];
+    test_worker workers[TEST_WORKERS];
+
+    CHECK(test_server_start(&srv));
+    CHECK(cfrds_server_init(&server, "127.0.0.1", srv.port, "admin", "secret"));
+    CHECK(cfrds_server_set_keepalive(server, true, 4, 0));
+    CHECK(cfrds_server_set_retry_policy(server, 2, 5, 20, 0));
+
+    for (int c = 0; c < TEST_WORKERS; c++)
+    {
+        workers[c].server = server;
+        workers[c].id = c;
+        workers[c].failed_line = 0;
+        CHECK(pthread_create(&threads[c], NULL, test_worker_run, &workers[c]) == 0);
+    }
+
+    for (int c = 0; c < TEST_WORKERS; c++)
+    {
+        CHECK(pthread_join(threads[c], NULL) == 0);
+        if (workers[c].failed_line)
+            fprintf(stderr, "worker %d failed at line %d\n", c, workers[c].failed_line);
+        CHECK(workers[c].failed_line == 0);
+    }
+
+    /* the pool is shared: far fewer connections than commands */
+    CHECK(atomic_load(&srv.accepted) < (TEST_WORKERS * TEST_ROUNDS * 2) / 4);
+
+    cfrds_server_free(server);
+    server = NULL;
+    test_server_stop(&srv);
+
+    return PASS;
+}
+
+/* ── main ──────────────────────────────────────────────────────────────── */
+
+int main(void)
+{
+    RUN(test_error_per_thread);
+    RUN(test_error_thread_lifetime);
+    RUN(test_many_servers);
+    RUN(test_concurrent_commands);
+
+    printf("\n%d test(s) failed.\n", _failures);
+    return _failures ? 1 : 0;
+}
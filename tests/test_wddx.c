@@ -11,6 +11,7 @@
  */
 
 #include <cfrds.h>
+#include "../src/cfrds_buffer.c"
 #include "../src/wddx.c"
 
 #include <stdio.h>
@@ -474,6 +475,10 @@ static int test_debugger_event_getters(void)
               "<var name=\"SCOPES\"><array length=\"2\"><string>SCOPE_A</string><string>SCOPE_B</string></array></var>"
               "<var name=\"THREADS\"><array length=\"1\"><string>THREAD_1</string></array></var>"
               "<var name=\"WATCH\"><array length=\"1\"><string>EXPR_1</string></array></var>"
+              "<var name=\"CF_TRACE\"><array length=\"2\"><string>index.cfm:3</string><null/></array></var>"
+              "<var name=\"JAVA_TRACE\"><struct><var name=\"0\"><string>x</string></var></struct></var>"
+              "<var name=\"EVENT\"><string>BREAKPOINT</string></var>"
+              "<var name=\"LINE\"><number>42</number></var>"
             "</struct>"
           "</array>"
         "</data>"
@@ -504,6 +509,16 @@ static int test_debugger_event_getters(void)
     CHECK(strcmp(cfrds_debugger_event_get_watch_item(event, 0), "EXPR_1") == 0);
     CHECK(cfrds_debugger_event_get_watch_item(event, 1) == NULL);
 
+    /* Test CF_TRACE / JAVA_TRACE */
+    CHECK(cfrds_debugger_event_get_cf_trace_count(event) == 2);
+    CHECK(strcmp(cfrds_debugger_event_get_cf_trace_item(event, 0), "index.cfm:3") == 0);
+    CHECK(cfrds_debugger_event_get_cf_trace_item(event, 1) == NULL);
+    CHECK(cfrds_debugger_event_get_cf_trace_item(event, 2) == NULL);
+    CHECK(cfrds_debugger_event_get_java_trace_item(event, 0) == NULL);
+
+    CHECK(cfrds_debugger_event_get_type(event) == CFRDS_DEBUGGER_EVENT_TYPE_BREAKPOINT);
+    CHECK(cfrds_debugger_event_breakpoint_get_line(event) == 42);
+
     return PASS;
 }
 
@@ -554,6 +569,679 @@ static int test_wddx_array_bounds(void)
     return PASS;
 }
 
+/* ── reader vs. libxml2 DOM ────────────────────────────────────────────── */
+
+static bool nodes_equal(const struct WDDX_NODE *a, const struct WDDX_NODE *b)
+{
+    if ((a == NULL)||(b == NULL))
+        return a == b;
+
+    if ((a->type != b->type)||(a->cnt != b->cnt))
+        return false;
+
+    switch (a->type)
+    {
+    case WDDX_BOOLEAN:
+        return a->boolean == b->boolean;
+    case WDDX_NUMBER:
+        return (a->number == b->number)||((isnan(a->number))&&(isnan(b->number)));
+    case WDDX_STRING:
+        return strcmp(a->string, b->string) == 0;
+    case WDDX_ARRAY:
+        for (int i = 0; i < a->cnt; i++)
+            if (!nodes_equal(a->items[i], b->items[i]))
+                return false;
+        return true;
+    case WDDX_STRUCT:
+        for (int i = 0; i < a->cnt; i++)
+        {
+            const WDDX_STRUCT_NODE *ia = a->items[i];
+            const WDDX_STRUCT_NODE *ib = b->items[i];
+            if ((strcmp(ia->name, ib->name) != 0)||(!nodes_equal(ia->value, ib->value)))
+                return false;
+        }
+        return true;
+    default:
+        return true;
+    }
+}
+
+/* Parses `xml` with the reader and with libxml2, the packets must be the same. */
+static bool reader_matches_dom(const char *xml)
+{
+    WDDX_defer(reader);
+    WDDX_defer(dom);
+
+    reader = wddx_from_xml(xml);
+    dom = wddx_from_xml_dom(xml);
+
+    if ((reader == NULL)||(dom == NULL))
+    {
+        if (reader != dom)
+            fprintf(stderr, "      mismatch (%s): %s\n", reader ? "reader only" : "dom only", xml);
+        return reader == dom;
+    }
+
+    if ((!nodes_equal(reader->header, dom->header))||(!nodes_equal(reader->data, dom->data)))
+    {
+        fprintf(stderr, "      mismatch (values): %s\n", xml);
+        return false;
+    }
+
+    return true;
+}
+
+#define PACKET(data) "<wddxPacket version=\"1.0\"><header/><data>" data "</data></wddxPacket>"
+
+static int test_reader_fixtures(void)
+{
+    const char *fixtures[] = {
+        FIXTURE_STRING, FIXTURE_NUMBER, FIXTURE_BOOL_TRUE, FIXTURE_BOOL_FALSE, FIXTURE_ARRAY,
+        FIXTURE_STRUCT, FIXTURE_MALFORMED, FIXTURE_WRONG_ROOT, FIXTURE_NESTED, FIXTURE_EMPTY_STRING,
+        FIXTURE_STRUCT_MISSING_VAR_NAME,
+    };
+
+    for (size_t c = 0; c < sizeof(fixtures) / sizeof(fixtures[0]); c++)
+        CHECK(reader_matches_dom(fixtures[c]));
+
+    return PASS;
+}
+
+static int test_reader_text(void)
+{
+    const char *packets[] = {
+        PACKET("<string>a &lt;b&gt; &amp; &apos;c&apos; &quot;d&quot;</string>"),
+        PACKET("<string>&#65;&#x42;&#x10348;&#xe9;</string>"),
+        PACKET("<string>caf\xC3\xA9 \xE2\x82\xAC</string>"),
+        PACKET("<string>line1\r\nline2\rline3\n</string>"),
+        PACKET("<string><![CDATA[<raw> & ]]]]></string>"),
+        PACKET("<string><!-- note -->after</string>"),
+        PACKET("<string><?pi some data?></string>"),
+        PACKET("<string>head<!-- c -->tail</string>"),
+        PACKET("<string><string>inner</string></string>"),
+        PACKET("<string>a]]b]>c</string>"),
+        PACKET("<number> 42</number>"),
+        PACKET("<number>42 </number>"),
+        PACKET("<number>1e3</number>"),
+        PACKET("<number>&#x31;.5</number>"),
+        PACKET("<number><![CDATA[7]]></number>"),
+        PACKET("<number></number>"),
+        PACKET("<number/>"),
+        PACKET("<number>x</number>"),
+        PACKET("<number><null/></number>"),
+        PACKET("<number>0123456789012345678901234567890123456789012345678901234567890123456789</number>"),
+        PACKET("<boolean value='false'/>"),
+        PACKET("<boolean value='FALSE'/>"),
+        PACKET("<boolean value=\"fa&#108;se\"/>"),
+        PACKET("<boolean/>"),
+        PACKET("<null><string>x</string></null>"),
+        PACKET("<unknown><string>x</string></unknown>"),
+    };
+
+    for (size_t c = 0; c < sizeof(packets) / sizeof(packets[0]); c++)
+        CHECK(reader_matches_dom(packets[c]));
+
+    WDDX_defer(w);
+    w = wddx_from_xml(packets[0]);
+    CHECK(w != NULL);
+    CHECK(strcmp(wddx_node_string(wddx_data(w)), "a <b> & 'c' \"d\"") == 0);
+
+    return PASS;
+}
+
+static int test_reader_containers(void)
+{
+    const char *packets[] = {
+        PACKET("<array length='2'> <string>a</string> <!-- c --> <number>1</number> </array>"),
+        PACKET("<array length='3'><string>a</string></array>"),
+        PACKET("<array length='1'><string>a</string><string>b</string></array>"),
+        PACKET("<array length=' +2x'><null/><foo/></array>"),
+        PACKET("<array length='0'><null/></array>"),
+        PACKET("<array length='-1'><null/></array>"),
+        PACKET("<array length='10001'><null/></array>"),
+        PACKET("<array><null/></array>"),
+        PACKET("<array length='1'/>"),
+        PACKET("<struct/>"),
+        PACKET("<struct></struct>"),
+        PACKET("<struct><var name='a'><string>x</string></var><var name='b'><null/></var></struct>"),
+        PACKET("<struct><var name='a'>text</var></struct>"),
+        PACKET("<struct><var name='a'></var></struct>"),
+        PACKET("<struct><var name='a'/></struct>"),
+        PACKET("<struct><var><null/></var></struct>"),
+        PACKET("<struct><other name='o'><null/></other><var name='a'><null/></var></struct>"),
+        PACKET("<struct><var name='a'><null/></var><other name='o'><null/></other></struct>"),
+        PACKET("<struct><var name='a'><null/></var><other/></struct>"),
+        PACKET("<struct><other/><var name='a'><null/></var></struct>"),
+        PACKET("<struct><var name='a'><null/></var><var name='b'><null/></var><var name='c'><null/></var>"
+               "<var name='d'><null/></var><var name='e'><null/></var><var name='f'><null/></var></struct>"),
+        PACKET("<struct><var name='k&amp;&#10;v'><!-- c --><null/></var></struct>"),
+        PACKET("<struct><var name='a'><array length='1'><struct><var name='b'><string>deep</string></var></struct></array></var></struct>"),
+    };
+
+    for (size_t c = 0; c < sizeof(packets) / sizeof(packets[0]); c++)
+        CHECK(reader_matches_dom(packets[c]));
+
+    return PASS;
+}
+
+static int test_reader_packet(void)
+{
+    const char *packets[] = {
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?><wddxPacket version='1.0'><header/><data><null/></data></wddxPacket>",
+        "<?xml version='1.0' encoding='ISO-8859-1'?><wddxPacket version='1.0'><header/><data><string>caf\xE9</string></data></wddxPacket>",
+        "\xEF\xBB\xBF<wddxPacket><header/><data><null/></data></wddxPacket>",
+        "<!-- before --><?pi x?>\n<wddxPacket>\n  <header/>\n  <data>\n    <null/>\n  </data>\n</wddxPacket>\n<!-- after -->\n",
+        "<!DOCTYPE wddxPacket [<!ENTITY e \"ent\">]><wddxPacket><header/><data><string>&e;</string></data></wddxPacket>",
+        "<wddxPacket><header><string>h</string></header><data><number>1</number></data><extra/></wddxPacket>",
+        "<wddxPacket><header/>text<data><null/></data></wddxPacket>",
+        "<wddxPacket><!-- c --><header/><data><null/></data></wddxPacket>",
+        "<wddxPacket><header/><!-- c --><data><null/></data></wddxPacket>",
+        "<wddxPacket><header/></wddxPacket>",
+        "<wddxPacket><data><null/></data></wddxPacket>",
+        "<wddxPacket/>",
+        "<wddxPacket><header/><data/></wddxPacket>",
+        "<wddxPacket><header/><data> <null/></data></wddxPacket>",
+        "<wddxPacket><header/><data><null/><string>second</string></data></wddxPacket>",
+    };
+
+    for (size_t c = 0; c < sizeof(packets) / sizeof(packets[0]); c++)
+        CHECK(reader_matches_dom(packets[c]));
+
+    return PASS;
+}
+
+static int test_reader_malformed(void)
+{
+    const char *packets[] = {
+        "",
+        "   ",
+        "<wddxPacket>",
+        "<wddxPacket><header/><data><null/></data></wddxpacket>",
+        "<wddxPacket><header/><data><null/></data></wddxPacket><second/>",
+        "<wddxPacket><header/><data><null/></data></wddxPacket>trailing",
+        PACKET("<string>&unknown;</string>"),
+        PACKET("<string>&amp</string>"),
+        PACKET("<string>&#0;</string>"),
+        PACKET("<string>&#xD800;</string>"),
+        PACKET("<string>a ]]> b</string>"),
+        PACKET("<string>a < b</string>"),
+        PACKET("<string>bad \xC3 utf8</string>"),
+        PACKET("<string>overlong \xC0\xAF</string>"),
+        PACKET("<string>control \x01</string>"),
+        PACKET("<string><!-- a -- b --></string>"),
+        PACKET("<string><?xml bad?></string>"),
+        PACKET("<string><![CDATA[open</string>"),
+        PACKET("<boolean value='a<b'/>"),
+        PACKET("<boolean value='true' value='false'/>"),
+        PACKET("<boolean value=true/>"),
+        PACKET("<boolean value='true'x='1'/>"),
+        PACKET("<string>a</strin>"),
+        PACKET("<struct><var name='a'><null/></var></struct"),
+    };
+
+    for (size_t c = 0; c < sizeof(packets) / sizeof(packets[0]); c++)
+    {
+        CHECK(reader_matches_dom(packets[c]));
+
+        WDDX_defer(w);
+        w = wddx_from_xml(packets[c]);
+        CHECK(w == NULL);
+    }
+
+    return PASS;
+}
+
+static int test_reader_depth(void)
+{
+    char *xml = malloc(64 * 1024);
+    CHECK(xml != NULL);
+
+    for (int levels = 100; levels <= 1000; levels += 900)
+    {
+        size_t pos = (size_t)sprintf(xml, "<wddxPacket><header/><data>");
+        for (int l = 0; l < levels; l++)
+            pos += (size_t)sprintf(xml + pos, "<array length='1'>");
+        pos += (size_t)sprintf(xml + pos, "<null/>");
+        for (int l = 0; l < levels; l++)
+            pos += (size_t)sprintf(xml + pos, "</array>");
+        sprintf(xml + pos, "</data></wddxPacket>");
+
+        if (!reader_matches_dom(xml))
+        {
+            free(xml);
+            CHECK(false);
+        }
+    }
+
+    free(xml);
+
+    return PASS;
+}
+
+/* ── struct key index ──────────────────────────────────────────────────── */
+
+static int test_struct_index_parsed(void)
+{
+    const int keys = 2000;
+    cfrds_buffer_defer(xml);
+    WDDX_defer(w);
+    char line[128];
+
+    CHECK(cfrds_buffer_create(&xml));
+    CHECK(cfrds_buffer_append(xml, "<wddxPacket><header/><data><struct>"));
+    for (int k = 0; k < keys; k++)
+    {
+        snprintf(line, sizeof(line), "<var name='KEY%d'><string>value %d</string></var>", k, k);
+        CHECK(cfrds_buffer_append(xml, line));
+    }
+    /* a duplicate key, lookups find the first one like a scan does */
+    CHECK(cfrds_buffer_append(xml, "<var name='KEY7'><string>duplicate</string></var>"));
+    CHECK(cfrds_buffer_append(xml, "</struct></data></wddxPacket>"));
+    CHECK(cfrds_buffer_append_bytes(xml, "", 1));
+
+    w = wddx_from_xml(cfrds_buffer_data(xml));
+    CHECK(w != NULL);
+    CHECK(wddx_data(w)->index != NULL);
+    CHECK(wddx_node_struct_size(wddx_data(w)) == keys + 1);
+
+    for (int k = 0; k < keys; k++)
+    {
+        const char *name = NULL;
+
+        snprintf(line, sizeof(line), "KEY%d", k);
+        const char *value = wddx_get_string(w, line);
+        CHECK(value != NULL);
+
+        snprintf(line, sizeof(line), "value %d", k);
+        CHECK(strcmp(value, line) == 0);
+
+        /* insertion order is kept */
+        CHECK(wddx_node_struct_at(wddx_data(w), (size_t)k, &name) != NULL);
+        snprintf(line, sizeof(line), "KEY%d", k);
+        CHECK(strcmp(name, line) == 0);
+    }
+
+    CHECK(strcmp(wddx_get_string(w, "KEY7"), "value 7") == 0);
+    CHECK(wddx_get_string(w, "KEY2000") == NULL);
+    CHECK(wddx_get_string(w, "key1") == NULL);
+    CHECK(wddx_get_string(w, "") == NULL);
+
+    return PASS;
+}
+
+static int test_struct_index_small(void)
+{
+    WDDX_defer(w);
+
+    w = wddx_from_xml(FIXTURE_STRUCT);
+    CHECK(w != NULL);
+    CHECK(wddx_data(w)->index == NULL);
+
+    return PASS;
+}
+
+static int test_struct_index_put(void)
+{
+    WDDX_defer(w);
+    char key[32];
+    char value[32];
+
+    w = wddx_create();
+    CHECK(w != NULL);
+
+    for (int k = 0; k < 500; k++)
+    {
+        snprintf(key, sizeof(key), "OUTER,K%d", k);
+        snprintf(value, sizeof(value), "v%d", k);
+        CHECK(wddx_put_string(w, key, value));
+
+        const struct WDDX_NODE *outer = wddx_get_var(w, "OUTER");
+        CHECK(outer != NULL);
+        CHECK((outer->index != NULL) == (k + 1 >= WDDX_STRUCT_INDEX_MIN));
+    }
+
+    /* overwriting goes through the index and adds no key */
+    CHECK(wddx_put_string(w, "OUTER,K123", "changed"));
+    CHECK(wddx_node_struct_size(wddx_get_var(w, "OUTER")) == 500);
+
+    for (int k = 0; k < 500; k++)
+    {
+        snprintf(key, sizeof(key), "OUTER,K%d", k);
+        snprintf(value, sizeof(value), "v%d", k);
+        const char *got = wddx_get_string(w, key);
+        CHECK(got != NULL);
+        CHECK(strcmp(got, (k == 123) ? "changed" : value) == 0);
+    }
+
+    return PASS;
+}
+
+/* ── compiled paths ────────────────────────────────────────────────────── */
+
+static int test_path_compiled_matches(void)
+{
+    static const char xml[] =
+        "<wddxPacket><header/><data><array length='3'>"
+        "<struct><var name='STATUS'><string>RDS_OK</string></var><var name='PORT'><number>5005</number></var>"
+        "<var name=''><string>empty key</string></var><var name='007'><string>digits</string></var>"
+        "<var name='WATCH'><array length='2'><string>a</string><string>b</string></array></var></struct>"
+        "<null/><string>third</string>"
+        "</array></data></wddxPacket>";
+    static const char *paths[] = {
+        "", "0", "0,", "1", "2", "3", "0,STATUS", "0,STATUS,", "0,PORT", "0,WATCH", "0,WATCH,1", "0,WATCH,01",
+        "0,WATCH,2", "0,WATCH,99999999999999999999", "0,,", "0,,X", ",STATUS", "0,007", "0,MISSING",
+        "0,STATUS,0", "STATUS", "0,WATCH,-1", "0,WATCH,1,X", "1,X", "2,0",
+    };
+    WDDX_defer(w);
+
+    w = wddx_from_xml(xml);
+    CHECK(w != NULL);
+
+    for (size_t c = 0; c < sizeof(paths) / sizeof(paths[0]); c++)
+    {
+        wddx_path_defer(path);
+        bool ok = false;
+        bool ok_compiled = true;
+
+        path = wddx_path_compile(paths[c]);
+        CHECK(path != NULL);
+        CHECK(wddx_get_var_compiled(w, path) == wddx_get_var(w, paths[c]));
+        CHECK(wddx_get_string_compiled(w, path) == wddx_get_string(w, paths[c]));
+        CHECK(wddx_get_number_compiled(w, path, &ok_compiled) == wddx_get_number(w, paths[c], &ok));
+        CHECK(ok == ok_compiled);
+    }
+
+    static wddx_path *status_slot;
+    static wddx_path *port_slot;
+    static wddx_path *root_slot;
+    CHECK(strcmp(wddx_get_string_compiled(w, wddx_path_static(&status_slot, "0,STATUS")), "RDS_OK") == 0);
+    CHECK(wddx_get_number_compiled(w, wddx_path_static(&port_slot, "0,PORT"), NULL) == 5005);
+    CHECK(wddx_get_var_compiled(w, NULL) == NULL);
+    CHECK(wddx_get_var_compiled(NULL, wddx_path_static(&root_slot, "0")) == NULL);
+
+    return PASS;
+}
+
+static int test_path_static_once(void)
+{
+    static wddx_path *slot = NULL;
+
+    const wddx_path *first = wddx_path_static(&slot, "0,EVENT");
+    CHECK(first != NULL);
+    CHECK(wddx_path_static(&slot, "0,EVENT") == first);
+    CHECK(slot == first);
+
+    wddx_path_free(slot);
+    slot = NULL;
+
+    return PASS;
+}
+
+/* ── direct serializer vs. libxml2 ─────────────────────────────────────── */
+
+/* wddx_to_xml must write exactly what the libxml2 serializer did. */
+static bool serializer_matches_libxml2(WDDX *w)
+{
+    xmlBufferPtr reference = wddx_to_xml_libxml2(w);
+    const char *xml = wddx_to_xml(w);
+    bool ret = (xml != NULL)&&(strcmp(xml, (const char *)xmlBufferContent(reference)) == 0);
+
+    if (!ret)
+        fprintf(stderr, "      libxml2: %s\n      direct:  %s\n", (const char *)xmlBufferContent(reference), xml);
+
+    xmlBufferFree(reference);
+
+    return ret;
+}
+
+static int test_serializer_matches_libxml2(void)
+{
+    static const char *values[] = {
+        "", "plain", "a<b>c", "]]>", "q\"s'", "tab\there", "nl\nx", "cr\rx", "caf\xC3\xA9 \xE2\x82\xAC",
+        "a long value with a < past the first sixteen bytes > and more\r\n",
+        "0123456789abcde<", "0123456789abcdef<", "\"\"\"\"\"\"\"\"\"\"\"\"\"\"\"\"\"",
+    };
+
+    for (size_t c = 0; c < sizeof(values) / sizeof(values[0]); c++)
+    {
+        WDDX_defer(w);
+        char path[64];
+
+        w = wddx_create();
+        CHECK(w != NULL);
+        CHECK(wddx_put_string(w, "0,STRING", values[c]));
+        CHECK(wddx_put_number(w, "0,NUMBER", (double)c / 4));
+        CHECK(wddx_put_bool(w, "0,BOOL", (c % 2) == 0));
+        snprintf(path, sizeof(path), "0,KEY %s,3", values[c]);
+        CHECK(wddx_put_string(w, path, values[c]));
+        CHECK(serializer_matches_libxml2(w));
+    }
+
+    /* empty packet, holes in an array, a struct in an array */
+    {
+        WDDX_defer(w);
+        w = wddx_create();
+        CHECK(w != NULL);
+        CHECK(serializer_matches_libxml2(w));
+        CHECK(wddx_put_string(w, "2,1,NAME", "x"));
+        CHECK(serializer_matches_libxml2(w));
+    }
+
+    return PASS;
+}
+
+static int test_serializer_escapes_ampersand(void)
+{
+    /* libxml2 read '&' in values as markup and dropped "a & b"; the direct serializer escapes it */
+    static const char *values[] = { "a & b", "&amp;", "&#65;", "&foo;", "x&" };
+
+    for (size_t c = 0; c < sizeof(values) / sizeof(values[0]); c++)
+    {
+        WDDX_defer(w);
+        WDDX_defer(parsed);
+
+        w = wddx_create();
+        CHECK(w != NULL);
+        CHECK(wddx_put_string(w, "0,EXPRESSION", values[c]));
+
+        parsed = wddx_from_xml(wddx_to_xml(w));
+        CHECK(parsed != NULL);
+        CHECK(strcmp(wddx_get_string(parsed, "0,EXPRESSION"), values[c]) == 0);
+    }
+
+    return PASS;
+}
+
+static int test_serializer_to_buffer(void)
+{
+    cfrds_buffer_defer(out);
+    WDDX_defer(w);
+
+    w = wddx_create();
+    CHECK(w != NULL);
+    CHECK(wddx_put_string(w, "0,COMMAND", "SET_BREAKPOINT"));
+    CHECK(cfrds_buffer_create(&out));
+    CHECK(cfrds_buffer_append(out, "prefix:"));
+
+    CHECK(wddx_to_buffer(w, out));
+    CHECK(cfrds_buffer_append_bytes(out, "", 1));
+    CHECK(strcmp(cfrds_buffer_data(out), "prefix:<wddxPacket version=\"1.0\"><header/><data><array length=\"1\">"
+                 "<struct type=\"java.util.HashMap\"><var name=\"COMMAND\"><string>SET_BREAKPOINT</string></var>"
+                 "</struct></array></data></wddxPacket>") == 0);
+
+    CHECK(!wddx_to_buffer(NULL, out));
+    CHECK(!wddx_to_buffer(w, NULL));
+
+    /* the packet's own buffer is reused */
+    const char *first = wddx_to_xml(w);
+    CHECK(first != NULL);
+    CHECK(strcmp(first, cfrds_buffer_data(out) + 7) == 0);
+    CHECK(wddx_to_xml(w) == first);
+
+    return PASS;
+}
+
+/* ── arena ─────────────────────────────────────────────────────────────── */
+
+/* The fixtures' data, each repeated under its own key, in one arena freed by wddx_cleanup(). */
+static int test_arena_fixtures_scaled(void)
+{
+    static const char *fixtures[] = { FIXTURE_STRING, FIXTURE_NUMBER, FIXTURE_BOOL_TRUE, FIXTURE_ARRAY,
+                                      FIXTURE_STRUCT, FIXTURE_NESTED, FIXTURE_EMPTY_STRING };
+    const size_t copies = 2000;
+    cfrds_buffer_defer(xml);
+    WDDX_defer(w);
+    char key[64];
+
+    CHECK(cfrds_buffer_create(&xml));
+    CHECK(cfrds_buffer_append(xml, "<wddxPacket version=\"1.0\"><header/><data><struct>"));
+    for (size_t k = 0; k < copies; k++)
+    {
+        const char *fixture = fixtures[k % (sizeof(fixtures) / sizeof(fixtures[0]))];
+        const char *data = strstr(fixture, "<data>") + strlen("<data>");
+        const char *data_end = strstr(data, "</data>");
+
+        snprintf(key, sizeof(key), "<var name=\"K%zu\">", k);
+        CHECK(cfrds_buffer_append(xml, key));
+        CHECK(cfrds_buffer_append_bytes(xml, data, (size_t)(data_end - data)));
+        CHECK(cfrds_buffer_append(xml, "</var>"));
+    }
+    CHECK(cfrds_buffer_append(xml, "</struct></data></wddxPacket>"));
+    CHECK(cfrds_buffer_append_bytes(xml, "", 1));
+
+    CHECK(reader_matches_dom(cfrds_buffer_data(xml)));
+
+    w = wddx_from_xml(cfrds_buffer_data(xml));
+    CHECK(w != NULL);
+    CHECK(wddx_node_struct_size(wddx_data(w)) == (int)copies);
+    CHECK(strcmp(wddx_get_string(w, "K1995"), "Hello, World!") == 0);
+    CHECK(wddx_node_array_size(wddx_get_var(w, "K1998")) == 2);
+    CHECK(strcmp(wddx_get_string(w, "K1999,host"), "localhost") == 0);
+    CHECK(wddx_node_array_size(wddx_get_var(w, "K1993,items")) == 3);
+
+    wddx_cleanup(&w);
+    CHECK(w == NULL);
+
+    return PASS;
+}
+
+/* Outgrown values and items lists stay in the arena, the tree only sees the new ones. */
+static int test_arena_put_replace_grow(void)
+{
+    WDDX_defer(w);
+    char path[64];
+    char value[64];
+
+    w = wddx_create();
+    CHECK(w != NULL);
+
+    for (int c = 0; c < 500; c++)
+    {
+        snprintf(value, sizeof(value), "value %d", c);
+        CHECK(wddx_put_string(w, "0,COMMAND", value));
+        snprintf(path, sizeof(path), "%d,KEY%d", c % 50, c);
+        CHECK(wddx_put_string(w, path, value + 6));
+    }
+
+    CHECK(strcmp(wddx_get_string(w, "0,COMMAND"), "value 499") == 0);
+    CHECK(wddx_node_array_size(wddx_data(w)) == 50);
+    CHECK(wddx_node_struct_size(wddx_get_var(w, "0")) == 11);
+    CHECK(wddx_node_struct_size(wddx_get_var(w, "49")) == 10);
+    CHECK(strcmp(wddx_get_string(w, "49,KEY499"), "499") == 0);
+    CHECK(strcmp(wddx_get_string(w, "0,KEY450"), "450") == 0);
+
+    WDDX_defer(parsed);
+    parsed = wddx_from_xml(wddx_to_xml(w));
+    CHECK(parsed != NULL);
+    CHECK(strcmp(wddx_get_string(parsed, "0,COMMAND"), "value 499") == 0);
+
+    return PASS;
+}
+
+/* Overwriting a value reuses its node when the new one fits and doubles the room when not. */
+static int test_arena_put_overwrite_reuse(void)
+{
+    WDDX_defer(w);
+    char value[1001];
+
+    w = wddx_create();
+    CHECK(w != NULL);
+
+    CHECK(wddx_put_string(w, "0,NAME", "the first value"));
+    const WDDX_NODE *node = wddx_get_var(w, "0,NAME");
+    CHECK(node != NULL);
+
+    CHECK(wddx_put_string(w, "0,NAME", "short"));
+    CHECK(wddx_get_var(w, "0,NAME") == node);
+    CHECK(strcmp(wddx_get_string(w, "0,NAME"), "short") == 0);
+
+    CHECK(wddx_put_number(w, "0,NAME", 42));
+    CHECK(wddx_get_var(w, "0,NAME") == node);
+    CHECK(wddx_node_type(node) == WDDX_NUMBER);
+
+    /* a value growing by one byte per put is moved only a logarithmic number of times */
+    int moves = 0;
+    for (size_t c = 1; c < sizeof(value); c++)
+    {
+        memset(value, 'x', c);
+        value[c] = '\0';
+        CHECK(wddx_put_string(w, "0,NAME", value));
+        if (wddx_get_var(w, "0,NAME") != node)
+            moves++;
+        node = wddx_get_var(w, "0,NAME");
+    }
+    CHECK(moves <= 10);
+    CHECK(strlen(wddx_get_string(w, "0,NAME")) == sizeof(value) - 1);
+
+    WDDX_defer(parsed);
+    parsed = wddx_from_xml(wddx_to_xml(w));
+    CHECK(parsed != NULL);
+    CHECK(strcmp(wddx_get_string(parsed, "0,NAME"), value) == 0);
+
+    return PASS;
+}
+
+/* Bytes taken by the chunks of a packet's arena. */
+static size_t arena_size(const WDDX *w)
+{
+    size_t ret = 0;
+
+    for (const cfrds_arena_chunk *chunk = w->arena->chunk; chunk; chunk = chunk->next)
+        ret += chunk->size;
+
+    return ret;
+}
+
+/* Appending N items to an array or a struct takes arena memory linear in N. */
+static int test_arena_put_append_linear(void)
+{
+    enum { COUNT = 9999 };
+    char path[32];
+
+    for (int kind = 0; kind < 2; kind++)
+    {
+        WDDX_defer(w);
+
+        w = wddx_create();
+        CHECK(w != NULL);
+
+        for (int c = 0; c < COUNT; c++)
+        {
+            snprintf(path, sizeof(path), kind ? "0,K%d" : "0,%d", c);
+            CHECK(wddx_put_number(w, path, c));
+        }
+
+        const WDDX_NODE *node = wddx_get_var(w, "0");
+        CHECK(kind ? wddx_node_struct_size(node) == COUNT : wddx_node_array_size(node) == COUNT);
+        CHECK(strcmp(wddx_node_string(wddx_get_var(w, kind ? "0,K9998" : "0,9998")), "9998") == 0);
+
+        /* about 100 bytes per item, the quadratic copies took hundreds of MB */
+        CHECK(arena_size(w) < 4 * 1024 * 1024);
+    }
+
+    return PASS;
+}
+
 /* ── main ──────────────────────────────────────────────────────────────── */
 
 int main(void)
@@ -592,6 +1280,34 @@ int main(void)
     RUN(test_wddx_array_bounds);
     RUN(test_wddx_put_partial_failure);
 
+    /* reader vs. libxml2 DOM */
+    RUN(test_reader_fixtures);
+    RUN(test_reader_text);
+    RUN(test_reader_containers);
+    RUN(test_reader_packet);
+    RUN(test_reader_malformed);
+    RUN(test_reader_depth);
+
+    /* struct key index */
+    RUN(test_struct_index_parsed);
+    RUN(test_struct_index_small);
+    RUN(test_struct_index_put);
+
+    /* compiled paths */
+    RUN(test_path_compiled_matches);
+    RUN(test_path_static_once);
+
+    /* direct serializer */
+    RUN(test_serializer_matches_libxml2);
+    RUN(test_serializer_escapes_ampersand);
+    RUN(test_serializer_to_buffer);
+
+    /* arena */
+    RUN(test_arena_fixtures_scaled);
+    RUN(test_arena_put_replace_grow);
+    RUN(test_arena_put_overwrite_reuse);
+    RUN(test_arena_put_append_linear);
+
     printf("\n%d test(s) failed.\n", _failures);
     return _failures ? 1 : 0;
 }